@@ -300,10 +300,10 @@ void PhysicsWorld2D::Update(float timeStep)
 
     using namespace PhysicsPreStep;
 
-    VariantMap& eventData = GetEventDataMap();
-    eventData[P_WORLD] = this;
-    eventData[P_TIMESTEP] = timeStep;
-    SendEvent(E_PHYSICSPRESTEP, eventData);
+    Payload payload;
+    payload.world_ = this;
+    payload.timeStep_ = timeStep;
+    SendTypedEvent(E_PHYSICSPRESTEP, payload);
 
     physicsStepping_ = true;
     world_->Step(timeStep, velocityIterations_, positionIterations_);
@@ -346,7 +346,9 @@ void PhysicsWorld2D::Update(float timeStep)
     SendBeginContactEvents();
     SendEndContactEvents();
 
-    using namespace PhysicsPostStep;
+    VariantMap& eventData = GetEventDataMap();
+    eventData[PhysicsPostStep::P_WORLD] = this;
+    eventData[PhysicsPostStep::P_TIMESTEP] = timeStep;
     SendEvent(E_PHYSICSPOSTSTEP, eventData);
 }
 
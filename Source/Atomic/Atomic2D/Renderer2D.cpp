@@ -49,6 +49,57 @@ namespace Atomic
 extern const char* blendModeNames[];
 
 static const unsigned MASK_VERTEX2D = MASK_POSITION | MASK_COLOR | MASK_TEXCOORD1;
+/// Minimum number of source batches per work item when calculating sort keys and copying vertices.
+static const unsigned MIN_SOURCE_BATCHES_PER_WORK_ITEM = 1024;
+
+/// Destination of the vertices copied by a work item.
+struct VertexCopy2D
+{
+    /// Locked vertex buffer.
+    Vertex2D* dest_;
+    /// First source batch of the view.
+    const SourceBatch2D* const* sourceBatches_;
+    /// Vertex start of each source batch.
+    const unsigned* vertexStarts_;
+};
+
+void CalculateSortKeysWork(const WorkItem* item, unsigned threadIndex)
+{
+    Camera* camera = reinterpret_cast<Camera*>(item->aux_);
+    SourceBatch2DSortItem* start = reinterpret_cast<SourceBatch2DSortItem*>(item->start_);
+    SourceBatch2DSortItem* end = reinterpret_cast<SourceBatch2DSortItem*>(item->end_);
+
+    while (start != end)
+    {
+        const SourceBatch2D* sourceBatch = start->sourceBatch_;
+        sourceBatch->distance_ = camera->GetDistance(sourceBatch->owner_->GetNode()->GetWorldPosition());
+
+        // Map the float distance to an unsigned integer of the same order, then invert it to sort far to near
+        unsigned distanceBits;
+        memcpy(&distanceBits, &sourceBatch->distance_, sizeof distanceBits);
+        distanceBits = (distanceBits & 0x80000000) ? ~distanceBits : (distanceBits | 0x80000000);
+
+        start->key_[0] = ~distanceBits;
+        start->key_[1] = (unsigned)sourceBatch->drawOrder_ ^ 0x80000000;
+        start->key_[2] = sourceBatch->material_->GetNameHash().Value();
+        ++start;
+    }
+}
+
+static void CopyVerticesWork(const WorkItem* item, unsigned threadIndex)
+{
+    const VertexCopy2D* copy = reinterpret_cast<const VertexCopy2D*>(item->aux_);
+    const SourceBatch2D* const* start = reinterpret_cast<const SourceBatch2D* const*>(item->start_);
+    const SourceBatch2D* const* end = reinterpret_cast<const SourceBatch2D* const*>(item->end_);
+
+    Vertex2D* dest = copy->dest_ + copy->vertexStarts_[start - copy->sourceBatches_];
+    while (start != end)
+    {
+        const Vector<Vertex2D>& vertices = (*start++)->vertices_;
+        memcpy(dest, vertices.Buffer(), vertices.Size() * sizeof(Vertex2D));
+        dest += vertices.Size();
+    }
+}
 
 ViewBatchInfo2D::ViewBatchInfo2D() :
     vertexBufferUpdateFrameNumber_(0),
@@ -222,15 +273,32 @@ void Renderer2D::UpdateGeometry(const FrameInfo& frame)
             Vertex2D* dest = reinterpret_cast<Vertex2D*>(vertexBuffer->Lock(0, vertexCount, true));
             if (dest)
             {
+                ATOMIC_PROFILE(CopyVertices2D);
+
+                // Every source batch has a precalculated vertex start, so ranges of them can be copied in parallel
                 const PODVector<const SourceBatch2D*>& sourceBatches = viewBatchInfo.sourceBatches_;
-                for (unsigned b = 0; b < sourceBatches.Size(); ++b)
+                VertexCopy2D copy;
+                copy.dest_ = dest;
+                copy.sourceBatches_ = sourceBatches.Buffer();
+                copy.vertexStarts_ = viewBatchInfo.vertexStarts_.Buffer();
+
+                WorkQueue* queue = GetSubsystem<WorkQueue>();
+                unsigned numWorkItems = Min(queue->GetNumThreads() + 1,
+                    (sourceBatches.Size() + MIN_SOURCE_BATCHES_PER_WORK_ITEM - 1) / MIN_SOURCE_BATCHES_PER_WORK_ITEM);
+                unsigned batchesPerItem = numWorkItems ? (sourceBatches.Size() + numWorkItems - 1) / numWorkItems : 0;
+
+                for (unsigned start = 0; start < sourceBatches.Size(); start += batchesPerItem)
                 {
-                    const Vector<Vertex2D>& vertices = sourceBatches[b]->vertices_;
-                    for (unsigned i = 0; i < vertices.Size(); ++i)
-                        dest[i] = vertices[i];
-                    dest += vertices.Size();
+                    SharedPtr<WorkItem> item = queue->GetFreeItem();
+                    item->priority_ = M_MAX_UNSIGNED;
+                    item->workFunction_ = CopyVerticesWork;
+                    item->aux_ = &copy;
+                    item->start_ = (void*)(copy.sourceBatches_ + start);
+                    item->end_ = (void*)(copy.sourceBatches_ + Min(start + batchesPerItem, sourceBatches.Size()));
+                    queue->AddWorkItem(item);
                 }
 
+                queue->Complete(M_MAX_UNSIGNED);
                 vertexBuffer->Unlock();
             }
             else
@@ -424,20 +492,6 @@ void Renderer2D::GetDrawables(PODVector<Drawable2D*>& dest, Node* node)
         GetDrawables(dest, i->Get());
 }
 
-static inline bool CompareSourceBatch2Ds(const SourceBatch2D* lhs, const SourceBatch2D* rhs)
-{
-    if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ > rhs->distance_;
-
-    if (lhs->drawOrder_ != rhs->drawOrder_)
-        return lhs->drawOrder_ < rhs->drawOrder_;
-
-    if (lhs->material_ != rhs->material_)
-        return lhs->material_->GetNameHash() < rhs->material_->GetNameHash();
-
-    return lhs < rhs;
-}
-
 void Renderer2D::UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* camera)
 {
     // Already update in same frame
@@ -459,15 +513,36 @@ void Renderer2D::UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* cam
         }
     }
 
-    for (unsigned i = 0; i < sourceBatches.Size(); ++i)
+    // Calculate distances and sort keys in parallel
     {
-        const SourceBatch2D* sourceBatch = sourceBatches[i];
-        Vector3 worldPos = sourceBatch->owner_->GetNode()->GetWorldPosition();
-        sourceBatch->distance_ = camera->GetDistance(worldPos);
+        ATOMIC_PROFILE(CalculateSortKeys2D);
+
+        sortItems_.Resize(sourceBatches.Size());
+        for (unsigned i = 0; i < sourceBatches.Size(); ++i)
+            sortItems_[i].sourceBatch_ = sourceBatches[i];
+
+        WorkQueue* queue = GetSubsystem<WorkQueue>();
+        unsigned numWorkItems = Min(queue->GetNumThreads() + 1,
+            (sortItems_.Size() + MIN_SOURCE_BATCHES_PER_WORK_ITEM - 1) / MIN_SOURCE_BATCHES_PER_WORK_ITEM);
+        unsigned itemsPerWorkItem = numWorkItems ? (sortItems_.Size() + numWorkItems - 1) / numWorkItems : 0;
+
+        for (unsigned start = 0; start < sortItems_.Size(); start += itemsPerWorkItem)
+        {
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = CalculateSortKeysWork;
+            item->aux_ = camera;
+            item->start_ = sortItems_.Buffer() + start;
+            item->end_ = sortItems_.Buffer() + Min(start + itemsPerWorkItem, sortItems_.Size());
+            queue->AddWorkItem(item);
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
     }
-    
-    Sort(sourceBatches.Begin(), sourceBatches.End(), CompareSourceBatch2Ds);
 
+    SortSourceBatches(sourceBatches);
+
+    viewBatchInfo.vertexStarts_.Resize(sourceBatches.Size());
     viewBatchInfo.batchCount_ = 0;
     Material* currMaterial = 0;
     unsigned iStart = 0;
@@ -481,6 +556,7 @@ void Renderer2D::UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* cam
         distance = Min(distance, sourceBatches[b]->distance_);
         Material* material = sourceBatches[b]->material_;
         const Vector<Vertex2D>& vertices = sourceBatches[b]->vertices_;
+        viewBatchInfo.vertexStarts_[b] = vStart + vCount;
 
         // When new material encountered, finish the current batch and start new
         if (currMaterial != material)
@@ -520,6 +596,54 @@ void Renderer2D::UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* cam
     viewBatchInfo.batchUpdatedFrameNumber_ = frame_.frameNumber_;
 }
 
+void Renderer2D::SortSourceBatches(PODVector<const SourceBatch2D*>& sourceBatches)
+{
+    ATOMIC_PROFILE(SortSourceBatches2D);
+
+    unsigned count = sortItems_.Size();
+    sortItemsTemp_.Resize(count);
+
+    // Count the byte histograms of all key words in one pass
+    static const unsigned NUM_DIGITS = 12;
+    unsigned histograms[NUM_DIGITS][256];
+    memset(histograms, 0, sizeof histograms);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        const unsigned* key = sortItems_[i].key_;
+        for (unsigned d = 0; d < NUM_DIGITS; ++d)
+            ++histograms[d][(key[2 - (d >> 2)] >> ((d & 3) << 3)) & 0xff];
+    }
+
+    // Stable LSD radix sort from the least significant byte of the material to the most significant byte of the
+    // distance. Bytes that are the same for all source batches, such as the distance in an orthographic view, are skipped
+    SourceBatch2DSortItem* src = sortItems_.Buffer();
+    SourceBatch2DSortItem* dest = sortItemsTemp_.Buffer();
+    for (unsigned d = 0; d < NUM_DIGITS; ++d)
+    {
+        unsigned* histogram = histograms[d];
+        unsigned word = 2 - (d >> 2);
+        unsigned shift = (d & 3) << 3;
+        if (count && histogram[(src[0].key_[word] >> shift) & 0xff] == count)
+            continue;
+
+        unsigned offset = 0;
+        for (unsigned i = 0; i < 256; ++i)
+        {
+            unsigned bucketSize = histogram[i];
+            histogram[i] = offset;
+            offset += bucketSize;
+        }
+
+        for (unsigned i = 0; i < count; ++i)
+            dest[histogram[(src[i].key_[word] >> shift) & 0xff]++] = src[i];
+
+        Swap(src, dest);
+    }
+
+    for (unsigned i = 0; i < count; ++i)
+        sourceBatches[i] = src[i].sourceBatch_;
+}
+
 void Renderer2D::AddViewBatch(ViewBatchInfo2D& viewBatchInfo, Material* material, 
     unsigned indexStart, unsigned indexCount, unsigned vertexStart, unsigned vertexCount, float distance)
 {
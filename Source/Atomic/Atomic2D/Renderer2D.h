@@ -36,6 +36,15 @@ class VertexBuffer;
 struct FrameInfo;
 struct SourceBatch2D;
 
+/// 2D source batch with its sort key, from most to least significant: distance, draw order and material.
+struct SourceBatch2DSortItem
+{
+    /// Sort key.
+    unsigned key_[3];
+    /// Source batch.
+    const SourceBatch2D* sourceBatch_;
+};
+
 /// 2D view batch info.
 struct ViewBatchInfo2D
 {
@@ -54,6 +63,8 @@ struct ViewBatchInfo2D
     unsigned batchUpdatedFrameNumber_;
     /// Source batches.
     PODVector<const SourceBatch2D*> sourceBatches_;
+    /// Vertex start of each source batch.
+    PODVector<unsigned> vertexStarts_;
     /// Batch count;
     unsigned batchCount_;
     /// Distances.
@@ -70,6 +81,7 @@ class ATOMIC_API Renderer2D : public Drawable
     ATOMIC_OBJECT(Renderer2D, Drawable);
 
     friend void CheckDrawableVisibilityWork(const WorkItem* item, unsigned threadIndex);
+    friend void CalculateSortKeysWork(const WorkItem* item, unsigned threadIndex);
 
 public:
     /// Construct.
@@ -117,6 +129,8 @@ private:
     void GetDrawables(PODVector<Drawable2D*>& drawables, Node* node);
     /// Update view batch info.
     void UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* camera);
+    /// Sort the source batches by key with a radix sort.
+    void SortSourceBatches(PODVector<const SourceBatch2D*>& sourceBatches);
     /// Add view batch.
     void AddViewBatch(ViewBatchInfo2D& viewBatchInfo, Material* material, 
         unsigned indexStart, unsigned indexCount, unsigned vertexStart, unsigned vertexCount, float distance);
@@ -139,6 +153,10 @@ private:
     HashMap<Texture2D*, HashMap<int, SharedPtr<Material> > > cachedMaterials_;
     /// Cached techniques per blend mode.
     HashMap<int, SharedPtr<Technique> > cachedTechniques_;
+    /// Source batch sort items.
+    PODVector<SourceBatch2DSortItem> sortItems_;
+    /// Source batch sort items being sorted into.
+    PODVector<SourceBatch2DSortItem> sortItemsTemp_;
 
     // ATOMIC BEGIN
 
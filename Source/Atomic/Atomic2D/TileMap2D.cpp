@@ -43,7 +43,8 @@ namespace Atomic
 extern const char* ATOMIC2D_CATEGORY;
 
 TileMap2D::TileMap2D(Context* context) :
-    Component(context)
+    Component(context),
+    tileChunkSize_(0)
 {
 }
 
@@ -56,6 +57,10 @@ void TileMap2D::RegisterObject(Context* context)
     context->RegisterFactory<TileMap2D>(ATOMIC2D_CATEGORY);
 
     ATOMIC_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    // ATOMIC BEGIN
+    // Before the tmx file so that loading does not build the layers twice
+    ATOMIC_ACCESSOR_ATTRIBUTE("Tile Chunk Size", GetTileChunkSize, SetTileChunkSize, int, 0, AM_DEFAULT);
+    // ATOMIC END
     ATOMIC_MIXED_ACCESSOR_ATTRIBUTE("Tmx File", GetTmxFileAttr, SetTmxFileAttr, ResourceRef, ResourceRef(TmxFile2D::GetTypeStatic()),
         AM_DEFAULT);
 }
@@ -148,6 +153,29 @@ void TileMap2D::SetTmxFile(TmxFile2D* tmxFile)
     }
 }
 
+// ATOMIC BEGIN
+
+void TileMap2D::SetTileChunkSize(int size)
+{
+    size = Max(size, 0);
+    if (size == tileChunkSize_)
+        return;
+
+    tileChunkSize_ = size;
+
+    // Rebuild the layers with the new layout
+    if (tmxFile_)
+    {
+        SharedPtr<TmxFile2D> tmxFile = tmxFile_;
+        SetTmxFile(0);
+        SetTmxFile(tmxFile);
+    }
+
+    MarkNetworkUpdate();
+}
+
+// ATOMIC END
+
 TmxFile2D* TileMap2D::GetTmxFile() const
 {
     return tmxFile_;
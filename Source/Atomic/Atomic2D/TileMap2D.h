@@ -78,6 +78,11 @@ public:
 
     TileMapLayer2D* GetLayerByName(const String& name) const;
 
+    /// Set tile chunk size. Tile layers are then built as chunks of pre-built geometry instead of a sprite node per tile. 0 (default) disables chunking; keep it for maps whose tiles overlap and rely on per-tile draw order, which chunks do not preserve.
+    void SetTileChunkSize(int size);
+    /// Return tile chunk size.
+    int GetTileChunkSize() const { return tileChunkSize_; }
+
     // ATOMIC END
 
 private:
@@ -89,6 +94,10 @@ private:
     SharedPtr<Node> rootNode_;
     /// Tile map layers.
     Vector<WeakPtr<TileMapLayer2D> > layers_;
+    // ATOMIC BEGIN
+    /// Tile chunk size, 0 if tile layers are not chunked.
+    int tileChunkSize_;
+    // ATOMIC END
 };
 
 }
@@ -0,0 +1,203 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Texture2D.h"
+#include "../Scene/Node.h"
+#include "../Atomic2D/Renderer2D.h"
+#include "../Atomic2D/Sprite2D.h"
+#include "../Atomic2D/TileMapChunk2D.h"
+#include "../Atomic2D/TmxFile2D.h"
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+extern const char* ATOMIC2D_CATEGORY;
+
+TileMapChunk2D::TileMapChunk2D(Context* context) :
+    Drawable2D(context),
+    numTiles_(0)
+{
+}
+
+TileMapChunk2D::~TileMapChunk2D()
+{
+}
+
+void TileMapChunk2D::RegisterObject(Context* context)
+{
+    context->RegisterFactory<TileMapChunk2D>(ATOMIC2D_CATEGORY);
+
+    ATOMIC_COPY_BASE_ATTRIBUTES(Drawable2D);
+}
+
+void TileMapChunk2D::SetTiles(const TileMapInfo2D& info, const TmxTileLayer2D* tileLayer, const IntRect& tileRect)
+{
+    tileRect_ = tileRect;
+    numTiles_ = 0;
+    textures_.Clear();
+    localVertices_.Clear();
+    boundingBox_.Clear();
+
+    unsigned color = Color::WHITE.ToUInt();
+
+    // Tiles are grouped into one source batch per texture, so the per-tile row order is not kept between textures
+    for (int y = tileRect.top_; y < tileRect.bottom_; ++y)
+    {
+        for (int x = tileRect.left_; x < tileRect.right_; ++x)
+        {
+            const Tile2D* tile = tileLayer->GetTile(x, y);
+            if (!tile)
+                continue;
+
+            Sprite2D* sprite = tile->GetSprite();
+            if (!sprite || !sprite->GetTexture())
+                continue;
+
+            Rect drawRect;
+            Rect textureRect;
+            if (!sprite->GetDrawRectangle(drawRect) || !sprite->GetTextureRectangle(textureRect))
+                continue;
+
+            unsigned batchIndex = 0;
+            while (batchIndex < textures_.Size() && textures_[batchIndex] != sprite->GetTexture())
+                ++batchIndex;
+            if (batchIndex == textures_.Size())
+            {
+                textures_.Push(SharedPtr<Texture2D>(sprite->GetTexture()));
+                localVertices_.Resize(textures_.Size());
+            }
+
+            Vector2 position = info.TileIndexToPosition(x, y);
+            drawRect.min_ += position;
+            drawRect.max_ += position;
+
+            /*
+            V1---------V2
+            |         / |
+            |       /   |
+            |     /     |
+            |   /       |
+            | /         |
+            V0---------V3
+            */
+            Vertex2D vertex0;
+            Vertex2D vertex1;
+            Vertex2D vertex2;
+            Vertex2D vertex3;
+
+            vertex0.position_ = Vector3(drawRect.min_.x_, drawRect.min_.y_, 0.0f);
+            vertex1.position_ = Vector3(drawRect.min_.x_, drawRect.max_.y_, 0.0f);
+            vertex2.position_ = Vector3(drawRect.max_.x_, drawRect.max_.y_, 0.0f);
+            vertex3.position_ = Vector3(drawRect.max_.x_, drawRect.min_.y_, 0.0f);
+
+            vertex0.uv_ = textureRect.min_;
+            vertex1.uv_ = Vector2(textureRect.min_.x_, textureRect.max_.y_);
+            vertex2.uv_ = textureRect.max_;
+            vertex3.uv_ = Vector2(textureRect.max_.x_, textureRect.min_.y_);
+
+            vertex0.color_ = vertex1.color_ = vertex2.color_ = vertex3.color_ = color;
+
+            PODVector<Vertex2D>& vertices = localVertices_[batchIndex];
+            vertices.Push(vertex0);
+            vertices.Push(vertex1);
+            vertices.Push(vertex2);
+            vertices.Push(vertex3);
+
+            boundingBox_.Merge(vertex0.position_);
+            boundingBox_.Merge(vertex2.position_);
+            ++numTiles_;
+        }
+    }
+
+    sourceBatches_.Resize(textures_.Size());
+    for (unsigned i = 0; i < sourceBatches_.Size(); ++i)
+    {
+        sourceBatches_[i].owner_ = this;
+        sourceBatches_[i].drawOrder_ = GetDrawOrder();
+    }
+
+    UpdateMaterials();
+
+    sourceBatchesDirty_ = true;
+    if (node_)
+        OnMarkedDirty(node_);
+}
+
+void TileMapChunk2D::OnSceneSet(Scene* scene)
+{
+    Drawable2D::OnSceneSet(scene);
+
+    UpdateMaterials();
+}
+
+void TileMapChunk2D::OnWorldBoundingBoxUpdate()
+{
+    // The local box is known from the tile rectangles, so there is no need to walk the vertices
+    worldBoundingBox_ = boundingBox_.Transformed(node_->GetWorldTransform());
+}
+
+void TileMapChunk2D::OnDrawOrderChanged()
+{
+    for (unsigned i = 0; i < sourceBatches_.Size(); ++i)
+        sourceBatches_[i].drawOrder_ = GetDrawOrder();
+}
+
+void TileMapChunk2D::UpdateSourceBatches()
+{
+    if (!sourceBatchesDirty_)
+        return;
+
+    // Only runs when the layer node moves, otherwise the cached world-space vertices are reused every frame
+    const Matrix3x4& worldTransform = node_->GetWorldTransform();
+    for (unsigned i = 0; i < sourceBatches_.Size(); ++i)
+    {
+        const PODVector<Vertex2D>& localVertices = localVertices_[i];
+        Vector<Vertex2D>& vertices = sourceBatches_[i].vertices_;
+        vertices.Resize(localVertices.Size());
+
+        for (unsigned j = 0; j < localVertices.Size(); ++j)
+        {
+            vertices[j] = localVertices[j];
+            vertices[j].position_ = worldTransform * localVertices[j].position_;
+        }
+    }
+
+    sourceBatchesDirty_ = false;
+}
+
+void TileMapChunk2D::UpdateMaterials()
+{
+    if (!renderer_)
+        return;
+
+    for (unsigned i = 0; i < sourceBatches_.Size(); ++i)
+        sourceBatches_[i].material_ = renderer_->GetMaterial(textures_[i], BLEND_ALPHA);
+}
+
+}
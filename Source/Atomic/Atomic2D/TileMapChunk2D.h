@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Atomic2D/Drawable2D.h"
+
+namespace Atomic
+{
+
+class TileMapInfo2D;
+class TmxTileLayer2D;
+
+/// Pre-built geometry of a rectangular chunk of tiles in a tile map layer, culled as a whole. The geometry is one batch per texture and chunks are ordered by chunk index, so unlike per-tile sprites, tiles that overlap their neighbours (e.g. tall or isometric tiles) are not guaranteed to draw in row order across textures or chunk borders.
+class ATOMIC_API TileMapChunk2D : public Drawable2D
+{
+    ATOMIC_OBJECT(TileMapChunk2D, Drawable2D);
+
+public:
+    /// Construct.
+    TileMapChunk2D(Context* context);
+    /// Destruct.
+    ~TileMapChunk2D();
+    /// Register object factory. Drawable2D must be registered first.
+    static void RegisterObject(Context* context);
+
+    /// Build geometry from the tiles of a tile layer inside the tile index rectangle (right and bottom exclusive).
+    void SetTiles(const TileMapInfo2D& info, const TmxTileLayer2D* tileLayer, const IntRect& tileRect);
+
+    /// Return tile index rectangle.
+    const IntRect& GetTileRect() const { return tileRect_; }
+    /// Return number of tiles in the chunk geometry.
+    unsigned GetNumTiles() const { return numTiles_; }
+
+protected:
+    /// Handle scene being assigned.
+    virtual void OnSceneSet(Scene* scene);
+    /// Recalculate the world-space bounding box.
+    virtual void OnWorldBoundingBoxUpdate();
+    /// Handle draw order changed.
+    virtual void OnDrawOrderChanged();
+    /// Update source batches.
+    virtual void UpdateSourceBatches();
+
+private:
+    /// Update materials of the source batches from their textures.
+    void UpdateMaterials();
+
+    /// Tile index rectangle.
+    IntRect tileRect_;
+    /// Number of tiles.
+    unsigned numTiles_;
+    /// Texture per source batch.
+    Vector<SharedPtr<Texture2D> > textures_;
+    /// Node-local vertices per source batch.
+    Vector<PODVector<Vertex2D> > localVertices_;
+};
+
+}
@@ -148,6 +148,8 @@ public:
 
     /// Return Object Group.
     TmxObjectGroup2D* GetObjectGroup() const;
+    /// Return whether the tile has any properties.
+    bool HasProperties() const { return propertySet_.NotNull(); }
 
     // ATOMIC END
 
@@ -33,6 +33,7 @@
 
 // ATOMIC BEGIN
 #include "../Atomic2D/RigidBody2D.h"
+#include "../Atomic2D/TileMapChunk2D.h"
 // ATOMIC END
 
 #include "../DebugNew.h"
@@ -189,6 +190,16 @@ void TileMapLayer2D::Initialize(TileMap2D* tileMap, const TmxLayer2D* tmxLayer)
         nodes_.Clear();
     }
 
+    // ATOMIC BEGIN
+    for (unsigned i = 0; i < chunks_.Size(); ++i)
+    {
+        if (chunks_[i])
+            chunks_[i]->Remove();
+    }
+
+    chunks_.Clear();
+    // ATOMIC END
+
     tileLayer_ = 0;
     objectGroup_ = 0;
     imageLayer_ = 0;
@@ -236,6 +247,14 @@ void TileMapLayer2D::SetDrawOrder(int drawOrder)
         if (staticSprite)
             staticSprite->SetLayer(drawOrder_);
     }
+
+    // ATOMIC BEGIN
+    for (unsigned i = 0; i < chunks_.Size(); ++i)
+    {
+        if (chunks_[i])
+            chunks_[i]->SetLayer(drawOrder_);
+    }
+    // ATOMIC END
 }
 
 void TileMapLayer2D::SetVisible(bool visible)
@@ -250,6 +269,14 @@ void TileMapLayer2D::SetVisible(bool visible)
         if (nodes_[i])
             nodes_[i]->SetEnabled(visible_);
     }
+
+    // ATOMIC BEGIN
+    for (unsigned i = 0; i < chunks_.Size(); ++i)
+    {
+        if (chunks_[i])
+            chunks_[i]->SetEnabled(visible_);
+    }
+    // ATOMIC END
 }
 
 TileMap2D* TileMapLayer2D::GetTileMap() const
@@ -295,6 +322,18 @@ Tile2D* TileMapLayer2D::GetTile(int x, int y) const
     return tileLayer_->GetTile(x, y);
 }
 
+// ATOMIC BEGIN
+
+TileMapChunk2D* TileMapLayer2D::GetChunk(unsigned index) const
+{
+    if (index >= chunks_.Size())
+        return 0;
+
+    return chunks_[index];
+}
+
+// ATOMIC END
+
 Node* TileMapLayer2D::GetTileNode(int x, int y) const
 {
     if (!tileLayer_)
@@ -341,6 +380,26 @@ Node* TileMapLayer2D::GetImageNode() const
     return nodes_[0];
 }
 
+// ATOMIC BEGIN
+
+// Return whether a tile defines at least one valid collision shape
+static bool HasTileCollision(const Tile2D* tile)
+{
+    TmxObjectGroup2D* group = tile->GetObjectGroup();
+    if (!group)
+        return false;
+
+    for (unsigned i = 0; i < group->GetNumObjects(); i++)
+    {
+        if (group->GetObject(i)->ValidCollisionShape())
+            return true;
+    }
+
+    return false;
+}
+
+// ATOMIC END
+
 void TileMapLayer2D::SetTileLayer(const TmxTileLayer2D* tileLayer)
 {
     tileLayer_ = tileLayer;
@@ -350,6 +409,39 @@ void TileMapLayer2D::SetTileLayer(const TmxTileLayer2D* tileLayer)
     nodes_.Resize((unsigned)(width * height));
 
     const TileMapInfo2D& info = tileMap_->GetInfo();
+
+    // ATOMIC BEGIN
+
+    // In chunked mode the sprites are baked into chunk geometry and tile nodes only exist for tiles with properties or physics
+    int chunkSize = tileMap_->GetTileChunkSize();
+    if (chunkSize > 0)
+    {
+        int numChunksX = (width + chunkSize - 1) / chunkSize;
+        for (int chunkY = 0; chunkY * chunkSize < height; ++chunkY)
+        {
+            for (int chunkX = 0; chunkX < numChunksX; ++chunkX)
+            {
+                IntRect tileRect(chunkX * chunkSize, chunkY * chunkSize, Min((chunkX + 1) * chunkSize, width),
+                    Min((chunkY + 1) * chunkSize, height));
+
+                TileMapChunk2D* chunk = GetNode()->CreateComponent<TileMapChunk2D>(LOCAL);
+                chunk->SetTemporary(true);
+                chunk->SetTiles(info, tileLayer, tileRect);
+                if (!chunk->GetNumTiles())
+                {
+                    chunk->Remove();
+                    continue;
+                }
+
+                chunk->SetLayer(drawOrder_);
+                chunk->SetOrderInLayer(chunkY * numChunksX + chunkX);
+                chunks_.Push(SharedPtr<TileMapChunk2D>(chunk));
+            }
+        }
+    }
+
+    // ATOMIC END
+
     for (int y = 0; y < height; ++y)
     {
         for (int x = 0; x < width; ++x)
@@ -358,41 +450,40 @@ void TileMapLayer2D::SetTileLayer(const TmxTileLayer2D* tileLayer)
             if (!tile)
                 continue;
 
+            // ATOMIC BEGIN
+            bool hasCollision = HasTileCollision(tile);
+            if (chunkSize > 0 && !hasCollision && !tile->HasProperties())
+                continue;
+            // ATOMIC END
+
             SharedPtr<Node> tileNode(GetNode()->CreateTemporaryChild("Tile"));
             tileNode->SetPosition(info.TileIndexToPosition(x, y));
 
-            StaticSprite2D* staticSprite = tileNode->CreateComponent<StaticSprite2D>();
-            staticSprite->SetSprite(tile->GetSprite());
-            staticSprite->SetLayer(drawOrder_);
-            staticSprite->SetOrderInLayer(y * width + x);
-
             // ATOMIC BEGIN
+            if (chunkSize <= 0)
+            {
+                StaticSprite2D* staticSprite = tileNode->CreateComponent<StaticSprite2D>();
+                staticSprite->SetSprite(tile->GetSprite());
+                staticSprite->SetLayer(drawOrder_);
+                staticSprite->SetOrderInLayer(y * width + x);
+            }
 
             // collision
-            RigidBody2D *body = NULL;
-            TmxObjectGroup2D* group = tile->GetObjectGroup();
-            if (group)
+            if (hasCollision)
             {
+                RigidBody2D* body = tileNode->CreateComponent<RigidBody2D>();
+                body->SetBodyType(BT_STATIC);
+
+                TmxObjectGroup2D* group = tile->GetObjectGroup();
                 for (unsigned i = 0; i < group->GetNumObjects(); i++)
                 {
                     TileMapObject2D* o = group->GetObject(i);
 
                     if (o->ValidCollisionShape())
-                    {
-                        if (!body)
-                        {
-                            body = tileNode->CreateComponent<RigidBody2D>();
-                            body->SetBodyType(BT_STATIC);
-                        }
-
                         o->CreateCollisionShape(tileNode);
-
-                    }
                 }
-
             }
 
-
             // ATOMIC END
 
             nodes_[y * width + x] = tileNode;
@@ -35,6 +35,7 @@ namespace Atomic
 class DebugRenderer;
 class Node;
 class TileMap2D;
+class TileMapChunk2D;
 class TmxImageLayer2D;
 class TmxLayer2D;
 class TmxObjectGroup2D;
@@ -86,7 +87,7 @@ public:
     int GetWidth() const;
     /// Return height (for tile layer only).
     int GetHeight() const;
-    /// Return tile node (for tile layer only).
+    /// Return tile node (for tile layer only). In chunked mode only tiles with properties or collision have a node.
     Node* GetTileNode(int x, int y) const;
     /// Return tile (for tile layer only).
     Tile2D* GetTile(int x, int y) const;
@@ -103,6 +104,10 @@ public:
 
     // ATOMIC BEGIN
     const String& GetName() const;
+    /// Return number of tile chunks (for chunked tile layer only).
+    unsigned GetNumChunks() const { return chunks_.Size(); }
+    /// Return tile chunk at index (for chunked tile layer only).
+    TileMapChunk2D* GetChunk(unsigned index) const;
     // ATOMIC END
 
 private:
@@ -129,6 +134,10 @@ private:
     bool visible_;
     /// Tile node or image nodes.
     Vector<SharedPtr<Node> > nodes_;
+    // ATOMIC BEGIN
+    /// Tile chunks in chunked mode.
+    Vector<SharedPtr<TileMapChunk2D> > chunks_;
+    // ATOMIC END
 };
 
 }
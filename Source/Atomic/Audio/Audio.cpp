@@ -26,16 +26,24 @@
 #include "../Audio/Sound.h"
 #include "../Audio/SoundListener.h"
 #include "../Audio/SoundSource3D.h"
+#include "../Audio/SoundStream.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/Timer.h"
+#include "../IO/File.h"
 #include "../IO/Log.h"
 
 // ATOMIC BEGIN
 #include <SDL/include/SDL.h>
 // ATOMIC END
 
+#ifdef ATOMIC_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 #ifdef _MSC_VER
@@ -51,14 +59,70 @@ static const int MIN_BUFFERLENGTH = 20;
 static const int MIN_MIXRATE = 11025;
 static const int MAX_MIXRATE = 48000;
 static const StringHash SOUND_MASTER_HASH("Master");
+static const unsigned DEFAULT_MAX_VOICES = 64;
+static const float DEFAULT_VIRTUALIZATION_GAIN = 0.001f;
+/// Length of sound stream data decoded ahead of playback.
+static const int DECODE_AHEAD_LENGTH = 400;
+/// Length of sound stream data decoded synchronously when playback starts.
+static const int DECODE_AHEAD_PRIME_LENGTH = 100;
+/// Time the decoder threads sleep when no stream needs decoding.
+static const unsigned DECODE_IDLE_MSEC = 5;
 
 static void SDLAudioCallback(void* userdata, Uint8* stream, int len);
 
+/// Thread that keeps sound streams decoded ahead of playback.
+class SoundDecoderThread : public Thread, public RefCounted
+{
+    ATOMIC_REFCOUNTED(SoundDecoderThread)
+
+public:
+    /// Construct.
+    SoundDecoderThread(Audio* owner) :
+        owner_(owner)
+    {
+    }
+
+    /// Decode streams until stopped.
+    virtual void ThreadFunction()
+    {
+        while (shouldRun_)
+        {
+            SoundStream* stream = owner_->ClaimDecodeStream();
+            if (stream)
+                owner_->ReleaseDecodeStream(stream, stream->DecodeAhead());
+            else
+            {
+                Time::Sleep(DECODE_IDLE_MSEC);
+                owner_->ResetIdleDecodeStreams();
+            }
+        }
+    }
+
+private:
+    /// Audio subsystem.
+    Audio* owner_;
+};
+
 Audio::Audio(Context* context) :
     Object(context),
     deviceID_(0),
     sampleSize_(0),
-    playing_(false)
+    playing_(false),
+    maxVoices_(DEFAULT_MAX_VOICES),
+    virtualizationGain_(DEFAULT_VIRTUALIZATION_GAIN),
+    numVoices_(0),
+    numVirtualVoices_(0),
+#ifdef ATOMIC_THREADING
+    numDecoderThreads_(1),
+#else
+    numDecoderThreads_(0),
+#endif
+    streamUnderruns_(0),
+    offline_(false),
+    offlineRealtime_(false),
+    offlineTime_(0.0f),
+    numOfflineSamples_(0),
+    recordedBytes_(0)
 {
     context_->RequireSDL(SDL_INIT_AUDIO);
 
@@ -73,6 +137,7 @@ Audio::Audio(Context* context) :
 
 Audio::~Audio()
 {
+    StopDecoderThreads();
     Release();
     context_->ReleaseSDL();
 }
@@ -130,13 +195,7 @@ bool Audio::SetMode(int bufferLengthMSec, int mixRate, bool stereo, bool interpo
     }
 #endif
 
-    stereo_ = obtained.channels == 2;
-    sampleSize_ = (unsigned)(stereo_ ? sizeof(int) : sizeof(short));
-    // Guarantee a fragment size that is low enough so that Vorbis decoding buffers do not wrap
-    fragmentSize_ = Min(NextPowerOfTwo((unsigned)(mixRate >> 6)), (unsigned)obtained.samples);
-    mixRate_ = obtained.freq;
-    interpolation_ = interpolation;
-    clipBuffer_ = new int[stereo ? fragmentSize_ << 1 : fragmentSize_];
+    SetupMixing(obtained.freq, obtained.channels == 2, interpolation, (unsigned)obtained.samples);
 
     ATOMIC_LOGINFO("Set audio mode " + String(mixRate_) + " Hz " + (stereo_ ? "stereo" : "mono") + " " +
             (interpolation_ ? "interpolated" : ""));
@@ -144,6 +203,129 @@ bool Audio::SetMode(int bufferLengthMSec, int mixRate, bool stereo, bool interpo
     return Play();
 }
 
+bool Audio::SetOfflineMode(int mixRate, bool stereo, bool interpolation, bool realtime)
+{
+    Release();
+
+    // Offline output must be deterministic, so streams are decoded synchronously on the mixing thread instead of on the
+    // decoder threads. Mixing is stopped at this point, so the decode-ahead buffers can be dropped safely
+    StopDecoderThreads();
+    {
+        MutexLock lock(decodeMutex_);
+        for (Vector<DecodeStream>::Iterator i = decodeStreams_.Begin(); i != decodeStreams_.End(); ++i)
+        {
+            streamUnderruns_ += i->stream_->GetNumUnderruns();
+            i->stream_->SetDecodeAheadSize(0);
+        }
+        decodeStreams_.Clear();
+    }
+
+    mixRate = Clamp(mixRate, MIN_MIXRATE, MAX_MIXRATE);
+    SetupMixing(mixRate, stereo, interpolation, M_MAX_UNSIGNED);
+    offlineBuffer_ = new unsigned char[fragmentSize_ * sampleSize_ * SAMPLE_SIZE_MUL];
+    offline_ = true;
+    offlineRealtime_ = realtime;
+    offlineTime_ = 0.0f;
+    numOfflineSamples_ = 0;
+
+    ATOMIC_LOGINFO("Set offline audio mode " + String(mixRate_) + " Hz " + (stereo_ ? "stereo" : "mono") + " " +
+            (interpolation_ ? "interpolated" : ""));
+
+    return Play();
+}
+
+unsigned Audio::MixOffline(void* dest, unsigned samples)
+{
+    if (!offline_)
+        return 0;
+
+    ATOMIC_PROFILE(MixOfflineAudio);
+
+    MutexLock lock(audioMutex_);
+    unsigned sampleBytes = sampleSize_ * SAMPLE_SIZE_MUL;
+    unsigned remaining = samples;
+
+    while (remaining)
+    {
+        // Without a destination, mix a fragment at a time into the internal buffer
+        unsigned workSamples = dest ? remaining : Min(remaining, fragmentSize_);
+        unsigned char* workDest = dest ? (unsigned char*)dest : offlineBuffer_.Get();
+        MixOutput(workDest, workSamples);
+
+        if (recordFile_)
+            recordedBytes_ += recordFile_->Write(workDest, workSamples * sampleBytes);
+
+        remaining -= workSamples;
+        if (dest)
+            dest = (unsigned char*)dest + workSamples * sampleBytes;
+    }
+
+    numOfflineSamples_ += samples;
+    return samples;
+}
+
+bool Audio::StartRecording(const String& fileName)
+{
+    if (!offline_)
+    {
+        ATOMIC_LOGERROR("Recording is only supported with offline audio output");
+        return false;
+    }
+
+    StopRecording();
+
+    SharedPtr<File> file(new File(context_, fileName, FILE_WRITE));
+    if (!file->IsOpen())
+    {
+        ATOMIC_LOGERROR("Could not open " + fileName + " for recording audio");
+        return false;
+    }
+
+    // Write the WAV header with the data sizes patched when the recording is finished. Output is 16-bit PCM,
+    // or 32-bit float where the mixer outputs float
+    unsigned channels = stereo_ ? 2 : 1;
+    unsigned bits = 16 * SAMPLE_SIZE_MUL;
+    unsigned blockAlign = channels * bits / 8;
+    file->WriteFileID("RIFF");
+    file->WriteUInt(0);
+    file->WriteFileID("WAVE");
+    file->WriteFileID("fmt ");
+    file->WriteUInt(16);
+    file->WriteUShort((unsigned short)(SAMPLE_SIZE_MUL == 2 ? 3 : 1));
+    file->WriteUShort((unsigned short)channels);
+    file->WriteUInt((unsigned)mixRate_);
+    file->WriteUInt((unsigned)mixRate_ * blockAlign);
+    file->WriteUShort((unsigned short)blockAlign);
+    file->WriteUShort((unsigned short)bits);
+    file->WriteFileID("data");
+    file->WriteUInt(0);
+
+    MutexLock lock(audioMutex_);
+    recordFile_ = file;
+    recordedBytes_ = 0;
+    return true;
+}
+
+void Audio::StopRecording()
+{
+    SharedPtr<File> file;
+    {
+        MutexLock lock(audioMutex_);
+        file = recordFile_;
+        recordFile_.Reset();
+    }
+
+    if (!file)
+        return;
+
+    // Patch the RIFF and data chunk sizes
+    file->Seek(4);
+    file->WriteUInt(recordedBytes_ + 36);
+    file->Seek(40);
+    file->WriteUInt(recordedBytes_);
+    file->Close();
+}
+
 void Audio::Update(float timeStep)
 {
     if (!playing_)
@@ -157,13 +339,14 @@ bool Audio::Play()
     if (playing_)
         return true;
 
-    if (!deviceID_)
+    if (!deviceID_ && !offline_)
     {
         ATOMIC_LOGERROR("No audio mode set, can not start playback");
         return false;
     }
 
-    SDL_PauseAudioDevice(deviceID_, 0);
+    if (deviceID_)
+        SDL_PauseAudioDevice(deviceID_, 0);
 
     // Update sound sources before resuming playback to make sure 3D positions are up to date
     UpdateInternal(0.0f);
@@ -220,6 +403,33 @@ void Audio::StopSound(Sound* soundClip)
     }
 }
 
+void Audio::SetMaxVoices(unsigned voices)
+{
+    MutexLock lock(audioMutex_);
+    maxVoices_ = voices;
+}
+
+void Audio::SetVirtualizationGain(float gain)
+{
+    MutexLock lock(audioMutex_);
+    virtualizationGain_ = Max(gain, 0.0f);
+}
+
+void Audio::SetNumDecoderThreads(unsigned threads)
+{
+#ifdef ATOMIC_THREADING
+    numDecoderThreads_ = threads;
+
+    // Running threads are restarted with the new count
+    if (!decoderThreads_.Empty())
+    {
+        StopDecoderThreads();
+        MutexLock lock(decodeMutex_);
+        CreateDecoderThreads(decodeStreams_.Empty() ? numDecoderThreads_ : Max(numDecoderThreads_, 1U));
+    }
+#endif
+}
+
 float Audio::GetMasterGain(const String& type) const
 {
     // By definition previously unknown types return full volume
@@ -248,12 +458,93 @@ void Audio::AddSoundSource(SoundSource* channel)
 
 void Audio::RemoveSoundSource(SoundSource* channel)
 {
+    MutexLock lock(audioMutex_);
     PODVector<SoundSource*>::Iterator i = soundSources_.Find(channel);
     if (i != soundSources_.End())
+        soundSources_.Erase(i);
+}
+
+void Audio::AddDecodeStream(SoundStream* stream)
+{
+    // In offline mode the stream is decoded on the mixing thread for deterministic output
+    if (!stream || !numDecoderThreads_ || offline_)
+        return;
+
+    // Decode the beginning synchronously so that playback does not start with an underrun
+    stream->SetDecodeAheadSize(stream->GetSampleSize() * stream->GetIntFrequency() * DECODE_AHEAD_LENGTH / 1000);
+    stream->DecodeAhead(stream->GetSampleSize() * stream->GetIntFrequency() * DECODE_AHEAD_PRIME_LENGTH / 1000);
+
+    MutexLock lock(decodeMutex_);
+    DecodeStream entry;
+    entry.stream_ = stream;
+    entry.decoding_ = false;
+    entry.idle_ = false;
+    entry.held_ = false;
+    decodeStreams_.Push(entry);
+
+    if (decoderThreads_.Empty())
+        CreateDecoderThreads(numDecoderThreads_);
+}
+
+void Audio::RemoveDecodeStream(SoundStream* stream)
+{
+    if (!stream || !stream->GetDecodeAheadSize())
+        return;
+
+    {
+        MutexLock lock(decodeMutex_);
+        if (HoldDecodeStream(stream))
+        {
+            for (Vector<DecodeStream>::Iterator i = decodeStreams_.Begin(); i != decodeStreams_.End(); ++i)
+            {
+                if (i->stream_ == stream)
+                {
+                    streamUnderruns_ += stream->GetNumUnderruns();
+                    decodeStreams_.Erase(i);
+                    break;
+                }
+            }
+        }
+    }
+
+    // The stream may be played again later without decoding ahead
+    stream->SetDecodeAheadSize(0);
+}
+
+bool Audio::SeekDecodeStream(SoundStream* stream, unsigned sampleNumber)
+{
+    if (!stream)
+        return false;
+
+    bool held;
+    {
+        MutexLock lock(decodeMutex_);
+        held = HoldDecodeStream(stream);
+    }
+
+    // The mixer reads the decoded data, so the seek and the reset of the decode-ahead buffer are done under the audio mutex.
+    // No decoder thread can claim the stream meanwhile
+    bool success;
     {
         MutexLock lock(audioMutex_);
-        soundSources_.Erase(i);
+        success = stream->Seek(sampleNumber);
+        if (success && held)
+            stream->ResetDecodeAhead();
     }
+
+    if (held)
+        UnholdDecodeStream(stream);
+
+    return success;
+}
+
+unsigned Audio::GetNumStreamUnderruns() const
+{
+    MutexLock lock(decodeMutex_);
+    unsigned underruns = streamUnderruns_;
+    for (Vector<DecodeStream>::ConstIterator i = decodeStreams_.Begin(); i != decodeStreams_.End(); ++i)
+        underruns += i->stream_->GetNumUnderruns();
+    return underruns;
 }
 
 float Audio::GetSoundSourceMasterGain(StringHash typeHash) const
@@ -280,60 +571,143 @@ void SDLAudioCallback(void* userdata, Uint8* stream, int len)
     }
 }
 
+/// Compare sound sources for mixing order: higher priority first, then louder first.
+static bool CompareVoices(SoundSource* lhs, SoundSource* rhs)
+{
+    if (lhs->GetPriority() != rhs->GetPriority())
+        return lhs->GetPriority() > rhs->GetPriority();
+    return lhs->GetAudibility() > rhs->GetAudibility();
+}
+
+/// Convert float samples to clamped 16-bit output.
+static void ConvertToShort(short* dest, const float* src, unsigned count)
+{
+    unsigned i = 0;
+#ifdef ATOMIC_SSE
+    // Packing with signed saturation performs the clamping
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), scale));
+        __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale));
+        _mm_storeu_si128((__m128i*)(dest + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < count; ++i)
+        dest[i] = (short)Clamp((int)(src[i] * 32767.0f), -32768, 32767);
+}
+
+/// Convert float samples to clamped float output.
+static void ConvertToFloat(float* dest, const float* src, unsigned count)
+{
+    unsigned i = 0;
+#ifdef ATOMIC_SSE
+    const __m128 minValue = _mm_set1_ps(-1.0f);
+    const __m128 maxValue = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dest + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), minValue), maxValue));
+#endif
+    for (; i < count; ++i)
+        dest[i] = Clamp(src[i], -1.0f, 1.0f);
+}
+
 void Audio::MixOutput(void* dest, unsigned samples)
 {
-    if (!playing_ || !clipBuffer_)
+    if (!playing_ || !mixBuffer_)
     {
         memset(dest, 0, samples * sampleSize_ * SAMPLE_SIZE_MUL);
         return;
     }
 
+    SelectVoices();
+
     while (samples)
     {
-        // If sample count exceeds the fragment (clip buffer) size, split the work
+        // If sample count exceeds the fragment (mix buffer) size, split the work
         unsigned workSamples = Min(samples, fragmentSize_);
-        unsigned clipSamples = workSamples;
+        unsigned mixSamples = workSamples;
         if (stereo_)
-            clipSamples <<= 1;
+            mixSamples <<= 1;
 
-        // Clear clip buffer
-        int* clipPtr = clipBuffer_.Get();
-        memset(clipPtr, 0, clipSamples * sizeof(int));
+        // Clear mix buffer
+        float* mixPtr = mixBuffer_.Get();
+        memset(mixPtr, 0, mixSamples * sizeof(float));
 
-        // Mix samples to clip buffer
-        for (PODVector<SoundSource*>::Iterator i = soundSources_.Begin(); i != soundSources_.End(); ++i)
-        {
-            SoundSource* source = *i;
+        // Mix samples to mix buffer. Virtual voices only advance their playback positions
+        for (PODVector<SoundSource*>::Iterator i = voices_.Begin(); i != voices_.End(); ++i)
+            (*i)->Mix(mixPtr, workSamples, mixRate_, stereo_, interpolation_);
+        for (PODVector<SoundSource*>::Iterator i = virtualVoices_.Begin(); i != virtualVoices_.End(); ++i)
+            (*i)->Mix(0, workSamples, mixRate_, stereo_, interpolation_);
 
-            // Check for pause if necessary
-            if (!pausedSoundTypes_.Empty())
-            {
-                if (pausedSoundTypes_.Contains(source->GetSoundType()))
-                    continue;
-            }
-
-            source->Mix(clipPtr, workSamples, mixRate_, stereo_, interpolation_);
-        }
-        // Copy output from clip buffer to destination
+        // Copy output from mix buffer to destination
 #ifdef __EMSCRIPTEN__
-        float* destPtr = (float*)dest;
-        while (clipSamples--)
-            *destPtr++ = (float)Clamp(*clipPtr++, -32768, 32767) / 32768.0f;
+        ConvertToFloat((float*)dest, mixPtr, mixSamples);
 #else
-        short* destPtr = (short*)dest;
-        while (clipSamples--)
-            *destPtr++ = (short)Clamp(*clipPtr++, -32768, 32767);
+        ConvertToShort((short*)dest, mixPtr, mixSamples);
 #endif
         samples -= workSamples;
         ((unsigned char*&)dest) += sampleSize_ * SAMPLE_SIZE_MUL * workSamples;
     }
 }
 
+void Audio::SelectVoices()
+{
+    voices_.Clear();
+    virtualVoices_.Clear();
+
+    for (PODVector<SoundSource*>::Iterator i = soundSources_.Begin(); i != soundSources_.End(); ++i)
+    {
+        SoundSource* source = *i;
+
+        // Check for pause if necessary
+        if (!pausedSoundTypes_.Empty())
+        {
+            if (pausedSoundTypes_.Contains(source->GetSoundType()))
+                continue;
+        }
+
+        if (!source->IsPlaying() || !source->IsEnabledEffective())
+            continue;
+
+        if (source->GetAudibility() <= virtualizationGain_)
+            virtualVoices_.Push(source);
+        else
+            voices_.Push(source);
+    }
+
+    // Over the voice limit, keep the most important voices
+    if (maxVoices_ && voices_.Size() > maxVoices_)
+    {
+        Sort(voices_.Begin(), voices_.End(), CompareVoices);
+        for (unsigned i = maxVoices_; i < voices_.Size(); ++i)
+            virtualVoices_.Push(voices_[i]);
+        voices_.Resize(maxVoices_);
+    }
+
+    for (PODVector<SoundSource*>::Iterator i = voices_.Begin(); i != voices_.End(); ++i)
+        (*i)->SetVirtual(false);
+    for (PODVector<SoundSource*>::Iterator i = virtualVoices_.Begin(); i != virtualVoices_.End(); ++i)
+        (*i)->SetVirtual(true);
+
+    numVoices_ = voices_.Size();
+    numVirtualVoices_ = virtualVoices_.Size();
+}
+
 void Audio::HandleRenderUpdate(StringHash eventType, VariantMap& eventData)
 {
     using namespace RenderUpdate;
 
-    Update(eventData[P_TIMESTEP].GetFloat());
+    float timeStep = eventData[P_TIMESTEP].GetFloat();
+    Update(timeStep);
+
+    // Stand in for the audio device by mixing the elapsed time
+    if (offline_ && offlineRealtime_ && playing_)
+    {
+        offlineTime_ += timeStep;
+        unsigned samples = (unsigned)(offlineTime_ * mixRate_);
+        offlineTime_ -= (float)samples / (float)mixRate_;
+        MixOffline(0, samples);
+    }
 }
 
 void Audio::Release()
@@ -344,10 +718,29 @@ void Audio::Release()
     {
         SDL_CloseAudioDevice(deviceID_);
         deviceID_ = 0;
-        clipBuffer_.Reset();
+        mixBuffer_.Reset();
+    }
+
+    if (offline_)
+    {
+        StopRecording();
+        offline_ = false;
+        offlineBuffer_.Reset();
+        mixBuffer_.Reset();
     }
 }
 
+void Audio::SetupMixing(int mixRate, bool stereo, bool interpolation, unsigned maxFragmentSize)
+{
+    stereo_ = stereo;
+    sampleSize_ = (unsigned)(stereo_ ? sizeof(int) : sizeof(short));
+    // Guarantee a fragment size that is low enough so that Vorbis decoding buffers do not wrap
+    fragmentSize_ = Min(NextPowerOfTwo((unsigned)(mixRate >> 6)), maxFragmentSize);
+    mixRate_ = mixRate;
+    interpolation_ = interpolation;
+    mixBuffer_ = new float[stereo_ ? fragmentSize_ << 1 : fragmentSize_];
+}
+
 void Audio::UpdateInternal(float timeStep)
 {
     ATOMIC_PROFILE(UpdateAudio);
@@ -368,6 +761,115 @@ void Audio::UpdateInternal(float timeStep)
     }
 }
 
+void Audio::CreateDecoderThreads(unsigned threads)
+{
+    for (unsigned i = 0; i < threads; ++i)
+    {
+        SharedPtr<SoundDecoderThread> thread(new SoundDecoderThread(this));
+        if (thread->Run())
+            decoderThreads_.Push(thread);
+        else
+            ATOMIC_LOGERROR("Could not start sound stream decoder thread");
+    }
+}
+
+void Audio::StopDecoderThreads()
+{
+    for (unsigned i = 0; i < decoderThreads_.Size(); ++i)
+        decoderThreads_[i]->Stop();
+    decoderThreads_.Clear();
+}
+
+SoundStream* Audio::ClaimDecodeStream()
+{
+    MutexLock lock(decodeMutex_);
+
+    // Prefer the stream closest to running out of data. Do not bother with streams that are mostly full
+    DecodeStream* best = 0;
+    unsigned bestDecodedBytes = M_MAX_UNSIGNED;
+    for (Vector<DecodeStream>::Iterator i = decodeStreams_.Begin(); i != decodeStreams_.End(); ++i)
+    {
+        if (i->decoding_ || i->idle_ || i->held_)
+            continue;
+
+        SoundStream* stream = i->stream_;
+        unsigned decodedBytes = stream->GetDecodedBytes();
+        if (decodedBytes > stream->GetDecodeAheadSize() - stream->GetDecodeAheadSize() / 4)
+            continue;
+        // Compare in relation to the buffer sizes, which differ by stream format
+        if (!best || (unsigned long long)decodedBytes * best->stream_->GetDecodeAheadSize() <
+            (unsigned long long)bestDecodedBytes * stream->GetDecodeAheadSize())
+        {
+            best = &(*i);
+            bestDecodedBytes = decodedBytes;
+        }
+    }
+
+    if (!best)
+        return 0;
+
+    best->decoding_ = true;
+    return best->stream_;
+}
+
+void Audio::ReleaseDecodeStream(SoundStream* stream, unsigned decodedBytes)
+{
+    MutexLock lock(decodeMutex_);
+    for (Vector<DecodeStream>::Iterator i = decodeStreams_.Begin(); i != decodeStreams_.End(); ++i)
+    {
+        if (i->stream_ == stream)
+        {
+            i->decoding_ = false;
+            i->idle_ = decodedBytes == 0;
+            if (i->held_)
+                decodeReleased_.Set();
+            break;
+        }
+    }
+}
+
+bool Audio::HoldDecodeStream(SoundStream* stream)
+{
+    for (;;)
+    {
+        Vector<DecodeStream>::Iterator i = decodeStreams_.Begin();
+        while (i != decodeStreams_.End() && i->stream_ != stream)
+            ++i;
+        if (i == decodeStreams_.End())
+            return false;
+
+        i->held_ = true;
+        if (!i->decoding_)
+            return true;
+
+        // Wait for the decoder thread to release the stream. The audio mutex is never held here, so mixing goes on
+        decodeMutex_.Release();
+        decodeReleased_.Wait();
+        decodeMutex_.Acquire();
+    }
+}
+
+void Audio::UnholdDecodeStream(SoundStream* stream)
+{
+    MutexLock lock(decodeMutex_);
+    for (Vector<DecodeStream>::Iterator i = decodeStreams_.Begin(); i != decodeStreams_.End(); ++i)
+    {
+        if (i->stream_ == stream)
+        {
+            i->held_ = false;
+            i->idle_ = false;
+            break;
+        }
+    }
+}
+
+void Audio::ResetIdleDecodeStreams()
+{
+    MutexLock lock(decodeMutex_);
+    for (Vector<DecodeStream>::Iterator i = decodeStreams_.Begin(); i != decodeStreams_.End(); ++i)
+        i->idle_ = false;
+}
+
 void RegisterAudioLibrary(Context* context)
 {
     Sound::RegisterObject(context);
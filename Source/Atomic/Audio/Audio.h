@@ -25,6 +25,7 @@
 #include "../Audio/AudioDefs.h"
 #include "../Container/ArrayPtr.h"
 #include "../Container/HashSet.h"
+#include "../Core/Condition.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 
@@ -32,15 +33,20 @@ namespace Atomic
 {
 
 class AudioImpl;
+class File;
 class Sound;
+class SoundDecoderThread;
 class SoundListener;
 class SoundSource;
+class SoundStream;
 
 /// %Audio subsystem.
 class ATOMIC_API Audio : public Object
 {
     ATOMIC_OBJECT(Audio, Object);
 
+    friend class SoundDecoderThread;
+
 public:
     /// Construct.
     Audio(Context* context);
@@ -49,6 +55,14 @@ public:
 
     /// Initialize sound output with specified buffer length and output mode.
     bool SetMode(int bufferLengthMSec, int mixRate, bool stereo, bool interpolation = true);
+    /// Initialize offline sound output without an audio device. Output is mixed with MixOffline(), and additionally on each frame by the elapsed time if realtime is true. Streams are decoded on the mixing thread for deterministic output.
+    bool SetOfflineMode(int mixRate, bool stereo, bool interpolation = true, bool realtime = true);
+    /// Mix offline sound output. The destination may be null to only record and advance playback. Return number of samples mixed.
+    unsigned MixOffline(void* dest, unsigned samples);
+    /// Start recording offline sound output to a WAV file. Return true on success.
+    bool StartRecording(const String& fileName);
+    /// Finish recording offline sound output.
+    void StopRecording();
     /// Run update on sound sources. Not required for continued playback, but frees unused sound sources & sounds and updates 3D positions.
     void Update(float timeStep);
     /// Restart sound output.
@@ -67,6 +81,12 @@ public:
     void SetListener(SoundListener* listener);
     /// Stop any sound source playing a certain sound clip.
     void StopSound(Sound* sound);
+    /// Set maximum number of voices mixed at once, 0 for unlimited. Sound sources beyond the limit are virtualized by priority and audibility.
+    void SetMaxVoices(unsigned voices);
+    /// Set effective gain below which a sound source is virtualized: it keeps its playback position but is not mixed.
+    void SetVirtualizationGain(float gain);
+    /// Set number of threads that decode sound streams ahead of playback, 0 to decode on the mixing thread. Streams already decoding ahead keep at least one thread.
+    void SetNumDecoderThreads(unsigned threads);
 
     /// Return byte size of one sample.
     unsigned GetSampleSize() const { return sampleSize_; }
@@ -83,8 +103,38 @@ public:
     /// Return whether audio is being output.
     bool IsPlaying() const { return playing_; }
 
-    /// Return whether an audio stream has been reserved.
-    bool IsInitialized() const { return deviceID_ != 0; }
+    /// Return maximum number of voices mixed at once.
+    unsigned GetMaxVoices() const { return maxVoices_; }
+
+    /// Return effective gain below which a sound source is virtualized.
+    float GetVirtualizationGain() const { return virtualizationGain_; }
+
+    /// Return number of voices mixed in the last output period.
+    unsigned GetNumVoices() const { return numVoices_; }
+
+    /// Return number of virtualized voices in the last output period.
+    unsigned GetNumVirtualVoices() const { return numVirtualVoices_; }
+
+    /// Return number of sound stream decoder threads.
+    unsigned GetNumDecoderThreads() const { return numDecoderThreads_; }
+
+    /// Return total number of times the mixer ran out of decoded sound stream data.
+    unsigned GetNumStreamUnderruns() const;
+
+    /// Return whether an audio stream has been reserved or offline output is in use.
+    bool IsInitialized() const { return deviceID_ != 0 || offline_; }
+
+    /// Return whether offline output without an audio device is in use.
+    bool IsOffline() const { return offline_; }
+
+    /// Return whether offline output is mixed automatically on each frame.
+    bool IsOfflineRealtime() const { return offlineRealtime_; }
+
+    /// Return whether offline output is being recorded.
+    bool IsRecording() const { return recordFile_.NotNull(); }
+
+    /// Return total number of offline output samples mixed.
+    unsigned long long GetNumOfflineSamples() const { return numOfflineSamples_; }
 
     /// Return master gain for a specific sound source type. Unknown sound types will return full gain (1).
     float GetMasterGain(const String& type) const;
@@ -105,6 +155,12 @@ public:
     void AddSoundSource(SoundSource* soundSource);
     /// Remove a sound source. Called by SoundSource.
     void RemoveSoundSource(SoundSource* soundSource);
+    /// Start decoding a sound stream ahead of playback. Called by SoundSource.
+    void AddDecodeStream(SoundStream* stream);
+    /// Stop decoding a sound stream ahead of playback and wait for a decoder thread to finish with it. Called by SoundSource without the audio mutex locked, after no sound source mixes the stream anymore.
+    void RemoveDecodeStream(SoundStream* stream);
+    /// Seek a sound stream and discard the data decoded ahead. Return true on success. Called by SoundSource without the audio mutex locked, as it may wait for a decoder thread.
+    bool SeekDecodeStream(SoundStream* stream, unsigned sampleNumber);
 
     /// Return audio thread mutex.
     Mutex& GetMutex() { return audioMutex_; }
@@ -128,9 +184,27 @@ private:
     void Release();
     /// Actually update sound sources with the specific timestep. Called internally.
     void UpdateInternal(float timeStep);
+    /// Choose the sound sources to mix and to virtualize for the next output period. Called internally.
+    void SelectVoices();
+    /// Set up the mixing buffers for the output format.
+    void SetupMixing(int mixRate, bool stereo, bool interpolation, unsigned maxFragmentSize);
+    /// Start or restart the decoder threads.
+    void CreateDecoderThreads(unsigned threads);
+    /// Stop the decoder threads.
+    void StopDecoderThreads();
+    /// Claim the sound stream with the least data decoded ahead. Return null if no stream needs decoding. Called by the decoder threads.
+    SoundStream* ClaimDecodeStream();
+    /// Release a claimed sound stream after decoding. Called by the decoder threads.
+    void ReleaseDecodeStream(SoundStream* stream, unsigned decodedBytes);
+    /// Wait until no decoder thread works on a sound stream and keep it from being claimed. Return false if the stream is not decoded ahead. Called with the decode mutex locked, which is released while waiting.
+    bool HoldDecodeStream(SoundStream* stream);
+    /// Let a held sound stream be claimed by the decoder threads again.
+    void UnholdDecodeStream(SoundStream* stream);
+    /// Make sound streams that produced no data eligible for decoding again. Called by the decoder threads when idle.
+    void ResetIdleDecodeStreams();
 
-    /// Clipping buffer for mixing.
-    SharedArrayPtr<int> clipBuffer_;
+    /// Float buffer for mixing.
+    SharedArrayPtr<float> mixBuffer_;
     /// Audio thread mutex.
     Mutex audioMutex_;
     /// SDL audio device ID.
@@ -155,6 +229,58 @@ private:
     PODVector<SoundSource*> soundSources_;
     /// Sound listener.
     WeakPtr<SoundListener> listener_;
+    /// Sound sources to mix in the current output period.
+    PODVector<SoundSource*> voices_;
+    /// Sound sources to only advance in the current output period.
+    PODVector<SoundSource*> virtualVoices_;
+    /// Maximum number of voices mixed at once.
+    unsigned maxVoices_;
+    /// Effective gain below which sound sources are virtualized.
+    float virtualizationGain_;
+    /// Number of voices mixed in the last output period.
+    unsigned numVoices_;
+    /// Number of virtualized voices in the last output period.
+    unsigned numVirtualVoices_;
+
+    /// %Sound stream being decoded ahead of playback.
+    struct DecodeStream
+    {
+        /// Stream.
+        SharedPtr<SoundStream> stream_;
+        /// Flag for a decoder thread working on the stream.
+        bool decoding_;
+        /// Flag for the stream having produced no data on its last decode.
+        bool idle_;
+        /// Flag for the main thread holding the stream, so that it is not claimed.
+        bool held_;
+    };
+
+    /// Sound streams being decoded ahead of playback.
+    Vector<DecodeStream> decodeStreams_;
+    /// Decoder threads.
+    Vector<SharedPtr<SoundDecoderThread> > decoderThreads_;
+    /// Mutex for the decoded streams.
+    mutable Mutex decodeMutex_;
+    /// Condition set by the decoder threads when they release a held stream.
+    Condition decodeReleased_;
+    /// Number of decoder threads to use.
+    unsigned numDecoderThreads_;
+    /// Underruns of streams no longer decoded ahead.
+    unsigned streamUnderruns_;
+    /// Offline output flag.
+    bool offline_;
+    /// Offline output mixed on each frame flag.
+    bool offlineRealtime_;
+    /// Elapsed time not yet mixed in realtime offline output.
+    float offlineTime_;
+    /// Total offline output samples mixed.
+    unsigned long long numOfflineSamples_;
+    /// Offline output buffer used when no destination is given.
+    SharedArrayPtr<unsigned char> offlineBuffer_;
+    /// WAV file being recorded.
+    SharedPtr<File> recordFile_;
+    /// Bytes of sound data recorded.
+    unsigned recordedBytes_;
 };
 
 /// Register Audio library objects.
@@ -33,66 +33,149 @@
 #include "../Scene/Node.h"
 #include "../Scene/ReplicationState.h"
 
+#ifdef ATOMIC_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Atomic
 {
 
-#define INC_POS_LOOPED() \
-    pos += intAdd; \
-    fractPos += fractAdd; \
-    if (fractPos > 65535) \
-    { \
-        fractPos &= 65535; \
-        ++pos; \
-    } \
-    while (pos >= end) \
-        pos -= (end - repeat); \
-
-#define INC_POS_ONESHOT() \
-    pos += intAdd; \
-    fractPos += fractAdd; \
-    if (fractPos > 65535) \
-    { \
-        fractPos &= 65535; \
-        ++pos; \
-    } \
-    if (pos >= end) \
-    { \
-        pos = 0; \
-        break; \
-    } \
-
-#define INC_POS_STEREO_LOOPED() \
-    pos += (intAdd << 1); \
-    fractPos += fractAdd; \
-    if (fractPos > 65535) \
-    { \
-        fractPos &= 65535; \
-        pos += 2; \
-    } \
-    while (pos >= end) \
-        pos -= (end - repeat); \
-
-#define INC_POS_STEREO_ONESHOT() \
-    pos += (intAdd << 1); \
-    fractPos += fractAdd; \
-    if (fractPos > 65535) \
-    { \
-        fractPos &= 65535; \
-        pos += 2; \
-    } \
-    if (pos >= end) \
-    { \
-        pos = 0; \
-        break; \
-    } \
-
-#define GET_IP_SAMPLE() (((((int)pos[1] - (int)pos[0]) * fractPos) / 65536) + (int)pos[0])
-
-#define GET_IP_SAMPLE_LEFT() (((((int)pos[2] - (int)pos[0]) * fractPos) / 65536) + (int)pos[0])
-
-#define GET_IP_SAMPLE_RIGHT() (((((int)pos[3] - (int)pos[1]) * fractPos) / 65536) + (int)pos[1])
+/// Number of output samples resampled at a time into the float staging buffers.
+static const unsigned MIX_BLOCK_SIZE = 256;
+
+/// Resample a block of sample frames into float staging buffers, advancing the playback position in 16.16 fixed point. Return the number of output samples produced, which is less than requested if a one-shot sound ends.
+template <class T, bool STEREO> static unsigned ResampleBlock(T*& pos, int& fractPos, T* end, T* repeat, bool looped,
+    int intAdd, int fractAdd, float scale, bool interpolation, float* left, float* right, float* nextLeft, float* nextRight,
+    float* fract, unsigned samples)
+{
+    const int step = STEREO ? 2 : 1;
+
+    for (unsigned i = 0; i < samples; ++i)
+    {
+        left[i] = pos[0] * scale;
+        if (STEREO)
+            right[i] = pos[1] * scale;
+        if (interpolation)
+        {
+            // The sound has safety samples past the end, so reading the next frame is always valid
+            nextLeft[i] = pos[step] * scale;
+            if (STEREO)
+                nextRight[i] = pos[step + 1] * scale;
+            fract[i] = fractPos * (1.0f / 65536.0f);
+        }
+
+        pos += intAdd * step;
+        fractPos += fractAdd;
+        if (fractPos > 65535)
+        {
+            fractPos &= 65535;
+            pos += step;
+        }
+        if (pos >= end)
+        {
+            if (!looped)
+            {
+                pos = 0;
+                return i + 1;
+            }
+            while (pos >= end)
+                pos -= (end - repeat);
+        }
+    }
+
+    return samples;
+}
+
+/// Linearly interpolate between the current and next sample frames in place.
+static void InterpolateBlock(float* samples, const float* next, const float* fract, unsigned count)
+{
+    unsigned i = 0;
+#ifdef ATOMIC_SSE
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 s = _mm_loadu_ps(samples + i);
+        __m128 delta = _mm_sub_ps(_mm_loadu_ps(next + i), s);
+        _mm_storeu_ps(samples + i, _mm_add_ps(s, _mm_mul_ps(delta, _mm_loadu_ps(fract + i))));
+    }
+#endif
+    for (; i < count; ++i)
+        samples[i] += (next[i] - samples[i]) * fract[i];
+}
+
+/// Accumulate mono samples with gain to a mono buffer.
+static void AccumulateMonoToMono(float* dest, const float* samples, float gain, unsigned count)
+{
+    unsigned i = 0;
+#ifdef ATOMIC_SSE
+    __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), _mm_mul_ps(_mm_loadu_ps(samples + i), g)));
+#endif
+    for (; i < count; ++i)
+        dest[i] += samples[i] * gain;
+}
+
+/// Accumulate mono samples with left and right gain to an interleaved stereo buffer.
+static void AccumulateMonoToStereo(float* dest, const float* samples, float leftGain, float rightGain, unsigned count)
+{
+    unsigned i = 0;
+#ifdef ATOMIC_SSE
+    __m128 g = _mm_setr_ps(leftGain, rightGain, leftGain, rightGain);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 s = _mm_loadu_ps(samples + i);
+        float* d = dest + (i << 1);
+        _mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(d), _mm_mul_ps(_mm_unpacklo_ps(s, s), g)));
+        _mm_storeu_ps(d + 4, _mm_add_ps(_mm_loadu_ps(d + 4), _mm_mul_ps(_mm_unpackhi_ps(s, s), g)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        dest[i << 1] += samples[i] * leftGain;
+        dest[(i << 1) + 1] += samples[i] * rightGain;
+    }
+}
+
+/// Accumulate stereo samples with gain to an interleaved stereo buffer.
+static void AccumulateStereoToStereo(float* dest, const float* left, const float* right, float gain, unsigned count)
+{
+    unsigned i = 0;
+#ifdef ATOMIC_SSE
+    __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 l = _mm_loadu_ps(left + i);
+        __m128 r = _mm_loadu_ps(right + i);
+        float* d = dest + (i << 1);
+        _mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(d), _mm_mul_ps(_mm_unpacklo_ps(l, r), g)));
+        _mm_storeu_ps(d + 4, _mm_add_ps(_mm_loadu_ps(d + 4), _mm_mul_ps(_mm_unpackhi_ps(l, r), g)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        dest[i << 1] += left[i] * gain;
+        dest[(i << 1) + 1] += right[i] * gain;
+    }
+}
+
+/// Accumulate stereo samples downmixed with gain to a mono buffer.
+static void AccumulateStereoToMono(float* dest, const float* left, const float* right, float gain, unsigned count)
+{
+    unsigned i = 0;
+    float halfGain = 0.5f * gain;
+#ifdef ATOMIC_SSE
+    __m128 g = _mm_set1_ps(halfGain);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 s = _mm_add_ps(_mm_loadu_ps(left + i), _mm_loadu_ps(right + i));
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), _mm_mul_ps(s, g)));
+    }
+#endif
+    for (; i < count; ++i)
+        dest[i] += (left[i] + right[i]) * halfGain;
+}
 
 static const int STREAM_SAFETY_SAMPLES = 4;
 
@@ -107,12 +190,14 @@ SoundSource::SoundSource(Context* context) :
     gain_(1.0f),
     attenuation_(1.0f),
     panning_(0.0f),
+    priority_(0),
     sendFinishedEvent_(false),
     autoRemove_(REMOVE_DISABLED),
     position_(0),
     fractPosition_(0),
     timePosition_(0.0f),
-    unusedStreamSize_(0)
+    unusedStreamSize_(0),
+    virtual_(false)
 {
     audio_ = GetSubsystem<Audio>();
 
@@ -125,7 +210,12 @@ SoundSource::SoundSource(Context* context) :
 SoundSource::~SoundSource()
 {
     if (audio_)
+    {
+        // Unlink from the mixer first, so that the decode-ahead buffer is not released while the audio thread reads it
         audio_->RemoveSoundSource(this);
+        FreeStreamLockless();
+        RemoveReleasedStreams();
+    }
 }
 
 void SoundSource::RegisterObject(Context* context)
@@ -139,6 +229,7 @@ void SoundSource::RegisterObject(Context* context)
     ATOMIC_ATTRIBUTE("Gain", float, gain_, 1.0f, AM_DEFAULT);
     ATOMIC_ATTRIBUTE("Attenuation", float, attenuation_, 1.0f, AM_DEFAULT);
     ATOMIC_ATTRIBUTE("Panning", float, panning_, 0.0f, AM_DEFAULT);
+    ATOMIC_ATTRIBUTE("Priority", int, priority_, 0, AM_DEFAULT);
     ATOMIC_ACCESSOR_ATTRIBUTE("Is Playing", IsPlaying, SetPlayingAttr, bool, false, AM_DEFAULT);
     ATOMIC_ENUM_ATTRIBUTE("Autoremove Mode", autoRemove_, autoRemoveModeNames, REMOVE_DISABLED, AM_DEFAULT);
     ATOMIC_ACCESSOR_ATTRIBUTE("Play Position", GetPositionAttr, SetPositionAttr, int, 0, AM_FILE);
@@ -160,9 +251,10 @@ void SoundSource::Seek(float seekTime)
     }
     else
     {
-        // Ogg format
-        if (soundStream_->Seek((unsigned)(seekTime * soundStream_->GetFrequency())))
+        // Ogg format. The audio subsystem locks the audio mutex for discarding the decode-ahead buffer
+        if (audio_->SeekDecodeStream(soundStream_, (unsigned)(seekTime * soundStream_->GetFrequency())))
         {
+            MutexLock lock(audio_->GetMutex());
             timePosition_ = seekTime;
         }
     }
@@ -185,6 +277,7 @@ void SoundSource::Play(Sound* sound)
     }
     else
         PlayLockless(sound);
+    RemoveReleasedStreams();
 
     // Forget the Sound & Is Playing attribute previous values so that they will be sent again, triggering
     // the sound correctly on network clients even after the initial playback
@@ -248,6 +341,7 @@ void SoundSource::Play(SoundStream* stream)
         sound_.Reset();
         PlayLockless(streamPtr);
     }
+    RemoveReleasedStreams();
 
     // Stream playback is not supported for network replication, no need to mark network dirty
 }
@@ -265,6 +359,7 @@ void SoundSource::Stop()
     }
     else
         StopLockless();
+    RemoveReleasedStreams();
 
     MarkNetworkUpdate();
 }
@@ -305,6 +400,12 @@ void SoundSource::SetPanning(float panning)
     MarkNetworkUpdate();
 }
 
+void SoundSource::SetPriority(int priority)
+{
+    priority_ = priority;
+    MarkNetworkUpdate();
+}
+
 void SoundSource::SetAutoRemoveMode(AutoRemoveMode mode)
 {
     autoRemove_ = mode;
@@ -337,7 +438,10 @@ void SoundSource::Update(float timeStep)
 
     // Free the stream if playback has stopped
     if (soundStream_ && !position_)
+    {
         StopLockless();
+        RemoveReleasedStreams();
+    }
 
     bool playing = IsPlaying();
 
@@ -363,7 +467,7 @@ void SoundSource::Update(float timeStep)
     }
 }
 
-void SoundSource::Mix(int* dest, unsigned samples, int mixRate, bool stereo, bool interpolation)
+void SoundSource::Mix(float* dest, unsigned samples, int mixRate, bool stereo, bool interpolation)
 {
     if (!position_ || (!sound_ && !soundStream_) || !IsEnabledEffective())
         return;
@@ -386,7 +490,7 @@ void SoundSource::Mix(int* dest, unsigned samples, int mixRate, bool stereo, boo
 
         // Request new data from the stream
         signed char* destination = streamBuffer_->GetStart() + unusedStreamSize_;
-        outBytes = neededSize ? soundStream_->GetData(destination, (unsigned)neededSize) : 0;
+        outBytes = neededSize ? soundStream_->ReadData(destination, (unsigned)neededSize) : 0;
         destination += outBytes;
         // Zero-fill rest if stream did not produce enough data
         if (outBytes < neededSize)
@@ -401,41 +505,11 @@ void SoundSource::Mix(int* dest, unsigned samples, int mixRate, bool stereo, boo
     if (!sound)
         return;
 
-    // Choose the correct mixing routine
-    if (!sound->IsStereo())
-    {
-        if (interpolation)
-        {
-            if (stereo)
-                MixMonoToStereoIP(sound, dest, samples, mixRate);
-            else
-                MixMonoToMonoIP(sound, dest, samples, mixRate);
-        }
-        else
-        {
-            if (stereo)
-                MixMonoToStereo(sound, dest, samples, mixRate);
-            else
-                MixMonoToMono(sound, dest, samples, mixRate);
-        }
-    }
+    // A virtual voice only advances its playback position
+    if (dest)
+        MixSound(sound, dest, samples, mixRate, stereo, interpolation);
     else
-    {
-        if (interpolation)
-        {
-            if (stereo)
-                MixStereoToStereoIP(sound, dest, samples, mixRate);
-            else
-                MixStereoToMonoIP(sound, dest, samples, mixRate);
-        }
-        else
-        {
-            if (stereo)
-                MixStereoToStereo(sound, dest, samples, mixRate);
-            else
-                MixStereoToMono(sound, dest, samples, mixRate);
-        }
-    }
+        MixZeroVolume(sound, samples, mixRate);
 
     // Update the time position. In stream mode, copy unused data back to the beginning of the stream buffer
     if (soundStream_)
@@ -446,8 +520,8 @@ void SoundSource::Mix(int* dest, unsigned samples, int mixRate, bool stereo, boo
         if (unusedStreamSize_)
             memcpy(streamBuffer_->GetStart(), (const void*)position_, (size_t)unusedStreamSize_);
 
-        // If stream did not produce any data, stop if applicable
-        if (!outBytes && soundStream_->GetStopAtEnd())
+        // If stream did not produce any data because it ended, stop if applicable. Running out of decoded data does not stop
+        if (!outBytes && soundStream_->GetStopAtEnd() && soundStream_->IsDrained())
         {
             position_ = 0;
             return;
@@ -472,8 +546,8 @@ void SoundSource::SetSoundAttr(const ResourceRef& value)
     else
     {
         // When changing the sound and not playing, free previous sound stream and stream buffer (if any)
-        soundStream_.Reset();
-        streamBuffer_.Reset();
+        FreeStreamLockless();
+        RemoveReleasedStreams();
         sound_ = newSound;
     }
 }
@@ -522,8 +596,7 @@ void SoundSource::PlayLockless(Sound* sound)
             if (start)
             {
                 // Free existing stream & stream buffer if any
-                soundStream_.Reset();
-                streamBuffer_.Reset();
+                FreeStreamLockless();
                 sound_ = sound;
                 position_ = start;
                 fractPosition_ = 0;
@@ -561,7 +634,16 @@ void SoundSource::PlayLockless(SharedPtr<SoundStream> stream)
         streamBuffer_->SetFormat(stream->GetIntFrequency(), stream->IsSixteenBit(), stream->IsStereo());
         streamBuffer_->SetLooped(true);
 
-        soundStream_ = stream;
+        // Let the audio subsystem decode the stream ahead on its decoder threads
+        if (stream != soundStream_)
+        {
+            if (soundStream_)
+                releasedStreams_.Push(soundStream_);
+            soundStream_ = stream;
+            if (audio_)
+                audio_->AddDecodeStream(soundStream_);
+        }
+
         unusedStreamSize_ = 0;
         position_ = streamBuffer_->GetStart();
         fractPosition_ = 0;
@@ -579,10 +661,28 @@ void SoundSource::StopLockless()
     timePosition_ = 0.0f;
 
     // Free the sound stream and decode buffer if a stream was playing
+    FreeStreamLockless();
+}
+
+void SoundSource::FreeStreamLockless()
+{
+    if (soundStream_)
+        releasedStreams_.Push(soundStream_);
     soundStream_.Reset();
     streamBuffer_.Reset();
 }
 
+void SoundSource::RemoveReleasedStreams()
+{
+    // Called without the audio mutex, as removing a stream may wait for a decoder thread
+    if (audio_)
+    {
+        for (unsigned i = 0; i < releasedStreams_.Size(); ++i)
+            audio_->RemoveDecodeStream(releasedStreams_[i]);
+    }
+    releasedStreams_.Clear();
+}
+
 void SoundSource::SetPlayPositionLockless(signed char* pos)
 {
     // Setting position on a stream is not supported
@@ -602,324 +702,20 @@ void SoundSource::SetPlayPositionLockless(signed char* pos)
     timePosition_ = ((float)(int)(size_t)(pos - sound_->GetStart())) / (sound_->GetSampleSize() * sound_->GetFrequency());
 }
 
-void SoundSource::MixMonoToMono(Sound* sound, int* dest, unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    int vol = (int)(256.0f * totalGain + 0.5f);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
-
-    float add = frequency_ / (float)mixRate;
-    int intAdd = (int)add;
-    int fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        short* pos = (short*)position_;
-        short* end = (short*)sound->GetEnd();
-        short* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (*pos * vol) / 256;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (*pos * vol) / 256;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        signed char* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + *pos * vol;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + *pos * vol;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixMonoToStereo(Sound* sound, int* dest, unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    int leftVol = (int)((-panning_ + 1.0f) * (256.0f * totalGain + 0.5f));
-    int rightVol = (int)((panning_ + 1.0f) * (256.0f * totalGain + 0.5f));
-    if (!leftVol && !rightVol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
-
-    float add = frequency_ / (float)mixRate;
-    int intAdd = (int)add;
-    int fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        short* pos = (short*)position_;
-        short* end = (short*)sound->GetEnd();
-        short* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (*pos * leftVol) / 256;
-                ++dest;
-                *dest = *dest + (*pos * rightVol) / 256;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (*pos * leftVol) / 256;
-                ++dest;
-                *dest = *dest + (*pos * rightVol) / 256;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        signed char* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + *pos * leftVol;
-                ++dest;
-                *dest = *dest + *pos * rightVol;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + *pos * leftVol;
-                ++dest;
-                *dest = *dest + *pos * rightVol;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixMonoToMonoIP(Sound* sound, int* dest, unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    int vol = (int)(256.0f * totalGain + 0.5f);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
-
-    float add = frequency_ / (float)mixRate;
-    int intAdd = (int)add;
-    int fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        short* pos = (short*)position_;
-        short* end = (short*)sound->GetEnd();
-        short* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (GET_IP_SAMPLE() * vol) / 256;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (GET_IP_SAMPLE() * vol) / 256;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        signed char* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + GET_IP_SAMPLE() * vol;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + GET_IP_SAMPLE() * vol;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixMonoToStereoIP(Sound* sound, int* dest, unsigned samples, int mixRate)
+void SoundSource::MixSound(Sound* sound, float* dest, unsigned samples, int mixRate, bool stereo, bool interpolation)
 {
     float totalGain = masterGain_ * attenuation_ * gain_;
-    int leftVol = (int)((-panning_ + 1.0f) * (256.0f * totalGain + 0.5f));
-    int rightVol = (int)((panning_ + 1.0f) * (256.0f * totalGain + 0.5f));
-    if (!leftVol && !rightVol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
+    bool sourceStereo = sound->IsStereo();
 
-    float add = frequency_ / (float)mixRate;
-    int intAdd = (int)add;
-    int fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        short* pos = (short*)position_;
-        short* end = (short*)sound->GetEnd();
-        short* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + (s * leftVol) / 256;
-                ++dest;
-                *dest = *dest + (s * rightVol) / 256;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + (s * leftVol) / 256;
-                ++dest;
-                *dest = *dest + (s * rightVol) / 256;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
+    // Mono sounds are panned in stereo output, stereo sounds are played back unpanned
+    float leftGain = totalGain;
+    float rightGain = totalGain;
+    if (stereo && !sourceStereo)
     {
-        signed char* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + s * leftVol;
-                ++dest;
-                *dest = *dest + s * rightVol;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + s * leftVol;
-                ++dest;
-                *dest = *dest + s * rightVol;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
+        leftGain *= 1.0f - panning_;
+        rightGain *= 1.0f + panning_;
     }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixStereoToMono(Sound* sound, int* dest, unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    int vol = (int)(256.0f * totalGain + 0.5f);
-    if (!vol)
+    if (leftGain <= 0.0f && rightGain <= 0.0f)
     {
         MixZeroVolume(sound, samples, mixRate);
         return;
@@ -929,303 +725,75 @@ void SoundSource::MixStereoToMono(Sound* sound, int* dest, unsigned samples, int
     int intAdd = (int)add;
     int fractAdd = (int)((add - floorf(add)) * 65536.0f);
     int fractPos = fractPosition_;
+    bool looped = sound->IsLooped();
+    unsigned outChannels = stereo ? 2 : 1;
 
-    if (sound->IsSixteenBit())
-    {
-        short* pos = (short*)position_;
-        short* end = (short*)sound->GetEnd();
-        short* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = ((int)pos[0] + (int)pos[1]) / 2;
-                *dest = *dest + (s * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = ((int)pos[0] + (int)pos[1]) / 2;
-                *dest = *dest + (s * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        signed char* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = ((int)pos[0] + (int)pos[1]) / 2;
-                *dest = *dest + s * vol;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = ((int)pos[0] + (int)pos[1]) / 2;
-                *dest = *dest + s * vol;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
+    float left[MIX_BLOCK_SIZE];
+    float right[MIX_BLOCK_SIZE];
+    float nextLeft[MIX_BLOCK_SIZE];
+    float nextRight[MIX_BLOCK_SIZE];
+    float fract[MIX_BLOCK_SIZE];
 
-void SoundSource::MixStereoToStereo(Sound* sound, int* dest, unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    int vol = (int)(256.0f * totalGain + 0.5f);
-    if (!vol)
+    while (samples)
     {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
+        unsigned block = Min(samples, MIX_BLOCK_SIZE);
+        unsigned count;
 
-    float add = frequency_ / (float)mixRate;
-    int intAdd = (int)add;
-    int fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        short* pos = (short*)position_;
-        short* end = (short*)sound->GetEnd();
-        short* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (pos[0] * vol) / 256;
-                ++dest;
-                *dest = *dest + (pos[1] * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
+        if (sound->IsSixteenBit())
         {
-            while (samples--)
-            {
-                *dest = *dest + (pos[0] * vol) / 256;
-                ++dest;
-                *dest = *dest + (pos[1] * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
+            short* pos = (short*)position_;
+            short* end = (short*)sound->GetEnd();
+            short* repeat = (short*)sound->GetRepeat();
+            if (sourceStereo)
+                count = ResampleBlock<short, true>(pos, fractPos, end, repeat, looped, intAdd, fractAdd, 1.0f / 32768.0f,
+                    interpolation, left, right, nextLeft, nextRight, fract, block);
+            else
+                count = ResampleBlock<short, false>(pos, fractPos, end, repeat, looped, intAdd, fractAdd, 1.0f / 32768.0f,
+                    interpolation, left, right, nextLeft, nextRight, fract, block);
             position_ = (signed char*)pos;
         }
-    }
-    else
-    {
-        signed char* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + pos[0] * vol;
-                ++dest;
-                *dest = *dest + pos[1] * vol;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
-        }
         else
         {
-            while (samples--)
-            {
-                *dest = *dest + pos[0] * vol;
-                ++dest;
-                *dest = *dest + pos[1] * vol;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
+            signed char* pos = (signed char*)position_;
+            signed char* end = sound->GetEnd();
+            signed char* repeat = sound->GetRepeat();
+            if (sourceStereo)
+                count = ResampleBlock<signed char, true>(pos, fractPos, end, repeat, looped, intAdd, fractAdd, 1.0f / 128.0f,
+                    interpolation, left, right, nextLeft, nextRight, fract, block);
+            else
+                count = ResampleBlock<signed char, false>(pos, fractPos, end, repeat, looped, intAdd, fractAdd, 1.0f / 128.0f,
+                    interpolation, left, right, nextLeft, nextRight, fract, block);
             position_ = pos;
         }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixStereoToMonoIP(Sound* sound, int* dest, unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    int vol = (int)(256.0f * totalGain + 0.5f);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
-
-    float add = frequency_ / (float)mixRate;
-    int intAdd = (int)add;
-    int fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        short* pos = (short*)position_;
-        short* end = (short*)sound->GetEnd();
-        short* repeat = (short*)sound->GetRepeat();
 
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
-                *dest = *dest + (s * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
+        if (interpolation)
         {
-            while (samples--)
-            {
-                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
-                *dest = *dest + (s * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
+            InterpolateBlock(left, nextLeft, fract, count);
+            if (sourceStereo)
+                InterpolateBlock(right, nextRight, fract, count);
         }
-    }
-    else
-    {
-        signed char* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
 
-        if (sound->IsLooped())
+        if (sourceStereo)
         {
-            while (samples--)
-            {
-                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
-                *dest = *dest + s * vol;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
+            if (stereo)
+                AccumulateStereoToStereo(dest, left, right, totalGain, count);
+            else
+                AccumulateStereoToMono(dest, left, right, totalGain, count);
         }
         else
         {
-            while (samples--)
-            {
-                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
-                *dest = *dest + s * vol;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
+            if (stereo)
+                AccumulateMonoToStereo(dest, left, leftGain, rightGain, count);
+            else
+                AccumulateMonoToMono(dest, left, totalGain, count);
         }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixStereoToStereoIP(Sound* sound, int* dest, unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    int vol = (int)(256.0f * totalGain + 0.5f);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
-
-    float add = frequency_ / (float)mixRate;
-    int intAdd = (int)add;
-    int fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        short* pos = (short*)position_;
-        short* end = (short*)sound->GetEnd();
-        short* repeat = (short*)sound->GetRepeat();
 
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (GET_IP_SAMPLE_LEFT() * vol) / 256;
-                ++dest;
-                *dest = *dest + (GET_IP_SAMPLE_RIGHT() * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (GET_IP_SAMPLE_LEFT() * vol) / 256;
-                ++dest;
-                *dest = *dest + (GET_IP_SAMPLE_RIGHT() * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        signed char* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
+        // A one-shot sound ended
+        if (!position_)
+            break;
 
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + GET_IP_SAMPLE_LEFT() * vol;
-                ++dest;
-                *dest = *dest + GET_IP_SAMPLE_RIGHT() * vol;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + GET_IP_SAMPLE_LEFT() * vol;
-                ++dest;
-                *dest = *dest + GET_IP_SAMPLE_RIGHT() * vol;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
-        }
+        dest += count * outChannels;
+        samples -= count;
     }
 
     fractPosition_ = fractPos;
@@ -72,6 +72,8 @@ public:
     void SetAttenuation(float attenuation);
     /// Set stereo panning. -1.0 is full left and 1.0 is full right.
     void SetPanning(float panning);
+    /// Set voice priority. When more sources are audible than the voice limit allows, higher priority sources are mixed first.
+    void SetPriority(int priority);
     /// Set to remove either the sound source component or its owner node from the scene automatically on sound playback completion. Disabled by default.
     void SetAutoRemoveMode(AutoRemoveMode mode);
     /// Set new playback position.
@@ -101,6 +103,15 @@ public:
     /// Return stereo panning.
     float GetPanning() const { return panning_; }
 
+    /// Return voice priority.
+    int GetPriority() const { return priority_; }
+
+    /// Return effective gain, used to rank the voices for mixing.
+    float GetAudibility() const { return masterGain_ * attenuation_ * gain_; }
+
+    /// Return whether the sound source was virtualized in the last mix: it keeps its playback position but is not heard.
+    bool IsVirtual() const { return virtual_; }
+
     /// Return automatic removal mode on sound playback completion.
     AutoRemoveMode GetAutoRemoveMode() const { return autoRemove_; }
 
@@ -109,8 +120,10 @@ public:
 
     /// Update the sound source. Perform subclass specific operations. Called by Audio.
     virtual void Update(float timeStep);
-    /// Mix sound source output to a 32-bit clipping buffer. Called by Audio.
-    void Mix(int* dest, unsigned samples, int mixRate, bool stereo, bool interpolation);
+    /// Mix sound source output to a float mixing buffer, or only advance the playback position if the buffer is null. Called by Audio.
+    void Mix(float* dest, unsigned samples, int mixRate, bool stereo, bool interpolation);
+    /// Set whether the sound source is virtualized. Called by Audio.
+    void SetVirtual(bool enable) { virtual_ = enable; }
     /// Update the effective master gain. Called internally and by Audio when the master gain changes.
     void UpdateMasterGain();
 
@@ -140,6 +153,8 @@ protected:
     float attenuation_;
     /// Stereo panning.
     float panning_;
+    /// Voice priority.
+    int priority_;
     /// Effective master gain.
     float masterGain_;
     /// Whether finished event should be sent on playback stop.
@@ -154,24 +169,14 @@ private:
     void PlayLockless(SharedPtr<SoundStream> stream);
     /// Stop sound without locking the audio mutex. Called internally.
     void StopLockless();
+    /// Free the sound stream and decode buffer without locking the audio mutex. The stream is only queued for removal from decoding ahead. Called internally.
+    void FreeStreamLockless();
+    /// Stop decoding the released sound streams ahead of playback. Called internally after the audio mutex is unlocked.
+    void RemoveReleasedStreams();
     /// Set new playback position without locking the audio mutex. Called internally.
     void SetPlayPositionLockless(signed char* position);
-    /// Mix mono sample to mono buffer.
-    void MixMonoToMono(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix mono sample to stereo buffer.
-    void MixMonoToStereo(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix mono sample to mono buffer interpolated.
-    void MixMonoToMonoIP(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix mono sample to stereo buffer interpolated.
-    void MixMonoToStereoIP(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix stereo sample to mono buffer.
-    void MixStereoToMono(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix stereo sample to stereo buffer.
-    void MixStereoToStereo(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix stereo sample to mono buffer interpolated.
-    void MixStereoToMonoIP(Sound* sound, int* dest, unsigned samples, int mixRate);
-    /// Mix stereo sample to stereo buffer interpolated.
-    void MixStereoToStereoIP(Sound* sound, int* dest, unsigned samples, int mixRate);
+    /// Resample, apply gain and accumulate the sound to a float mixing buffer.
+    void MixSound(Sound* sound, float* dest, unsigned samples, int mixRate, bool stereo, bool interpolation);
     /// Advance playback pointer without producing audible output.
     void MixZeroVolume(Sound* sound, unsigned samples, int mixRate);
     /// Advance playback pointer to simulate audio playback in headless mode.
@@ -181,6 +186,8 @@ private:
     SharedPtr<Sound> sound_;
     /// Sound stream that is being played.
     SharedPtr<SoundStream> soundStream_;
+    /// Sound streams no longer played, to be removed from decoding ahead once the audio mutex is unlocked.
+    Vector<SharedPtr<SoundStream> > releasedStreams_;
     /// Playback position.
     volatile signed char* position_;
     /// Playback fractional position.
@@ -191,6 +198,8 @@ private:
     SharedPtr<Sound> streamBuffer_;
     /// Unused stream bytes from previous frame.
     int unusedStreamSize_;
+    /// Virtualized flag.
+    volatile bool virtual_;
 };
 
 }
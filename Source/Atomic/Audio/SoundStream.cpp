@@ -24,6 +24,8 @@
 
 #include "../Audio/SoundStream.h"
 
+#include "../DebugNew.h"
+
 namespace Atomic
 {
 
@@ -31,7 +33,13 @@ SoundStream::SoundStream() :
     frequency_(44100),
     stopAtEnd_(false),
     sixteenBit_(false),
-    stereo_(false)
+    stereo_(false),
+    decodeAheadSize_(0),
+    readPosition_(0),
+    writePosition_(0),
+    numUnderruns_(0),
+    sourceEnded_(false),
+    drained_(false)
 {
 }
 
@@ -56,6 +64,101 @@ void SoundStream::SetStopAtEnd(bool enable)
     stopAtEnd_ = enable;
 }
 
+void SoundStream::SetDecodeAheadSize(unsigned numBytes)
+{
+    if (numBytes)
+    {
+        // Keep room for at least a few samples so that reads and writes stay aligned to whole samples
+        numBytes = NextPowerOfTwo(Max(numBytes, GetSampleSize() * 4));
+        if (numBytes != decodeAheadSize_)
+        {
+            decodeAheadBuffer_ = new signed char[numBytes];
+            decodeAheadSize_ = numBytes;
+        }
+    }
+    else
+    {
+        decodeAheadBuffer_.Reset();
+        decodeAheadSize_ = 0;
+    }
+
+    ResetDecodeAhead();
+}
+
+unsigned SoundStream::DecodeAhead(unsigned maxBytes)
+{
+    if (!decodeAheadSize_)
+        return 0;
+
+    unsigned writePosition = writePosition_.load(std::memory_order_relaxed);
+    unsigned freeBytes = decodeAheadSize_ - (writePosition - readPosition_.load(std::memory_order_acquire));
+    freeBytes = Min(freeBytes, maxBytes);
+    freeBytes -= freeBytes % GetSampleSize();
+
+    unsigned decodedBytes = 0;
+    while (freeBytes)
+    {
+        // Decode up to the end of the ring buffer at a time
+        unsigned offset = writePosition & (decodeAheadSize_ - 1);
+        unsigned numBytes = Min(freeBytes, decodeAheadSize_ - offset);
+        unsigned outBytes = GetData(decodeAheadBuffer_.Get() + offset, numBytes);
+
+        writePosition += outBytes;
+        writePosition_.store(writePosition, std::memory_order_release);
+        decodedBytes += outBytes;
+        freeBytes -= outBytes;
+
+        sourceEnded_.store(outBytes < numBytes, std::memory_order_release);
+        if (outBytes < numBytes)
+            break;
+    }
+
+    return decodedBytes;
+}
+
+void SoundStream::ResetDecodeAhead()
+{
+    readPosition_.store(0, std::memory_order_relaxed);
+    writePosition_.store(0, std::memory_order_relaxed);
+    sourceEnded_.store(false, std::memory_order_relaxed);
+    drained_ = false;
+}
+
+unsigned SoundStream::ReadData(signed char* dest, unsigned numBytes)
+{
+    if (!decodeAheadSize_)
+    {
+        unsigned outBytes = GetData(dest, numBytes);
+        drained_ = outBytes < numBytes;
+        return outBytes;
+    }
+
+    // Check for the end of data before looking at the buffer, so that data decoded in between is not mistaken for the end
+    bool sourceEnded = sourceEnded_.load(std::memory_order_acquire);
+    unsigned readPosition = readPosition_.load(std::memory_order_relaxed);
+    unsigned decodedBytes = writePosition_.load(std::memory_order_acquire) - readPosition;
+    unsigned outBytes = Min(numBytes, decodedBytes);
+
+    // Copy in at most two parts as the data may wrap around the end of the ring buffer
+    unsigned offset = readPosition & (decodeAheadSize_ - 1);
+    unsigned firstBytes = Min(outBytes, decodeAheadSize_ - offset);
+    memcpy(dest, decodeAheadBuffer_.Get() + offset, firstBytes);
+    if (outBytes > firstBytes)
+        memcpy(dest + firstBytes, decodeAheadBuffer_.Get(), outBytes - firstBytes);
+    readPosition_.store(readPosition + outBytes, std::memory_order_release);
+
+    drained_ = false;
+    if (outBytes < numBytes)
+    {
+        if (sourceEnded)
+            drained_ = true;
+        else
+            numUnderruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return outBytes;
+}
+
 unsigned SoundStream::GetSampleSize() const
 {
     unsigned size = 1;
@@ -22,7 +22,11 @@
 
 #pragma once
 
+#include "../Container/ArrayPtr.h"
 #include "../Container/RefCounted.h"
+#include "../Math/MathDefs.h"
+
+#include <atomic>
 
 namespace Atomic
 {
@@ -41,9 +45,18 @@ public:
     /// Seek to sample number. Return true on success. Need not be implemented by all streams.
     virtual bool Seek(unsigned sample_number);
     
-    /// Produce sound data into destination. Return number of bytes produced. Called by SoundSource from the mixing thread.
+    /// Produce sound data into destination. Return number of bytes produced. Called by SoundSource from the mixing thread, or from a decoder thread when decoding ahead.
     virtual unsigned GetData(signed char* dest, unsigned numBytes) = 0;
 
+    /// Set size of the decode-ahead ring buffer in bytes, rounded up to a power of two. Zero disables decoding ahead. Must not be called while the stream is being mixed or decoded.
+    void SetDecodeAheadSize(unsigned numBytes);
+    /// Fill the decode-ahead buffer by calling GetData(), up to the specified amount of bytes. Return number of bytes decoded. Called from a single decoder thread at a time.
+    unsigned DecodeAhead(unsigned maxBytes = M_MAX_UNSIGNED);
+    /// Discard the decode-ahead buffer contents, for example after seeking. Must not be called while the stream is being mixed or decoded.
+    void ResetDecodeAhead();
+    /// Read sound data for mixing, from the decode-ahead buffer if enabled or directly from GetData() otherwise. Return number of bytes read. Called by SoundSource from the mixing thread.
+    unsigned ReadData(signed char* dest, unsigned numBytes);
+
     /// Set sound data format.
     void SetFormat(unsigned frequency, bool sixteenBit, bool stereo);
     /// Set whether playback should stop when no more data. Default false.
@@ -67,6 +80,18 @@ public:
     /// Return whether data is stereo.
     bool IsStereo() const { return stereo_; }
 
+    /// Return size of the decode-ahead buffer in bytes, or zero if not decoding ahead.
+    unsigned GetDecodeAheadSize() const { return decodeAheadSize_; }
+
+    /// Return amount of decoded data waiting to be mixed in bytes.
+    unsigned GetDecodedBytes() const { return writePosition_.load(std::memory_order_acquire) - readPosition_.load(std::memory_order_acquire); }
+
+    /// Return number of times the mixer needed more data than had been decoded ahead.
+    unsigned GetNumUnderruns() const { return numUnderruns_.load(std::memory_order_relaxed); }
+
+    /// Return whether the last read reached the end of the data.
+    bool IsDrained() const { return drained_; }
+
 protected:
     /// Default frequency.
     unsigned frequency_;
@@ -76,6 +101,22 @@ protected:
     bool sixteenBit_;
     /// Stereo flag.
     bool stereo_;
+
+private:
+    /// Decode-ahead ring buffer.
+    SharedArrayPtr<signed char> decodeAheadBuffer_;
+    /// Decode-ahead ring buffer size, a power of two.
+    unsigned decodeAheadSize_;
+    /// Total bytes read from the decode-ahead buffer, written by the mixing thread.
+    std::atomic<unsigned> readPosition_;
+    /// Total bytes written to the decode-ahead buffer, written by the decoder thread.
+    std::atomic<unsigned> writePosition_;
+    /// Underrun count.
+    std::atomic<unsigned> numUnderruns_;
+    /// Flag for GetData() having produced less data than requested on the last decode.
+    std::atomic<bool> sourceEnded_;
+    /// Flag for the last read having reached the end of the data.
+    volatile bool drained_;
 };
 
 }
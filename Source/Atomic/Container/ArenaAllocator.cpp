@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/ArenaAllocator.h"
+
+#include <stddef.h>
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+/// %Arena memory block.
+struct ArenaBlock
+{
+    /// Previous block in the chain.
+    ArenaBlock* prev_;
+    /// Size of the data.
+    unsigned size_;
+    /// Offset of the first free byte in the data.
+    unsigned used_;
+    /// Data follows.
+};
+
+static const unsigned BLOCK_HEADER_SIZE = (sizeof(ArenaBlock) + 15) & ~15u;
+
+static unsigned char* GetBlockData(ArenaBlock* block)
+{
+    return reinterpret_cast<unsigned char*>(block) + BLOCK_HEADER_SIZE;
+}
+
+ArenaAllocator::ArenaAllocator(unsigned blockSize) :
+    block_(0),
+    blockSize_(blockSize ? blockSize : 1),
+    capacity_(0),
+    numAllocations_(0),
+    allocatedBytes_(0),
+    numBlockAllocations_(0)
+{
+}
+
+ArenaAllocator::~ArenaAllocator()
+{
+    FreeBlocks();
+}
+
+void* ArenaAllocator::Allocate(unsigned size, unsigned alignment)
+{
+    if (!block_)
+        AllocateBlock(size + alignment);
+
+    // Block data is 16-byte aligned, so offsets can be aligned directly unless the alignment is larger
+    size_t address = (size_t)(GetBlockData(block_) + block_->used_);
+    size_t aligned = (address + alignment - 1) & ~((size_t)alignment - 1);
+    unsigned offset = block_->used_ + (unsigned)(aligned - address);
+
+    if (offset + size > block_->size_)
+    {
+        AllocateBlock(size + alignment);
+        address = (size_t)GetBlockData(block_);
+        aligned = (address + alignment - 1) & ~((size_t)alignment - 1);
+        offset = (unsigned)(aligned - address);
+    }
+
+    allocatedBytes_ += offset + size - block_->used_;
+    block_->used_ = offset + size;
+    ++numAllocations_;
+
+    return GetBlockData(block_) + offset;
+}
+
+void ArenaAllocator::Reset()
+{
+    // Replace several blocks with one that fits all of them, so that the next cycle needs no new blocks
+    if (block_ && block_->prev_)
+    {
+        unsigned capacity = capacity_;
+        FreeBlocks();
+        blockSize_ = capacity;
+        AllocateBlock(capacity);
+    }
+    else if (block_)
+        block_->used_ = 0;
+
+    numAllocations_ = 0;
+    allocatedBytes_ = 0;
+    numBlockAllocations_ = 0;
+}
+
+void ArenaAllocator::AllocateBlock(unsigned minSize)
+{
+    // Grow the block size so that the number of blocks stays low for growing workloads
+    unsigned size = blockSize_;
+    while (size < minSize)
+        size <<= 1;
+    blockSize_ = size << 1;
+
+    ArenaBlock* block = reinterpret_cast<ArenaBlock*>(new unsigned char[BLOCK_HEADER_SIZE + size]);
+    block->prev_ = block_;
+    block->size_ = size;
+    block->used_ = 0;
+    block_ = block;
+
+    capacity_ += size;
+    ++numBlockAllocations_;
+}
+
+void ArenaAllocator::FreeBlocks()
+{
+    while (block_)
+    {
+        ArenaBlock* prev = block_->prev_;
+        delete[] reinterpret_cast<unsigned char*>(block_);
+        block_ = prev;
+    }
+
+    capacity_ = 0;
+}
+
+}
@@ -0,0 +1,83 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "Atomic/Atomic.h"
+
+namespace Atomic
+{
+
+struct ArenaBlock;
+
+/// Linear allocator that hands out memory from large blocks and frees it all at once on Reset(). Allocations are not freed
+/// individually. After a reset the arena keeps a single block large enough for everything allocated before, so a steady
+/// workload stops allocating from the heap. Not thread-safe; use one arena per thread.
+class ATOMIC_API ArenaAllocator
+{
+public:
+    /// Construct with the size of the first block.
+    ArenaAllocator(unsigned blockSize = 64 * 1024);
+    /// Destruct. Free all blocks.
+    ~ArenaAllocator();
+
+    /// Allocate memory with the given alignment, which must be a power of two.
+    void* Allocate(unsigned size, unsigned alignment = 16);
+    /// Free all allocations at once. Merges the blocks into one if more than one was needed.
+    void Reset();
+
+    /// Return number of allocations since the last reset.
+    unsigned GetNumAllocations() const { return numAllocations_; }
+    /// Return number of bytes allocated since the last reset, including alignment padding.
+    unsigned GetAllocatedBytes() const { return allocatedBytes_; }
+    /// Return number of heap allocations made for new blocks since the last reset.
+    unsigned GetNumBlockAllocations() const { return numBlockAllocations_; }
+    /// Return total size of the blocks.
+    unsigned GetCapacity() const { return capacity_; }
+
+private:
+    /// Prevent copy construction.
+    ArenaAllocator(const ArenaAllocator& rhs);
+    /// Prevent assignment.
+    ArenaAllocator& operator =(const ArenaAllocator& rhs);
+
+    /// Allocate a new block that fits at least the given size and make it current.
+    void AllocateBlock(unsigned minSize);
+    /// Free all blocks.
+    void FreeBlocks();
+
+    /// Current block, which is the head of the block chain.
+    ArenaBlock* block_;
+    /// Size of the next block to allocate.
+    unsigned blockSize_;
+    /// Total size of the blocks.
+    unsigned capacity_;
+    /// Number of allocations since the last reset.
+    unsigned numAllocations_;
+    /// Number of bytes allocated since the last reset.
+    unsigned allocatedBytes_;
+    /// Number of blocks allocated since the last reset.
+    unsigned numBlockAllocations_;
+};
+
+}
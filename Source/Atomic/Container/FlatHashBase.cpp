@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/FlatHashBase.h"
+
+#include <cstring>
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+unsigned FlatHashBase::FindFreeSlot(unsigned hash) const
+{
+    unsigned group = HashGroup(hash);
+    for (unsigned probe = 1;; ++probe)
+    {
+        unsigned mask = MatchFree(ctrl_ + group * GROUP_SIZE);
+        if (mask)
+            return group * GROUP_SIZE + LowestBit(mask);
+        group = NextGroup(group, probe);
+    }
+}
+
+unsigned FlatHashBase::FindEntrySlot(unsigned index) const
+{
+    unsigned hash = hashes_[index];
+    unsigned char ctrl = HashCtrl(hash);
+    unsigned group = HashGroup(hash);
+    for (unsigned probe = 1;; ++probe)
+    {
+        unsigned mask = MatchGroup(ctrl_ + group * GROUP_SIZE, ctrl);
+        while (mask)
+        {
+            unsigned slot = group * GROUP_SIZE + LowestBit(mask);
+            if (slots_[slot] == index)
+                return slot;
+            mask &= mask - 1;
+        }
+        group = NextGroup(group, probe);
+    }
+}
+
+void FlatHashBase::ReserveSlot()
+{
+    // Keep at most 7/8 of the slots in use, so that every probe sequence reaches an empty slot
+    unsigned used = hashes_.Size() + numDeleted_ + 1;
+    if (used * 8 <= capacity_ * 7)
+        return;
+
+    // Purge deleted slots without growing if they are taking up a large part of the table
+    unsigned capacity = capacity_;
+    if (!capacity)
+        capacity = GROUP_SIZE;
+    else if ((hashes_.Size() + 1) * 16 > capacity_ * 7)
+        capacity <<= 1;
+
+    Rehash(capacity);
+}
+
+void FlatHashBase::ReserveTable(unsigned numElements)
+{
+    unsigned capacity = GROUP_SIZE;
+    while (numElements * 8 > capacity * 7)
+        capacity <<= 1;
+
+    if (capacity > capacity_)
+        Rehash(capacity);
+}
+
+void FlatHashBase::InsertEntry(unsigned hash)
+{
+    unsigned index = hashes_.Size();
+    hashes_.Push(hash);
+
+    unsigned slot = FindFreeSlot(hash);
+    if (ctrl_[slot] == CTRL_DELETED)
+        --numDeleted_;
+    ctrl_[slot] = HashCtrl(hash);
+    slots_[slot] = index;
+}
+
+void FlatHashBase::EraseSlot(unsigned slot)
+{
+    unsigned index = slots_[slot];
+    unsigned last = hashes_.Size() - 1;
+
+    // If the group has an empty slot, no probe sequence continues past it and the slot can be made empty as well
+    unsigned groupStart = slot & ~(GROUP_SIZE - 1);
+    if (MatchGroup(ctrl_ + groupStart, CTRL_EMPTY))
+        ctrl_[slot] = CTRL_EMPTY;
+    else
+    {
+        ctrl_[slot] = CTRL_DELETED;
+        ++numDeleted_;
+    }
+
+    if (index != last)
+    {
+        slots_[FindEntrySlot(last)] = index;
+        hashes_[index] = hashes_[last];
+    }
+    hashes_.Pop();
+}
+
+void FlatHashBase::ClearTable()
+{
+    if (ctrl_)
+        memset(ctrl_, CTRL_EMPTY, capacity_);
+    numDeleted_ = 0;
+    hashes_.Clear();
+}
+
+void FlatHashBase::Rehash(unsigned capacity)
+{
+    delete[] ctrl_;
+    delete[] slots_;
+
+    capacity_ = capacity;
+    numDeleted_ = 0;
+    ctrl_ = new unsigned char[capacity_];
+    slots_ = new unsigned[capacity_];
+    memset(ctrl_, CTRL_EMPTY, capacity_);
+
+    for (unsigned i = 0; i < hashes_.Size(); ++i)
+    {
+        unsigned slot = FindFreeSlot(hashes_[i]);
+        ctrl_[slot] = HashCtrl(hashes_[i]);
+        slots_[slot] = i;
+    }
+}
+
+}
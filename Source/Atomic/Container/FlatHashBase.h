@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "Atomic/Atomic.h"
+
+#include "../Container/Hash.h"
+#include "../Container/Swap.h"
+#include "../Container/Vector.h"
+
+#ifdef ATOMIC_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Atomic
+{
+
+/// Open addressing flat hash set/map base class. Manages a table of control bytes and slots referring to densely stored entries.
+/** Slots are probed in groups of 16 control bytes, each holding 7 bits of the entry's hash, so that most lookups only compare
+    keys of entries that are likely to match. Entries are stored contiguously in insertion order until erased, and erasing moves
+    the last entry into the erased position.
+  */
+class ATOMIC_API FlatHashBase
+{
+public:
+    /// Number of slots probed at once.
+    static const unsigned GROUP_SIZE = 16;
+    /// Control byte of an empty slot.
+    static const unsigned char CTRL_EMPTY = 0x80;
+    /// Control byte of a slot whose entry has been erased.
+    static const unsigned char CTRL_DELETED = 0xfe;
+    /// Index returned when a key is not found.
+    static const unsigned NOT_FOUND = 0xffffffff;
+
+    /// Construct.
+    FlatHashBase() :
+        ctrl_(0),
+        slots_(0),
+        capacity_(0),
+        numDeleted_(0)
+    {
+    }
+
+    /// Destruct.
+    ~FlatHashBase()
+    {
+        delete[] ctrl_;
+        delete[] slots_;
+    }
+
+    /// Return number of elements.
+    unsigned Size() const { return hashes_.Size(); }
+
+    /// Return number of slots in the table.
+    unsigned NumSlots() const { return capacity_; }
+
+    /// Return whether has no elements.
+    bool Empty() const { return hashes_.Empty(); }
+
+protected:
+    /// Swap the table with another hash set or map.
+    void SwapTable(FlatHashBase& rhs)
+    {
+        Atomic::Swap(ctrl_, rhs.ctrl_);
+        Atomic::Swap(slots_, rhs.slots_);
+        Atomic::Swap(capacity_, rhs.capacity_);
+        Atomic::Swap(numDeleted_, rhs.numDeleted_);
+        hashes_.Swap(rhs.hashes_);
+    }
+
+    /// Mix a key hash so that both the slot position and the control byte bits are well distributed.
+    static unsigned MixHash(unsigned hash)
+    {
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6b;
+        hash ^= hash >> 13;
+        return hash;
+    }
+
+    /// Return the control byte stored for a mixed hash.
+    static unsigned char HashCtrl(unsigned hash) { return (unsigned char)(hash >> 25); }
+
+    /// Return the first group to probe for a mixed hash.
+    unsigned HashGroup(unsigned hash) const { return hash & ((capacity_ / GROUP_SIZE) - 1); }
+
+    /// Return the next group in the probe sequence. Probing by increasing steps visits every group when the group count is a power of two.
+    unsigned NextGroup(unsigned group, unsigned probe) const { return (group + probe) & ((capacity_ / GROUP_SIZE) - 1); }
+
+    /// Return a bit mask of the slots in a group whose control byte matches.
+    static unsigned MatchGroup(const unsigned char* group, unsigned char ctrl)
+    {
+#ifdef ATOMIC_SSE
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)ctrl)));
+#else
+        unsigned mask = 0;
+        for (unsigned i = 0; i < GROUP_SIZE; ++i)
+        {
+            if (group[i] == ctrl)
+                mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    /// Return a bit mask of the empty or deleted slots in a group.
+    static unsigned MatchFree(const unsigned char* group)
+    {
+#ifdef ATOMIC_SSE
+        // Empty and deleted control bytes are the only ones with the high bit set
+        return (unsigned)_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group)));
+#else
+        unsigned mask = 0;
+        for (unsigned i = 0; i < GROUP_SIZE; ++i)
+        {
+            if (group[i] & 0x80)
+                mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    /// Return index of the lowest set bit in a non-zero mask.
+    static unsigned LowestBit(unsigned mask)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return (unsigned)__builtin_ctz(mask);
+#else
+        unsigned index = 0;
+        while (!(mask & 1))
+        {
+            mask >>= 1;
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    /// Find a free slot for a mixed hash. The table must have been allocated.
+    unsigned FindFreeSlot(unsigned hash) const;
+    /// Find the slot referring to an entry. The entry must exist.
+    unsigned FindEntrySlot(unsigned index) const;
+    /// Make room in the table for one more entry, growing or purging deleted slots if necessary.
+    void ReserveSlot();
+    /// Grow the table to hold a number of entries without rehashing.
+    void ReserveTable(unsigned numElements);
+    /// Add the hash of a new entry that has been appended to the entries and insert it into the table.
+    void InsertEntry(unsigned hash);
+    /// Remove an entry from the table by slot. The last entry is moved into its index, which the derived class must mirror.
+    void EraseSlot(unsigned slot);
+    /// Remove all entries from the table, keeping its capacity.
+    void ClearTable();
+    /// Reallocate the table with a specific number of slots and insert all entries.
+    void Rehash(unsigned capacity);
+
+    /// Control bytes, capacity_ in size.
+    unsigned char* ctrl_;
+    /// Entry indices of the slots, capacity_ in size.
+    unsigned* slots_;
+    /// Number of slots. Zero or a power of two no smaller than GROUP_SIZE.
+    unsigned capacity_;
+    /// Number of deleted slots.
+    unsigned numDeleted_;
+    /// Mixed hashes of the entries.
+    PODVector<unsigned> hashes_;
+};
+
+}
@@ -0,0 +1,403 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+#include "../Container/Pair.h"
+#include "../Container/Sort.h"
+
+#if ATOMIC_CXX11
+#include <initializer_list>
+#endif
+
+namespace Atomic
+{
+
+/// Open addressing hash map template class with contiguous storage. Faster to look up and iterate than %HashMap, but iterators
+/// and pointers to values are invalidated by inserting and erasing, and erasing changes the iteration order.
+template <class T, class U> class FlatHashMap : public FlatHashBase
+{
+public:
+    typedef T KeyType;
+    typedef U ValueType;
+
+    /// Hash map key-value pair. The key must not be modified.
+    class KeyValue
+    {
+    public:
+        /// Construct with default key.
+        KeyValue() :
+            first_(T())
+        {
+        }
+
+        /// Construct with key and value.
+        KeyValue(const T& first, const U& second) :
+            first_(first),
+            second_(second)
+        {
+        }
+
+        /// Test for equality with another pair.
+        bool operator ==(const KeyValue& rhs) const { return first_ == rhs.first_ && second_ == rhs.second_; }
+
+        /// Test for inequality with another pair.
+        bool operator !=(const KeyValue& rhs) const { return first_ != rhs.first_ || second_ != rhs.second_; }
+
+        /// Key.
+        T first_;
+        /// Value.
+        U second_;
+    };
+
+    typedef RandomAccessIterator<KeyValue> Iterator;
+    typedef RandomAccessConstIterator<KeyValue> ConstIterator;
+
+    /// Construct empty.
+    FlatHashMap()
+    {
+    }
+
+    /// Construct from another hash map.
+    FlatHashMap(const FlatHashMap<T, U>& map)
+    {
+        *this = map;
+    }
+#if ATOMIC_CXX11
+    /// Aggregate initialization constructor.
+    FlatHashMap(const std::initializer_list<Pair<T, U>>& list)
+    {
+        for (auto it = list.begin(); it != list.end(); it++)
+        {
+            Insert(*it);
+        }
+    }
+#endif
+
+    /// Assign a hash map.
+    FlatHashMap& operator =(const FlatHashMap<T, U>& rhs)
+    {
+        // In case of self-assignment do nothing
+        if (&rhs != this)
+        {
+            entries_ = rhs.entries_;
+            hashes_ = rhs.hashes_;
+            // An empty source has no table, so empty ours instead of leaving slots that refer to the old entries
+            if (rhs.capacity_)
+                Rehash(rhs.capacity_);
+            else
+                ClearTable();
+        }
+        return *this;
+    }
+
+    /// Add-assign a pair.
+    FlatHashMap& operator +=(const Pair<T, U>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Add-assign a hash map.
+    FlatHashMap& operator +=(const FlatHashMap<T, U>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another hash map.
+    bool operator ==(const FlatHashMap<T, U>& rhs) const
+    {
+        if (rhs.Size() != Size())
+            return false;
+
+        for (ConstIterator i = Begin(); i != End(); ++i)
+        {
+            ConstIterator j = rhs.Find(i->first_);
+            if (j == rhs.End() || j->second_ != i->second_)
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another hash map.
+    bool operator !=(const FlatHashMap<T, U>& rhs) const { return !(*this == rhs); }
+
+    /// Index the map. Create a new pair if key not found.
+    U& operator [](const T& key)
+    {
+        unsigned hash = MixHash(MakeHash(key));
+        unsigned slot = FindSlot(key, hash);
+        return slot != NOT_FOUND ? entries_[slots_[slot]].second_ : entries_[InsertEntry(key, U(), hash)].second_;
+    }
+
+    /// Index the map. Return null if key is not found, does not create a new pair.
+    U* operator [](const T& key) const
+    {
+        unsigned slot = FindSlot(key, MixHash(MakeHash(key)));
+        return slot != NOT_FOUND ? const_cast<U*>(&entries_[slots_[slot]].second_) : 0;
+    }
+
+#if ATOMIC_CXX11
+    /// Populate the map using variadic template. This handles the base case.
+    FlatHashMap& Populate(const T& key, const U& value)
+    {
+        this->operator [](key) = value;
+        return *this;
+    };
+    /// Populate the map using variadic template.
+    template <typename... Args> FlatHashMap& Populate(const T& key, const U& value, Args... args)
+    {
+        this->operator [](key) = value;
+        return Populate(args...);
+    };
+#endif
+
+    /// Insert a pair. Return an iterator to it.
+    Iterator Insert(const Pair<T, U>& pair)
+    {
+        bool exists;
+        return Insert(pair, exists);
+    }
+
+    /// Insert a pair. Return iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const Pair<T, U>& pair, bool& exists)
+    {
+        unsigned hash = MixHash(MakeHash(pair.first_));
+        unsigned slot = FindSlot(pair.first_, hash);
+        exists = slot != NOT_FOUND;
+        if (exists)
+        {
+            // If exists, just change the value
+            KeyValue& existing = entries_[slots_[slot]];
+            existing.second_ = pair.second_;
+            return Iterator(&existing);
+        }
+
+        return Iterator(&entries_[InsertEntry(pair.first_, pair.second_, hash)]);
+    }
+
+    /// Insert a map.
+    void Insert(const FlatHashMap<T, U>& map)
+    {
+        for (ConstIterator i = map.Begin(); i != map.End(); ++i)
+            Insert(MakePair(i->first_, i->second_));
+    }
+
+    /// Insert a pair only if a corresponding key does not already exist. Return iterator to the new or existing pair.
+    Iterator InsertNew(const T& key, const U& value)
+    {
+        unsigned hash = MixHash(MakeHash(key));
+        unsigned slot = FindSlot(key, hash);
+        if (slot != NOT_FOUND)
+            return Iterator(&entries_[slots_[slot]]);
+
+        return Iterator(&entries_[InsertEntry(key, value, hash)]);
+    }
+
+    /// Erase a pair by key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        unsigned slot = FindSlot(key, MixHash(MakeHash(key)));
+        if (slot == NOT_FOUND)
+            return false;
+
+        EraseEntry(slot);
+        return true;
+    }
+
+    /// Erase a pair by iterator. Return iterator to the pair that took its place, which is the next pair to iterate.
+    Iterator Erase(const Iterator& it)
+    {
+        unsigned index = (unsigned)(it.ptr_ - entries_.Buffer());
+        if (index >= entries_.Size())
+            return End();
+
+        EraseEntry(FindEntrySlot(index));
+        return Iterator(entries_.Buffer() + index);
+    }
+
+    /// Clear the map. Retains the allocated memory.
+    void Clear()
+    {
+        entries_.Clear();
+        ClearTable();
+    }
+
+    /// Swap with another hash map.
+    void Swap(FlatHashMap<T, U>& rhs)
+    {
+        SwapTable(rhs);
+        entries_.Swap(rhs.entries_);
+    }
+
+    /// Reserve memory for a number of pairs.
+    void Reserve(unsigned numElements)
+    {
+        entries_.Reserve(numElements);
+        ReserveTable(numElements);
+    }
+
+    /// Sort pairs. After sorting the map can be iterated in order until new elements are inserted or erased.
+    void Sort()
+    {
+        if (entries_.Size() < 2)
+            return;
+
+        Atomic::Sort(entries_.Begin(), entries_.End(), CompareEntries);
+        for (unsigned i = 0; i < entries_.Size(); ++i)
+            hashes_[i] = MixHash(MakeHash(entries_[i].first_));
+        Rehash(capacity_);
+    }
+
+    /// Return iterator to the pair with key, or end iterator if not found.
+    Iterator Find(const T& key)
+    {
+        unsigned slot = FindSlot(key, MixHash(MakeHash(key)));
+        return slot != NOT_FOUND ? Iterator(&entries_[slots_[slot]]) : End();
+    }
+
+    /// Return const iterator to the pair with key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        unsigned slot = FindSlot(key, MixHash(MakeHash(key)));
+        return slot != NOT_FOUND ? ConstIterator(entries_.Buffer() + slots_[slot]) : End();
+    }
+
+    /// Return whether contains a pair with key.
+    bool Contains(const T& key) const { return FindSlot(key, MixHash(MakeHash(key))) != NOT_FOUND; }
+
+    /// Try to copy value to output. Return true if was found.
+    bool TryGetValue(const T& key, U& out) const
+    {
+        unsigned slot = FindSlot(key, MixHash(MakeHash(key)));
+        if (slot == NOT_FOUND)
+            return false;
+
+        out = entries_[slots_[slot]].second_;
+        return true;
+    }
+
+    /// Return all the keys.
+    Vector<T> Keys() const
+    {
+        Vector<T> result;
+        result.Reserve(Size());
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->first_);
+        return result;
+    }
+
+    /// Return all the values.
+    Vector<U> Values() const
+    {
+        Vector<U> result;
+        result.Reserve(Size());
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->second_);
+        return result;
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() { return entries_.Begin(); }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return entries_.Begin(); }
+
+    /// Return iterator to the end.
+    Iterator End() { return entries_.End(); }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return entries_.End(); }
+
+    /// Return first pair.
+    const KeyValue& Front() const { return entries_.Front(); }
+
+    /// Return last pair.
+    const KeyValue& Back() const { return entries_.Back(); }
+
+private:
+    /// Find the slot of a key, or NOT_FOUND.
+    unsigned FindSlot(const T& key, unsigned hash) const
+    {
+        if (!capacity_)
+            return NOT_FOUND;
+
+        const KeyValue* entries = entries_.Buffer();
+        const unsigned* slots = slots_;
+        unsigned char ctrl = HashCtrl(hash);
+        unsigned group = HashGroup(hash);
+        for (unsigned probe = 1;; ++probe)
+        {
+            const unsigned char* groupCtrl = ctrl_ + group * GROUP_SIZE;
+            unsigned mask = MatchGroup(groupCtrl, ctrl);
+            while (mask)
+            {
+                unsigned slot = group * GROUP_SIZE + LowestBit(mask);
+                if (entries[slots[slot]].first_ == key)
+                    return slot;
+                mask &= mask - 1;
+            }
+
+            // A group with an empty slot ends the probe sequence
+            if (MatchGroup(groupCtrl, CTRL_EMPTY))
+                return NOT_FOUND;
+            group = NextGroup(group, probe);
+        }
+    }
+
+    /// Append a new pair and insert it into the table. Return its index.
+    unsigned InsertEntry(const T& key, const U& value, unsigned hash)
+    {
+        ReserveSlot();
+        entries_.Push(KeyValue(key, value));
+        FlatHashBase::InsertEntry(hash);
+        return entries_.Size() - 1;
+    }
+
+    /// Erase a pair by slot, moving the last pair into its place.
+    void EraseEntry(unsigned slot)
+    {
+        unsigned index = slots_[slot];
+        EraseSlot(slot);
+        entries_.EraseSwap(index);
+    }
+
+    /// Compare two pairs by key.
+    static bool CompareEntries(const KeyValue& lhs, const KeyValue& rhs) { return lhs.first_ < rhs.first_; }
+
+    /// Key-value pairs.
+    Vector<KeyValue> entries_;
+};
+
+template <class T, class U> typename Atomic::FlatHashMap<T, U>::ConstIterator begin(const Atomic::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Atomic::FlatHashMap<T, U>::ConstIterator end(const Atomic::FlatHashMap<T, U>& v) { return v.End(); }
+
+template <class T, class U> typename Atomic::FlatHashMap<T, U>::Iterator begin(Atomic::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Atomic::FlatHashMap<T, U>::Iterator end(Atomic::FlatHashMap<T, U>& v) { return v.End(); }
+
+}
@@ -0,0 +1,266 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+#include "../Container/Sort.h"
+
+#if ATOMIC_CXX11
+#include <initializer_list>
+#endif
+
+namespace Atomic
+{
+
+/// Open addressing hash set template class with contiguous storage. Faster to look up and iterate than %HashSet, but iterators
+/// are invalidated by inserting and erasing, and erasing changes the iteration order.
+template <class T> class FlatHashSet : public FlatHashBase
+{
+public:
+    typedef RandomAccessConstIterator<T> Iterator;
+    typedef RandomAccessConstIterator<T> ConstIterator;
+
+    /// Construct empty.
+    FlatHashSet()
+    {
+    }
+
+    /// Construct from another hash set.
+    FlatHashSet(const FlatHashSet<T>& set)
+    {
+        *this = set;
+    }
+#if ATOMIC_CXX11
+    /// Aggregate initialization constructor.
+    FlatHashSet(const std::initializer_list<T>& list)
+    {
+        for (auto it = list.begin(); it != list.end(); it++)
+        {
+            Insert(*it);
+        }
+    }
+#endif
+
+    /// Assign a hash set.
+    FlatHashSet& operator =(const FlatHashSet<T>& rhs)
+    {
+        // In case of self-assignment do nothing
+        if (&rhs != this)
+        {
+            keys_ = rhs.keys_;
+            hashes_ = rhs.hashes_;
+            // An empty source has no table, so empty ours instead of leaving slots that refer to the old entries
+            if (rhs.capacity_)
+                Rehash(rhs.capacity_);
+            else
+                ClearTable();
+        }
+        return *this;
+    }
+
+    /// Add-assign a value.
+    FlatHashSet& operator +=(const T& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Add-assign a hash set.
+    FlatHashSet& operator +=(const FlatHashSet<T>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another hash set.
+    bool operator ==(const FlatHashSet<T>& rhs) const
+    {
+        if (rhs.Size() != Size())
+            return false;
+
+        for (ConstIterator i = Begin(); i != End(); ++i)
+        {
+            if (!rhs.Contains(*i))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another hash set.
+    bool operator !=(const FlatHashSet<T>& rhs) const { return !(*this == rhs); }
+
+    /// Insert a key. Return an iterator to it.
+    Iterator Insert(const T& key)
+    {
+        bool exists;
+        return Insert(key, exists);
+    }
+
+    /// Insert a key. Return iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const T& key, bool& exists)
+    {
+        unsigned hash = MixHash(MakeHash(key));
+        unsigned slot = FindSlot(key, hash);
+        exists = slot != NOT_FOUND;
+        if (exists)
+            return Iterator(&keys_[slots_[slot]]);
+
+        ReserveSlot();
+        keys_.Push(key);
+        InsertEntry(hash);
+        return Iterator(&keys_.Back());
+    }
+
+    /// Insert a set.
+    void Insert(const FlatHashSet<T>& set)
+    {
+        for (ConstIterator i = set.Begin(); i != set.End(); ++i)
+            Insert(*i);
+    }
+
+    /// Erase a key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        unsigned slot = FindSlot(key, MixHash(MakeHash(key)));
+        if (slot == NOT_FOUND)
+            return false;
+
+        EraseEntry(slot);
+        return true;
+    }
+
+    /// Erase a key by iterator. Return iterator to the key that took its place, which is the next key to iterate.
+    Iterator Erase(const Iterator& it)
+    {
+        unsigned index = (unsigned)(it.ptr_ - keys_.Buffer());
+        if (index >= keys_.Size())
+            return End();
+
+        EraseEntry(FindEntrySlot(index));
+        return Iterator(keys_.Buffer() + index);
+    }
+
+    /// Clear the set. Retains the allocated memory.
+    void Clear()
+    {
+        keys_.Clear();
+        ClearTable();
+    }
+
+    /// Swap with another hash set.
+    void Swap(FlatHashSet<T>& rhs)
+    {
+        SwapTable(rhs);
+        keys_.Swap(rhs.keys_);
+    }
+
+    /// Reserve memory for a number of keys.
+    void Reserve(unsigned numElements)
+    {
+        keys_.Reserve(numElements);
+        ReserveTable(numElements);
+    }
+
+    /// Sort keys. After sorting the set can be iterated in order until new elements are inserted or erased.
+    void Sort()
+    {
+        if (keys_.Size() < 2)
+            return;
+
+        Atomic::Sort(keys_.Begin(), keys_.End());
+        for (unsigned i = 0; i < keys_.Size(); ++i)
+            hashes_[i] = MixHash(MakeHash(keys_[i]));
+        Rehash(capacity_);
+    }
+
+    /// Return iterator to the key, or end iterator if not found.
+    Iterator Find(const T& key) const
+    {
+        unsigned slot = FindSlot(key, MixHash(MakeHash(key)));
+        return slot != NOT_FOUND ? Iterator(keys_.Buffer() + slots_[slot]) : End();
+    }
+
+    /// Return whether contains a key.
+    bool Contains(const T& key) const { return FindSlot(key, MixHash(MakeHash(key))) != NOT_FOUND; }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() const { return Iterator(keys_.Buffer()); }
+
+    /// Return iterator to the end.
+    Iterator End() const { return Iterator(keys_.Buffer() + keys_.Size()); }
+
+    /// Return first key.
+    const T& Front() const { return keys_.Front(); }
+
+    /// Return last key.
+    const T& Back() const { return keys_.Back(); }
+
+private:
+    /// Find the slot of a key, or NOT_FOUND.
+    unsigned FindSlot(const T& key, unsigned hash) const
+    {
+        if (!capacity_)
+            return NOT_FOUND;
+
+        const T* keys = keys_.Buffer();
+        const unsigned* slots = slots_;
+        unsigned char ctrl = HashCtrl(hash);
+        unsigned group = HashGroup(hash);
+        for (unsigned probe = 1;; ++probe)
+        {
+            const unsigned char* groupCtrl = ctrl_ + group * GROUP_SIZE;
+            unsigned mask = MatchGroup(groupCtrl, ctrl);
+            while (mask)
+            {
+                unsigned slot = group * GROUP_SIZE + LowestBit(mask);
+                if (keys[slots[slot]] == key)
+                    return slot;
+                mask &= mask - 1;
+            }
+
+            // A group with an empty slot ends the probe sequence
+            if (MatchGroup(groupCtrl, CTRL_EMPTY))
+                return NOT_FOUND;
+            group = NextGroup(group, probe);
+        }
+    }
+
+    /// Erase a key by slot, moving the last key into its place.
+    void EraseEntry(unsigned slot)
+    {
+        unsigned index = slots_[slot];
+        EraseSlot(slot);
+        keys_.EraseSwap(index);
+    }
+
+    /// Keys.
+    Vector<T> keys_;
+};
+
+template <class T> typename Atomic::FlatHashSet<T>::ConstIterator begin(const Atomic::FlatHashSet<T>& v) { return v.Begin(); }
+
+template <class T> typename Atomic::FlatHashSet<T>::ConstIterator end(const Atomic::FlatHashSet<T>& v) { return v.End(); }
+
+}
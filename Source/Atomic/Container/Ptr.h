@@ -73,6 +73,22 @@ public:
         AddRef();
     }
 
+#if ATOMIC_CXX11
+    /// Move-construct from another shared pointer. Transfers the reference without touching the reference count.
+    SharedPtr(SharedPtr<T>&& rhs) :
+        ptr_(rhs.ptr_)
+    {
+        rhs.ptr_ = 0;
+    }
+
+    /// Move-construct from another shared pointer allowing implicit upcasting.
+    template <class U> SharedPtr(SharedPtr<U>&& rhs) :
+        ptr_(rhs.ptr_)
+    {
+        rhs.ptr_ = 0;
+    }
+#endif
+
     /// Destruct. Release the object reference.
     ~SharedPtr()
     {
@@ -118,6 +134,31 @@ public:
         return *this;
     }
 
+#if ATOMIC_CXX11
+    /// Move-assign from another shared pointer. Transfers the reference without touching the reference count.
+    SharedPtr<T>& operator =(SharedPtr<T>&& rhs)
+    {
+        if (this != &rhs)
+        {
+            ReleaseRef();
+            ptr_ = rhs.ptr_;
+            rhs.ptr_ = 0;
+        }
+
+        return *this;
+    }
+
+    /// Move-assign from another shared pointer allowing implicit upcasting.
+    template <class U> SharedPtr<T>& operator =(SharedPtr<U>&& rhs)
+    {
+        ReleaseRef();
+        ptr_ = rhs.ptr_;
+        rhs.ptr_ = 0;
+
+        return *this;
+    }
+#endif
+
     /// Point to the object.
     T* operator ->() const
     {
@@ -154,6 +195,9 @@ public:
     /// Reset to null and release the object reference.
     void Reset() { ReleaseRef(); }
 
+    /// Swap with another shared pointer. Transfers the references without touching the reference counts.
+    void Swap(SharedPtr<T>& rhs) { Atomic::Swap(ptr_, rhs.ptr_); }
+
     /// Detach without destroying the object even if the refcount goes zero. To be used for scripting language interoperation.
     T* Detach()
     {
@@ -161,9 +205,9 @@ public:
         if (ptr_)
         {
             RefCount* refCount = RefCountPtr();
-            ++refCount->refs_; // 2 refs
+            refCount->Increment(refCount->refs_); // 2 refs
             Reset(); // 1 ref
-            --refCount->refs_; // 0 refs
+            refCount->Decrement(refCount->refs_); // 0 refs
         }
         return ptr;
     }
@@ -449,7 +493,7 @@ public:
     bool NotNull() const { return refCount_ != 0; }
 
     /// Return the object's reference count, or 0 if null pointer or if object has expired.
-    int Refs() const { return (refCount_ && refCount_->refs_ >= 0) ? refCount_->refs_ : 0; }
+    int Refs() const { return (refCount_ && refCount_->refs_ >= 0) ? refCount_->refs_.load(std::memory_order_relaxed) : 0; }
 
     /// Return the object's weak reference count.
     int WeakRefs() const
@@ -457,7 +501,7 @@ public:
         if (!Expired())
             return ptr_->WeakRefs();
         else
-            return refCount_ ? refCount_->weakRefs_ : 0;
+            return refCount_ ? refCount_->weakRefs_.load(std::memory_order_relaxed) : 0;
     }
 
     /// Return whether the object has expired. If null pointer, always return true.
@@ -478,7 +522,7 @@ private:
         if (refCount_)
         {
             assert(refCount_->weakRefs_ >= 0);
-            ++(refCount_->weakRefs_);
+            refCount_->Increment(refCount_->weakRefs_);
         }
     }
 
@@ -488,9 +532,9 @@ private:
         if (refCount_)
         {
             assert(refCount_->weakRefs_ > 0);
-            --(refCount_->weakRefs_);
 
-            if (Expired() && !refCount_->weakRefs_)
+            // Use the decremented value, as in atomic mode the object may expire concurrently on another thread
+            if (!refCount_->Decrement(refCount_->weakRefs_) && Expired())
                 delete refCount_;
         }
 
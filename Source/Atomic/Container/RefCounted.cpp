@@ -33,11 +33,12 @@ RefCounted::RefCounted() :
     refCount_(new RefCount()),
 // ATOMIC BEGIN
     instantiationType_(INSTANTIATION_NATIVE),
-    jsHeapPtr_(0)
+    jsHeapPtr_(0),
+    jsStashIndex_(0)
 // ATOMIC END
 {
     // Hold a weak ref to self to avoid possible double delete of the refcount
-    (refCount_->weakRefs_)++;
+    refCount_->weakRefs_.store(1, std::memory_order_relaxed);
 
 // ATOMIC BEGIN
     for (unsigned i = 0; i < refCountedCreatedFunctions_.Size(); i++)
@@ -52,9 +53,8 @@ RefCounted::~RefCounted()
     assert(refCount_->weakRefs_ > 0);
 
     // Mark object as expired, release the self weak ref and delete the refcount if no other weak refs exist
-    refCount_->refs_ = -1;
-    (refCount_->weakRefs_)--;
-    if (!refCount_->weakRefs_)
+    refCount_->refs_.store(-1, std::memory_order_release);
+    if (!refCount_->Decrement(refCount_->weakRefs_))
         delete refCount_;
 
     refCount_ = 0;
@@ -68,10 +68,10 @@ RefCounted::~RefCounted()
 void RefCounted::AddRef()
 {
     assert(refCount_->refs_ >= 0);
-    (refCount_->refs_)++;
+    int refs = refCount_->Increment(refCount_->refs_);
 
 // ATOMIC BEGIN
-    if (jsHeapPtr_ && refCount_->refs_ == 2)
+    if (jsHeapPtr_ && refs == 2)
     {
         for (unsigned i = 0; i < refCountChangedFunctions_.Size(); i++)
         {
@@ -84,27 +84,32 @@ void RefCounted::AddRef()
 void RefCounted::ReleaseRef()
 {
     assert(refCount_->refs_ > 0);
-    (refCount_->refs_)--;
+    // Read members before the decrement, as after it another thread may already have deleted the object
+    bool scriptObject = jsHeapPtr_ != 0;
+    int refs = refCount_->Decrement(refCount_->refs_);
 
 // ATOMIC BEGIN
-    if (jsHeapPtr_ && refCount_->refs_ == 1)
+    if (scriptObject && refs == 1)
     {
         for (unsigned i = 0; i < refCountChangedFunctions_.Size(); i++)
         {
-            (refCount_->refs_)++;
+            refCount_->Increment(refCount_->refs_);
             refCountChangedFunctions_[i](this, 1);
             if (refCount_->refs_ == 1)
             {
-                refCount_->refs_ = 0;
+                refCount_->refs_.store(0, std::memory_order_relaxed);
                 delete this;
                 return;
             }
-            (refCount_->refs_)--;
+            refCount_->Decrement(refCount_->refs_);
         }
+
+        refs = refCount_->refs_;
     }
 // ATOMIC END
 
-    if (!refCount_->refs_)
+    // Only the release that brought the count to zero may delete, as in atomic mode other threads may release concurrently
+    if (!refs)
         delete this;
 }
 
@@ -128,13 +133,13 @@ PODVector<RefCountedDeletedFunction> RefCounted::refCountedDeletedFunctions_;
 void RefCounted::AddRefSilent()
 {
     assert(refCount_->refs_ >= 0);
-    (refCount_->refs_)++;
+    refCount_->Increment(refCount_->refs_);
 }
 
 void RefCounted::ReleaseRefSilent()
 {
     assert(refCount_->refs_ > 0);
-    (refCount_->refs_)--;
+    refCount_->Decrement(refCount_->refs_);
 }
 
 void RefCounted::AddRefCountChangedFunction(RefCountChangedFunction function)
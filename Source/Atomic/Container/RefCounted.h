@@ -25,6 +25,8 @@
 #include "Atomic/Atomic.h"
 #include "Vector.h"
 
+#include <atomic>
+
 // ATOMIC BEGIN
 
 #include "../Container/Str.h"
@@ -68,13 +70,15 @@ typedef const void* ClassID;
 
 // ATOMIC END
 
-/// Reference count structure.
+/// Reference count structure. The counts are atomic variables, but are only modified with atomic read-modify-write operations
+/// when atomic mode is enabled, so that objects used from one thread only pay nothing extra.
 struct RefCount
 {
     /// Construct.
     RefCount() :
         refs_(0),
-        weakRefs_(0)
+        weakRefs_(0),
+        atomic_(false)
     {
     }
 
@@ -82,14 +86,39 @@ struct RefCount
     ~RefCount()
     {
         // Set reference counts below zero to fire asserts if this object is still accessed
-        refs_ = -1;
-        weakRefs_ = -1;
+        refs_.store(-1, std::memory_order_relaxed);
+        weakRefs_.store(-1, std::memory_order_relaxed);
+    }
+
+    /// Increment a count and return the new value.
+    int Increment(std::atomic<int>& count)
+    {
+        if (atomic_)
+            return count.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        int value = count.load(std::memory_order_relaxed) + 1;
+        count.store(value, std::memory_order_relaxed);
+        return value;
+    }
+
+    /// Decrement a count and return the new value. In atomic mode the thread that reaches zero sees all writes made by the
+    /// threads that released before it.
+    int Decrement(std::atomic<int>& count)
+    {
+        if (atomic_)
+            return count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+
+        int value = count.load(std::memory_order_relaxed) - 1;
+        count.store(value, std::memory_order_relaxed);
+        return value;
     }
 
     /// Reference count. If below zero, the object has been destroyed.
-    int refs_;
+    std::atomic<int> refs_;
     /// Weak reference count.
-    int weakRefs_;
+    std::atomic<int> weakRefs_;
+    /// Atomic mode flag.
+    bool atomic_;
 };
 
 /// Base class for intrusively reference-counted objects. These are noncopyable and non-assignable.
@@ -113,6 +142,13 @@ public:
     /// Return pointer to the reference count structure.
     RefCount* RefCountPtr() { return refCount_; }
 
+    /// Enable atomic reference counting, which makes adding and releasing strong and weak references from several threads
+    /// safe. Must be called before the object is shared between threads, typically from the constructor. Promoting a weak
+    /// pointer to a shared pointer is still only safe while another strong reference is known to be held.
+    void SetAtomicRefCount() { refCount_->atomic_ = true; }
+    /// Return whether reference counting is atomic.
+    bool IsAtomicRefCount() const { return refCount_->atomic_; }
+
 // ATOMIC BEGIN
 
     virtual bool IsObject() const { return false; }
@@ -132,6 +168,10 @@ public:
     inline void* JSGetHeapPtr() const { return jsHeapPtr_; }
     inline void  JSSetHeapPtr(void* heapptr) { jsHeapPtr_ = heapptr; }
 
+    /// JavaScript VM, 1-based slot in the stash registry array keeping the script object alive, 0 if not stashed
+    inline unsigned JSGetStashIndex() const { return jsStashIndex_; }
+    inline void JSSetStashIndex(unsigned index) { jsStashIndex_ = index; }
+
     inline InstantiationType GetInstantiationType()  const { return instantiationType_; }
     inline void SetInstantiationType(InstantiationType type) { instantiationType_ = type; }
 
@@ -159,6 +199,7 @@ private:
 
     InstantiationType instantiationType_;
     void* jsHeapPtr_;
+    unsigned jsStashIndex_;
 
     static PODVector<RefCountChangedFunction> refCountChangedFunctions_;
     static PODVector<RefCountedCreatedFunction> refCountedCreatedFunctions_;
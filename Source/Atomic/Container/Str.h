@@ -514,7 +514,7 @@ private:
     /// Replace a substring with another substring.
     void Replace(unsigned pos, unsigned length, const char* srcStart, unsigned srcLength);
 
-    /// String length.
+    /// String length. The member layout is mirrored by AtomicString in the C# bindings, so it must not change.
     unsigned length_;
     /// Capacity, zero if buffer not allocated.
     unsigned capacity_;
@@ -91,7 +91,7 @@ public:
     ~Vector()
     {
         DestructElements(Buffer(), size_);
-        delete[] buffer_;
+        FreeBuffer(buffer_, capacity_);
     }
 
     /// Assign from another vector.
@@ -369,23 +369,19 @@ public:
         if (newCapacity < size_)
             newCapacity = size_;
 
-        if (newCapacity != capacity_)
-        {
-            T* newBuffer = 0;
-            capacity_ = newCapacity;
+        if (newCapacity != Capacity())
+            Reallocate(newCapacity, GetArena());
+    }
 
-            if (capacity_)
-            {
-                newBuffer = reinterpret_cast<T*>(AllocateBuffer((unsigned)(capacity_ * sizeof(T))));
-                // Move the data into the new buffer
-                ConstructElements(newBuffer, Buffer(), size_);
-            }
+    /// Set new capacity and move the elements to a buffer allocated from an arena, or from the heap if the arena is null. Later
+    /// growth allocates from the same arena. An arena buffer must not be used after the arena is reset.
+    void Reserve(unsigned newCapacity, ArenaAllocator* arena)
+    {
+        if (newCapacity < size_)
+            newCapacity = size_;
 
-            // Delete the old buffer
-            DestructElements(Buffer(), size_);
-            delete[] buffer_;
-            buffer_ = reinterpret_cast<unsigned char*>(newBuffer);
-        }
+        if (newCapacity != Capacity() || arena != GetArena())
+            Reallocate(newCapacity, arena);
     }
 
     /// Reallocate so that no extra memory is used.
@@ -462,7 +458,7 @@ public:
     unsigned Size() const { return size_; }
 
     /// Return capacity of vector.
-    unsigned Capacity() const { return capacity_; }
+    unsigned Capacity() const { return capacity_ & ~ARENA_BUFFER_FLAG; }
 
     /// Return whether vector is empty.
     bool Empty() const { return size_ == 0; }
@@ -471,6 +467,25 @@ public:
     T* Buffer() const { return reinterpret_cast<T*>(buffer_); }
 
 private:
+    /// Move the elements to a new buffer with the given capacity.
+    void Reallocate(unsigned newCapacity, ArenaAllocator* arena)
+    {
+        T* newBuffer = 0;
+
+        if (newCapacity)
+        {
+            newBuffer = reinterpret_cast<T*>(AllocateBuffer((unsigned)(newCapacity * sizeof(T)), arena));
+            // Move the data into the new buffer
+            ConstructElements(newBuffer, Buffer(), size_);
+        }
+
+        // Delete the old buffer
+        DestructElements(Buffer(), size_);
+        FreeBuffer(buffer_, capacity_);
+        buffer_ = reinterpret_cast<unsigned char*>(newBuffer);
+        capacity_ = newCapacity | (arena && newCapacity ? ARENA_BUFFER_FLAG : 0);
+    }
+
     /// Resize the vector and create/remove new elements as necessary. Current buffer will be stored in tempBuffer in case of reallocation.
     void Resize(unsigned newSize, const T* src, Vector<T>& tempBuffer)
     {
@@ -480,11 +495,11 @@ private:
         else
         {
             // Allocate new buffer if necessary and copy the current elements
-            if (newSize > capacity_)
+            if (newSize > Capacity())
             {
                 Swap(tempBuffer);
                 size_ = tempBuffer.size_;
-                capacity_ = tempBuffer.capacity_;
+                capacity_ = tempBuffer.Capacity();
 
                 if (!capacity_)
                     capacity_ = newSize;
@@ -494,7 +509,11 @@ private:
                         capacity_ += (capacity_ + 1) >> 1;
                 }
 
-                buffer_ = AllocateBuffer((unsigned)(capacity_ * sizeof(T)));
+                // Grow into the same arena as the old buffer, if any
+                ArenaAllocator* arena = tempBuffer.GetArena();
+                buffer_ = AllocateBuffer((unsigned)(capacity_ * sizeof(T)), arena);
+                if (arena)
+                    capacity_ |= ARENA_BUFFER_FLAG;
                 if (tempBuffer.Buffer())
                 {
                     ConstructElements(Buffer(), tempBuffer.Buffer(), size_);
@@ -629,7 +648,7 @@ public:
     /// Destruct.
     ~PODVector()
     {
-        delete[] buffer_;
+        FreeBuffer(buffer_, capacity_);
     }
 
     /// Assign from another vector.
@@ -739,7 +758,7 @@ public:
     /// Add an element at the end.
     void Push(const T& value)
     {
-        if (size_ < capacity_)
+        if (size_ < Capacity())
             ++size_;
         else
             Resize(size_ + 1);
@@ -927,24 +946,28 @@ public:
     /// Resize the vector.
     void Resize(unsigned newSize)
     {
-        if (newSize > capacity_)
+        unsigned capacity = Capacity();
+        if (newSize > capacity)
         {
-            if (!capacity_)
-                capacity_ = newSize;
+            if (!capacity)
+                capacity = newSize;
             else
             {
-                while (capacity_ < newSize)
-                    capacity_ += (capacity_ + 1) >> 1;
+                while (capacity < newSize)
+                    capacity += (capacity + 1) >> 1;
             }
 
-            unsigned char* newBuffer = AllocateBuffer((unsigned)(capacity_ * sizeof(T)));
+            // Grow into the same arena as the old buffer, if any
+            ArenaAllocator* arena = GetArena();
+            unsigned char* newBuffer = AllocateBuffer((unsigned)(capacity * sizeof(T)), arena);
             // Move the data into the new buffer and delete the old
             if (buffer_)
             {
                 CopyElements(reinterpret_cast<T*>(newBuffer), Buffer(), size_);
-                delete[] buffer_;
+                FreeBuffer(buffer_, capacity_);
             }
             buffer_ = newBuffer;
+            capacity_ = capacity | (arena ? ARENA_BUFFER_FLAG : 0);
         }
 
         size_ = newSize;
@@ -956,22 +979,19 @@ public:
         if (newCapacity < size_)
             newCapacity = size_;
 
-        if (newCapacity != capacity_)
-        {
-            unsigned char* newBuffer = 0;
-            capacity_ = newCapacity;
+        if (newCapacity != Capacity())
+            Reallocate(newCapacity, GetArena());
+    }
 
-            if (capacity_)
-            {
-                newBuffer = AllocateBuffer((unsigned)(capacity_ * sizeof(T)));
-                // Move the data into the new buffer
-                CopyElements(reinterpret_cast<T*>(newBuffer), Buffer(), size_);
-            }
+    /// Set new capacity and move the elements to a buffer allocated from an arena, or from the heap if the arena is null. Later
+    /// growth allocates from the same arena. An arena buffer must not be used after the arena is reset.
+    void Reserve(unsigned newCapacity, ArenaAllocator* arena)
+    {
+        if (newCapacity < size_)
+            newCapacity = size_;
 
-            // Delete the old buffer
-            delete[] buffer_;
-            buffer_ = newBuffer;
-        }
+        if (newCapacity != Capacity() || arena != GetArena())
+            Reallocate(newCapacity, arena);
     }
 
     /// Reallocate so that no extra memory is used.
@@ -1040,7 +1060,7 @@ public:
     unsigned Size() const { return size_; }
 
     /// Return capacity of vector.
-    unsigned Capacity() const { return capacity_; }
+    unsigned Capacity() const { return capacity_ & ~ARENA_BUFFER_FLAG; }
 
     /// Return whether vector is empty.
     bool Empty() const { return size_ == 0; }
@@ -1049,6 +1069,24 @@ public:
     T* Buffer() const { return reinterpret_cast<T*>(buffer_); }
 
 private:
+    /// Move the elements to a new buffer with the given capacity.
+    void Reallocate(unsigned newCapacity, ArenaAllocator* arena)
+    {
+        unsigned char* newBuffer = 0;
+
+        if (newCapacity)
+        {
+            newBuffer = AllocateBuffer((unsigned)(newCapacity * sizeof(T)), arena);
+            // Move the data into the new buffer
+            CopyElements(reinterpret_cast<T*>(newBuffer), Buffer(), size_);
+        }
+
+        // Delete the old buffer
+        FreeBuffer(buffer_, capacity_);
+        buffer_ = newBuffer;
+        capacity_ = newCapacity | (arena && newCapacity ? ARENA_BUFFER_FLAG : 0);
+    }
+
     /// Move a range of elements within the vector.
     void MoveRange(unsigned dest, unsigned src, unsigned count)
     {
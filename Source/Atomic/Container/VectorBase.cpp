@@ -22,16 +22,38 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/ArenaAllocator.h"
 #include "../Container/VectorBase.h"
 
+#include <atomic>
+
 #include "../DebugNew.h"
 
 namespace Atomic
 {
 
+static std::atomic<unsigned> numHeapAllocations(0);
+
 unsigned char* VectorBase::AllocateBuffer(unsigned size)
 {
+    numHeapAllocations.fetch_add(1, std::memory_order_relaxed);
     return new unsigned char[size];
 }
 
+unsigned char* VectorBase::AllocateBuffer(unsigned size, ArenaAllocator* arena)
+{
+    if (!arena)
+        return AllocateBuffer(size);
+
+    unsigned char* buffer = static_cast<unsigned char*>(arena->Allocate(size + ARENA_BUFFER_HEADER_SIZE, 16)) +
+        ARENA_BUFFER_HEADER_SIZE;
+    *reinterpret_cast<ArenaAllocator**>(buffer - ARENA_BUFFER_HEADER_SIZE) = arena;
+    return buffer;
+}
+
+unsigned VectorBase::GetNumHeapAllocations()
+{
+    return numHeapAllocations.load(std::memory_order_relaxed);
+}
+
 }
@@ -29,6 +29,8 @@
 namespace Atomic
 {
 
+class ArenaAllocator;
+
 /// Random access iterator.
 template <class T> struct RandomAccessIterator
 {
@@ -303,8 +305,31 @@ public:
         Atomic::Swap(buffer_, rhs.buffer_);
     }
 
+    /// Return the arena the buffer was allocated from, or null if allocated from the heap.
+    ArenaAllocator* GetArena() const
+    {
+        return (capacity_ & ARENA_BUFFER_FLAG) ? *reinterpret_cast<ArenaAllocator**>(buffer_ - ARENA_BUFFER_HEADER_SIZE) : 0;
+    }
+
+    /// Return number of buffers allocated from the heap by all vectors since startup.
+    static unsigned GetNumHeapAllocations();
+
 protected:
+    /// Capacity flag marking a buffer allocated from an arena. Such buffers are never freed individually.
+    static const unsigned ARENA_BUFFER_FLAG = 0x80000000;
+    /// Size of the header storing the arena pointer in front of an arena buffer. Keeps the buffer 16-byte aligned.
+    static const unsigned ARENA_BUFFER_HEADER_SIZE = 16;
+
+    /// Allocate a buffer from the heap.
     static unsigned char* AllocateBuffer(unsigned size);
+    /// Allocate a buffer from an arena, or from the heap if the arena is null.
+    static unsigned char* AllocateBuffer(unsigned size, ArenaAllocator* arena);
+    /// Free a buffer allocated with the given capacity flags.
+    static void FreeBuffer(unsigned char* buffer, unsigned capacity)
+    {
+        if (!(capacity & ARENA_BUFFER_FLAG))
+            delete[] buffer;
+    }
 
     /// Size of vector.
     unsigned size_;
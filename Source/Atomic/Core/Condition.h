@@ -47,6 +47,8 @@ private:
 #ifndef _WIN32
     /// Mutex for the event, necessary for pthreads-based implementation.
     void* mutex_;
+    /// Signaled flag, so that a Set() without a waiting thread is not lost.
+    bool signaled_;
 #endif
     /// Operating system specific event.
     void* event_;
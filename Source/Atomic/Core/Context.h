@@ -31,11 +31,12 @@ namespace Atomic
 
 // ATOMIC BEGIN
 
+/// Listener notified of every event sent. The event data is passed unconverted, so listeners should only call GetVariantMap() for events they handle.
 class GlobalEventListener
 {
 public:
-    virtual void BeginSendEvent(Context* context, Object* sender, StringHash eventType, VariantMap& eventData) = 0;
-    virtual void EndSendEvent(Context* context, Object* sender, StringHash eventType, VariantMap& eventData) = 0;
+    virtual void BeginSendEvent(Context* context, Object* sender, StringHash eventType, TypedEventData& eventData) = 0;
+    virtual void EndSendEvent(Context* context, Object* sender, StringHash eventType, TypedEventData& eventData) = 0;
 };
 
 // ATOMIC END
@@ -296,14 +297,14 @@ private:
     // ATOMIC BEGIN
 
     /// Begin event send.
-    void GlobalBeginSendEvent(Object* sender, StringHash eventType, VariantMap& eventData) {
+    void GlobalBeginSendEvent(Object* sender, StringHash eventType, TypedEventData& eventData) {
         for (unsigned i = 0; i < globalEventListeners_.Size(); i++)
             globalEventListeners_[i]->BeginSendEvent(this, sender, eventType, eventData);
         eventSenders_.Push(sender);
     }
 
     /// End event send. Clean up event receivers removed in the meanwhile.
-    void GlobalEndSendEvent(Object* sender, StringHash eventType, VariantMap& eventData) {
+    void GlobalEndSendEvent(Object* sender, StringHash eventType, TypedEventData& eventData) {
         for (unsigned i = 0; i < globalEventListeners_.Size(); i++)
             globalEventListeners_[i]->EndSendEvent(this, sender, eventType, eventData);
         eventSenders_.Pop();
@@ -38,6 +38,23 @@ ATOMIC_EVENT(E_BEGINFRAME, BeginFrame)
 ATOMIC_EVENT(E_UPDATE, Update)
 {
     ATOMIC_PARAM(P_TIMESTEP, TimeStep);            // float
+
+    /// Typed payload. Sent with Object::SendTypedEvent.
+    struct Payload
+    {
+        /// Convert to event parameters.
+        void ToVariantMap(VariantMap& dest) const { dest[P_TIMESTEP] = timeStep_; }
+
+        /// Fill from event parameters.
+        void FromVariantMap(const VariantMap& source)
+        {
+            const Variant* timeStep = source[P_TIMESTEP];
+            timeStep_ = timeStep ? timeStep->GetFloat() : 0.0f;
+        }
+
+        /// Time step.
+        float timeStep_;
+    };
 }
 
 /// Application-wide logic post-update event.
@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/CoreEvents.h"
+#include "../Core/FrameAllocator.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
+#include "../Metrics/Metrics.h"
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+FrameAllocator::FrameAllocator(Context* context) :
+    Object(context),
+    numAllocations_(0),
+    allocatedBytes_(0),
+    numHeapVectorAllocations_(0),
+    lastHeapVectorAllocations_(VectorBase::GetNumHeapAllocations())
+{
+    arenas_.Push(new ArenaAllocator());
+
+    SubscribeToEvent(E_BEGINFRAME, ATOMIC_HANDLER(FrameAllocator, HandleBeginFrame));
+    SubscribeToEvent(E_ENDFRAME, ATOMIC_HANDLER(FrameAllocator, HandleEndFrame));
+}
+
+FrameAllocator::~FrameAllocator()
+{
+    for (unsigned i = 0; i < arenas_.Size(); ++i)
+        delete arenas_[i];
+}
+
+ArenaAllocator* FrameAllocator::GetArena(unsigned threadIndex) const
+{
+    if (threadIndex >= arenas_.Size() || (!threadIndex && !Thread::IsMainThread()))
+        return 0;
+
+    return arenas_[threadIndex];
+}
+
+void* FrameAllocator::Allocate(unsigned size, unsigned alignment, unsigned threadIndex)
+{
+    ArenaAllocator* arena = GetArena(threadIndex);
+    return arena ? arena->Allocate(size, alignment) : 0;
+}
+
+void FrameAllocator::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    // Worker threads may be created after this subsystem, so add their arenas here where no work items are running
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    unsigned numArenas = queue ? queue->GetNumThreads() + 1 : 1;
+    while (arenas_.Size() < numArenas)
+        arenas_.Push(new ArenaAllocator());
+}
+
+void FrameAllocator::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    numAllocations_ = 0;
+    allocatedBytes_ = 0;
+
+    for (unsigned i = 0; i < arenas_.Size(); ++i)
+    {
+        numAllocations_ += arenas_[i]->GetNumAllocations();
+        allocatedBytes_ += arenas_[i]->GetAllocatedBytes();
+        arenas_[i]->Reset();
+    }
+
+    unsigned heapVectorAllocations = VectorBase::GetNumHeapAllocations();
+    numHeapVectorAllocations_ = heapVectorAllocations - lastHeapVectorAllocations_;
+    lastHeapVectorAllocations_ = heapVectorAllocations;
+
+    Metrics* metrics = GetSubsystem<Metrics>();
+    if (metrics)
+    {
+        metrics->SetStatistic("Frame Arena Allocations", (float)numAllocations_);
+        metrics->SetStatistic("Frame Arena KB", allocatedBytes_ / 1024.0f);
+        metrics->SetStatistic("Frame Heap Vector Allocations", (float)numHeapVectorAllocations_);
+    }
+}
+
+}
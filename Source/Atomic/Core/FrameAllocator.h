@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/ArenaAllocator.h"
+#include "../Core/Object.h"
+
+namespace Atomic
+{
+
+/// Per-frame linear memory subsystem. Each work queue thread has its own arena, which is reset at the end of every frame, so
+/// memory from it must not outlive the frame it was allocated in. Use for temporary containers on update and render hot paths,
+/// for example with PODVector::Reserve(capacity, arena).
+class ATOMIC_API FrameAllocator : public Object
+{
+    ATOMIC_OBJECT(FrameAllocator, Object);
+
+public:
+    /// Construct.
+    FrameAllocator(Context* context);
+    /// Destruct.
+    virtual ~FrameAllocator();
+
+    /// Return the arena of a work queue thread, 0 being the main thread. Return null when called with index 0 outside the main
+    /// thread, for example from a background loading thread, or with an index beyond the work queue threads.
+    ArenaAllocator* GetArena(unsigned threadIndex = 0) const;
+    /// Allocate memory for the current frame from the arena of a work queue thread.
+    void* Allocate(unsigned size, unsigned alignment = 16, unsigned threadIndex = 0);
+
+    /// Return number of arena allocations during the last frame.
+    unsigned GetNumAllocations() const { return numAllocations_; }
+    /// Return number of bytes allocated from the arenas during the last frame.
+    unsigned GetAllocatedBytes() const { return allocatedBytes_; }
+    /// Return number of vector buffers allocated from the heap during the last frame.
+    unsigned GetNumHeapVectorAllocations() const { return numHeapVectorAllocations_; }
+
+private:
+    /// Create arenas for any new work queue threads at the frame begin.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    /// Gather statistics and reset the arenas at the frame end.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+
+    /// Arenas indexed by work queue thread index.
+    PODVector<ArenaAllocator*> arenas_;
+    /// Number of arena allocations during the last frame.
+    unsigned numAllocations_;
+    /// Number of bytes allocated from the arenas during the last frame.
+    unsigned allocatedBytes_;
+    /// Number of vector buffers allocated from the heap during the last frame.
+    unsigned numHeapVectorAllocations_;
+    /// Heap vector allocation count at the last frame end.
+    unsigned lastHeapVectorAllocations_;
+};
+
+}
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/InternedString.h"
+#include "../Core/Mutex.h"
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+const InternedString InternedString::EMPTY;
+
+/// Return the pool of interned strings. Hash map nodes are never moved, so entries can be pointed to.
+static HashMap<String, StringHash>& GetPool()
+{
+    static HashMap<String, StringHash> pool;
+    return pool;
+}
+
+/// Return the mutex for accessing the pool from several threads.
+static Mutex& GetPoolMutex()
+{
+    static Mutex poolMutex;
+    return poolMutex;
+}
+
+InternedString::InternedString(const String& str) :
+    entry_(str.Empty() ? 0 : Intern(str))
+{
+}
+
+InternedString::InternedString(const char* str) :
+    entry_((!str || !*str) ? 0 : Intern(String(str)))
+{
+}
+
+unsigned InternedString::GetNumInternedStrings()
+{
+    MutexLock lock(GetPoolMutex());
+    return GetPool().Size();
+}
+
+const InternedString::Entry* InternedString::Intern(const String& str)
+{
+    MutexLock lock(GetPoolMutex());
+
+    HashMap<String, StringHash>& pool = GetPool();
+    HashMap<String, StringHash>::Iterator i = pool.Find(str);
+    if (i == pool.End())
+        i = pool.Insert(MakePair(str, StringHash(str)));
+
+    return &(*i);
+}
+
+}
@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Math/StringHash.h"
+
+namespace Atomic
+{
+
+/// Immutable string stored once in a global pool. Copying, comparing for equality and hashing do not touch the characters, which
+/// suits names that are compared and hashed constantly. Interned strings are never freed.
+class ATOMIC_API InternedString
+{
+public:
+    /// Pool entry of an interned string and its hash.
+    typedef HashMap<String, StringHash>::KeyValue Entry;
+
+    /// Construct empty.
+    InternedString() :
+        entry_(0)
+    {
+    }
+
+    /// Construct from a string, adding it to the pool if not interned yet.
+    InternedString(const String& str);
+    /// Construct from a C string, adding it to the pool if not interned yet.
+    InternedString(const char* str);
+
+    /// Test for equality with another interned string.
+    bool operator ==(const InternedString& rhs) const { return entry_ == rhs.entry_; }
+
+    /// Test for inequality with another interned string.
+    bool operator !=(const InternedString& rhs) const { return entry_ != rhs.entry_; }
+
+    /// Test for equality with a string.
+    bool operator ==(const String& rhs) const { return GetString() == rhs; }
+
+    /// Test for inequality with a string.
+    bool operator !=(const String& rhs) const { return GetString() != rhs; }
+
+    /// Test if string is less than another interned string.
+    bool operator <(const InternedString& rhs) const { return GetString() < rhs.GetString(); }
+
+    /// Return the string.
+    operator const String&() const { return GetString(); }
+
+    /// Return the string.
+    const String& GetString() const { return entry_ ? entry_->first_ : String::EMPTY; }
+
+    /// Return the C string.
+    const char* CString() const { return GetString().CString(); }
+
+    /// Return length.
+    unsigned Length() const { return GetString().Length(); }
+
+    /// Return whether the string is empty.
+    bool Empty() const { return !entry_ || entry_->first_.Empty(); }
+
+    /// Return the case-insensitive string hash.
+    StringHash GetHash() const { return entry_ ? entry_->second_ : StringHash::ZERO; }
+
+    /// Return hash value for HashSet & HashMap.
+    unsigned ToHash() const { return GetHash().Value(); }
+
+    /// Return number of strings in the pool.
+    static unsigned GetNumInternedStrings();
+
+    /// Empty interned string.
+    static const InternedString EMPTY;
+
+private:
+    /// Find or add a pool entry for a string.
+    static const Entry* Intern(const String& str);
+
+    /// Pool entry, null if empty.
+    const Entry* entry_;
+};
+
+}
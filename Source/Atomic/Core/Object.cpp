@@ -90,6 +90,12 @@ Object::~Object()
 }
 
 void Object::OnEvent(Object* sender, StringHash eventType, VariantMap& eventData)
+{
+    TypedEventData typedEventData(eventData);
+    OnTypedEvent(sender, eventType, typedEventData);
+}
+
+void Object::OnTypedEvent(Object* sender, StringHash eventType, TypedEventData& eventData)
 {
     // ATOMIC BEGIN
     if (blockEvents_)
@@ -121,7 +127,7 @@ void Object::OnEvent(Object* sender, StringHash eventType, VariantMap& eventData
     if (specific)
     {
         context->SetEventHandler(specific);
-        specific->Invoke(eventData);
+        specific->InvokeTyped(eventData);
         context->SetEventHandler(0);
         return;
     }
@@ -129,7 +135,7 @@ void Object::OnEvent(Object* sender, StringHash eventType, VariantMap& eventData
     if (nonSpecific)
     {
         context->SetEventHandler(nonSpecific);
-        nonSpecific->Invoke(eventData);
+        nonSpecific->InvokeTyped(eventData);
         context->SetEventHandler(0);
     }
 }
@@ -315,6 +321,12 @@ void Object::SendEvent(StringHash eventType)
 }
 // ATOMIC BEGIN
 void Object::SendEvent(StringHash eventType, VariantMap& eventData)
+{
+    TypedEventData typedEventData(eventData);
+    SendEvent(eventType, typedEventData);
+}
+
+void Object::SendEvent(StringHash eventType, TypedEventData& eventData)
 {
 #if ATOMIC_PROFILING
     bool eventProfilingEnabled = false;
@@ -328,7 +340,7 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
         SendEventNonProfiled(eventType, eventData);
 }
 
-void Object::SendEventProfiled(StringHash eventType, VariantMap& eventData)
+void Object::SendEventProfiled(StringHash eventType, TypedEventData& eventData)
 {
 #if ATOMIC_PROFILING
     String eventName;
@@ -339,7 +351,7 @@ void Object::SendEventProfiled(StringHash eventType, VariantMap& eventData)
     SendEventNonProfiled(eventType, eventData);
 }
 
-void Object::SendEventNonProfiled(StringHash eventType, VariantMap& eventData)
+void Object::SendEventNonProfiled(StringHash eventType, TypedEventData& eventData)
 // ATOMIC END
 {
     if (!Thread::IsMainThread())
@@ -379,7 +391,7 @@ void Object::SendEventNonProfiled(StringHash eventType, VariantMap& eventData)
             if (!receiver)
                 continue;
 
-            receiver->OnEvent(this, eventType, eventData);
+            DeliverEvent(receiver, eventType, eventData);
 
             // If self has been destroyed as a result of event handling, exit
             if (self.Expired())
@@ -410,7 +422,7 @@ void Object::SendEventNonProfiled(StringHash eventType, VariantMap& eventData)
                 if (!receiver)
                     continue;
 
-                receiver->OnEvent(this, eventType, eventData);
+                DeliverEvent(receiver, eventType, eventData);
 
                 if (self.Expired())
                 {
@@ -430,7 +442,7 @@ void Object::SendEventNonProfiled(StringHash eventType, VariantMap& eventData)
                 if (!receiver || processed.Contains(receiver))
                     continue;
 
-                receiver->OnEvent(this, eventType, eventData);
+                DeliverEvent(receiver, eventType, eventData);
 
                 if (self.Expired())
                 {
@@ -452,6 +464,15 @@ void Object::SendEventNonProfiled(StringHash eventType, VariantMap& eventData)
 
 }
 
+void Object::DeliverEvent(Object* receiver, StringHash eventType, TypedEventData& eventData)
+{
+    // Events sent as a VariantMap go through OnEvent, so that subclasses overriding it keep receiving them
+    if (eventData.GetPayload())
+        receiver->OnTypedEvent(this, eventType, eventData);
+    else
+        receiver->OnEvent(this, eventType, eventData.GetVariantMap());
+}
+
 VariantMap& Object::GetEventDataMap() const
 {
     return context_->GetEventDataMap();
@@ -110,6 +110,66 @@ private:
         static Atomic::StringHash GetBaseTypeStatic() { static const Atomic::StringHash baseTypeStatic(#baseTypeName); return baseTypeStatic; }
 
 
+/// Event data being sent. Either a VariantMap, or a typed payload struct that is converted to a VariantMap only when a receiver needs one.
+class ATOMIC_API TypedEventData
+{
+public:
+    /// Function that converts a typed payload to a VariantMap. Also identifies the payload type.
+    typedef void (*ToVariantMapFunction)(const void*, VariantMap&);
+
+    /// Construct from a VariantMap.
+    explicit TypedEventData(VariantMap& eventData) :
+        payload_(0),
+        toVariantMap_(0),
+        eventData_(&eventData),
+        converted_(true)
+    {
+    }
+
+    /// Construct from a typed payload and the map to convert it to on demand.
+    TypedEventData(const void* payload, ToVariantMapFunction toVariantMap, VariantMap& eventData) :
+        payload_(payload),
+        toVariantMap_(toVariantMap),
+        eventData_(&eventData),
+        converted_(false)
+    {
+    }
+
+    /// Return the event data as a VariantMap. Converts a typed payload on first use.
+    VariantMap& GetVariantMap()
+    {
+        if (!converted_)
+        {
+            toVariantMap_(payload_, *eventData_);
+            converted_ = true;
+        }
+        return *eventData_;
+    }
+
+    /// Return whether the VariantMap holds the event data, i.e. it was sent as a map or has been converted already.
+    bool IsConverted() const { return converted_; }
+    /// Return the typed payload, or null if sent as a VariantMap.
+    const void* GetPayload() const { return payload_; }
+    /// Return the payload conversion function, or null if sent as a VariantMap.
+    ToVariantMapFunction GetToVariantMapFunction() const { return toVariantMap_; }
+
+private:
+    /// Typed payload.
+    const void* payload_;
+    /// Payload conversion function.
+    ToVariantMapFunction toVariantMap_;
+    /// Map for the event data.
+    VariantMap* eventData_;
+    /// Whether the map holds the event data.
+    bool converted_;
+};
+
+/// Convert a typed event payload to a VariantMap.
+template <class P> void TypedEventPayloadToVariantMap(const void* payload, VariantMap& dest)
+{
+    static_cast<const P*>(payload)->ToVariantMap(dest);
+}
+
 /// Base class for objects with type identification, subsystem access and event sending/receiving capability.
 class ATOMIC_API Object : public RefCounted
 {
@@ -127,8 +187,10 @@ public:
     virtual const String& GetTypeName() const = 0;
     /// Return type info.
     virtual const TypeInfo* GetTypeInfo() const = 0;
-    /// Handle event.
+    /// Handle event sent as a VariantMap. Events sent with a typed payload (E_UPDATE, E_SCENEUPDATE, E_PHYSICSPRESTEP, E_NODECOLLISION) bypass this function, override OnTypedEvent() to intercept every event.
     virtual void OnEvent(Object* sender, StringHash eventType, VariantMap& eventData);
+    /// Handle event sent with a typed payload, or forwarded from OnEvent(). Call eventData.GetVariantMap() to read the payload as a VariantMap.
+    virtual void OnTypedEvent(Object* sender, StringHash eventType, TypedEventData& eventData);
 
     /// Return type info static.
     static const TypeInfo* GetTypeInfoStatic() { return 0; }
@@ -169,6 +231,16 @@ public:
     void SendEvent(StringHash eventType);
     /// Send event with parameters to all subscribers.
     void SendEvent(StringHash eventType, VariantMap& eventData);
+    /// Send event with data that may hold a typed payload to all subscribers.
+    void SendEvent(StringHash eventType, TypedEventData& eventData);
+    /// Send event with a typed payload struct to all subscribers. Handlers subscribed with ATOMIC_TYPED_HANDLER receive the struct
+    /// directly. Other receivers get it converted to a VariantMap, which happens at most once and only if such a receiver exists.
+    /// The struct must define ToVariantMap(VariantMap&) const and FromVariantMap(const VariantMap&).
+    template <class P> void SendTypedEvent(StringHash eventType, const P& payload)
+    {
+        TypedEventData eventData(&payload, &TypedEventPayloadToVariantMap<P>, GetEventDataMap());
+        SendEvent(eventType, eventData);
+    }
     /// Return a preallocated map for event data. Used for optimization to avoid constant re-allocation of event data maps.
     VariantMap& GetEventDataMap() const;
 #if ATOMIC_CXX11
@@ -227,8 +299,8 @@ protected:
     /// Execution context.
     Context* context_;
 
-    void SendEventProfiled(StringHash eventType, VariantMap& eventData);
-    void SendEventNonProfiled(StringHash eventType, VariantMap& eventData);
+    void SendEventProfiled(StringHash eventType, TypedEventData& eventData);
+    void SendEventNonProfiled(StringHash eventType, TypedEventData& eventData);
 
 private:
     /// Find the first event handler with no specific sender.
@@ -239,6 +311,8 @@ private:
     EventHandler* FindSpecificEventHandler(Object* sender, StringHash eventType, EventHandler** previous = 0) const;
     /// Remove event handlers related to a specific sender.
     void RemoveEventSender(Object* sender);
+    /// Pass an event being sent to a receiver, as a typed payload if it has one.
+    void DeliverEvent(Object* receiver, StringHash eventType, TypedEventData& eventData);
 
     /// Event handlers. Sender is null for non-specific handlers.
     LinkedList<EventHandler> eventHandlers_;
@@ -334,6 +408,8 @@ public:
 
     /// Invoke event handler function.
     virtual void Invoke(VariantMap& eventData) = 0;
+    /// Invoke event handler function with data that may hold a typed payload. By default converts it to a VariantMap.
+    virtual void InvokeTyped(TypedEventData& eventData) { Invoke(eventData.GetVariantMap()); }
     /// Return a unique copy of the event handler.
     virtual EventHandler* Clone() const = 0;
 
@@ -393,6 +469,59 @@ private:
     HandlerFunctionPtr function_;
 };
 
+/// Template implementation of the event handler invoke helper for a handler function taking a typed payload struct.
+template <class T, class P> class TypedEventHandlerImpl : public EventHandler
+{
+public:
+    typedef void (T::*HandlerFunctionPtr)(StringHash, const P&);
+
+    /// Construct with receiver and function pointers and userdata.
+    TypedEventHandlerImpl(T* receiver, HandlerFunctionPtr function, void* userData = 0) :
+        EventHandler(receiver, userData),
+        function_(function)
+    {
+        assert(receiver_);
+        assert(function_);
+    }
+
+    /// Invoke event handler function. Converts the VariantMap to the payload struct.
+    virtual void Invoke(VariantMap& eventData)
+    {
+        P payload;
+        payload.FromVariantMap(eventData);
+        T* receiver = static_cast<T*>(receiver_);
+        (receiver->*function_)(eventType_, payload);
+    }
+
+    /// Invoke event handler function. Passes the payload directly if it is of the expected type.
+    virtual void InvokeTyped(TypedEventData& eventData)
+    {
+        if (eventData.GetToVariantMapFunction() == &TypedEventPayloadToVariantMap<P>)
+        {
+            T* receiver = static_cast<T*>(receiver_);
+            (receiver->*function_)(eventType_, *static_cast<const P*>(eventData.GetPayload()));
+        }
+        else
+            Invoke(eventData.GetVariantMap());
+    }
+
+    /// Return a unique copy of the event handler.
+    virtual EventHandler* Clone() const
+    {
+        return new TypedEventHandlerImpl(static_cast<T*>(receiver_), function_, userData_);
+    }
+
+private:
+    /// Class-specific pointer to handler function.
+    HandlerFunctionPtr function_;
+};
+
+/// Construct a typed event handler, deducing the payload type from the handler function.
+template <class T, class P> EventHandler* MakeTypedEventHandler(T* receiver, void (T::*function)(StringHash, const P&), void* userData = 0)
+{
+    return new TypedEventHandlerImpl<T, P>(receiver, function, userData);
+}
+
 #if ATOMIC_CXX11
 /// Template implementation of the event handler invoke helper (std::function instance).
 class EventHandler11Impl : public EventHandler
@@ -443,6 +572,8 @@ struct ATOMIC_API EventNameRegistrar
 #define ATOMIC_HANDLER(className, function) (new Atomic::EventHandlerImpl<className>(this, &className::function))
 /// Convenience macro to construct an EventHandler that points to a receiver object and its member function, and also defines a userdata pointer.
 #define ATOMIC_HANDLER_USERDATA(className, function, userData) (new Atomic::EventHandlerImpl<className>(this, &className::function, userData))
+/// Convenience macro to construct an EventHandler that points to a receiver object and its member function taking a typed event payload.
+#define ATOMIC_TYPED_HANDLER(className, function) (Atomic::MakeTypedEventHandler<className>(this, &className::function))
 
 
 // ATOMIC BEGIN
@@ -21,19 +21,170 @@
 //
 
 #include "../Precompiled.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
 #include "../Core/StringUtils.h"
+#include "../IO/File.h"
+#include "../IO/Log.h"
+#include "../Math/MathDefs.h"
 
 namespace Atomic
 {
 
+/// Process wide registry of counters and histograms.
+struct ProfilerStatistics
+{
+    ~ProfilerStatistics()
+    {
+        for (unsigned i = 0; i < counters_.Size(); ++i)
+            delete counters_[i];
+        for (unsigned i = 0; i < histograms_.Size(); ++i)
+            delete histograms_[i];
+    }
+
+    Mutex mutex_;
+    PODVector<ProfilerCounter*> counters_;
+    PODVector<ProfilerHistogram*> histograms_;
+};
+
+static ProfilerStatistics& GetProfilerStatistics()
+{
+    static ProfilerStatistics statistics;
+    return statistics;
+}
+
+static unsigned GetCounterShard()
+{
+    // mix the thread id, ids are often aligned addresses
+    unsigned long long id = (unsigned long long)Thread::GetCurrentThreadID();
+    id ^= id >> 33;
+    id *= 0xff51afd7ed558ccdULL;
+    id ^= id >> 33;
+    return (unsigned)(id % PROFILER_COUNTER_SHARDS);
+}
+
+static String EscapeJSON(const String& value)
+{
+    String escaped = value;
+    escaped.Replace("\\", "\\\\");
+    escaped.Replace("\"", "\\\"");
+    return escaped;
+}
+
+ProfilerCounter::ProfilerCounter(const String& name) :
+    name_(name)
+{
+    Reset();
+}
+
+void ProfilerCounter::Add(long long value)
+{
+    shards_[GetCounterShard()].value_.fetch_add(value, std::memory_order_relaxed);
+}
+
+void ProfilerCounter::Reset()
+{
+    for (unsigned i = 0; i < PROFILER_COUNTER_SHARDS; ++i)
+        shards_[i].value_.store(0, std::memory_order_relaxed);
+}
+
+long long ProfilerCounter::GetValue() const
+{
+    long long value = 0;
+    for (unsigned i = 0; i < PROFILER_COUNTER_SHARDS; ++i)
+        value += shards_[i].value_.load(std::memory_order_relaxed);
+    return value;
+}
+
+ProfilerHistogram::ProfilerHistogram(const String& name) :
+    name_(name)
+{
+    Reset();
+}
+
+void ProfilerHistogram::Record(unsigned value)
+{
+    buckets_[GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+
+    unsigned max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        ;
+}
+
+void ProfilerHistogram::Reset()
+{
+    for (unsigned i = 0; i < PROFILER_HISTOGRAM_BUCKETS; ++i)
+        buckets_[i].store(0, std::memory_order_relaxed);
+
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+double ProfilerHistogram::GetMean() const
+{
+    unsigned long long count = GetCount();
+    return count ? (double)sum_.load(std::memory_order_relaxed) / count : 0.0;
+}
+
+unsigned ProfilerHistogram::GetPercentile(float percentile) const
+{
+    unsigned long long count = GetCount();
+    if (!count)
+        return 0;
+
+    unsigned long long target = (unsigned long long)ceil(count * Clamp(percentile, 0.0f, 100.0f) / 100.0);
+    if (!target)
+        target = 1;
+
+    unsigned long long cumulative = 0;
+    for (unsigned i = 0; i < PROFILER_HISTOGRAM_BUCKETS; ++i)
+    {
+        cumulative += buckets_[i].load(std::memory_order_relaxed);
+        if (cumulative >= target)
+            return Min(GetBucketUpperBound(i), GetMax());
+    }
+
+    return GetMax();
+}
+
+unsigned ProfilerHistogram::GetBucket(unsigned value)
+{
+    // values below the sub-bucket count are exact, above that each power of two is split linearly
+    if (value < PROFILER_HISTOGRAM_SUB_BUCKETS)
+        return value;
+
+    unsigned exponent = LogBaseTwo(value);
+    unsigned subBucket = (value >> (exponent - 3)) & (PROFILER_HISTOGRAM_SUB_BUCKETS - 1);
+    return (exponent - 2) * PROFILER_HISTOGRAM_SUB_BUCKETS + subBucket;
+}
+
+unsigned ProfilerHistogram::GetBucketUpperBound(unsigned bucket)
+{
+    if (bucket < PROFILER_HISTOGRAM_SUB_BUCKETS)
+        return bucket;
+
+    unsigned exponent = bucket / PROFILER_HISTOGRAM_SUB_BUCKETS + 2;
+    unsigned subBucket = bucket % PROFILER_HISTOGRAM_SUB_BUCKETS;
+    unsigned long long lower = (unsigned long long)(PROFILER_HISTOGRAM_SUB_BUCKETS + subBucket) << (exponent - 3);
+    unsigned long long upper = lower + (1ULL << (exponent - 3)) - 1;
+    return (unsigned)Min(upper, (unsigned long long)M_MAX_UNSIGNED);
+}
+
 Profiler::Profiler(Context* context)
-    : Object(context)
+    : Object(context),
+    frameHistogram_(RegisterHistogram("Frame")),
+    frameStarted_(false)
 {
     SetEnabled(true);
 #if !ATOMIC_PROFILING
     enableEventProfiling_ = false;
 #endif
+
+    SubscribeToEvent(E_BEGINFRAME, ATOMIC_HANDLER(Profiler, HandleBeginFrame));
 }
 
 Profiler::~Profiler()
@@ -113,6 +264,13 @@ bool Profiler::GetLowPriorityEventTracing()
 
 void Profiler::SaveProfilerData(const String& filePath)
 {
+    // counters and histograms are always available, block data only with ATOMIC_PROFILING
+    if (filePath.EndsWith(".json", false))
+    {
+        SaveStatistics(filePath);
+        return;
+    }
+
 #if ATOMIC_PROFILING
     ::profiler::dumpBlocksToFile(filePath.CString());
 #endif
@@ -157,4 +315,103 @@ void Profiler::EndBlock()
 #endif
 }
 
+ProfilerCounter* Profiler::RegisterCounter(const String& name)
+{
+    ProfilerStatistics& statistics = GetProfilerStatistics();
+    MutexLock lock(statistics.mutex_);
+
+    for (unsigned i = 0; i < statistics.counters_.Size(); ++i)
+    {
+        if (statistics.counters_[i]->GetName() == name)
+            return statistics.counters_[i];
+    }
+
+    statistics.counters_.Push(new ProfilerCounter(name));
+    return statistics.counters_.Back();
+}
+
+ProfilerHistogram* Profiler::RegisterHistogram(const String& name)
+{
+    ProfilerStatistics& statistics = GetProfilerStatistics();
+    MutexLock lock(statistics.mutex_);
+
+    for (unsigned i = 0; i < statistics.histograms_.Size(); ++i)
+    {
+        if (statistics.histograms_[i]->GetName() == name)
+            return statistics.histograms_[i];
+    }
+
+    statistics.histograms_.Push(new ProfilerHistogram(name));
+    return statistics.histograms_.Back();
+}
+
+void Profiler::ResetStatistics()
+{
+    ProfilerStatistics& statistics = GetProfilerStatistics();
+    MutexLock lock(statistics.mutex_);
+
+    for (unsigned i = 0; i < statistics.counters_.Size(); ++i)
+        statistics.counters_[i]->Reset();
+
+    for (unsigned i = 0; i < statistics.histograms_.Size(); ++i)
+        statistics.histograms_[i]->Reset();
+}
+
+String Profiler::GetStatisticsJSON() const
+{
+    ProfilerStatistics& statistics = GetProfilerStatistics();
+    MutexLock lock(statistics.mutex_);
+
+    String json = "{\n  \"counters\": {";
+
+    for (unsigned i = 0; i < statistics.counters_.Size(); ++i)
+    {
+        const ProfilerCounter* counter = statistics.counters_[i];
+        json.AppendWithFormat("%s\n    \"%s\": %lld", i ? "," : "", EscapeJSON(counter->GetName()).CString(),
+            counter->GetValue());
+    }
+
+    json += "\n  },\n  \"histograms\": {";
+
+    // values in microseconds
+    for (unsigned i = 0; i < statistics.histograms_.Size(); ++i)
+    {
+        const ProfilerHistogram* histogram = statistics.histograms_[i];
+        json.AppendWithFormat("%s\n    \"%s\": { \"count\": %llu, \"mean\": %.1f, \"p50\": %u, \"p90\": %u, "
+            "\"p99\": %u, \"max\": %u }", i ? "," : "", EscapeJSON(histogram->GetName()).CString(),
+            histogram->GetCount(), histogram->GetMean(), histogram->GetPercentile(50.0f),
+            histogram->GetPercentile(90.0f), histogram->GetPercentile(99.0f), histogram->GetMax());
+    }
+
+    json += "\n  }\n}\n";
+
+    return json;
+}
+
+bool Profiler::SaveStatistics(const String& filePath) const
+{
+    String json = GetStatisticsJSON();
+
+    File file(context_, filePath, FILE_WRITE);
+    if (!file.IsOpen())
+    {
+        ATOMIC_LOGERRORF("Profiler::SaveStatistics - failed to open %s", filePath.CString());
+        return false;
+    }
+
+    return file.Write(json.CString(), json.Length()) == json.Length();
+}
+
+void Profiler::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    // time between frame starts, includes rendering and frame limiting
+    if (frameStarted_)
+        frameHistogram_->Record((unsigned)frameTimer_.GetUSec(true));
+    else
+    {
+        frameTimer_.Reset();
+        frameStarted_ = true;
+    }
+}
+
 }
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "../Container/Str.h"
 #include "../Core/Thread.h"
 #include "../Core/Timer.h"
@@ -51,6 +53,110 @@ enum ProfilerBlockStatus
     FORCE_ON_WITHOUT_CHILDREN = FORCE_ON | OFF_RECURSIVE,
 };
 
+/// Number of counter shards, threads are spread over them to avoid contending on one cache line.
+static const unsigned PROFILER_COUNTER_SHARDS = 16;
+/// Linear sub-buckets per power of two in histograms, bounds the relative error of percentiles to 1/8.
+static const unsigned PROFILER_HISTOGRAM_SUB_BUCKETS = 8;
+/// Number of histogram buckets, covers the full unsigned range.
+static const unsigned PROFILER_HISTOGRAM_BUCKETS = (32 - 2) * PROFILER_HISTOGRAM_SUB_BUCKETS;
+
+/// Always-on counter. Can be added to from any thread without locking.
+class ATOMIC_API ProfilerCounter
+{
+public:
+    /// Construct.
+    ProfilerCounter(const String& name);
+
+    /// Add to the counter.
+    void Add(long long value = 1);
+    /// Reset the counter to zero.
+    void Reset();
+
+    /// Return name.
+    const String& GetName() const { return name_; }
+    /// Return the sum over all threads.
+    long long GetValue() const;
+
+private:
+    /// Counter cell padded to a cache line.
+    struct Shard
+    {
+        std::atomic<long long> value_;
+        char padding_[64 - sizeof(std::atomic<long long>)];
+    };
+
+    /// Name.
+    String name_;
+    /// Keeps the first shard off the cache line of the name. Padding is used instead of alignas(64), as C++11 heap allocation does not honour over-alignment.
+    char padding_[64];
+    /// Shards indexed by thread. Each fills a cache line, so the values of two shards never share one.
+    Shard shards_[PROFILER_COUNTER_SHARDS];
+};
+
+/// Always-on log-linear latency histogram. Values are microseconds, can be recorded from any thread without locking. Recorded values accumulate until Reset() or Profiler::ResetStatistics(), so statistics cover the whole period since then, not a single frame.
+class ATOMIC_API ProfilerHistogram
+{
+public:
+    /// Construct.
+    ProfilerHistogram(const String& name);
+
+    /// Record a value.
+    void Record(unsigned value);
+    /// Reset all recorded values.
+    void Reset();
+
+    /// Return name.
+    const String& GetName() const { return name_; }
+    /// Return number of recorded values.
+    unsigned long long GetCount() const { return count_.load(std::memory_order_relaxed); }
+    /// Return largest recorded value.
+    unsigned GetMax() const { return max_.load(std::memory_order_relaxed); }
+    /// Return mean of recorded values.
+    double GetMean() const;
+    /// Return value at percentile (0-100) of all values recorded since the last reset, accurate to the bucket width.
+    unsigned GetPercentile(float percentile) const;
+
+private:
+    /// Return bucket of a value.
+    static unsigned GetBucket(unsigned value);
+    /// Return largest value which falls in a bucket.
+    static unsigned GetBucketUpperBound(unsigned bucket);
+
+    /// Name.
+    String name_;
+    /// Bucket counts.
+    std::atomic<unsigned> buckets_[PROFILER_HISTOGRAM_BUCKETS];
+    /// Number of recorded values.
+    std::atomic<unsigned long long> count_;
+    /// Sum of recorded values.
+    std::atomic<unsigned long long> sum_;
+    /// Largest recorded value.
+    std::atomic<unsigned> max_;
+};
+
+/// Records the lifetime of a scope to a histogram.
+class ATOMIC_API ProfilerHistogramScope
+{
+public:
+    /// Construct and start timing.
+    ProfilerHistogramScope(ProfilerHistogram* histogram) :
+        histogram_(histogram)
+    {
+    }
+
+    /// Destruct and record the elapsed time.
+    ~ProfilerHistogramScope()
+    {
+        histogram_->Record((unsigned)timer_.GetUSec(false));
+    }
+
+private:
+    /// Histogram.
+    ProfilerHistogram* histogram_;
+    /// Timer.
+    HiresTimer timer_;
+};
+
 
 /// Hierarchical performance profiler subsystem.
 class ATOMIC_API Profiler : public Object
@@ -94,10 +200,31 @@ public:
     /// End block started with BeginBlock().
     void EndBlock();
 
+    /// Return counter by name, created on first use. Counters live until the program exits.
+    static ProfilerCounter* RegisterCounter(const String& name);
+    /// Return histogram by name, created on first use. Histograms live until the program exits.
+    static ProfilerHistogram* RegisterHistogram(const String& name);
+    /// Reset all counters and histograms. Call to start a new reporting period, for example after each statistics dump.
+    static void ResetStatistics();
+    /// Return frame time histogram. Holds the time of every frame since the last reset, so its percentiles are frame time tails over that period.
+    ProfilerHistogram* GetFrameHistogram() const { return frameHistogram_; }
+    /// Return counters and histograms as JSON.
+    String GetStatisticsJSON() const;
+    /// Save counters and histograms as JSON. Return true if successful.
+    bool SaveStatistics(const String& filePath) const;
+
 private:
+    /// Handle frame begin, records the previous frame time.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
 
     bool enableEventProfiling_ = true;
     HashMap<unsigned, ::profiler::BaseBlockDescriptor*> blockDescriptorCache_;
+    /// Frame time histogram.
+    ProfilerHistogram* frameHistogram_;
+    /// Frame timer.
+    HiresTimer frameTimer_;
+    /// Whether a frame has begun.
+    bool frameStarted_;
 };
 
 #if ATOMIC_PROFILING
@@ -114,4 +241,13 @@ private:
 #   define ATOMIC_PROFILE_THREAD(name)
 #endif
 
+// Always-on counter and histogram macros, independent of ATOMIC_PROFILING.
+#define ATOMIC_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ATOMIC_PROFILE_CONCAT(a, b) ATOMIC_PROFILE_CONCAT_IMPL(a, b)
+#define ATOMIC_PROFILE_COUNTER(name, value) \
+    do { static Atomic::ProfilerCounter* counter = Atomic::Profiler::RegisterCounter(#name); counter->Add(value); } while (0)
+#define ATOMIC_PROFILE_HISTOGRAM(name) \
+    static Atomic::ProfilerHistogram* ATOMIC_PROFILE_CONCAT(histogram_, __LINE__) = Atomic::Profiler::RegisterHistogram(#name); \
+    Atomic::ProfilerHistogramScope ATOMIC_PROFILE_CONCAT(histogramScope_, __LINE__)(ATOMIC_PROFILE_CONCAT(histogram_, __LINE__))
+
 }
@@ -329,6 +329,7 @@ void WorkQueue::ProcessItems(unsigned threadIndex)
                 queueMutex_.Release();
                 item->workFunction_(item, threadIndex);
                 item->completed_ = true;
+                ATOMIC_PROFILE_COUNTER(WorkerThreadItems, 1);
             }
             else
             {
@@ -52,6 +52,8 @@ public:
         completed_(false),
         pooled_(false)
     {
+        // Work items are referenced from the worker threads
+        SetAtomicRefCount();
     }
 
     /// Work function. Called with the work item and thread index (0 = main thread) as parameters.
@@ -22,8 +22,10 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
 #include "../Database/Database.h"
+#include "../Database/DbWorker.h"
 
 namespace Atomic
 {
@@ -31,11 +33,21 @@ namespace Atomic
 Database::Database(Context* context_) :
     Object(context_),
 #ifdef ODBC_3_OR_LATER
-    poolSize_(0)
+    poolSize_(0),
 #else
-    poolSize_(M_MAX_UNSIGNED)
+    poolSize_(M_MAX_UNSIGNED),
 #endif
+    nextRequestID_(0)
 {
+    worker_ = new DbWorker(this);
+
+    SubscribeToEvent(E_BEGINFRAME, ATOMIC_HANDLER(Database, HandleBeginFrame));
+}
+
+Database::~Database()
+{
+    // Shut down the worker first, as it uses pooled connections
+    worker_.Reset();
 }
 
 DBAPI Database::GetAPI()
@@ -51,21 +63,7 @@ DbConnection* Database::Connect(const String& connectionString)
 {
     ATOMIC_PROFILE(DatabaseConnect);
 
-    SharedPtr<DbConnection> connection;
-    if (IsPooling())
-    {
-        Vector<SharedPtr<DbConnection> >& connectionsPool = connectionsPool_[connectionString];
-        while (!connectionsPool.Empty())
-        {
-            connection = connectionsPool.Back();
-            connectionsPool.Pop();
-            if (connection->IsConnected())
-                break;
-            connection = 0;
-        }
-    }
-    if (!connection)
-        connection = new DbConnection(context_, connectionString);
+    SharedPtr<DbConnection> connection = AcquireConnection(connectionString);
     if (connection->IsConnected())
     {
         connections_.Push(connection);
@@ -88,12 +86,79 @@ void Database::Disconnect(DbConnection* connection)
     // Must finalize the connection before closing the connection or returning it to the pool
     connection->Finalize();
 
+    ReleaseConnection(dbConnection);
+}
+
+SharedPtr<DbRequest> Database::ExecuteAsync(const String& connectionString, const String& sql, const VariantVector& parameters)
+{
+    SharedPtr<DbRequest> request(new DbRequest(++nextRequestID_, connectionString, sql, parameters));
+
+    // Start the worker thread on the first request. If threading is not available, requests execute at frame start
+    if (!worker_->IsStarted())
+        worker_->Run();
+
+    worker_->QueueRequest(request);
+    return request;
+}
+
+unsigned Database::GetNumPendingRequests() const
+{
+    return worker_->GetNumPendingRequests();
+}
+
+void Database::SetPoolSize(unsigned poolSize)
+{
+    MutexLock lock(poolMutex_);
+
+    poolSize_ = poolSize;
+    for (HashMap<String, Vector<SharedPtr<DbConnection> > >::Iterator i = connectionsPool_.Begin(); i != connectionsPool_.End(); ++i)
+    {
+        if (i->second_.Size() > poolSize_)
+            i->second_.Resize(poolSize_);
+    }
+}
+
+SharedPtr<DbConnection> Database::AcquireConnection(const String& connectionString)
+{
+    SharedPtr<DbConnection> connection;
     if (IsPooling())
     {
-        Vector<SharedPtr<DbConnection> >& connectionsPool = connectionsPool_[connection->GetConnectionString()];
-        if (connectionsPool.Size() < poolSize_)
-            connectionsPool.Push(dbConnection);
+        MutexLock lock(poolMutex_);
+
+        Vector<SharedPtr<DbConnection> >& connectionsPool = connectionsPool_[connectionString];
+        while (!connectionsPool.Empty())
+        {
+            connection = connectionsPool.Back();
+            connectionsPool.Pop();
+            if (connection->IsConnected())
+                break;
+            connection = 0;
+        }
     }
+    if (!connection)
+        connection = new DbConnection(context_, connectionString);
+
+    return connection;
+}
+
+void Database::ReleaseConnection(const SharedPtr<DbConnection>& connection)
+{
+    if (!IsPooling() || !connection->IsConnected())
+        return;
+
+    MutexLock lock(poolMutex_);
+
+    Vector<SharedPtr<DbConnection> >& connectionsPool = connectionsPool_[connection->GetConnectionString()];
+    if (connectionsPool.Size() < poolSize_)
+        connectionsPool.Push(connection);
+}
+
+void Database::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    if (!worker_->IsStarted())
+        worker_->ProcessRequests();
+
+    worker_->SendCompletionEvents();
 }
 
 }
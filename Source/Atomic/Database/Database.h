@@ -22,8 +22,10 @@
 
 #pragma once
 
+#include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Database/DbConnection.h"
+#include "../Database/DbRequest.h"
 
 namespace Atomic
 {
@@ -36,15 +38,20 @@ enum DBAPI
 };
 
 class DbConnection;
+class DbWorker;
 
 /// %Database subsystem. Manage database connections.
 class ATOMIC_API Database : public Object
 {
     ATOMIC_OBJECT(Database, Object);
 
+    friend class DbWorker;
+
 public:
     /// Construct.
     Database(Context* context_);
+    /// Destruct.
+    ~Database();
     /// Return the underlying database API.
     static DBAPI GetAPI();
 
@@ -52,6 +59,10 @@ public:
     DbConnection* Connect(const String& connectionString);
     /// Disconnect a database connection. The connection object pointer should not be used anymore after this.
     void Disconnect(DbConnection* connection);
+    /// Queue an SQL statement for execution on the database worker thread. Parameters are bound to the statement in order. E_DBREQUESTCOMPLETED is sent when finished.
+    SharedPtr<DbRequest> ExecuteAsync(const String& connectionString, const String& sql, const VariantVector& parameters = Variant::emptyVariantVector);
+    /// Return number of asynchronous requests queued or executing.
+    unsigned GetNumPendingRequests() const;
 
     /// Return true when using internal database connection pool. The internal database pool is managed by the Database subsystem itself and should not be confused with ODBC connection pool option when ODBC is being used.
     bool IsPooling() const { return (bool)poolSize_; }
@@ -59,16 +70,29 @@ public:
     /// Get internal database connection pool size.
     unsigned GetPoolSize() const { return poolSize_; }
 
-    /// Set internal database connection pool size.
-    void SetPoolSize(unsigned poolSize) { poolSize_ = poolSize; }
+    /// Set internal database connection pool size. Pooled connections exceeding the new size are closed.
+    void SetPoolSize(unsigned poolSize);
 
 private:
+    /// Return a pooled connection or create a new one. Thread-safe.
+    SharedPtr<DbConnection> AcquireConnection(const String& connectionString);
+    /// Return a finalized connection to the pool, or let it close when not pooling or the pool is full. Thread-safe, but the connection may be destroyed, so call from the main thread.
+    void ReleaseConnection(const SharedPtr<DbConnection>& connection);
+    /// Handle begin frame event. Send completion events for finished asynchronous requests.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+
     /// %Database connection pool size. Default to 0 when using ODBC 3.0 or later as ODBC 3.0 driver manager could manage its own database connection pool.
     unsigned poolSize_;
     /// Active database connections.
     Vector<SharedPtr<DbConnection> > connections_;
     ///%Database connections pool.
     HashMap<String, Vector<SharedPtr<DbConnection> > > connectionsPool_;
+    /// Mutex for the connection pool, which is shared with the worker thread.
+    Mutex poolMutex_;
+    /// Asynchronous request worker. Its thread will start on the first request.
+    SharedPtr<DbWorker> worker_;
+    /// Next asynchronous request ID.
+    unsigned nextRequestID_;
 };
 
 }
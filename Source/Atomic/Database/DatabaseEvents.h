@@ -41,4 +41,12 @@ ATOMIC_EVENT(E_DBCURSOR, DbCursor)
     ATOMIC_PARAM(P_ABORT, Abort);                  // bool [in]
 }
 
+/// Asynchronous database request finished. Sent in the main thread at the beginning of the frame, in request submission order.
+ATOMIC_EVENT(E_DBREQUESTCOMPLETED, DbRequestCompleted)
+{
+    ATOMIC_PARAM(P_REQUEST, Request);              // DbRequest pointer
+    ATOMIC_PARAM(P_REQUESTID, RequestID);          // unsigned
+    ATOMIC_PARAM(P_SUCCESS, Success);              // bool
+}
+
 }
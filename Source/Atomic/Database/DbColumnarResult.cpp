@@ -0,0 +1,245 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Database/DbColumnarResult.h"
+
+#include <cstring>
+
+namespace Atomic
+{
+
+DbColumnarResult::DbColumnarResult() :
+    numRows_(0),
+    numAffectedRows_(-1)
+{
+}
+
+void DbColumnarResult::Clear()
+{
+    columns_.Clear();
+    numRows_ = 0;
+    numAffectedRows_ = -1;
+}
+
+void DbColumnarResult::SetColumns(const StringVector& names)
+{
+    Clear();
+    columns_.Resize(names.Size());
+    for (unsigned i = 0; i < names.Size(); ++i)
+        columns_[i].name_ = names[i];
+}
+
+void DbColumnarResult::AppendNull(unsigned column)
+{
+    DbColumn& col = columns_[column];
+    col.nulls_.Push(true);
+
+    switch (col.type_)
+    {
+    case DBCOLUMN_INTEGER:
+        col.integers_.Push(0);
+        break;
+
+    case DBCOLUMN_REAL:
+        col.reals_.Push(0.0);
+        break;
+
+    case DBCOLUMN_TEXT:
+    case DBCOLUMN_BLOB:
+        col.offsets_.Push(col.data_.Size());
+        break;
+
+    default:
+        break;
+    }
+}
+
+void DbColumnarResult::AppendInteger(unsigned column, long long value)
+{
+    DbColumn& col = columns_[column];
+    SetColumnType(col, DBCOLUMN_INTEGER);
+    col.integers_.Push(value);
+    col.nulls_.Push(false);
+}
+
+void DbColumnarResult::AppendReal(unsigned column, double value)
+{
+    DbColumn& col = columns_[column];
+    SetColumnType(col, DBCOLUMN_REAL);
+    col.reals_.Push(value);
+    col.nulls_.Push(false);
+}
+
+void DbColumnarResult::AppendText(unsigned column, const char* value, unsigned length)
+{
+    DbColumn& col = columns_[column];
+    SetColumnType(col, DBCOLUMN_TEXT);
+
+    unsigned offset = col.data_.Size();
+    col.data_.Resize(offset + length + 1);
+    if (length)
+        memcpy(&col.data_[offset], value, length);
+    col.data_[offset + length] = 0;
+    col.offsets_.Push(col.data_.Size());
+    col.nulls_.Push(false);
+}
+
+void DbColumnarResult::AppendBlob(unsigned column, const void* data, unsigned size)
+{
+    DbColumn& col = columns_[column];
+    SetColumnType(col, DBCOLUMN_BLOB);
+
+    unsigned offset = col.data_.Size();
+    col.data_.Resize(offset + size);
+    if (size)
+        memcpy(&col.data_[offset], data, size);
+    col.offsets_.Push(col.data_.Size());
+    col.nulls_.Push(false);
+}
+
+unsigned DbColumnarResult::GetColumnIndex(const String& name) const
+{
+    for (unsigned i = 0; i < columns_.Size(); ++i)
+    {
+        if (columns_[i].name_ == name)
+            return i;
+    }
+
+    return M_MAX_UNSIGNED;
+}
+
+long long DbColumnarResult::GetInteger(unsigned column, unsigned row) const
+{
+    const DbColumn& col = columns_[column];
+    if (col.type_ == DBCOLUMN_INTEGER)
+        return col.integers_[row];
+    else if (col.type_ == DBCOLUMN_REAL)
+        return (long long)col.reals_[row];
+    else
+        return 0;
+}
+
+double DbColumnarResult::GetReal(unsigned column, unsigned row) const
+{
+    const DbColumn& col = columns_[column];
+    if (col.type_ == DBCOLUMN_REAL)
+        return col.reals_[row];
+    else if (col.type_ == DBCOLUMN_INTEGER)
+        return (double)col.integers_[row];
+    else
+        return 0.0;
+}
+
+const char* DbColumnarResult::GetText(unsigned column, unsigned row) const
+{
+    const DbColumn& col = columns_[column];
+    if (col.type_ != DBCOLUMN_TEXT || col.nulls_[row])
+        return "";
+
+    return (const char*)&col.data_[col.offsets_[row]];
+}
+
+const unsigned char* DbColumnarResult::GetBlob(unsigned column, unsigned row, unsigned& size) const
+{
+    const DbColumn& col = columns_[column];
+    if ((col.type_ != DBCOLUMN_TEXT && col.type_ != DBCOLUMN_BLOB) || col.nulls_[row])
+    {
+        size = 0;
+        return 0;
+    }
+
+    unsigned start = col.offsets_[row];
+    size = col.offsets_[row + 1] - start;
+    // Do not report the null terminator of text values
+    if (col.type_ == DBCOLUMN_TEXT)
+        --size;
+    return size ? &col.data_[start] : 0;
+}
+
+Variant DbColumnarResult::GetVariant(unsigned column, unsigned row) const
+{
+    const DbColumn& col = columns_[column];
+    if (col.nulls_[row])
+        return Variant::EMPTY;
+
+    switch (col.type_)
+    {
+    case DBCOLUMN_INTEGER:
+        return Variant(col.integers_[row]);
+
+    case DBCOLUMN_REAL:
+        return Variant(col.reals_[row]);
+
+    case DBCOLUMN_TEXT:
+        return Variant(GetText(column, row));
+
+    case DBCOLUMN_BLOB:
+        {
+            unsigned size;
+            const unsigned char* data = GetBlob(column, row, size);
+            return Variant(PODVector<unsigned char>(data, size));
+        }
+
+    default:
+        return Variant::EMPTY;
+    }
+}
+
+void DbColumnarResult::SetColumnType(DbColumn& column, DbColumnType type)
+{
+    if (column.type_ == type)
+        return;
+
+    assert(column.type_ == DBCOLUMN_NULL);
+    column.type_ = type;
+
+    // Previous rows were all nulls, give them default storage in the now typed array
+    unsigned rows = column.nulls_.Size();
+    switch (type)
+    {
+    case DBCOLUMN_INTEGER:
+        column.integers_.Resize(rows);
+        for (unsigned i = 0; i < rows; ++i)
+            column.integers_[i] = 0;
+        break;
+
+    case DBCOLUMN_REAL:
+        column.reals_.Resize(rows);
+        for (unsigned i = 0; i < rows; ++i)
+            column.reals_[i] = 0.0;
+        break;
+
+    case DBCOLUMN_TEXT:
+    case DBCOLUMN_BLOB:
+        column.offsets_.Resize(rows + 1);
+        for (unsigned i = 0; i <= rows; ++i)
+            column.offsets_[i] = 0;
+        break;
+
+    default:
+        break;
+    }
+}
+
+}
@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Str.h"
+#include "../Core/Variant.h"
+
+namespace Atomic
+{
+
+/// Storage type of a column in a columnar resultset.
+enum DbColumnType
+{
+    DBCOLUMN_NULL = 0,
+    DBCOLUMN_INTEGER,
+    DBCOLUMN_REAL,
+    DBCOLUMN_TEXT,
+    DBCOLUMN_BLOB
+};
+
+/// Typed storage of a single resultset column. Only the array matching the column type is used.
+struct ATOMIC_API DbColumn
+{
+    /// Construct.
+    DbColumn() :
+        type_(DBCOLUMN_NULL)
+    {
+    }
+
+    /// Column name.
+    String name_;
+    /// Column storage type. Fixed by the first non-null value.
+    DbColumnType type_;
+    /// Integer values, one per row.
+    PODVector<long long> integers_;
+    /// Real values, one per row.
+    PODVector<double> reals_;
+    /// Text and blob start offsets into data, one per row plus the end offset.
+    PODVector<unsigned> offsets_;
+    /// Text and blob data. Text values are stored null-terminated.
+    PODVector<unsigned char> data_;
+    /// Null flags, one per row.
+    PODVector<bool> nulls_;
+};
+
+/// %Database query result stored column by column in typed buffers instead of per-cell Variants.
+class ATOMIC_API DbColumnarResult
+{
+public:
+    /// Construct an empty result.
+    DbColumnarResult();
+
+    /// Clear all columns and rows.
+    void Clear();
+    /// Set the column headers. Clears previous rows.
+    void SetColumns(const StringVector& names);
+    /// Begin a new row. Each column must then be appended exactly once.
+    void BeginRow() { ++numRows_; }
+    /// Append a null value to a column.
+    void AppendNull(unsigned column);
+    /// Append an integer value to a column.
+    void AppendInteger(unsigned column, long long value);
+    /// Append a real value to a column.
+    void AppendReal(unsigned column, double value);
+    /// Append a text value to a column.
+    void AppendText(unsigned column, const char* value, unsigned length);
+    /// Append a blob value to a column.
+    void AppendBlob(unsigned column, const void* data, unsigned size);
+    /// Set number of affected rows by a DML query.
+    void SetNumAffectedRows(long numAffectedRows) { numAffectedRows_ = numAffectedRows; }
+
+    /// Return number of columns in the resultset.
+    unsigned GetNumColumns() const { return columns_.Size(); }
+    /// Return number of rows in the resultset.
+    unsigned GetNumRows() const { return numRows_; }
+    /// Return number of affected rows by the DML query or -1 if the number of affected rows is not available.
+    long GetNumAffectedRows() const { return numAffectedRows_; }
+    /// Return index of a column by name, or M_MAX_UNSIGNED if not found.
+    unsigned GetColumnIndex(const String& name) const;
+    /// Return column name.
+    const String& GetColumnName(unsigned column) const { return columns_[column].name_; }
+    /// Return column storage type.
+    DbColumnType GetColumnType(unsigned column) const { return columns_[column].type_; }
+    /// Return column storage for direct bulk access.
+    const DbColumn& GetColumn(unsigned column) const { return columns_[column]; }
+
+    /// Return whether a cell is null.
+    bool IsNull(unsigned column, unsigned row) const { return columns_[column].nulls_[row]; }
+    /// Return an integer cell. Returns zero if the column is not an integer column.
+    long long GetInteger(unsigned column, unsigned row) const;
+    /// Return a real cell. Integer columns are converted.
+    double GetReal(unsigned column, unsigned row) const;
+    /// Return a text cell as a null-terminated string. Returns an empty string if the column is not a text column.
+    const char* GetText(unsigned column, unsigned row) const;
+    /// Return a blob or text cell data and size.
+    const unsigned char* GetBlob(unsigned column, unsigned row, unsigned& size) const;
+    /// Return a cell converted to a Variant. This is slow and is meant for scripting or debugging.
+    Variant GetVariant(unsigned column, unsigned row) const;
+
+private:
+    /// Fix the storage type of a column on its first non-null value, filling previous rows with defaults.
+    void SetColumnType(DbColumn& column, DbColumnType type);
+
+    /// Columns.
+    Vector<DbColumn> columns_;
+    /// Number of rows.
+    unsigned numRows_;
+    /// Number of affected rows by recent DML query.
+    long numAffectedRows_;
+};
+
+}
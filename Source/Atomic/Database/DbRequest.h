@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/RefCounted.h"
+#include "../Database/DbColumnarResult.h"
+
+#include <atomic>
+
+namespace Atomic
+{
+
+/// Asynchronous database request state.
+enum DbRequestState
+{
+    DBREQUEST_QUEUED = 0,
+    DBREQUEST_EXECUTING,
+    DBREQUEST_COMPLETED,
+    DBREQUEST_FAILED
+};
+
+/// Asynchronous database request. Executed on the database worker thread; the result may only be accessed once finished.
+class ATOMIC_API DbRequest : public RefCounted
+{
+    ATOMIC_REFCOUNTED(DbRequest)
+
+    friend class DbWorker;
+
+public:
+    /// Construct.
+    DbRequest(unsigned id, const String& connectionString, const String& sql, const VariantVector& parameters) :
+        id_(id),
+        connectionString_(connectionString),
+        sql_(sql),
+        parameters_(parameters),
+        state_(DBREQUEST_QUEUED)
+    {
+    }
+
+    /// Return request ID.
+    unsigned GetID() const { return id_; }
+    /// Return connection string of the database the request is executed on.
+    const String& GetConnectionString() const { return connectionString_; }
+    /// Return SQL text.
+    const String& GetSQL() const { return sql_; }
+    /// Return parameter values.
+    const VariantVector& GetParameters() const { return parameters_; }
+    /// Return request state.
+    DbRequestState GetState() const { return state_.load(std::memory_order_acquire); }
+    /// Return whether the request has finished, either successfully or not. Once true, the result written by the worker thread is visible to the caller.
+    bool IsFinished() const { return state_.load(std::memory_order_acquire) >= DBREQUEST_COMPLETED; }
+    /// Return whether the request finished successfully.
+    bool IsSuccess() const { return state_.load(std::memory_order_acquire) == DBREQUEST_COMPLETED; }
+    /// Return the result. Only valid once the request has finished.
+    const DbColumnarResult& GetResult() const { return result_; }
+
+private:
+    /// Request ID.
+    unsigned id_;
+    /// Connection string.
+    String connectionString_;
+    /// SQL text.
+    String sql_;
+    /// Parameter values, bound in order.
+    VariantVector parameters_;
+    /// Result.
+    DbColumnarResult result_;
+    /// Request state. Written by the worker thread with release ordering after the result.
+    std::atomic<DbRequestState> state_;
+};
+
+}
@@ -0,0 +1,206 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Profiler.h"
+#include "../Database/Database.h"
+#include "../Database/DatabaseEvents.h"
+#include "../Database/DbWorker.h"
+
+namespace Atomic
+{
+
+DbWorker::DbWorker(Database* owner) :
+    owner_(owner)
+{
+}
+
+DbWorker::~DbWorker()
+{
+    // Wake up the thread so that it notices it should stop
+    shouldRun_ = false;
+    queueCondition_.Set();
+    Stop();
+
+    MutexLock lock(queueMutex_);
+    queue_.Clear();
+}
+
+void DbWorker::ThreadFunction()
+{
+    ATOMIC_PROFILE_THREAD("DbWorker Thread");
+
+    while (shouldRun_)
+    {
+        DbRequest* request = 0;
+
+        queueMutex_.Acquire();
+        if (!queue_.Empty())
+        {
+            request = queue_.Front();
+            queue_.PopFront();
+        }
+        queueMutex_.Release();
+
+        if (request)
+            ExecuteRequest(request);
+        else
+        {
+            // Do not keep connections out of the pool while idle
+            ReleaseConnections();
+            queueCondition_.Wait();
+        }
+    }
+}
+
+void DbWorker::QueueRequest(DbRequest* request)
+{
+    requests_.Push(SharedPtr<DbRequest>(request));
+
+    {
+        MutexLock lock(queueMutex_);
+        queue_.Push(request);
+    }
+
+    queueCondition_.Set();
+}
+
+void DbWorker::ProcessRequests()
+{
+    for (;;)
+    {
+        DbRequest* request = 0;
+
+        {
+            MutexLock lock(queueMutex_);
+            if (queue_.Empty())
+                break;
+            request = queue_.Front();
+            queue_.PopFront();
+        }
+
+        ExecuteRequest(request);
+    }
+
+    ReleaseConnections();
+}
+
+void DbWorker::SendCompletionEvents()
+{
+    // Report in submission order, so that callers can rely on their requests completing in sequence
+    while (!requests_.Empty() && requests_.Front()->IsFinished())
+    {
+        SharedPtr<DbRequest> request = requests_.Front();
+        requests_.PopFront();
+
+        using namespace DbRequestCompleted;
+
+        VariantMap& eventData = owner_->GetEventDataMap();
+        eventData[P_REQUEST] = request.Get();
+        eventData[P_REQUESTID] = request->GetID();
+        eventData[P_SUCCESS] = request->IsSuccess();
+        owner_->SendEvent(E_DBREQUESTCOMPLETED, eventData);
+    }
+
+    Vector<SharedPtr<DbConnection> > releasedConnections;
+    {
+        MutexLock lock(queueMutex_);
+        releasedConnections.Swap(releasedConnections_);
+    }
+
+    for (unsigned i = 0; i < releasedConnections.Size(); ++i)
+        owner_->ReleaseConnection(releasedConnections[i]);
+}
+
+unsigned DbWorker::GetNumPendingRequests() const
+{
+    unsigned count = 0;
+    for (List<SharedPtr<DbRequest> >::ConstIterator i = requests_.Begin(); i != requests_.End(); ++i)
+    {
+        if (!(*i)->IsFinished())
+            ++count;
+    }
+
+    return count;
+}
+
+void DbWorker::ExecuteRequest(DbRequest* request)
+{
+    ATOMIC_PROFILE(ExecuteDbRequest);
+
+    request->state_.store(DBREQUEST_EXECUTING, std::memory_order_relaxed);
+
+    bool success = false;
+    DbConnection* connection = GetConnection(request->connectionString_);
+    if (connection)
+    {
+        SharedPtr<DbStatement> statement = connection->Prepare(request->sql_);
+        if (statement)
+        {
+            for (unsigned i = 0; i < request->parameters_.Size(); ++i)
+                statement->Bind(i, request->parameters_[i]);
+
+            success = connection->ExecuteColumnar(statement, request->result_);
+        }
+    }
+
+    // Must be the last access to the request, as the main thread may release it once finished
+    request->state_.store(success ? DBREQUEST_COMPLETED : DBREQUEST_FAILED, std::memory_order_release);
+}
+
+DbConnection* DbWorker::GetConnection(const String& connectionString)
+{
+    HashMap<String, SharedPtr<DbConnection> >::Iterator i = connections_.Find(connectionString);
+    if (i != connections_.End())
+        return i->second_;
+
+    SharedPtr<DbConnection> connection = owner_->AcquireConnection(connectionString);
+    if (!connection->IsConnected())
+    {
+        // Objects must not be destroyed outside the main thread
+        MutexLock lock(queueMutex_);
+        releasedConnections_.Push(connection);
+        connection.Reset();
+        return 0;
+    }
+
+    connections_[connectionString] = connection;
+    return connection;
+}
+
+void DbWorker::ReleaseConnections()
+{
+    if (connections_.Empty())
+        return;
+
+    // Statements are finalized here, as the connection is not used by this thread afterwards
+    for (HashMap<String, SharedPtr<DbConnection> >::Iterator i = connections_.Begin(); i != connections_.End(); ++i)
+        i->second_->Finalize();
+
+    MutexLock lock(queueMutex_);
+    for (HashMap<String, SharedPtr<DbConnection> >::Iterator i = connections_.Begin(); i != connections_.End(); ++i)
+        releasedConnections_.Push(i->second_);
+    connections_.Clear();
+}
+
+}
@@ -0,0 +1,88 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Container/List.h"
+#include "../Container/Ptr.h"
+#include "../Container/RefCounted.h"
+#include "../Core/Condition.h"
+#include "../Core/Mutex.h"
+#include "../Core/Thread.h"
+#include "../Database/DbConnection.h"
+#include "../Database/DbRequest.h"
+
+namespace Atomic
+{
+
+class Database;
+
+/// Dedicated thread executing asynchronous database requests. Owned by the Database subsystem.
+class DbWorker : public RefCounted, public Thread
+{
+    ATOMIC_REFCOUNTED(DbWorker)
+
+public:
+    /// Construct.
+    DbWorker(Database* owner);
+    /// Destruct. Stop the thread and discard requests which have not been executed.
+    ~DbWorker();
+
+    /// Request execution loop.
+    virtual void ThreadFunction();
+
+    /// Queue a request and wake up the thread.
+    void QueueRequest(DbRequest* request);
+    /// Execute all queued requests in the calling thread. Used when threading is not available.
+    void ProcessRequests();
+    /// Send completion events for finished requests and release them, and return connections released by the worker to the pool. Must be called from the main thread.
+    void SendCompletionEvents();
+
+    /// Return number of requests queued or executing.
+    unsigned GetNumPendingRequests() const;
+
+private:
+    /// Execute one request.
+    void ExecuteRequest(DbRequest* request);
+    /// Return the worker's connection for a connection string, acquiring one from the pool if necessary.
+    DbConnection* GetConnection(const String& connectionString);
+    /// Finalize the worker's connections and hand them to the main thread for returning to the pool. Called when the queue runs empty.
+    void ReleaseConnections();
+
+    /// Database subsystem.
+    Database* owner_;
+    /// All requests not yet reported. Accessed only by the main thread.
+    List<SharedPtr<DbRequest> > requests_;
+    /// Requests waiting for execution. Pointers are guaranteed to be valid (point to requests_.)
+    List<DbRequest*> queue_;
+    /// Mutex for the execution queue.
+    mutable Mutex queueMutex_;
+    /// Condition to wake up the thread when requests are queued.
+    Condition queueCondition_;
+    /// Connections used by the worker, by connection string. Accessed only by the worker.
+    HashMap<String, SharedPtr<DbConnection> > connections_;
+    /// Connections no longer used by the worker, returned to the pool or released in the main thread.
+    Vector<SharedPtr<DbConnection> > releasedConnections_;
+};
+
+}
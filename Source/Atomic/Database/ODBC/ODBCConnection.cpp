@@ -36,9 +36,12 @@
 namespace Atomic
 {
 
+static const unsigned DEFAULT_STATEMENT_CACHE_SIZE = 64;
+
 DbConnection::DbConnection(Context* context, const String& connectionString) :
     Object(context),
-    connectionString_(connectionString)
+    connectionString_(connectionString),
+    statementCacheSize_(DEFAULT_STATEMENT_CACHE_SIZE)
 {
     try
     {
@@ -67,16 +70,88 @@ DbConnection::~DbConnection()
 
 void DbConnection::Finalize()
 {
-    // TODO
+    // Statements may still be referenced by the caller, so finalize explicitly instead of relying on destruction
+    for (HashMap<String, SharedPtr<DbStatement> >::Iterator i = statements_.Begin(); i != statements_.End(); ++i)
+        i->second_->Finalize();
+    statements_.Clear();
+
+    for (Vector<WeakPtr<DbStatement> >::Iterator i = uncachedStatements_.Begin(); i != uncachedStatements_.End(); ++i)
+    {
+        if (!i->Expired())
+            (*i)->Finalize();
+    }
+    uncachedStatements_.Clear();
+}
+
+SharedPtr<DbStatement> DbConnection::Prepare(const String& sql)
+{
+    String trimmedSqlStr = sql.Trimmed();
+
+    HashMap<String, SharedPtr<DbStatement> >::Iterator i = statements_.Find(trimmedSqlStr);
+    // Only hand out a cached statement when nobody else holds it, as resetting it would disturb the other user
+    if (i != statements_.End() && i->second_.Refs() == 1)
+    {
+        i->second_->ClearBindings();
+        return i->second_;
+    }
+
+    SharedPtr<DbStatement> statement(new DbStatement(this, trimmedSqlStr));
+    if (!statement->IsValid())
+        return SharedPtr<DbStatement>();
+
+    if (i != statements_.End())
+    {
+        // Leave the statement out of the cache, but remember it so that Finalize() reaches it
+        for (unsigned j = 0; j < uncachedStatements_.Size();)
+        {
+            if (uncachedStatements_[j].Expired())
+                uncachedStatements_.Erase(j);
+            else
+                ++j;
+        }
+        uncachedStatements_.Push(WeakPtr<DbStatement>(statement));
+        return statement;
+    }
+
+    // Drop statements which are not held outside the cache when it grows too large
+    if (statements_.Size() >= statementCacheSize_)
+    {
+        for (HashMap<String, SharedPtr<DbStatement> >::Iterator j = statements_.Begin(); j != statements_.End();)
+        {
+            if (j->second_.Refs() == 1)
+                j = statements_.Erase(j);
+            else
+                ++j;
+        }
+    }
+
+    statements_[trimmedSqlStr] = statement;
+    return statement;
 }
 
 DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
+{
+    SharedPtr<DbStatement> statement = Prepare(sql);
+    if (!statement)
+    {
+        ATOMIC_LOGERROR("Could not execute: statement preparation failed");
+        return DbResult();
+    }
+
+    return Execute(statement, useCursorEvent);
+}
+
+DbResult DbConnection::Execute(DbStatement* statement, bool useCursorEvent)
 {
     DbResult result;
 
+    if (!statement || !statement->IsValid())
+        return result;
+
     try
     {
-        result.resultImpl_ = nanodbc::execute(connectionImpl_, sql.Trimmed().CString());
+        statement->ApplyBindings();
+        result.resultImpl_ = nanodbc::execute(statement->statementImpl_);
         unsigned numCols = (unsigned)result.resultImpl_.columns();
         if (numCols)
         {
@@ -126,7 +201,7 @@ DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
                     VariantMap& eventData = GetEventDataMap();
                     eventData[P_DBCONNECTION] = this;
                     eventData[P_RESULTIMPL] = &result.resultImpl_;
-                    eventData[P_SQL] = sql;
+                    eventData[P_SQL] = statement->GetSQL();
                     eventData[P_NUMCOLS] = numCols;
                     eventData[P_COLVALUES] = colValues;
                     eventData[P_COLHEADERS] = result.columns_;
@@ -155,6 +230,81 @@ DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
     return result;
 }
 
+bool DbConnection::ExecuteColumnar(const String& sql, DbColumnarResult& result)
+{
+    SharedPtr<DbStatement> statement = Prepare(sql);
+    if (!statement)
+    {
+        ATOMIC_LOGERROR("Could not execute: statement preparation failed");
+        result.Clear();
+        return false;
+    }
+
+    return ExecuteColumnar(statement, result);
+}
+
+bool DbConnection::ExecuteColumnar(DbStatement* statement, DbColumnarResult& result)
+{
+    result.Clear();
+    if (!statement || !statement->IsValid())
+        return false;
+
+    try
+    {
+        statement->ApplyBindings();
+        nanodbc::result resultImpl = nanodbc::execute(statement->statementImpl_);
+
+        unsigned numCols = (unsigned)resultImpl.columns();
+        StringVector columns(numCols);
+        for (unsigned i = 0; i < numCols; ++i)
+            columns[i] = resultImpl.column_name((short)i).c_str();
+        result.SetColumns(columns);
+
+        while (numCols && resultImpl.next())
+        {
+            result.BeginRow();
+            for (unsigned i = 0; i < numCols; ++i)
+            {
+                short column = (short)i;
+                if (resultImpl.is_null(column))
+                {
+                    result.AppendNull(i);
+                    continue;
+                }
+
+                switch (resultImpl.column_c_datatype(column))
+                {
+                case SQL_C_LONG:
+                case SQL_C_SBIGINT:
+                    result.AppendInteger(i, resultImpl.get<int64_t>(column));
+                    break;
+
+                case SQL_C_FLOAT:
+                case SQL_C_DOUBLE:
+                    result.AppendReal(i, resultImpl.get<double>(column));
+                    break;
+
+                default:
+                    {
+                        // All other types are stored using their string representation
+                        nanodbc::string_type text = resultImpl.get<nanodbc::string_type>(column);
+                        result.AppendText(i, text.c_str(), (unsigned)text.length());
+                    }
+                    break;
+                }
+            }
+        }
+
+        result.SetNumAffectedRows(numCols ? -1 : resultImpl.affected_rows());
+        return true;
+    }
+    catch (std::runtime_error& e)
+    {
+        HandleRuntimeError("Could not execute", e.what());
+        return false;
+    }
+}
+
 void DbConnection::HandleRuntimeError(const char* message, const char* cause)
 {
     StringVector tokens = (String(cause) + "::").Split(':');      // Added "::" as sentinels against unexpected cause format
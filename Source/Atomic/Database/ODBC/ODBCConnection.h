@@ -22,8 +22,11 @@
 
 #pragma once
 
+#include "../../Container/HashMap.h"
 #include "../../Core/Object.h"
+#include "../../Database/DbColumnarResult.h"
 #include "../../Database/DbResult.h"
+#include "../../Database/DbStatement.h"
 
 #include <nanodbc.h>
 
@@ -43,8 +46,23 @@ public:
     /// Finalize all prepared statements, close all BLOB handles, and finish all sqlite3_backup objects
     void Finalize();
 
+    /// Return a prepared statement for the SQL text with its parameters cleared. Statements are cached, so repeated calls with the same SQL do not parse it again. A cached statement still held by another caller is never handed out twice; a separate statement is prepared instead. Return null if failed.
+    SharedPtr<DbStatement> Prepare(const String& sql);
     /// Execute an SQL statements immediately. Send E_DBCURSOR event for each row in the resultset when useCursorEvent parameter is set to true.
     DbResult Execute(const String& sql, bool useCursorEvent = false);
+    /// Execute a prepared statement with its currently bound parameters. Send E_DBCURSOR event for each row in the resultset when useCursorEvent parameter is set to true.
+    DbResult Execute(DbStatement* statement, bool useCursorEvent = false);
+    /// Execute an SQL statement into a columnar result. Does not send cursor events, so it is safe to call outside the main thread. Return true if successful.
+    bool ExecuteColumnar(const String& sql, DbColumnarResult& result);
+    /// Execute a prepared statement into a columnar result. Does not send cursor events, so it is safe to call outside the main thread. Return true if successful.
+    bool ExecuteColumnar(DbStatement* statement, DbColumnarResult& result);
+
+    /// Set maximum number of cached prepared statements. Statements not held outside the cache are released when the limit is exceeded.
+    void SetStatementCacheSize(unsigned size) { statementCacheSize_ = size; }
+    /// Return maximum number of cached prepared statements.
+    unsigned GetStatementCacheSize() const { return statementCacheSize_; }
+    /// Return number of cached prepared statements.
+    unsigned GetNumCachedStatements() const { return statements_.Size(); }
 
     /// Return database connection string. The connection string for SQLite3 is using the URI format described in https://www.sqlite.org/uri.html, while the connection string for ODBC is using DSN format as per ODBC standard.
     const String& GetConnectionString() const { return connectionString_; }
@@ -63,6 +81,12 @@ private:
     String connectionString_;
     /// The underlying implementation connection object.
     nanodbc::connection connectionImpl_;
+    /// Prepared statements by SQL text.
+    HashMap<String, SharedPtr<DbStatement> > statements_;
+    /// Prepared statements outside the cache, which must still be finalized along with the connection.
+    Vector<WeakPtr<DbStatement> > uncachedStatements_;
+    /// Maximum number of cached prepared statements.
+    unsigned statementCacheSize_;
 };
 
 }
@@ -0,0 +1,151 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../../Precompiled.h"
+
+#include "../../Database/DbConnection.h"
+#include "../../IO/Log.h"
+
+#ifdef _WIN32
+// Needs to be included above sql.h for windows
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#include <sqlext.h>
+
+namespace Atomic
+{
+
+DbStatement::DbStatement(DbConnection* connection, const String& sql) :
+    connection_(connection),
+    sql_(sql),
+    valid_(false)
+{
+    try
+    {
+        statementImpl_.prepare(*const_cast<nanodbc::connection*>(connection->GetConnectionImpl()), sql_.CString());
+        valid_ = true;
+    }
+    catch (std::runtime_error& e)
+    {
+        ATOMIC_LOGERRORF("Could not prepare: %s", e.what());
+    }
+}
+
+DbStatement::~DbStatement()
+{
+    Finalize();
+}
+
+bool DbStatement::Bind(unsigned index, const Variant& value)
+{
+    if (!valid_)
+        return false;
+
+    if (index >= parameters_.Size())
+        parameters_.Resize(index + 1);
+    parameters_[index] = value;
+    return true;
+}
+
+bool DbStatement::BindNull(unsigned index)
+{
+    return Bind(index, Variant::EMPTY);
+}
+
+void DbStatement::ClearBindings()
+{
+    parameters_.Clear();
+    statementImpl_.reset_parameters();
+}
+
+unsigned DbStatement::GetNumParameters() const
+{
+    if (!valid_)
+        return 0;
+
+    SQLSMALLINT count = 0;
+    SQLNumParams((SQLHSTMT)statementImpl_.native_statement_handle(), &count);
+    return (unsigned)count;
+}
+
+void DbStatement::ApplyBindings()
+{
+    integers_.Resize(parameters_.Size());
+    reals_.Resize(parameters_.Size());
+
+    for (unsigned i = 0; i < parameters_.Size(); ++i)
+    {
+        short param = (short)i;
+        Variant& value = parameters_[i];
+
+        switch (value.GetType())
+        {
+        case VAR_NONE:
+            statementImpl_.bind_null(param);
+            break;
+
+        case VAR_INT:
+        case VAR_INT64:
+            integers_[i] = value.GetInt64();
+            statementImpl_.bind(param, (const int64_t*)&integers_[i]);
+            break;
+
+        case VAR_BOOL:
+            integers_[i] = value.GetBool() ? 1 : 0;
+            statementImpl_.bind(param, (const int64_t*)&integers_[i]);
+            break;
+
+        case VAR_FLOAT:
+        case VAR_DOUBLE:
+            reals_[i] = value.GetDouble();
+            statementImpl_.bind(param, &reals_[i]);
+            break;
+
+        default:
+            // All other types are bound using their string representation
+            if (value.GetType() != VAR_STRING)
+                value = value.ToString();
+            statementImpl_.bind(param, value.GetString().CString());
+            break;
+        }
+    }
+}
+
+void DbStatement::Finalize()
+{
+    if (valid_)
+    {
+        try
+        {
+            statementImpl_.close();
+        }
+        catch (std::runtime_error& e)
+        {
+            ATOMIC_LOGERRORF("Could not finalize: %s", e.what());
+        }
+        valid_ = false;
+    }
+}
+
+}
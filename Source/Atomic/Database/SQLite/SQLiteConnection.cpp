@@ -28,10 +28,13 @@
 namespace Atomic
 {
 
+static const unsigned DEFAULT_STATEMENT_CACHE_SIZE = 64;
+
 DbConnection::DbConnection(Context* context, const String& connectionString) :
     Object(context),
     connectionString_(connectionString),
-    connectionImpl_(0)
+    connectionImpl_(0),
+    statementCacheSize_(DEFAULT_STATEMENT_CACHE_SIZE)
 {
     if (sqlite3_open(connectionString.CString(), &connectionImpl_) != SQLITE_OK)
     {
@@ -55,33 +58,91 @@ DbConnection::~DbConnection()
 
 void DbConnection::Finalize()
 {
-    // TODO
+    // Statements may still be referenced by the caller, so finalize explicitly instead of relying on destruction
+    for (HashMap<String, SharedPtr<DbStatement> >::Iterator i = statements_.Begin(); i != statements_.End(); ++i)
+        i->second_->Finalize();
+    statements_.Clear();
+
+    for (Vector<WeakPtr<DbStatement> >::Iterator i = uncachedStatements_.Begin(); i != uncachedStatements_.End(); ++i)
+    {
+        if (!i->Expired())
+            (*i)->Finalize();
+    }
+    uncachedStatements_.Clear();
 }
 
-DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
+SharedPtr<DbStatement> DbConnection::Prepare(const String& sql)
 {
-    DbResult result;
-    const char* zLeftover = 0;
-    sqlite3_stmt* pStmt = 0;
     assert(connectionImpl_);
 
     // 2016-10-09: Prevent string corruption when trimmed is returned.
     String trimmedSqlStr = sql.Trimmed();
 
-    int rc = sqlite3_prepare_v2(connectionImpl_, trimmedSqlStr.CString(), -1, &pStmt, &zLeftover);
-    if (rc != SQLITE_OK)
+    HashMap<String, SharedPtr<DbStatement> >::Iterator i = statements_.Find(trimmedSqlStr);
+    // Only hand out a cached statement when nobody else holds it, as resetting it would disturb the other user
+    if (i != statements_.End() && i->second_.Refs() == 1)
     {
-        ATOMIC_LOGERRORF("Could not execute: %s", sqlite3_errmsg(connectionImpl_));
-        assert(!pStmt);
-        return result;
+        i->second_->Reset();
+        i->second_->ClearBindings();
+        return i->second_;
     }
-    if (*zLeftover)
+
+    SharedPtr<DbStatement> statement(new DbStatement(this, trimmedSqlStr));
+    if (!statement->IsValid())
+        return SharedPtr<DbStatement>();
+
+    if (i != statements_.End())
     {
-        ATOMIC_LOGERROR("Could not execute: only one SQL statement is allowed");
-        sqlite3_finalize(pStmt);
-        return result;
+        // Leave the statement out of the cache, but remember it so that Finalize() reaches it
+        for (unsigned j = 0; j < uncachedStatements_.Size();)
+        {
+            if (uncachedStatements_[j].Expired())
+                uncachedStatements_.Erase(j);
+            else
+                ++j;
+        }
+        uncachedStatements_.Push(WeakPtr<DbStatement>(statement));
+        return statement;
     }
 
+    // Drop statements which are not held outside the cache when it grows too large
+    if (statements_.Size() >= statementCacheSize_)
+    {
+        for (HashMap<String, SharedPtr<DbStatement> >::Iterator j = statements_.Begin(); j != statements_.End();)
+        {
+            if (j->second_.Refs() == 1)
+                j = statements_.Erase(j);
+            else
+                ++j;
+        }
+    }
+
+    statements_[trimmedSqlStr] = statement;
+    return statement;
+}
+
+DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
+{
+    SharedPtr<DbStatement> statement = Prepare(sql);
+    if (!statement)
+    {
+        ATOMIC_LOGERROR("Could not execute: statement preparation failed");
+        return DbResult();
+    }
+
+    return Execute(statement, useCursorEvent);
+}
+
+DbResult DbConnection::Execute(DbStatement* statement, bool useCursorEvent)
+{
+    DbResult result;
+    assert(connectionImpl_);
+
+    if (!statement || !statement->IsValid())
+        return result;
+
+    sqlite3_stmt* pStmt = statement->GetStatementImpl();
+
     unsigned numCols = (unsigned)sqlite3_column_count(pStmt);
     result.columns_.Resize(numCols);
     for (unsigned i = 0; i < numCols; ++i)
@@ -92,7 +153,7 @@ DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
 
     while (1)
     {
-        rc = sqlite3_step(pStmt);
+        int rc = sqlite3_step(pStmt);
         if (rc == SQLITE_ROW)
         {
             VariantVector colValues(numCols);
@@ -129,7 +190,7 @@ DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
                 VariantMap& eventData = GetEventDataMap();
                 eventData[P_DBCONNECTION] = this;
                 eventData[P_RESULTIMPL] = pStmt;
-                eventData[P_SQL] = sql;
+                eventData[P_SQL] = statement->GetSQL();
                 eventData[P_NUMCOLS] = numCols;
                 eventData[P_COLVALUES] = colValues;
                 eventData[P_COLHEADERS] = result.columns_;
@@ -145,22 +206,134 @@ DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
             if (!filtered)
                 result.rows_.Push(colValues);
             if (aborted)
-            {
-                sqlite3_finalize(pStmt);
                 break;
-            }
         }
-        else if (rc != SQLITE_DONE)
-            ATOMIC_LOGERRORF("Could not execute: %s", sqlite3_errmsg(connectionImpl_));
-        if (rc != SQLITE_ROW)
+        else
         {
-            sqlite3_finalize(pStmt);
+            if (rc != SQLITE_DONE)
+                ATOMIC_LOGERRORF("Could not execute: %s", sqlite3_errmsg(connectionImpl_));
             break;
         }
     }
 
+    // Reset instead of finalizing so that the prepared statement can be reused
+    statement->Reset();
+
     result.numAffectedRows_ = numCols ? -1 : sqlite3_changes(connectionImpl_);
     return result;
 }
 
+bool DbConnection::ExecuteColumnar(const String& sql, DbColumnarResult& result)
+{
+    SharedPtr<DbStatement> statement = Prepare(sql);
+    if (!statement)
+    {
+        ATOMIC_LOGERROR("Could not execute: statement preparation failed");
+        result.Clear();
+        return false;
+    }
+
+    return ExecuteColumnar(statement, result);
+}
+
+bool DbConnection::ExecuteColumnar(DbStatement* statement, DbColumnarResult& result)
+{
+    assert(connectionImpl_);
+
+    result.Clear();
+    if (!statement || !statement->IsValid())
+        return false;
+
+    sqlite3_stmt* pStmt = statement->GetStatementImpl();
+
+    unsigned numCols = (unsigned)sqlite3_column_count(pStmt);
+    StringVector columns(numCols);
+    for (unsigned i = 0; i < numCols; ++i)
+        columns[i] = sqlite3_column_name(pStmt, i);
+    result.SetColumns(columns);
+
+    bool success = true;
+
+    while (1)
+    {
+        int rc = sqlite3_step(pStmt);
+        if (rc == SQLITE_ROW)
+        {
+            result.BeginRow();
+            for (unsigned i = 0; i < numCols; ++i)
+            {
+                int type = sqlite3_column_type(pStmt, i);
+                if (type == SQLITE_NULL)
+                {
+                    result.AppendNull(i);
+                    continue;
+                }
+
+                // Once a column has its storage type, let SQLite convert mismatching values to it
+                DbColumnType colType = result.GetColumnType(i);
+                if (colType == DBCOLUMN_NULL)
+                {
+                    switch (type)
+                    {
+                    case SQLITE_INTEGER:
+                        colType = DBCOLUMN_INTEGER;
+                        break;
+
+                    case SQLITE_FLOAT:
+                        colType = DBCOLUMN_REAL;
+                        break;
+
+                    case SQLITE_BLOB:
+                        colType = DBCOLUMN_BLOB;
+                        break;
+
+                    default:
+                        colType = DBCOLUMN_TEXT;
+                        break;
+                    }
+                }
+
+                switch (colType)
+                {
+                case DBCOLUMN_INTEGER:
+                    result.AppendInteger(i, sqlite3_column_int64(pStmt, i));
+                    break;
+
+                case DBCOLUMN_REAL:
+                    result.AppendReal(i, sqlite3_column_double(pStmt, i));
+                    break;
+
+                case DBCOLUMN_BLOB:
+                    {
+                        const void* data = sqlite3_column_blob(pStmt, i);
+                        result.AppendBlob(i, data, (unsigned)sqlite3_column_bytes(pStmt, i));
+                    }
+                    break;
+
+                default:
+                    {
+                        const char* text = (const char*)sqlite3_column_text(pStmt, i);
+                        result.AppendText(i, text, (unsigned)sqlite3_column_bytes(pStmt, i));
+                    }
+                    break;
+                }
+            }
+        }
+        else
+        {
+            if (rc != SQLITE_DONE)
+            {
+                ATOMIC_LOGERRORF("Could not execute: %s", sqlite3_errmsg(connectionImpl_));
+                success = false;
+            }
+            break;
+        }
+    }
+
+    statement->Reset();
+
+    result.SetNumAffectedRows(numCols ? -1 : sqlite3_changes(connectionImpl_));
+    return success;
+}
+
 }
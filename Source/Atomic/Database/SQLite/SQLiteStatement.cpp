@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../../Precompiled.h"
+
+#include "../../Database/DbConnection.h"
+#include "../../IO/Log.h"
+
+namespace Atomic
+{
+
+DbStatement::DbStatement(DbConnection* connection, const String& sql) :
+    connection_(connection),
+    sql_(sql),
+    statementImpl_(0)
+{
+    sqlite3* connectionImpl = const_cast<sqlite3*>(connection->GetConnectionImpl());
+    assert(connectionImpl);
+
+    const char* zLeftover = 0;
+    if (sqlite3_prepare_v2(connectionImpl, sql_.CString(), -1, &statementImpl_, &zLeftover) != SQLITE_OK)
+    {
+        ATOMIC_LOGERRORF("Could not prepare: %s", sqlite3_errmsg(connectionImpl));
+        assert(!statementImpl_);
+        return;
+    }
+    if (*zLeftover)
+    {
+        ATOMIC_LOGERROR("Could not prepare: only one SQL statement is allowed");
+        Finalize();
+    }
+}
+
+DbStatement::~DbStatement()
+{
+    Finalize();
+}
+
+bool DbStatement::Bind(unsigned index, const Variant& value)
+{
+    if (!statementImpl_)
+        return false;
+
+    int param = (int)index + 1;
+    int rc;
+
+    switch (value.GetType())
+    {
+    case VAR_NONE:
+        rc = sqlite3_bind_null(statementImpl_, param);
+        break;
+
+    case VAR_INT:
+        rc = sqlite3_bind_int(statementImpl_, param, value.GetInt());
+        break;
+
+    case VAR_BOOL:
+        rc = sqlite3_bind_int(statementImpl_, param, value.GetBool() ? 1 : 0);
+        break;
+
+    case VAR_INT64:
+        rc = sqlite3_bind_int64(statementImpl_, param, value.GetInt64());
+        break;
+
+    case VAR_FLOAT:
+    case VAR_DOUBLE:
+        rc = sqlite3_bind_double(statementImpl_, param, value.GetDouble());
+        break;
+
+    case VAR_STRING:
+        {
+            const String& str = value.GetString();
+            rc = sqlite3_bind_text(statementImpl_, param, str.CString(), str.Length(), SQLITE_TRANSIENT);
+        }
+        break;
+
+    case VAR_BUFFER:
+        {
+            const PODVector<unsigned char>& buffer = value.GetBuffer();
+            rc = sqlite3_bind_blob(statementImpl_, param, buffer.Size() ? &buffer[0] : 0, buffer.Size(), SQLITE_TRANSIENT);
+        }
+        break;
+
+    default:
+        // All other types are bound using their string representation
+        {
+            String str = value.ToString();
+            rc = sqlite3_bind_text(statementImpl_, param, str.CString(), str.Length(), SQLITE_TRANSIENT);
+        }
+        break;
+    }
+
+    if (rc != SQLITE_OK)
+    {
+        ATOMIC_LOGERRORF("Could not bind parameter %d: %s", index, sqlite3_errstr(rc));
+        return false;
+    }
+
+    return true;
+}
+
+bool DbStatement::BindNull(unsigned index)
+{
+    return statementImpl_ && sqlite3_bind_null(statementImpl_, (int)index + 1) == SQLITE_OK;
+}
+
+void DbStatement::ClearBindings()
+{
+    if (statementImpl_)
+        sqlite3_clear_bindings(statementImpl_);
+}
+
+unsigned DbStatement::GetNumParameters() const
+{
+    return statementImpl_ ? (unsigned)sqlite3_bind_parameter_count(statementImpl_) : 0;
+}
+
+void DbStatement::Reset()
+{
+    if (statementImpl_)
+        sqlite3_reset(statementImpl_);
+}
+
+void DbStatement::Finalize()
+{
+    if (statementImpl_)
+    {
+        sqlite3_finalize(statementImpl_);
+        statementImpl_ = 0;
+    }
+}
+
+}
@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../../Container/RefCounted.h"
+#include "../../Core/Variant.h"
+
+#include <sqlite3.h>
+
+namespace Atomic
+{
+
+class DbConnection;
+
+/// Prepared SQL statement. Parsed once and cached by the owning connection, parameters are bound before each execution.
+class ATOMIC_API DbStatement : public RefCounted
+{
+    ATOMIC_REFCOUNTED(DbStatement)
+
+    friend class DbConnection;
+
+public:
+    /// Construct and prepare the statement. Check IsValid() for success.
+    DbStatement(DbConnection* connection, const String& sql);
+    /// Destruct. Finalize the statement.
+    virtual ~DbStatement();
+
+    /// Bind a parameter value. Parameter indices are 0-based. Return true if successful.
+    bool Bind(unsigned index, const Variant& value);
+    /// Bind null to a parameter. Return true if successful.
+    bool BindNull(unsigned index);
+    /// Reset all parameters to null.
+    void ClearBindings();
+
+    /// Return the SQL text of the statement.
+    const String& GetSQL() const { return sql_; }
+    /// Return number of parameters in the statement.
+    unsigned GetNumParameters() const;
+    /// Return whether the statement was prepared successfully.
+    bool IsValid() const { return statementImpl_ != 0; }
+
+    /// Return the underlying implementation statement object pointer.
+    sqlite3_stmt* GetStatementImpl() const { return statementImpl_; }
+
+private:
+    /// Reset the statement so that it can be executed again. Bindings are retained.
+    void Reset();
+    /// Finalize the statement. It can not be used anymore after this.
+    void Finalize();
+
+    /// Owning connection.
+    DbConnection* connection_;
+    /// SQL text.
+    String sql_;
+    /// The underlying implementation statement object.
+    sqlite3_stmt* statementImpl_;
+};
+
+}
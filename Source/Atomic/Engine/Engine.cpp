@@ -25,6 +25,7 @@
 #include "../Audio/Audio.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/FrameAllocator.h"
 // ATOMIC BEGIN
 #include "../Core/Profiler.h"
 #include "../Engine/EngineDefs.h"
@@ -149,9 +150,9 @@ Engine::Engine(Context* context) :
     // Create subsystems which do not depend on engine initialization or startup parameters
     context_->RegisterSubsystem(new Time(context_));
     context_->RegisterSubsystem(new WorkQueue(context_));
-#ifdef ATOMIC_PROFILING
+    context_->RegisterSubsystem(new FrameAllocator(context_));
+    // always registered for counters and histograms, block profiling depends on ATOMIC_PROFILING
     context_->RegisterSubsystem(new Profiler(context_));
-#endif
     context_->RegisterSubsystem(new FileSystem(context_));
 #ifdef ATOMIC_LOGGING
     context_->RegisterSubsystem(new Log(context_));
@@ -196,9 +197,7 @@ Engine::Engine(Context* context) :
     context_->engine_ = context_->GetSubsystem<Engine>();
     context_->time_ = context_->GetSubsystem<Time>();
     context_->workQueue_ = context_->GetSubsystem<WorkQueue>();
-#ifdef ATOMIC_PROFILING
     context_->profiler_ = context_->GetSubsystem<Profiler>();
-#endif
     context_->fileSystem_ = context_->GetSubsystem<FileSystem>();
 #ifdef ATOMIC_LOGGING
     context_->log_ = context_->GetSubsystem<Log>();
@@ -363,7 +362,7 @@ bool Engine::Initialize(const VariantMap& parameters)
         renderer->SetTextureFilterMode((TextureFilterMode)GetParameter(parameters, EP_TEXTURE_FILTER_MODE, FILTER_TRILINEAR).GetInt());
         renderer->SetTextureAnisotropy(GetParameter(parameters, EP_TEXTURE_ANISOTROPY, 4).GetInt());
 
-        if (GetParameter(parameters, EP_SOUND, true).GetBool())
+        if (GetParameter(parameters, EP_SOUND, true).GetBool() && !GetParameter(parameters, EP_SOUND_OFFLINE, false).GetBool())
         {
             GetSubsystem<Audio>()->SetMode(
                 GetParameter(parameters, EP_SOUND_BUFFER, 100).GetInt(),
@@ -374,6 +373,16 @@ bool Engine::Initialize(const VariantMap& parameters)
         }
     }
 
+    // Offline audio output needs no sound device, so it is also available in headless mode
+    if (GetParameter(parameters, EP_SOUND, true).GetBool() && GetParameter(parameters, EP_SOUND_OFFLINE, false).GetBool())
+    {
+        GetSubsystem<Audio>()->SetOfflineMode(
+            GetParameter(parameters, EP_SOUND_MIX_RATE, 44100).GetInt(),
+            GetParameter(parameters, EP_SOUND_STEREO, true).GetBool(),
+            GetParameter(parameters, EP_SOUND_INTERPOLATION, true).GetBool()
+        );
+    }
+
     // Init FPU state of main thread
     InitFPU();
 
@@ -743,11 +752,11 @@ void Engine::DumpResources(bool dumpFileName)
         return;
 
     ResourceCache* cache = GetSubsystem<ResourceCache>();
-    const HashMap<StringHash, ResourceGroup>& resourceGroups = cache->GetAllResources();
+    const FlatHashMap<StringHash, ResourceGroup>& resourceGroups = cache->GetAllResources();
     if (dumpFileName)
     {
         ATOMIC_LOGRAW("Used resources:\n");
-        for (HashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups.Begin(); i != resourceGroups.End(); ++i)
+        for (FlatHashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups.Begin(); i != resourceGroups.End(); ++i)
         {
             const HashMap<StringHash, SharedPtr<Resource> >& resources = i->second_.resources_;
             if (dumpFileName)
@@ -805,13 +814,17 @@ void Engine::DumpMemory()
 void Engine::Update()
 {
     ATOMIC_PROFILE(Update);
+    ATOMIC_PROFILE_HISTOGRAM(Update);
 
-    // Logic update event
+    // Logic update event. Sent with a typed payload, as it has the most receivers
     using namespace Update;
 
+    Payload payload;
+    payload.timeStep_ = timeStep_;
+    SendTypedEvent(E_UPDATE, payload);
+
     VariantMap& eventData = GetEventDataMap();
     eventData[P_TIMESTEP] = timeStep_;
-    SendEvent(E_UPDATE, eventData);
 
     // Logic post-update event
     SendEvent(E_POSTUPDATE, eventData);
@@ -835,6 +848,7 @@ void Engine::Render()
         return;
 
     ATOMIC_PROFILE(Render);
+    ATOMIC_PROFILE_HISTOGRAM(Render);
 
     // If device is lost, BeginFrame will fail and we skip rendering
     Graphics* graphics = GetSubsystem<Graphics>();
@@ -204,6 +204,8 @@ bool EngineConfig::LoadSoundConfig(const JSONValue& jsound)
             valueMap_["SoundBuffer"] = GetIntValue(jvalue, 100);
         else if (key == "mixrate")
             valueMap_["SoundMixRate"] = GetIntValue(jvalue, 44100);
+        else if (key == "offline")
+            valueMap_["SoundOffline"] = GetBoolValue(jvalue, false);
 
     }
 
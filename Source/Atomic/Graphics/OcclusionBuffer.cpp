@@ -28,6 +28,10 @@
 #include "../Graphics/OcclusionBuffer.h"
 #include "../IO/Log.h"
 
+#ifdef ATOMIC_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Atomic
@@ -47,6 +51,13 @@ void DrawOcclusionBatchWork(const WorkItem* item, unsigned threadIndex)
     buffer->DrawBatch(batch, threadIndex);
 }
 
+void DrawOcclusionBinWork(const WorkItem* item, unsigned threadIndex)
+{
+    OcclusionBuffer* buffer = reinterpret_cast<OcclusionBuffer*>(item->aux_);
+    const OcclusionBin& bin = *reinterpret_cast<OcclusionBin*>(item->start_);
+    buffer->DrawBin(bin);
+}
+
 OcclusionBuffer::OcclusionBuffer(Context* context) :
     Object(context),
     width_(0),
@@ -54,11 +65,13 @@ OcclusionBuffer::OcclusionBuffer(Context* context) :
     numTriangles_(0),
     maxTriangles_(OCCLUSION_DEFAULT_MAX_TRIANGLES),
     cullMode_(CULL_CCW),
+    threaded_(false),
     depthHierarchyDirty_(true),
     reverseCulling_(false),
     nearClip_(0.0f),
     farClip_(0.0f)
 {
+    buffer_.data_ = 0;
 }
 
 OcclusionBuffer::~OcclusionBuffer()
@@ -71,12 +84,23 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     if (height & 1)
         ++height;
 
-    if (width == width_ && height == height_)
-        return true;
-
     if (width <= 0 || height <= 0)
         return false;
 
+    threaded_ = threaded && GetSubsystem<WorkQueue>()->GetNumThreads() > 0;
+
+    // Triangles are queued per thread and then rasterized in horizontal bins, so a single buffer is enough
+    triangles_.Resize(threaded_ ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 0);
+    bins_.Resize(threaded_ ? (unsigned)((height + OCCLUSION_BIN_HEIGHT - 1) / OCCLUSION_BIN_HEIGHT) : 0);
+    for (unsigned i = 0; i < bins_.Size(); ++i)
+    {
+        bins_[i].minY_ = (int)i * OCCLUSION_BIN_HEIGHT;
+        bins_[i].maxY_ = Min((int)(i + 1) * OCCLUSION_BIN_HEIGHT, height);
+    }
+
+    if (width == width_ && height == height_)
+        return true;
+
     if (!IsPowerOfTwo((unsigned)width))
     {
         ATOMIC_LOGERRORF("Requested occlusion buffer width %d is not a power of two", width);
@@ -86,17 +110,9 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     width_ = width;
     height_ = height;
 
-    // Build work buffers for threading
-    unsigned numThreadBuffers = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 1;
-    buffers_.Resize(numThreadBuffers);
-    for (unsigned i = 0; i < numThreadBuffers; ++i)
-    {
-        // Reserve extra memory in case 3D clipping is not exact
-        OcclusionBufferData& buffer = buffers_[i];
-        buffer.dataWithSafety_ = new int[width * (height + 2) + 2];
-        buffer.data_ = buffer.dataWithSafety_.Get() + width + 1;
-        buffer.used_ = false;
-    }
+    // Reserve extra memory in case 3D clipping is not exact
+    buffer_.dataWithSafety_ = new int[width * (height + 2) + 2];
+    buffer_.data_ = buffer_.dataWithSafety_.Get() + width + 1;
 
     mipBuffers_.Clear();
 
@@ -113,7 +129,7 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     }
 
     ATOMIC_LOGDEBUG("Set occlusion buffer size " + String(width_) + "x" + String(height_) + " with " +
-             String(mipBuffers_.Size()) + " mip levels and " + String(numThreadBuffers) + " thread buffers");
+             String(mipBuffers_.Size()) + " mip levels and " + String(bins_.Size()) + " thread bins");
 
     CalculateViewport();
     return true;
@@ -160,10 +176,7 @@ void OcclusionBuffer::Clear()
 {
     Reset();
 
-    // Only clear the main thread buffer. Rest are cleared on-demand when drawing the first batch
-    ClearBuffer(0);
-    for (unsigned i = 1; i < buffers_.Size(); ++i)
-        buffers_[i].used_ = false;
+    ClearBuffer();
 
     depthHierarchyDirty_ = true;
 }
@@ -206,17 +219,22 @@ bool OcclusionBuffer::AddTriangles(const Matrix3x4& model, const void* vertexDat
 
 void OcclusionBuffer::DrawTriangles()
 {
-    if (buffers_.Size() == 1)
+    if (!buffer_.data_)
+    {
+        batches_.Clear();
+        return;
+    }
+
+    if (!threaded_)
     {
-        // Not threaded
         for (Vector<OcclusionBatch>::Iterator i = batches_.Begin(); i != batches_.End(); ++i)
             DrawBatch(*i, 0);
 
         depthHierarchyDirty_ = true;
     }
-    else if (buffers_.Size() > 1)
+    else
     {
-        // Threaded
+        // Threaded: first transform, clip and project the batches into per-thread triangle lists
         WorkQueue* queue = GetSubsystem<WorkQueue>();
 
         for (Vector<OcclusionBatch>::Iterator i = batches_.Begin(); i != batches_.End(); ++i)
@@ -231,7 +249,8 @@ void OcclusionBuffer::DrawTriangles()
 
         queue->Complete(M_MAX_UNSIGNED);
 
-        MergeBuffers();
+        // Then rasterize the triangles in horizontal bins, each owned by one worker
+        DrawBins();
         depthHierarchyDirty_ = true;
     }
 
@@ -240,7 +259,7 @@ void OcclusionBuffer::DrawTriangles()
 
 void OcclusionBuffer::BuildDepthHierarchy()
 {
-    if (buffers_.Empty() || !depthHierarchyDirty_)
+    if (!buffer_.data_ || !depthHierarchyDirty_)
         return;
 
     ATOMIC_PROFILE(BuildDepthHierarchy);
@@ -252,7 +271,7 @@ void OcclusionBuffer::BuildDepthHierarchy()
     {
         for (int y = 0; y < height; ++y)
         {
-            int* src = buffers_[0].data_ + (y * 2) * width_;
+            int* src = buffer_.data_ + (y * 2) * width_;
             DepthValue* dest = mipBuffers_[0].Get() + y * width;
             DepthValue* end = dest + width;
 
@@ -342,9 +361,104 @@ void OcclusionBuffer::ResetUseTimer()
 
 bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
 {
-    if (buffers_.Empty())
+    if (!buffer_.data_)
         return true;
 
+    IntRect rect;
+    int z;
+    if (!ProjectBox(worldSpaceBox, rect, z))
+        return true;
+
+    return IsVisible(rect, z);
+}
+
+void OcclusionBuffer::IsVisible(const BoundingBox* worldSpaceBoxes, unsigned count, bool* results) const
+{
+    if (!buffer_.data_)
+    {
+        for (unsigned i = 0; i < count; ++i)
+            results[i] = true;
+        return;
+    }
+
+    // Each box is projected and then tested against the depth hierarchy before moving on to the next box
+    IntRect rect;
+    int z;
+    for (unsigned i = 0; i < count; ++i)
+        results[i] = !ProjectBox(worldSpaceBoxes[i], rect, z) || IsVisible(rect, z);
+}
+
+#ifdef ATOMIC_SSE
+static inline float HorizontalMin(__m128 value)
+{
+    value = _mm_min_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)));
+    value = _mm_min_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(value);
+}
+
+static inline float HorizontalMax(__m128 value)
+{
+    value = _mm_max_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)));
+    value = _mm_max_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(value);
+}
+#endif
+
+bool OcclusionBuffer::ProjectBox(const BoundingBox& worldSpaceBox, IntRect& rect, int& z) const
+{
+    float minX, maxX, minY, maxY, minZ;
+
+#ifdef ATOMIC_SSE
+    // Transform the corners as two groups of four, the near (min Z) and far (max Z) faces, in structure-of-arrays form
+    const Matrix4& m = viewProj_;
+    __m128 x = _mm_set_ps(worldSpaceBox.max_.x_, worldSpaceBox.min_.x_, worldSpaceBox.max_.x_, worldSpaceBox.min_.x_);
+    __m128 y = _mm_set_ps(worldSpaceBox.max_.y_, worldSpaceBox.max_.y_, worldSpaceBox.min_.y_, worldSpaceBox.min_.y_);
+    __m128 xyX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m.m00_)), _mm_mul_ps(y, _mm_set1_ps(m.m01_))), _mm_set1_ps(m.m03_));
+    __m128 xyY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m.m10_)), _mm_mul_ps(y, _mm_set1_ps(m.m11_))), _mm_set1_ps(m.m13_));
+    __m128 xyZ = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m.m20_)), _mm_mul_ps(y, _mm_set1_ps(m.m21_))), _mm_set1_ps(m.m23_));
+    __m128 xyW = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m.m30_)), _mm_mul_ps(y, _mm_set1_ps(m.m31_))), _mm_set1_ps(m.m33_));
+
+    __m128 minXs, maxXs, minYs, maxYs, minZs;
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        __m128 boxZ = _mm_set1_ps(i ? worldSpaceBox.max_.z_ : worldSpaceBox.min_.z_);
+        __m128 clipX = _mm_add_ps(xyX, _mm_mul_ps(boxZ, _mm_set1_ps(m.m02_)));
+        __m128 clipY = _mm_add_ps(xyY, _mm_mul_ps(boxZ, _mm_set1_ps(m.m12_)));
+        // Apply a far clip relative bias
+        __m128 clipZ = _mm_sub_ps(_mm_add_ps(xyZ, _mm_mul_ps(boxZ, _mm_set1_ps(m.m22_))), _mm_set1_ps(OCCLUSION_RELATIVE_BIAS));
+        __m128 clipW = _mm_add_ps(xyW, _mm_mul_ps(boxZ, _mm_set1_ps(m.m32_)));
+
+        // If any of the corners cross the near plane, assume visible
+        if (_mm_movemask_ps(_mm_cmple_ps(clipZ, _mm_setzero_ps())))
+            return false;
+
+        __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), clipW);
+        __m128 projX = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(invW, clipX), _mm_set1_ps(scaleX_)), _mm_set1_ps(offsetX_));
+        __m128 projY = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(invW, clipY), _mm_set1_ps(scaleY_)), _mm_set1_ps(offsetY_));
+        __m128 projZ = _mm_mul_ps(_mm_mul_ps(invW, clipZ), _mm_set1_ps(OCCLUSION_Z_SCALE));
+
+        if (!i)
+        {
+            minXs = maxXs = projX;
+            minYs = maxYs = projY;
+            minZs = projZ;
+        }
+        else
+        {
+            minXs = _mm_min_ps(minXs, projX);
+            maxXs = _mm_max_ps(maxXs, projX);
+            minYs = _mm_min_ps(minYs, projY);
+            maxYs = _mm_max_ps(maxYs, projY);
+            minZs = _mm_min_ps(minZs, projZ);
+        }
+    }
+
+    minX = HorizontalMin(minXs);
+    maxX = HorizontalMax(maxXs);
+    minY = HorizontalMin(minYs);
+    maxY = HorizontalMax(maxYs);
+    minZ = HorizontalMin(minZs);
+#else
     // Transform corners to projection space
     Vector4 vertices[8];
     vertices[0] = ModelTransform(viewProj_, worldSpaceBox.min_);
@@ -361,10 +475,8 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
         vertices[i].z_ -= OCCLUSION_RELATIVE_BIAS;
 
     // Transform to screen space. If any of the corners cross the near plane, assume visible
-    float minX, maxX, minY, maxY, minZ;
-
     if (vertices[0].z_ <= 0.0f)
-        return true;
+        return false;
 
     Vector3 projected = ViewportTransform(vertices[0]);
     minX = maxX = projected.x_;
@@ -375,7 +487,7 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
     for (unsigned i = 1; i < 8; ++i)
     {
         if (vertices[i].z_ <= 0.0f)
-            return true;
+            return false;
 
         projected = ViewportTransform(vertices[i]);
 
@@ -385,18 +497,19 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
         if (projected.y_ > maxY) maxY = projected.y_;
         if (projected.z_ < minZ) minZ = projected.z_;
     }
+#endif
 
     // Expand the bounding box 1 pixel in each direction to be conservative and correct rasterization offset
-    IntRect rect(
+    rect = IntRect(
         (int)(minX - 1.5f), (int)(minY - 1.5f),
         (int)(maxX + 0.5f), (int)(maxY + 0.5f)
     );
 
     // If the rect is outside, let frustum culling handle
     if (rect.right_ < 0 || rect.bottom_ < 0)
-        return true;
+        return false;
     if (rect.left_ >= width_ || rect.top_ >= height_)
-        return true;
+        return false;
 
     // Clipping of rect
     if (rect.left_ < 0)
@@ -409,8 +522,12 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
         rect.bottom_ = height_ - 1;
 
     // Convert depth to integer and apply final bias
-    int z = (int)(minZ + 0.5f) - OCCLUSION_FIXED_BIAS;
+    z = (int)(minZ + 0.5f) - OCCLUSION_FIXED_BIAS;
+    return true;
+}
 
+bool OcclusionBuffer::IsVisible(const IntRect& rect, int z) const
+{
     if (!depthHierarchyDirty_)
     {
         // Start from lowest mip level and check if a conclusive result can be found
@@ -447,12 +564,22 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
     }
 
     // If no conclusive result, finally check the pixel-level data
-    int* row = buffers_[0].data_ + rect.top_ * width_;
-    int* endRow = buffers_[0].data_ + rect.bottom_ * width_;
+    int* row = buffer_.data_ + rect.top_ * width_;
+    int* endRow = buffer_.data_ + rect.bottom_ * width_;
     while (row <= endRow)
     {
         int* src = row + rect.left_;
         int* end = row + rect.right_;
+#ifdef ATOMIC_SSE
+        // Four pixels at a time: visible if any stored depth is at or behind the box
+        __m128i boxZ = _mm_set1_epi32(z - 1);
+        while (end - src >= 3)
+        {
+            if (_mm_movemask_epi8(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)src), boxZ)))
+                return true;
+            src += 4;
+        }
+#endif
         while (src <= end)
         {
             if (z <= *src)
@@ -473,13 +600,6 @@ unsigned OcclusionBuffer::GetUseTimer()
 
 void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadIndex)
 {
-    // If buffer not yet used, clear it
-    if (threadIndex > 0 && !buffers_[threadIndex].used_)
-    {
-        ClearBuffer(threadIndex);
-        buffers_[threadIndex].used_ = true;
-    }
-
     Matrix4 modelViewProj = viewProj_ * batch.model_;
 
     // Theoretical max. amount of vertices if each of the 6 clipping planes doubles the triangle count
@@ -643,7 +763,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
         bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
         if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
         {
-            DrawTriangle2D(projected, clockwise, threadIndex);
+            SubmitTriangle2D(projected, clockwise, threadIndex);
             drawOk = true;
         }
     }
@@ -681,7 +801,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
                 bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
                 if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
                 {
-                    DrawTriangle2D(projected, clockwise, threadIndex);
+                    SubmitTriangle2D(projected, clockwise, threadIndex);
                     drawOk = true;
                 }
             }
@@ -822,7 +942,155 @@ struct Edge
     int invZStep_;
 };
 
-void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
+void OcclusionBuffer::SubmitTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
+{
+    if (!threaded_)
+    {
+        DrawTriangle2D(vertices, clockwise, 0, height_);
+        return;
+    }
+
+    triangles_[threadIndex].Resize(triangles_[threadIndex].Size() + 1);
+    OcclusionTriangle& triangle = triangles_[threadIndex].Back();
+    triangle.vertices_[0] = vertices[0];
+    triangle.vertices_[1] = vertices[1];
+    triangle.vertices_[2] = vertices[2];
+    triangle.clockwise_ = clockwise;
+    triangle.topY_ = (int)Min(Min(vertices[0].y_, vertices[1].y_), vertices[2].y_);
+    triangle.bottomY_ = (int)Max(Max(vertices[0].y_, vertices[1].y_), vertices[2].y_);
+}
+
+void OcclusionBuffer::DrawBins()
+{
+    {
+        ATOMIC_PROFILE(BinOcclusionTriangles);
+
+        for (unsigned i = 0; i < bins_.Size(); ++i)
+            bins_[i].triangles_.Clear();
+
+        int numBins = (int)bins_.Size();
+        for (unsigned i = 0; i < triangles_.Size(); ++i)
+        {
+            const PODVector<OcclusionTriangle>& triangles = triangles_[i];
+            for (PODVector<OcclusionTriangle>::ConstIterator j = triangles.Begin(); j != triangles.End(); ++j)
+            {
+                if (j->bottomY_ <= 0 || j->topY_ >= height_ || j->topY_ == j->bottomY_)
+                    continue;
+
+                int firstBin = Max(j->topY_, 0) / OCCLUSION_BIN_HEIGHT;
+                int lastBin = Min((Min(j->bottomY_, height_) - 1) / OCCLUSION_BIN_HEIGHT, numBins - 1);
+                for (int k = firstBin; k <= lastBin; ++k)
+                    bins_[k].triangles_.Push(&(*j));
+            }
+        }
+    }
+
+    // The bins cover disjoint pixel rows, so workers can write to the shared buffer without merging
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+
+    for (unsigned i = 0; i < bins_.Size(); ++i)
+    {
+        if (bins_[i].triangles_.Empty())
+            continue;
+
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = DrawOcclusionBinWork;
+        item->aux_ = this;
+        item->start_ = &bins_[i];
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+
+    for (unsigned i = 0; i < triangles_.Size(); ++i)
+        triangles_[i].Clear();
+}
+
+void OcclusionBuffer::DrawBin(const OcclusionBin& bin)
+{
+    for (PODVector<const OcclusionTriangle*>::ConstIterator i = bin.triangles_.Begin(); i != bin.triangles_.End(); ++i)
+        DrawTriangle2D((*i)->vertices_, (*i)->clockwise_, bin.minY_, bin.maxY_);
+}
+
+/// Step an edge down a number of pixel rows.
+static inline void StepEdge(Edge& edge, int rows)
+{
+    edge.x_ += edge.xStep_ * rows;
+    edge.invZ_ += edge.invZStep_ * rows;
+}
+
+/// Write the closer of the interpolated and stored depth along a pixel span, clipped to the buffer row.
+static inline void DrawSpan(int* row, int width, int left, int right, int invZ, int dInvZdX)
+{
+    if (left < 0)
+    {
+        invZ -= left * dInvZdX;
+        left = 0;
+    }
+    if (right > width)
+        right = width;
+
+    int* dest = row + left;
+    int* end = row + right;
+
+#ifdef ATOMIC_SSE
+    if (end - dest >= 4)
+    {
+        __m128i z = _mm_set_epi32(invZ + 3 * dInvZdX, invZ + 2 * dInvZdX, invZ + dInvZdX, invZ);
+        __m128i zStep = _mm_set1_epi32(4 * dInvZdX);
+        while (end - dest >= 4)
+        {
+            __m128i stored = _mm_loadu_si128((const __m128i*)dest);
+            __m128i closer = _mm_cmplt_epi32(z, stored);
+            _mm_storeu_si128((__m128i*)dest, _mm_or_si128(_mm_and_si128(closer, z), _mm_andnot_si128(closer, stored)));
+            z = _mm_add_epi32(z, zStep);
+            invZ += 4 * dInvZdX;
+            dest += 4;
+        }
+    }
+#endif
+
+    while (dest < end)
+    {
+        if (invZ < *dest)
+            *dest = invZ;
+        invZ += dInvZdX;
+        ++dest;
+    }
+}
+
+/// Draw the rows between startY and endY (exclusive) of a triangle half, limited to rows between minY and maxY (exclusive).
+static inline void DrawTriangleHalf(int* buffer, int width, int startY, int endY, int minY, int maxY, Edge& left, Edge& right,
+    int dInvZdX)
+{
+    // Skip the rows above the drawn range in one step
+    int y = startY;
+    int skip = Min(Max(minY, startY), endY) - startY;
+    StepEdge(left, skip);
+    StepEdge(right, skip);
+    y += skip;
+
+    int drawEndY = Max(Min(endY, maxY), y);
+    int* row = buffer + y * width;
+    for (; y < drawEndY; ++y)
+    {
+        DrawSpan(row, width, left.x_ >> 16, right.x_ >> 16, left.invZ_, dInvZdX);
+
+        left.x_ += left.xStep_;
+        left.invZ_ += left.invZStep_;
+        right.x_ += right.xStep_;
+        right.invZ_ += right.invZStep_;
+        row += width;
+    }
+
+    // The long edge continues into the second half, so step it past the rest
+    skip = endY - y;
+    StepEdge(left, skip);
+    StepEdge(right, skip);
+}
+
+void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, int minY, int maxY)
 {
     int top, middle, bottom;
     bool middleIsRight;
@@ -898,132 +1166,26 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     Edge topToBottom(gradients, vertices[top], vertices[bottom], topY);
     Edge middleToBottom(gradients, vertices[middle], vertices[bottom], middleY);
 
-    int* bufferData = buffers_[threadIndex].data_;
+    int* bufferData = buffer_.data_;
 
     if (middleIsRight)
     {
-        // Top half
-        int* row = bufferData + topY * width_;
-        int* endRow = bufferData + middleY * width_;
-        while (row < endRow)
-        {
-            int invZ = topToBottom.invZ_;
-            int* dest = row + (topToBottom.x_ >> 16);
-            int* end = row + (topToMiddle.x_ >> 16);
-            while (dest < end)
-            {
-                if (invZ < *dest)
-                    *dest = invZ;
-                invZ += gradients.dInvZdXInt_;
-                ++dest;
-            }
-
-            topToBottom.x_ += topToBottom.xStep_;
-            topToBottom.invZ_ += topToBottom.invZStep_;
-            topToMiddle.x_ += topToMiddle.xStep_;
-            row += width_;
-        }
-
-        // Bottom half
-        row = bufferData + middleY * width_;
-        endRow = bufferData + bottomY * width_;
-        while (row < endRow)
-        {
-            int invZ = topToBottom.invZ_;
-            int* dest = row + (topToBottom.x_ >> 16);
-            int* end = row + (middleToBottom.x_ >> 16);
-            while (dest < end)
-            {
-                if (invZ < *dest)
-                    *dest = invZ;
-                invZ += gradients.dInvZdXInt_;
-                ++dest;
-            }
-
-            topToBottom.x_ += topToBottom.xStep_;
-            topToBottom.invZ_ += topToBottom.invZStep_;
-            middleToBottom.x_ += middleToBottom.xStep_;
-            row += width_;
-        }
+        DrawTriangleHalf(bufferData, width_, topY, middleY, minY, maxY, topToBottom, topToMiddle, gradients.dInvZdXInt_);
+        DrawTriangleHalf(bufferData, width_, middleY, bottomY, minY, maxY, topToBottom, middleToBottom, gradients.dInvZdXInt_);
     }
     else
     {
-        // Top half
-        int* row = bufferData + topY * width_;
-        int* endRow = bufferData + middleY * width_;
-        while (row < endRow)
-        {
-            int invZ = topToMiddle.invZ_;
-            int* dest = row + (topToMiddle.x_ >> 16);
-            int* end = row + (topToBottom.x_ >> 16);
-            while (dest < end)
-            {
-                if (invZ < *dest)
-                    *dest = invZ;
-                invZ += gradients.dInvZdXInt_;
-                ++dest;
-            }
-
-            topToMiddle.x_ += topToMiddle.xStep_;
-            topToMiddle.invZ_ += topToMiddle.invZStep_;
-            topToBottom.x_ += topToBottom.xStep_;
-            row += width_;
-        }
-
-        // Bottom half
-        row = bufferData + middleY * width_;
-        endRow = bufferData + bottomY * width_;
-        while (row < endRow)
-        {
-            int invZ = middleToBottom.invZ_;
-            int* dest = row + (middleToBottom.x_ >> 16);
-            int* end = row + (topToBottom.x_ >> 16);
-            while (dest < end)
-            {
-                if (invZ < *dest)
-                    *dest = invZ;
-                invZ += gradients.dInvZdXInt_;
-                ++dest;
-            }
-
-            middleToBottom.x_ += middleToBottom.xStep_;
-            middleToBottom.invZ_ += middleToBottom.invZStep_;
-            topToBottom.x_ += topToBottom.xStep_;
-            row += width_;
-        }
-    }
-}
-
-void OcclusionBuffer::MergeBuffers()
-{
-    ATOMIC_PROFILE(MergeBuffers);
-
-    for (unsigned i = 1; i < buffers_.Size(); ++i)
-    {
-        if (!buffers_[i].used_)
-            continue;
-
-        int* src = buffers_[i].data_;
-        int* dest = buffers_[0].data_;
-        int count = width_ * height_;
-
-        while (count--)
-        {
-            // If thread buffer's depth value is closer, overwrite the original
-            if (*src < *dest)
-                *dest = *src;
-            ++src;
-            ++dest;
-        }
+        DrawTriangleHalf(bufferData, width_, topY, middleY, minY, maxY, topToMiddle, topToBottom, gradients.dInvZdXInt_);
+        DrawTriangleHalf(bufferData, width_, middleY, bottomY, minY, maxY, middleToBottom, topToBottom, gradients.dInvZdXInt_);
     }
 }
 
-void OcclusionBuffer::ClearBuffer(unsigned threadIndex)
+void OcclusionBuffer::ClearBuffer()
 {
-    if (threadIndex >= buffers_.Size())
+    if (!buffer_.data_)
         return;
 
-    int* dest = buffers_[threadIndex].data_;
+    int* dest = buffer_.data_;
     int count = width_ * height_;
     int fillValue = (int)OCCLUSION_Z_SCALE;
 
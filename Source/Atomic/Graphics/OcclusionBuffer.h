@@ -48,15 +48,13 @@ struct DepthValue
     int max_;
 };
 
-/// Per-thread occlusion buffer data.
+/// Occlusion buffer data.
 struct OcclusionBufferData
 {
     /// Full buffer data with safety padding.
     SharedArrayPtr<int> dataWithSafety_;
     /// Buffer data.
     int* data_;
-    /// Use flag.
-    bool used_;
 };
 
 /// Stored occlusion render job.
@@ -78,12 +76,37 @@ struct OcclusionBatch
     unsigned drawCount_;
 };
 
+/// Clipped and projected occluder triangle waiting to be rasterized.
+struct OcclusionTriangle
+{
+    /// Screen space vertices.
+    Vector3 vertices_[3];
+    /// Clockwise flag.
+    bool clockwise_;
+    /// First pixel row.
+    int topY_;
+    /// Last pixel row, exclusive.
+    int bottomY_;
+};
+
+/// Horizontal band of the occlusion buffer with the triangles overlapping it.
+struct OcclusionBin
+{
+    /// First pixel row.
+    int minY_;
+    /// Last pixel row, exclusive.
+    int maxY_;
+    /// Overlapping triangles.
+    PODVector<const OcclusionTriangle*> triangles_;
+};
+
 static const int OCCLUSION_MIN_SIZE = 8;
 static const int OCCLUSION_DEFAULT_MAX_TRIANGLES = 5000;
 static const float OCCLUSION_RELATIVE_BIAS = 0.00001f;
 static const int OCCLUSION_FIXED_BIAS = 16;
 static const float OCCLUSION_X_SCALE = 65536.0f;
 static const float OCCLUSION_Z_SCALE = 16777216.0f;
+static const int OCCLUSION_BIN_HEIGHT = 16;
 
 /// Software renderer for occlusion.
 class ATOMIC_API OcclusionBuffer : public Object
@@ -96,7 +119,7 @@ public:
     /// Destruct.
     virtual ~OcclusionBuffer();
 
-    /// Set occlusion buffer size and whether to reserve multiple buffers for threading optimization.
+    /// Set occlusion buffer size and whether to rasterize in horizontal bands on worker threads.
     bool SetSize(int width, int height, bool threaded);
     /// Set camera view to render from.
     void SetView(Camera* camera);
@@ -121,7 +144,7 @@ public:
     void ResetUseTimer();
 
     /// Return highest level depth values.
-    int* GetBuffer() const { return buffers_.Size() ? buffers_[0].data_ : (int*)0; }
+    int* GetBuffer() const { return buffer_.data_; }
 
     /// Return view transform matrix.
     const Matrix3x4& GetView() const { return view_; }
@@ -145,15 +168,19 @@ public:
     CullMode GetCullMode() const { return cullMode_; }
 
     /// Return whether is using threads to speed up rendering.
-    bool IsThreaded() const { return buffers_.Size() > 1; }
+    bool IsThreaded() const { return threaded_; }
 
     /// Test a bounding box for visibility. For best performance, build depth hierarchy first.
     bool IsVisible(const BoundingBox& worldSpaceBox) const;
+    /// Test an array of bounding boxes for visibility and write one result per box.
+    void IsVisible(const BoundingBox* worldSpaceBoxes, unsigned count, bool* results) const;
     /// Return time since last use in milliseconds.
     unsigned GetUseTimer();
 
     /// Draw a batch. Called internally.
     void DrawBatch(const OcclusionBatch& batch, unsigned threadIndex);
+    /// Rasterize the triangles of a bin. Called internally.
+    void DrawBin(const OcclusionBin& bin);
 
 private:
     /// Apply modelview transform to vertex.
@@ -170,15 +197,25 @@ private:
     void DrawTriangle(Vector4* vertices, unsigned threadIndex);
     /// Clip vertices against a plane.
     void ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles);
-    /// Draw a clipped triangle.
-    void DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
-    /// Clear a thread work buffer.
-    void ClearBuffer(unsigned threadIndex);
-    /// Merge thread work buffers into the first buffer.
-    void MergeBuffers();
-
-    /// Highest-level buffer data per thread.
-    Vector<OcclusionBufferData> buffers_;
+    /// Rasterize a clipped triangle directly, or queue it for binning when threaded.
+    void SubmitTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
+    /// Draw the pixel rows of a clipped triangle that fall between minY and maxY (exclusive).
+    void DrawTriangle2D(const Vector3* vertices, bool clockwise, int minY, int maxY);
+    /// Sort queued triangles into bins and rasterize the bins on worker threads.
+    void DrawBins();
+    /// Clear the buffer.
+    void ClearBuffer();
+    /// Project a bounding box to a conservative screen rectangle and nearest depth. Return false if the box must be assumed visible.
+    bool ProjectBox(const BoundingBox& worldSpaceBox, IntRect& rect, int& z) const;
+    /// Test a screen rectangle at a depth against the depth hierarchy and pixel data.
+    bool IsVisible(const IntRect& rect, int z) const;
+
+    /// Highest-level buffer data.
+    OcclusionBufferData buffer_;
+    /// Queued triangles per thread in threaded mode.
+    Vector<PODVector<OcclusionTriangle> > triangles_;
+    /// Horizontal bins in threaded mode.
+    Vector<OcclusionBin> bins_;
     /// Reduced size depth buffers.
     Vector<SharedArrayPtr<DepthValue> > mipBuffers_;
     /// Submitted render jobs.
@@ -193,6 +230,8 @@ private:
     unsigned maxTriangles_;
     /// Culling mode.
     CullMode cullMode_;
+    /// Threaded rasterization flag.
+    bool threaded_;
     /// Depth hierarchy needs update flag.
     bool depthHierarchyDirty_;
     /// Culling reverse flag.
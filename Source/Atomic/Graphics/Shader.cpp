@@ -29,6 +29,9 @@
 #include "../IO/Deserializer.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#ifdef ATOMIC_THREADING
+#include "../Resource/BackgroundLoader.h"
+#endif
 #include "../Resource/ResourceCache.h"
 
 #include "../DebugNew.h"
@@ -172,6 +175,13 @@ bool Shader::ProcessSource(String& code, Deserializer& source)
             timeStamp_ = fileTimeStamp;
     }
 
+#ifdef ATOMIC_THREADING
+    // When background loaded, the source is a buffer carrying the timestamp read by the I/O stage
+    BackgroundLoadBuffer* buffer = dynamic_cast<BackgroundLoadBuffer*>(&source);
+    if (buffer && buffer->GetLastModifiedTime() > timeStamp_)
+        timeStamp_ = buffer->GetLastModifiedTime();
+#endif
+
     // Store resource dependencies for includes so that we know to reload if any of them changes
     if (source.GetName() != GetName())
         cache->StoreResourceDependency(this, source.GetName());
@@ -55,6 +55,9 @@
 namespace Atomic
 {
 
+/// Maximum number of occludees tested against the occlusion buffer in one batch.
+static const int OCCLUSION_TEST_GROUP_SIZE = 64;
+
 static const Vector3* directions[] =
 {
     &Vector3::RIGHT,
@@ -179,58 +182,79 @@ void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
     unsigned cameraViewMask = view->cullCamera_->GetViewMask();
     bool cameraZoneOverride = view->cameraZoneOverride_;
     PerThreadSceneResult& result = view->sceneResults_[threadIndex];
+    BoundingBox occludeeBoxes[OCCLUSION_TEST_GROUP_SIZE];
+    bool occludeeVisible[OCCLUSION_TEST_GROUP_SIZE];
 
     while (start != end)
     {
-        Drawable* drawable = *start++;
+        Drawable** groupEnd = start + Min((int)(end - start), OCCLUSION_TEST_GROUP_SIZE);
 
-        if (!buffer || !drawable->IsOccludee() || buffer->IsVisible(drawable->GetWorldBoundingBox()))
+        // Test the occludees of a group of drawables against the occlusion buffer in one batch
+        unsigned numOccludees = 0;
+        if (buffer)
         {
-            drawable->UpdateBatches(view->frame_);
-            // If draw distance non-zero, update and check it
-            float maxDistance = drawable->GetDrawDistance();
-            if (maxDistance > 0.0f)
+            for (Drawable** i = start; i != groupEnd; ++i)
             {
-                if (drawable->GetDistance() > maxDistance)
-                    continue;
+                if ((*i)->IsOccludee())
+                    occludeeBoxes[numOccludees++] = (*i)->GetWorldBoundingBox();
             }
 
-            drawable->MarkInView(view->frame_);
+            buffer->IsVisible(occludeeBoxes, numOccludees, occludeeVisible);
+        }
 
-            // For geometries, find zone, clear lights and calculate view space Z range
-            if (drawable->GetDrawableFlags() & DRAWABLE_GEOMETRY)
+        unsigned occludeeIndex = 0;
+        while (start != groupEnd)
+        {
+            Drawable* drawable = *start++;
+
+            if (!buffer || !drawable->IsOccludee() || occludeeVisible[occludeeIndex++])
             {
-                Zone* drawableZone = drawable->GetZone();
-                if (!cameraZoneOverride &&
-                    (drawable->IsZoneDirty() || !drawableZone || (drawableZone->GetViewMask() & cameraViewMask) == 0))
-                    view->FindZone(drawable);
+                drawable->UpdateBatches(view->frame_);
+                // If draw distance non-zero, update and check it
+                float maxDistance = drawable->GetDrawDistance();
+                if (maxDistance > 0.0f)
+                {
+                    if (drawable->GetDistance() > maxDistance)
+                        continue;
+                }
 
-                const BoundingBox& geomBox = drawable->GetWorldBoundingBox();
-                Vector3 center = geomBox.Center();
-                Vector3 edge = geomBox.Size() * 0.5f;
+                drawable->MarkInView(view->frame_);
 
-                // Do not add "infinite" objects like skybox to prevent shadow map focusing behaving erroneously
-                if (edge.LengthSquared() < M_LARGE_VALUE * M_LARGE_VALUE)
+                // For geometries, find zone, clear lights and calculate view space Z range
+                if (drawable->GetDrawableFlags() & DRAWABLE_GEOMETRY)
                 {
-                    float viewCenterZ = viewZ.DotProduct(center) + viewMatrix.m23_;
-                    float viewEdgeZ = absViewZ.DotProduct(edge);
-                    float minZ = viewCenterZ - viewEdgeZ;
-                    float maxZ = viewCenterZ + viewEdgeZ;
-                    drawable->SetMinMaxZ(viewCenterZ - viewEdgeZ, viewCenterZ + viewEdgeZ);
-                    result.minZ_ = Min(result.minZ_, minZ);
-                    result.maxZ_ = Max(result.maxZ_, maxZ);
-                }
-                else
-                    drawable->SetMinMaxZ(M_LARGE_VALUE, M_LARGE_VALUE);
+                    Zone* drawableZone = drawable->GetZone();
+                    if (!cameraZoneOverride &&
+                        (drawable->IsZoneDirty() || !drawableZone || (drawableZone->GetViewMask() & cameraViewMask) == 0))
+                        view->FindZone(drawable);
 
-                result.geometries_.Push(drawable);
-            }
-            else if (drawable->GetDrawableFlags() & DRAWABLE_LIGHT)
-            {
-                Light* light = static_cast<Light*>(drawable);
-                // Skip lights with zero brightness or black color
-                if (!light->GetEffectiveColor().Equals(Color::BLACK))
-                    result.lights_.Push(light);
+                    const BoundingBox& geomBox = drawable->GetWorldBoundingBox();
+                    Vector3 center = geomBox.Center();
+                    Vector3 edge = geomBox.Size() * 0.5f;
+
+                    // Do not add "infinite" objects like skybox to prevent shadow map focusing behaving erroneously
+                    if (edge.LengthSquared() < M_LARGE_VALUE * M_LARGE_VALUE)
+                    {
+                        float viewCenterZ = viewZ.DotProduct(center) + viewMatrix.m23_;
+                        float viewEdgeZ = absViewZ.DotProduct(edge);
+                        float minZ = viewCenterZ - viewEdgeZ;
+                        float maxZ = viewCenterZ + viewEdgeZ;
+                        drawable->SetMinMaxZ(viewCenterZ - viewEdgeZ, viewCenterZ + viewEdgeZ);
+                        result.minZ_ = Min(result.minZ_, minZ);
+                        result.maxZ_ = Max(result.maxZ_, maxZ);
+                    }
+                    else
+                        drawable->SetMinMaxZ(M_LARGE_VALUE, M_LARGE_VALUE);
+
+                    result.geometries_.Push(drawable);
+                }
+                else if (drawable->GetDrawableFlags() & DRAWABLE_LIGHT)
+                {
+                    Light* light = static_cast<Light*>(drawable);
+                    // Skip lights with zero brightness or black color
+                    if (!light->GetEffectiveColor().Equals(Color::BLACK))
+                        result.lights_.Push(light);
+                }
             }
         }
     }
@@ -2922,7 +2946,7 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
     {
         BatchGroupKey key(batch);
 
-        HashMap<BatchGroupKey, BatchGroup>::Iterator i = queue.batchGroups_.Find(key);
+        FlatHashMap<BatchGroupKey, BatchGroup>::Iterator i = queue.batchGroups_.Find(key);
         if (i == queue.batchGroups_.End())
         {
             // Create a new group based on the batch
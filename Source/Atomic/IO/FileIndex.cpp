@@ -0,0 +1,463 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
+#include "../IO/File.h"
+#include "../IO/FileIndex.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+
+#include <sys/stat.h>
+#include <ctime>
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+static const unsigned FILE_INDEX_VERSION = 1;
+
+/// Directory revalidated by a file index update.
+struct FileIndexTask
+{
+    /// Directory path relative to the root, with trailing slash.
+    String path_;
+    /// Full directory path.
+    String fullPath_;
+    /// Previous listing, or null if the directory was not indexed.
+    const FileIndexDir* previous_;
+    /// Revalidated listing.
+    FileIndexDir dir_;
+    /// Whether the directory exists.
+    bool exists_;
+};
+
+static bool GetFileIndexStat(const String& fileName, unsigned& size, unsigned& lastModified, bool& directory)
+{
+#ifdef _WIN32
+    struct _stat st;
+    if (_stat(fileName.CString(), &st))
+        return false;
+#else
+    struct stat st;
+    if (stat(fileName.CString(), &st))
+        return false;
+#endif
+
+    directory = (st.st_mode & S_IFDIR) != 0;
+    size = directory ? 0 : (unsigned)st.st_size;
+    lastModified = (unsigned)st.st_mtime;
+    return true;
+}
+
+static void UpdateFileIndexDir(FileIndexTask* task)
+{
+    unsigned size;
+    bool directory;
+    task->exists_ = GetFileIndexStat(task->fullPath_, size, task->dir_.lastModified_, directory) && directory;
+    if (!task->exists_)
+        return;
+
+    const FileIndexDir* previous = task->previous_;
+    Vector<FileIndexEntry>& entries = task->dir_.entries_;
+
+    // A directory modified in the same second it was listed may have changed after the listing, so it is listed again
+    if (previous && previous->lastModified_ == task->dir_.lastModified_ && previous->lastModified_ < previous->listTime_)
+    {
+        task->dir_.listTime_ = previous->listTime_;
+        entries.Reserve(previous->entries_.Size());
+        for (unsigned i = 0; i < previous->entries_.Size(); ++i)
+        {
+            FileIndexEntry entry = previous->entries_[i];
+            if (GetFileIndexStat(task->fullPath_ + entry.name_, entry.size_, entry.lastModified_, entry.directory_))
+                entries.Push(entry);
+        }
+    }
+    else
+    {
+        task->dir_.listTime_ = (unsigned)time(0);
+
+        Vector<DirEntry> dirEntries;
+        ReadDirEntries(dirEntries, task->fullPath_, false);
+        entries.Reserve(dirEntries.Size());
+
+        FileIndexEntry entry;
+        for (unsigned i = 0; i < dirEntries.Size(); ++i)
+        {
+            entry.name_ = dirEntries[i].name_;
+            if (entry.name_ == "." || entry.name_ == "..")
+                continue;
+            if (GetFileIndexStat(task->fullPath_ + entry.name_, entry.size_, entry.lastModified_, entry.directory_))
+                entries.Push(entry);
+        }
+    }
+}
+
+static void UpdateFileIndexWork(const WorkItem* item, unsigned threadIndex)
+{
+    UpdateFileIndexDir(reinterpret_cast<FileIndexTask*>(item->start_));
+}
+
+FileIndex::FileIndex(Context* context) :
+    Object(context),
+    numEntries_(0)
+{
+}
+
+FileIndex::~FileIndex()
+{
+}
+
+void FileIndex::SetRootPath(const String& pathName)
+{
+    String rootPath = AddTrailingSlash(pathName);
+    if (rootPath != rootPath_)
+    {
+        Clear();
+        rootPath_ = rootPath;
+    }
+}
+
+bool FileIndex::Load(const String& fileName)
+{
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+    if (!fileSystem || !fileSystem->FileExists(fileName))
+        return false;
+
+    File file(context_);
+    if (!file.Open(fileName, FILE_READ))
+        return false;
+
+    if (file.ReadFileID() != "FIDX")
+    {
+        ATOMIC_LOGERROR(fileName + " is not a valid file index");
+        return false;
+    }
+
+    // Indices from other versions are discarded and rebuilt by the next update
+    if (file.ReadUInt() != FILE_INDEX_VERSION)
+        return false;
+
+    Clear();
+    rootPath_ = file.ReadString();
+
+    unsigned numDirs = file.ReadUInt();
+    for (unsigned i = 0; i < numDirs && !file.IsEof(); ++i)
+    {
+        FileIndexDir& dir = dirs_[file.ReadString()];
+        dir.lastModified_ = file.ReadUInt();
+        dir.listTime_ = file.ReadUInt();
+
+        unsigned numEntries = file.ReadVLE();
+        dir.entries_.Resize(numEntries);
+        for (unsigned j = 0; j < numEntries; ++j)
+        {
+            FileIndexEntry& entry = dir.entries_[j];
+            entry.name_ = file.ReadString();
+            entry.size_ = file.ReadUInt();
+            entry.lastModified_ = file.ReadUInt();
+            entry.directory_ = file.ReadBool();
+            dir.entryIndices_[entry.name_] = j;
+        }
+
+        numEntries_ += numEntries;
+    }
+
+    return true;
+}
+
+bool FileIndex::Save(const String& fileName) const
+{
+    File file(context_);
+    if (!file.Open(fileName, FILE_WRITE))
+        return false;
+
+    file.WriteFileID("FIDX");
+    file.WriteUInt(FILE_INDEX_VERSION);
+    file.WriteString(rootPath_);
+    file.WriteUInt(dirs_.Size());
+
+    for (HashMap<String, FileIndexDir>::ConstIterator i = dirs_.Begin(); i != dirs_.End(); ++i)
+    {
+        const FileIndexDir& dir = i->second_;
+        file.WriteString(i->first_);
+        file.WriteUInt(dir.lastModified_);
+        file.WriteUInt(dir.listTime_);
+        file.WriteVLE(dir.entries_.Size());
+
+        for (unsigned j = 0; j < dir.entries_.Size(); ++j)
+        {
+            const FileIndexEntry& entry = dir.entries_[j];
+            file.WriteString(entry.name_);
+            file.WriteUInt(entry.size_);
+            file.WriteUInt(entry.lastModified_);
+            file.WriteBool(entry.directory_);
+        }
+    }
+
+    return true;
+}
+
+bool FileIndex::Update()
+{
+    addedEntries_.Clear();
+    modifiedEntries_.Clear();
+    removedEntries_.Clear();
+
+    if (rootPath_.Empty())
+        return false;
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    bool threaded = queue && queue->GetNumThreads() && Thread::IsMainThread() && !queue->IsCompleting();
+
+    HashMap<String, FileIndexDir> dirs;
+    unsigned numEntries = 0;
+
+    Vector<FileIndexTask> level(1);
+    level[0].fullPath_ = rootPath_;
+    HashMap<String, FileIndexDir>::ConstIterator root = dirs_.Find(String::EMPTY);
+    level[0].previous_ = root != dirs_.End() ? &root->second_ : 0;
+
+    // Revalidate one directory level at a time, with one work item per directory
+    while (level.Size())
+    {
+        if (threaded)
+        {
+            for (unsigned i = 0; i < level.Size(); ++i)
+            {
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = UpdateFileIndexWork;
+                item->start_ = &level[i];
+                queue->AddWorkItem(item);
+            }
+            queue->Complete(M_MAX_UNSIGNED);
+        }
+        else
+        {
+            for (unsigned i = 0; i < level.Size(); ++i)
+                UpdateFileIndexDir(&level[i]);
+        }
+
+        Vector<FileIndexTask> nextLevel;
+
+        for (unsigned i = 0; i < level.Size(); ++i)
+        {
+            FileIndexTask& task = level[i];
+            const FileIndexDir* previous = task.previous_;
+            if (!task.exists_)
+            {
+                if (previous)
+                    RemoveDir(task.path_);
+                continue;
+            }
+
+            FileIndexDir& dir = dirs[task.path_];
+            dir.lastModified_ = task.dir_.lastModified_;
+            dir.listTime_ = task.dir_.listTime_;
+            dir.entries_.Swap(task.dir_.entries_);
+            numEntries += dir.entries_.Size();
+
+            for (unsigned j = 0; j < dir.entries_.Size(); ++j)
+            {
+                const FileIndexEntry& entry = dir.entries_[j];
+                dir.entryIndices_[entry.name_] = j;
+
+                String fullPath = task.fullPath_ + entry.name_;
+                const unsigned* previousIndex = previous ? previous->entryIndices_[entry.name_] : 0;
+                if (!previousIndex)
+                    addedEntries_.Push(fullPath);
+                else
+                {
+                    const FileIndexEntry& previousEntry = previous->entries_[*previousIndex];
+                    if (previousEntry.directory_ != entry.directory_)
+                    {
+                        removedEntries_.Push(fullPath);
+                        if (previousEntry.directory_)
+                            RemoveDir(task.path_ + entry.name_ + "/");
+                        addedEntries_.Push(fullPath);
+                    }
+                    else if (!entry.directory_ && (previousEntry.size_ != entry.size_ ||
+                        previousEntry.lastModified_ != entry.lastModified_))
+                        modifiedEntries_.Push(fullPath);
+                }
+
+                if (entry.directory_)
+                {
+                    FileIndexTask child;
+                    child.path_ = task.path_ + entry.name_ + "/";
+                    child.fullPath_ = fullPath + "/";
+                    HashMap<String, FileIndexDir>::ConstIterator l = dirs_.Find(child.path_);
+                    child.previous_ = l != dirs_.End() ? &l->second_ : 0;
+                    nextLevel.Push(child);
+                }
+            }
+
+            if (previous)
+            {
+                for (unsigned j = 0; j < previous->entries_.Size(); ++j)
+                {
+                    const FileIndexEntry& previousEntry = previous->entries_[j];
+                    if (dir.entryIndices_.Contains(previousEntry.name_))
+                        continue;
+
+                    removedEntries_.Push(task.fullPath_ + previousEntry.name_);
+                    if (previousEntry.directory_)
+                        RemoveDir(task.path_ + previousEntry.name_ + "/");
+                }
+            }
+        }
+
+        level.Swap(nextLevel);
+    }
+
+    dirs_.Swap(dirs);
+    numEntries_ = numEntries;
+
+    return addedEntries_.Size() || modifiedEntries_.Size() || removedEntries_.Size();
+}
+
+void FileIndex::Clear()
+{
+    dirs_.Clear();
+    numEntries_ = 0;
+    addedEntries_.Clear();
+    modifiedEntries_.Clear();
+    removedEntries_.Clear();
+}
+
+void FileIndex::ScanDir(Vector<String>& result, const String& pathName, const String& filter, unsigned flags, bool recursive) const
+{
+    result.Clear();
+
+    String path = AddTrailingSlash(pathName);
+    if (rootPath_.Empty() || !path.StartsWith(rootPath_))
+        return;
+
+    String filterExtension = filter.Substring(filter.FindLast('.'));
+    if (filterExtension.Contains('*'))
+        filterExtension.Clear();
+
+    ScanDirInternal(result, path.Substring(rootPath_.Length()), String::EMPTY, filterExtension, flags, recursive);
+}
+
+const FileIndexEntry* FileIndex::GetEntry(const String& fileName) const
+{
+    unsigned index;
+    const FileIndexDir* dir = FindEntry(fileName, index);
+    return dir ? &dir->entries_[index] : 0;
+}
+
+bool FileIndex::FileExists(const String& fileName) const
+{
+    const FileIndexEntry* entry = GetEntry(fileName);
+    return entry && !entry->directory_;
+}
+
+bool FileIndex::DirExists(const String& pathName) const
+{
+    if (!rootPath_.Empty() && AddTrailingSlash(pathName) == rootPath_)
+        return dirs_.Contains(String::EMPTY);
+
+    const FileIndexEntry* entry = GetEntry(pathName);
+    return entry && entry->directory_;
+}
+
+unsigned FileIndex::GetLastModifiedTime(const String& fileName) const
+{
+    const FileIndexEntry* entry = GetEntry(fileName);
+    return entry ? entry->lastModified_ : 0;
+}
+
+const FileIndexDir* FileIndex::FindEntry(const String& fileName, unsigned& index) const
+{
+    if (rootPath_.Empty() || !fileName.StartsWith(rootPath_))
+        return 0;
+
+    String relativePath = RemoveTrailingSlash(fileName.Substring(rootPath_.Length()));
+    if (relativePath.Empty())
+        return 0;
+
+    unsigned slashPos = relativePath.FindLast('/');
+    String dirPath = slashPos != String::NPOS ? relativePath.Substring(0, slashPos + 1) : String::EMPTY;
+    String name = slashPos != String::NPOS ? relativePath.Substring(slashPos + 1) : relativePath;
+
+    HashMap<String, FileIndexDir>::ConstIterator i = dirs_.Find(dirPath);
+    if (i == dirs_.End())
+        return 0;
+
+    HashMap<String, unsigned>::ConstIterator j = i->second_.entryIndices_.Find(name);
+    if (j == i->second_.entryIndices_.End())
+        return 0;
+
+    index = j->second_;
+    return &i->second_;
+}
+
+void FileIndex::ScanDirInternal(Vector<String>& result, const String& dirPath, const String& deltaPath,
+    const String& filterExtension, unsigned flags, bool recursive) const
+{
+    HashMap<String, FileIndexDir>::ConstIterator i = dirs_.Find(dirPath);
+    if (i == dirs_.End())
+        return;
+
+    const Vector<FileIndexEntry>& entries = i->second_.entries_;
+    for (unsigned j = 0; j < entries.Size(); ++j)
+    {
+        const FileIndexEntry& entry = entries[j];
+        if (entry.directory_)
+        {
+            if (flags & SCAN_DIRS)
+                result.Push(deltaPath + entry.name_);
+            if (recursive)
+                ScanDirInternal(result, dirPath + entry.name_ + "/", deltaPath + entry.name_ + "/", filterExtension, flags, recursive);
+        }
+        else if (flags & SCAN_FILES)
+        {
+            if (filterExtension.Empty() || entry.name_.EndsWith(filterExtension))
+                result.Push(deltaPath + entry.name_);
+        }
+    }
+}
+
+void FileIndex::RemoveDir(const String& dirPath)
+{
+    HashMap<String, FileIndexDir>::ConstIterator i = dirs_.Find(dirPath);
+    if (i == dirs_.End())
+        return;
+
+    const Vector<FileIndexEntry>& entries = i->second_.entries_;
+    for (unsigned j = 0; j < entries.Size(); ++j)
+    {
+        removedEntries_.Push(rootPath_ + dirPath + entries[j].name_);
+        if (entries[j].directory_)
+            RemoveDir(dirPath + entries[j].name_ + "/");
+    }
+}
+
+}
@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Core/Object.h"
+
+namespace Atomic
+{
+
+/// File or directory recorded in a FileIndex.
+struct FileIndexEntry
+{
+    /// File or directory name.
+    String name_;
+    /// Size in bytes. Zero for directories.
+    unsigned size_;
+    /// Last modified time as seconds since 1.1.1970.
+    unsigned lastModified_;
+    /// Whether the entry is a directory.
+    bool directory_;
+};
+
+/// Directory listing recorded in a FileIndex.
+struct FileIndexDir
+{
+    /// Last modified time of the directory itself.
+    unsigned lastModified_;
+    /// Time the entries were listed. The listing is only reused when the directory was last modified before this.
+    unsigned listTime_;
+    /// Entries in listing order.
+    Vector<FileIndexEntry> entries_;
+    /// Entry indices by name.
+    HashMap<String, unsigned> entryIndices_;
+};
+
+/// Persistent index of the size and modification time of the files below a root directory. Update revalidates it
+/// incrementally: directories whose modification time has not changed are not listed again, only their files are checked.
+/// Directories are processed in parallel on the WorkQueue. Hidden files and directories are not indexed.
+class ATOMIC_API FileIndex : public Object
+{
+    ATOMIC_OBJECT(FileIndex, Object);
+
+public:
+    /// Construct.
+    FileIndex(Context* context);
+    /// Destruct.
+    virtual ~FileIndex();
+
+    /// Set the root directory. Clear the index if the root changes.
+    void SetRootPath(const String& pathName);
+    /// Load the index from a file. The root directory is taken from the file. Return true if successful.
+    bool Load(const String& fileName);
+    /// Save the index to a file. Return true if successful.
+    bool Save(const String& fileName) const;
+    /// Revalidate the index against the file system and record the added, modified and removed entries. Return true if anything changed.
+    bool Update();
+    /// Clear the index.
+    void Clear();
+
+    /// Scan an indexed directory like FileSystem::ScanDir, using the state from the last update. The "." and ".." entries are not returned.
+    void ScanDir(Vector<String>& result, const String& pathName, const String& filter, unsigned flags, bool recursive) const;
+    /// Return an indexed file or directory, or null if it is not in the index.
+    const FileIndexEntry* GetEntry(const String& fileName) const;
+    /// Return whether an indexed file exists.
+    bool FileExists(const String& fileName) const;
+    /// Return whether an indexed directory exists.
+    bool DirExists(const String& pathName) const;
+    /// Return the last modified time of an indexed file, or 0 if it is not in the index.
+    unsigned GetLastModifiedTime(const String& fileName) const;
+
+    /// Return the root directory.
+    const String& GetRootPath() const { return rootPath_; }
+    /// Return number of indexed files and directories.
+    unsigned GetNumEntries() const { return numEntries_; }
+    /// Return full paths of the entries added by the last update.
+    const Vector<String>& GetAddedEntries() const { return addedEntries_; }
+    /// Return full paths of the files modified since the previous update.
+    const Vector<String>& GetModifiedEntries() const { return modifiedEntries_; }
+    /// Return full paths of the entries removed by the last update.
+    const Vector<String>& GetRemovedEntries() const { return removedEntries_; }
+
+private:
+    /// Find the directory and entry index of a path. Return null if not found.
+    const FileIndexDir* FindEntry(const String& fileName, unsigned& index) const;
+    /// Collect scan results from an indexed directory.
+    void ScanDirInternal(Vector<String>& result, const String& dirPath, const String& deltaPath, const String& filterExtension,
+        unsigned flags, bool recursive) const;
+    /// Record the entries of a previously indexed directory and its subdirectories as removed.
+    void RemoveDir(const String& dirPath);
+
+    /// Root directory with trailing slash.
+    String rootPath_;
+    /// Directory listings by path relative to the root, with trailing slash. The root is the empty path.
+    HashMap<String, FileIndexDir> dirs_;
+    /// Number of indexed files and directories.
+    unsigned numEntries_;
+    /// Entries added by the last update.
+    Vector<String> addedEntries_;
+    /// Files modified since the previous update.
+    Vector<String> modifiedEntries_;
+    /// Entries removed by the last update.
+    Vector<String> removedEntries_;
+};
+
+}
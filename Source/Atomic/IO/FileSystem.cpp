@@ -26,6 +26,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
@@ -290,7 +291,8 @@ private:
 FileSystem::FileSystem(Context* context) :
     Object(context),
     nextAsyncExecID_(1),
-    executeConsoleCommands_(false)
+    executeConsoleCommands_(false),
+    parallelScanDir_(true)
 {
     SubscribeToEvent(E_BEGINFRAME, ATOMIC_HANDLER(FileSystem, HandleBeginFrame));
 
@@ -729,7 +731,8 @@ void FileSystem::ScanDir(Vector<String>& result, const String& pathName, const S
     if (CheckAccess(pathName))
     {
         String initialPath = AddTrailingSlash(pathName);
-        ScanDirInternal(result, initialPath, initialPath, filter, flags, recursive);
+        if (!recursive || !ScanDirParallel(result, initialPath, filter, flags))
+            ScanDirInternal(result, initialPath, initialPath, filter, flags, recursive);
     }
 }
 
@@ -882,70 +885,131 @@ void FileSystem::ScanDirInternal(Vector<String>& result, String path, const Stri
         return;
     }
 #endif
-#ifdef _WIN32
-    WIN32_FIND_DATAW info;
-    HANDLE handle = FindFirstFileW(WString(path + "*").CString(), &info);
-    if (handle != INVALID_HANDLE_VALUE)
+    Vector<DirEntry> entries;
+    ReadDirEntries(entries, path, (flags & SCAN_HIDDEN) != 0);
+
+    for (unsigned i = 0; i < entries.Size(); ++i)
     {
-        do
+        const DirEntry& entry = entries[i];
+        if (entry.directory_)
         {
-            String fileName(info.cFileName);
-            if (!fileName.Empty())
-            {
-                if (info.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN && !(flags & SCAN_HIDDEN))
-                    continue;
-                if (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
-                {
-                    if (flags & SCAN_DIRS)
-                        result.Push(deltaPath + fileName);
-                    if (recursive && fileName != "." && fileName != "..")
-                        ScanDirInternal(result, path + fileName, startPath, filter, flags, recursive);
-                }
-                else if (flags & SCAN_FILES)
-                {
-                    if (filterExtension.Empty() || fileName.EndsWith(filterExtension))
-                        result.Push(deltaPath + fileName);
-                }
-            }
+            if (flags & SCAN_DIRS)
+                result.Push(deltaPath + entry.name_);
+            if (recursive && entry.name_ != "." && entry.name_ != "..")
+                ScanDirInternal(result, path + entry.name_, startPath, filter, flags, recursive);
+        }
+        else if (flags & SCAN_FILES)
+        {
+            if (filterExtension.Empty() || entry.name_.EndsWith(filterExtension))
+                result.Push(deltaPath + entry.name_);
         }
-        while (FindNextFileW(handle, &info));
+    }
+}
+
+/// Directory listed by a parallel directory scan.
+struct ScanDirTask
+{
+    /// Directory path with trailing slash.
+    String path_;
+    /// Entries of the directory.
+    Vector<DirEntry> entries_;
+    /// Index of the first subdirectory task. Subdirectory tasks are consecutive and in entry order.
+    unsigned firstChild_;
+    /// Whether to include hidden entries.
+    bool includeHidden_;
+};
+
+static void ScanDirWork(const WorkItem* item, unsigned threadIndex)
+{
+    ScanDirTask* task = reinterpret_cast<ScanDirTask*>(item->start_);
+    ReadDirEntries(task->entries_, task->path_, task->includeHidden_);
+}
+
+static void CollectScanDirResults(Vector<String>& result, const Vector<ScanDirTask>& tasks, unsigned index,
+    const String& deltaPath, const String& filterExtension, unsigned flags)
+{
+    const ScanDirTask& task = tasks[index];
+    unsigned childIndex = task.firstChild_;
 
-        FindClose(handle);
+    for (unsigned i = 0; i < task.entries_.Size(); ++i)
+    {
+        const DirEntry& entry = task.entries_[i];
+        if (entry.directory_)
+        {
+            if (flags & SCAN_DIRS)
+                result.Push(deltaPath + entry.name_);
+            if (entry.name_ != "." && entry.name_ != "..")
+                CollectScanDirResults(result, tasks, childIndex++, deltaPath + entry.name_ + "/", filterExtension, flags);
+        }
+        else if (flags & SCAN_FILES)
+        {
+            if (filterExtension.Empty() || entry.name_.EndsWith(filterExtension))
+                result.Push(deltaPath + entry.name_);
+        }
     }
-#else
-    DIR* dir;
-    struct dirent* de;
-    struct stat st;
-    dir = opendir(GetNativePath(path).CString());
-    if (dir)
+}
+
+bool FileSystem::ScanDirParallel(Vector<String>& result, const String& path, const String& filter, unsigned flags) const
+{
+    if (!parallelScanDir_ || !Thread::IsMainThread())
+        return false;
+
+#ifdef __ANDROID__
+    if (ATOMIC_IS_ASSET(path))
+        return false;
+#endif
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    if (!queue || !queue->GetNumThreads() || queue->IsCompleting())
+        return false;
+
+    // List one directory level at a time, with one work item per directory. The tasks of the next level are only
+    // appended after the previous level completes, so that the task vector is not reallocated under the workers
+    Vector<ScanDirTask> tasks;
+    tasks.Resize(1);
+    tasks[0].path_ = path;
+    tasks[0].includeHidden_ = (flags & SCAN_HIDDEN) != 0;
+
+    unsigned levelStart = 0;
+    while (levelStart < tasks.Size())
     {
-        while ((de = readdir(dir)))
+        unsigned levelEnd = tasks.Size();
+
+        for (unsigned i = levelStart; i < levelEnd; ++i)
         {
-            /// \todo Filename may be unnormalized Unicode on Mac OS X. Re-normalize as necessary
-            String fileName(de->d_name);
-            bool normalEntry = fileName != "." && fileName != "..";
-            if (normalEntry && !(flags & SCAN_HIDDEN) && fileName.StartsWith("."))
-                continue;
-            String pathAndName = path + fileName;
-            if (!stat(pathAndName.CString(), &st))
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = ScanDirWork;
+            item->start_ = &tasks[i];
+            queue->AddWorkItem(item);
+        }
+        queue->Complete(M_MAX_UNSIGNED);
+
+        for (unsigned i = levelStart; i < levelEnd; ++i)
+        {
+            tasks[i].firstChild_ = tasks.Size();
+            for (unsigned j = 0; j < tasks[i].entries_.Size(); ++j)
             {
-                if (st.st_mode & S_IFDIR)
-                {
-                    if (flags & SCAN_DIRS)
-                        result.Push(deltaPath + fileName);
-                    if (recursive && normalEntry)
-                        ScanDirInternal(result, path + fileName, startPath, filter, flags, recursive);
-                }
-                else if (flags & SCAN_FILES)
+                const DirEntry& entry = tasks[i].entries_[j];
+                if (entry.directory_ && entry.name_ != "." && entry.name_ != "..")
                 {
-                    if (filterExtension.Empty() || fileName.EndsWith(filterExtension))
-                        result.Push(deltaPath + fileName);
+                    ScanDirTask child;
+                    child.path_ = tasks[i].path_ + entry.name_ + "/";
+                    child.includeHidden_ = tasks[i].includeHidden_;
+                    tasks.Push(child);
                 }
             }
         }
-        closedir(dir);
+
+        levelStart = levelEnd;
     }
-#endif
+
+    String filterExtension = filter.Substring(filter.FindLast('.'));
+    if (filterExtension.Contains('*'))
+        filterExtension.Clear();
+
+    CollectScanDirResults(result, tasks, 0, String::EMPTY, filterExtension, flags);
+    return true;
 }
 
 void FileSystem::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
@@ -1269,6 +1333,71 @@ bool FileSystem::CopyDir(const String& directoryIn, const String& directoryOut)
 
 }
 
+bool ReadDirEntries(Vector<DirEntry>& result, const String& pathName, bool includeHidden)
+{
+    result.Clear();
+
+    String path = AddTrailingSlash(pathName);
+    DirEntry entry;
+
+#ifdef _WIN32
+    WIN32_FIND_DATAW info;
+    HANDLE handle = FindFirstFileW(WString(path + "*").CString(), &info);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    do
+    {
+        entry.name_ = String(info.cFileName);
+        if (entry.name_.Empty())
+            continue;
+        if (info.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN && !includeHidden)
+            continue;
+        entry.directory_ = (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        result.Push(entry);
+    }
+    while (FindNextFileW(handle, &info));
+
+    FindClose(handle);
+#else
+    DIR* dir = opendir(GetNativePath(path).CString());
+    if (!dir)
+        return false;
+
+    struct dirent* de;
+    struct stat st;
+    while ((de = readdir(dir)))
+    {
+        /// \todo Filename may be unnormalized Unicode on Mac OS X. Re-normalize as necessary
+        entry.name_ = de->d_name;
+        bool normalEntry = entry.name_ != "." && entry.name_ != "..";
+        if (normalEntry && !includeHidden && entry.name_.StartsWith("."))
+            continue;
+
+        // Use the entry type reported by readdir when available, and only stat symbolic links and unknown entries
+        bool typeKnown = false;
+#ifdef DT_DIR
+        if (de->d_type == DT_DIR || de->d_type == DT_REG)
+        {
+            entry.directory_ = de->d_type == DT_DIR;
+            typeKnown = true;
+        }
+#endif
+        if (!typeKnown)
+        {
+            if (stat((path + entry.name_).CString(), &st))
+                continue;
+            entry.directory_ = (st.st_mode & S_IFDIR) != 0;
+        }
+
+        result.Push(entry);
+    }
+    closedir(dir);
+#endif
+
+    return true;
+}
+
 bool IsAbsoluteParentPath(const String& absParentPath, const String& fullPath)
 {
     if (!IsAbsolutePath(absParentPath) || !IsAbsolutePath(fullPath))
@@ -56,6 +56,15 @@ private:
     unsigned index_;
 };
 
+/// Directory entry returned by ReadDirEntries.
+struct DirEntry
+{
+    /// File or directory name. The "." and ".." entries are included as directories.
+    String name_;
+    /// Whether the entry is a directory.
+    bool directory_;
+};
+
 // ATOMIC END
 
 // LUMA BEGIN
@@ -154,12 +163,19 @@ public:
     bool CreateDirsRecursive(const String& directoryIn);
 
     bool RemoveDir(const String& directoryIn, bool recursive);
+
+    /// Set whether recursive directory scans from the main thread are split into WorkQueue items, one per subdirectory. Default true.
+    void SetParallelScanDir(bool enable) { parallelScanDir_ = enable; }
+    /// Return whether recursive directory scans use the WorkQueue.
+    bool GetParallelScanDir() const { return parallelScanDir_; }
 // ATOMIC END
 
 private:
     /// Scan directory, called internally.
     void ScanDirInternal
         (Vector<String>& result, String path, const String& startPath, const String& filter, unsigned flags, bool recursive) const;
+    /// Scan directory recursively, listing each directory level in parallel on the WorkQueue. Return false if the WorkQueue can not be used.
+    bool ScanDirParallel(Vector<String>& result, const String& path, const String& filter, unsigned flags) const;
     /// Handle begin frame event to check for completed async executions.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
     /// Handle a console command event.
@@ -173,6 +189,8 @@ private:
     unsigned nextAsyncExecID_;
     /// Flag for executing engine console commands as OS-specific system command. Default to true.
     bool executeConsoleCommands_;
+    /// Flag for scanning directories in parallel on the WorkQueue.
+    bool parallelScanDir_;
 };
 
 /// Split a full path to path, filename and extension. The extension will be converted to lowercase by default.
@@ -204,6 +222,8 @@ ATOMIC_API WString GetWideNativePath(const String& pathName);
 ATOMIC_API bool IsAbsolutePath(const String& pathName);
 
 // ATOMIC BEGIN
+/// Read the entries of a single directory without recursing. Hidden entries are skipped unless requested. Return false if the directory could not be opened. Safe to call from worker threads.
+ATOMIC_API bool ReadDirEntries(Vector<DirEntry>& result, const String& pathName, bool includeHidden);
 ATOMIC_API bool IsAbsoluteParentPath(const String& absParentPath, const String& fullPath);
 ATOMIC_API String GetSanitizedPath(const String& path);
 
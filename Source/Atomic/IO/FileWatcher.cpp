@@ -31,6 +31,9 @@
 #include <windows.h>
 #elif __linux__
 #include <sys/inotify.h>
+#include <poll.h>
+#include <cerrno>
+#include <cstring>
 extern "C"
 {
 // Need read/close for inotify
@@ -58,6 +61,8 @@ FileWatcher::FileWatcher(Context* context) :
 #ifdef ATOMIC_FILEWATCHER
 #ifdef __linux__
     watchHandle_ = inotify_init();
+    if (pipe(wakeHandles_) < 0)
+        wakeHandles_[0] = wakeHandles_[1] = -1;
 #elif defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
     supported_ = IsFileWatcherSupported();
 #endif
@@ -70,6 +75,11 @@ FileWatcher::~FileWatcher()
 #ifdef ATOMIC_FILEWATCHER
 #ifdef __linux__
     close(watchHandle_);
+    if (wakeHandles_[0] >= 0)
+    {
+        close(wakeHandles_[0]);
+        close(wakeHandles_[1]);
+    }
 #endif
 #endif
 }
@@ -233,6 +243,16 @@ void FileWatcher::StopWatching()
 #ifdef _WIN32
         CloseHandle((HANDLE)dirHandle_);
 #elif defined(__linux__)
+        // Wake up the watcher thread and wait for it to exit before removing the watches, as it may add watches for
+        // new subdirectories
+        char wake = 0;
+        bool woken = wakeHandles_[1] >= 0 && write(wakeHandles_[1], &wake, 1) == 1;
+        Stop();
+
+        // Consume the wake-up byte so that the pipe is ready for the next watch
+        if (woken && read(wakeHandles_[0], &wake, 1) != 1)
+            ATOMIC_LOGWARNING("Failed to reset file watcher wake-up pipe");
+
         for (HashMap<int, String>::Iterator i = dirHandle_.Begin(); i != dirHandle_.End(); ++i)
             inotify_rm_watch(watchHandle_, i->first_);
         dirHandle_.Clear();
@@ -300,31 +320,81 @@ void FileWatcher::ThreadFunction()
     }
 #elif defined(__linux__)
     unsigned char buffer[BUFFERSIZE];
+    Vector<String> fileNames;
+
+    pollfd fds[2];
+    fds[0].fd = watchHandle_;
+    fds[0].events = POLLIN;
+    fds[1].fd = wakeHandles_[0];
+    fds[1].events = POLLIN;
+    int numFds = wakeHandles_[0] >= 0 ? 2 : 1;
 
     while (shouldRun_)
     {
+        // Block until the kernel has events or the thread is being stopped. Fall back to a timeout if there is no wake pipe
+        int ready = poll(fds, (nfds_t)numFds, numFds == 2 ? -1 : 100);
+        if (ready < 0)
+        {
+            // A signal interrupted the wait, keep watching
+            if (errno == EINTR)
+                continue;
+            ATOMIC_LOGERROR("Failed to wait for file watcher events: " + String(strerror(errno)));
+            return;
+        }
+        if (!ready || !shouldRun_)
+            continue;
+        if (numFds == 2 && (fds[1].revents & POLLIN))
+            break;
+        if (!(fds[0].revents & POLLIN))
+            continue;
+
         int i = 0;
         int length = (int)read(watchHandle_, buffer, sizeof(buffer));
 
         if (length < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            ATOMIC_LOGERROR("Failed to read file watcher events: " + String(strerror(errno)));
             return;
+        }
+
+        // Coalesce the events of one read into a single batch, so that the changes mutex is taken once
+        fileNames.Clear();
 
         while (i < length)
         {
             inotify_event* event = (inotify_event*)&buffer[i];
 
+            if (event->mask & IN_Q_OVERFLOW)
+                ATOMIC_LOGWARNING("File watcher event queue overflow, some file changes may not be notified");
+
             if (event->len > 0)
             {
-                if (event->mask & IN_MODIFY || event->mask & IN_MOVE)
+                HashMap<int, String>::ConstIterator dir = dirHandle_.Find(event->wd);
+                if (dir != dirHandle_.End())
                 {
-                    String fileName;
-                    fileName = dirHandle_[event->wd] + event->name;
-                    AddChange(fileName);
+                    String fileName = dir->second_ + event->name;
+
+                    // Watch subdirectories created after watching started
+                    if (watchSubDirs_ && (event->mask & IN_CREATE) && (event->mask & IN_ISDIR))
+                    {
+                        int flags = IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO;
+                        int handle = inotify_add_watch(watchHandle_, (path_ + fileName).CString(), (unsigned)flags);
+                        if (handle >= 0)
+                            dirHandle_[handle] = AddTrailingSlash(fileName);
+                    }
+
+                    if ((event->mask & IN_MODIFY || event->mask & IN_MOVE) && !fileNames.Contains(fileName))
+                        fileNames.Push(fileName);
                 }
             }
 
             i += sizeof(inotify_event) + event->len;
         }
+
+        if (fileNames.Size())
+            AddChanges(fileNames);
     }
 #elif defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
     while (shouldRun_)
@@ -351,6 +421,14 @@ void FileWatcher::AddChange(const String& fileName)
     changes_[fileName].Reset();
 }
 
+void FileWatcher::AddChanges(const Vector<String>& fileNames)
+{
+    MutexLock lock(changesMutex_);
+
+    for (unsigned i = 0; i < fileNames.Size(); ++i)
+        changes_[fileNames[i]].Reset();
+}
+
 bool FileWatcher::GetNextChange(String& dest)
 {
     MutexLock lock(changesMutex_);
@@ -375,4 +453,25 @@ bool FileWatcher::GetNextChange(String& dest)
     }
 }
 
+bool FileWatcher::GetChanges(Vector<String>& dest)
+{
+    MutexLock lock(changesMutex_);
+
+    unsigned delayMsec = (unsigned)(delay_ * 1000.0f);
+    unsigned oldSize = dest.Size();
+
+    for (HashMap<String, Timer>::Iterator i = changes_.Begin(); i != changes_.End();)
+    {
+        if (i->second_.GetMSec(false) >= delayMsec)
+        {
+            dest.Push(i->first_);
+            i = changes_.Erase(i);
+        }
+        else
+            ++i;
+    }
+
+    return dest.Size() > oldSize;
+}
+
 }
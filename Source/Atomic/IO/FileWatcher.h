@@ -55,8 +55,12 @@ public:
     void SetDelay(float interval);
     /// Add a file change into the changes queue.
     void AddChange(const String& fileName);
+    /// Add several file changes into the changes queue at once.
+    void AddChanges(const Vector<String>& fileNames);
     /// Return a file change (true if was found, false if not.)
     bool GetNextChange(String& dest);
+    /// Append all file changes that have exceeded the delay to the destination and remove them from the queue. Return true if any were found.
+    bool GetChanges(Vector<String>& dest);
 
     /// Return the path being watched, or empty if not watching.
     const String& GetPath() const { return path_; }
@@ -89,6 +93,8 @@ private:
     HashMap<int, String> dirHandle_;
     /// Linux inotify needs a handle.
     int watchHandle_;
+    /// Pipe used to wake up the watcher thread when stopping.
+    int wakeHandles_[2];
 
 #elif defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
     
@@ -52,11 +52,17 @@ bool MetricsSnapshot::CompareInstanceMetrics(const MetricsSnapshot::InstanceMetr
     */
 }
 
+bool MetricsSnapshot::CompareStatisticMetrics(const MetricsSnapshot::StatisticMetric& lhs, const MetricsSnapshot::StatisticMetric& rhs)
+{
+    return lhs.name < rhs.name;
+}
+
 void MetricsSnapshot::Clear()
 {
     instanceMetrics_.Clear();
     nodeMetrics_.Clear();
     resourceMetrics_.Clear();
+    statisticMetrics_.Clear();
 }
 
 void MetricsSnapshot::RegisterInstance(const String& classname, InstantiationType instantiationType, int count)
@@ -83,6 +89,16 @@ void MetricsSnapshot::RegisterInstance(const String& classname, InstantiationTyp
 
 }
 
+void MetricsSnapshot::RegisterStatistic(const String& name, float value)
+{
+    StatisticMetric *metric = &statisticMetrics_[name];
+
+    if (!metric->name.Length())
+        metric->name = name;
+
+    metric->value = value;
+}
+
 String MetricsSnapshot::PrintData(unsigned columns, unsigned minCount)
 {
     String output;
@@ -148,6 +164,29 @@ String MetricsSnapshot::PrintData(unsigned columns, unsigned minCount)
     if (line.Length())
         output += line;
 
+    if (statisticMetrics_.Size())
+    {
+        Vector<MetricsSnapshot::StatisticMetric> statisticSort;
+
+        HashMap<StringHash, StatisticMetric>::ConstIterator statisticItr = statisticMetrics_.Begin();
+
+        while (statisticItr != statisticMetrics_.End())
+        {
+            statisticSort.Push(statisticItr->second_);
+            statisticItr++;
+        }
+
+        Sort(statisticSort.Begin(), statisticSort.End(), CompareStatisticMetrics);
+
+        output += "\n\nStatistic                         Value\n\n";
+
+        for (unsigned i = 0; i < statisticSort.Size(); i++)
+        {
+            snprintf(entry, ENTRY_MAX_LENGTH, "%-32s : %12.3f\n", statisticSort[i].name.CString(), statisticSort[i].value);
+            output += String(entry);
+        }
+    }
+
     return output;
 
 }
@@ -307,6 +346,31 @@ void Metrics::Capture(MetricsSnapshot* snapshot)
 
     CaptureInstances(snapshot);
 
+    HashMap<StringHash, MetricsSnapshot::StatisticMetric>::ConstIterator itr = statistics_.Begin();
+
+    while (itr != statistics_.End())
+    {
+        snapshot->RegisterStatistic(itr->second_.name, itr->second_.value);
+        itr++;
+    }
+
+}
+
+void Metrics::SetStatistic(const String& name, float value)
+{
+    MetricsSnapshot::StatisticMetric& statistic = statistics_[name];
+
+    if (!statistic.name.Length())
+        statistic.name = name;
+
+    statistic.value = value;
+}
+
+float Metrics::GetStatistic(const String& name) const
+{
+    HashMap<StringHash, MetricsSnapshot::StatisticMetric>::ConstIterator itr = statistics_.Find(name);
+
+    return itr != statistics_.End() ? itr->second_.value : 0.0f;
 }
 
 bool Metrics::Enable()
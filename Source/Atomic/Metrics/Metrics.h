@@ -45,6 +45,9 @@ public:
     /// Register instance(s) of classname in metrics snapshot
     void RegisterInstance(const String& classname, InstantiationType instantiationType, int count = 1);
 
+    /// Register a named statistic value in metrics snapshot
+    void RegisterStatistic(const String& name, float value);
+
 private:
 
     struct InstanceMetric
@@ -85,7 +88,19 @@ private:
         }
     };
 
+    struct StatisticMetric
+    {
+        String name;
+        float value;
+
+        StatisticMetric()
+        {
+            value = 0.0f;
+        }
+    };
+
     static bool CompareInstanceMetrics(const InstanceMetric& lhs, const InstanceMetric& rhs);
+    static bool CompareStatisticMetrics(const StatisticMetric& lhs, const StatisticMetric& rhs);
 
     // StringHash(classname) => InstanceMetrics
     HashMap<StringHash, InstanceMetric> instanceMetrics_;
@@ -96,6 +111,9 @@ private:
     // StringHash(resource name) => ResourceMetrics
     HashMap<StringHash, ResourceMetric> resourceMetrics_;
 
+    // StringHash(statistic name) => StatisticMetrics
+    HashMap<StringHash, StatisticMetric> statisticMetrics_;
+
 };
 
 /// Metrics subsystem
@@ -124,6 +142,11 @@ public:
     /// Prints names of registered node instances output string
     String PrintNodeNames() const;
 
+    /// Set a named statistic, included in captured snapshots. Cheap and usable while the subsystem is not enabled
+    void SetStatistic(const String& name, float value);
+    /// Return a named statistic, 0 if not set
+    float GetStatistic(const String& name) const;
+
 private:
 
     // A RefCountedInfo entry, necessary as we need to access instances in RefCounted constructor/destructor
@@ -167,6 +190,9 @@ private:
     // Lookup from string hashes to avoid String thrashing in the metrics subsystem with large numbers of instances
     HashMap<StringHash, String> names_;
 
+    // StringHash(statistic name) => statistic, set by other subsystems
+    HashMap<StringHash, MetricsSnapshot::StatisticMetric> statistics_;
+
 };
 
 
@@ -92,6 +92,7 @@ CrowdAgent::CrowdAgent(Context* context) :
     obstacleAvoidanceType_(DEFAULT_AGENT_OBSTACLE_AVOIDANCE_TYPE),
     navQuality_(DEFAULT_AGENT_AVOIDANCE_QUALITY),
     navPushiness_(DEFAULT_AGENT_NAVIGATION_PUSHINESS),
+    positionChanged_(false),
     previousTargetState_(CA_TARGET_NONE),
     previousAgentState_(CA_STATE_WALKING),
     ignoreTransformChanges_(false)
@@ -516,6 +517,27 @@ bool CrowdAgent::IsInCrowd() const
     return crowdManager_ && agentCrowdId_ != -1;
 }
 
+void CrowdAgent::ApplyCrowdPosition(const dtCrowdAgent* ag)
+{
+    assert (ag);
+    if (!node_)
+        return;
+
+    Vector3 newPos(ag->npos);
+    if (newPos != previousPosition_)
+    {
+        previousPosition_ = newPos;
+        positionChanged_ = true;
+
+        if (updateNodePosition_)
+        {
+            ignoreTransformChanges_ = true;
+            node_->SetWorldPosition(newPos);
+            ignoreTransformChanges_ = false;
+        }
+    }
+}
+
 void CrowdAgent::OnCrowdUpdate(dtCrowdAgent* ag, float dt)
 {
     assert (ag);
@@ -527,17 +549,10 @@ void CrowdAgent::OnCrowdUpdate(dtCrowdAgent* ag, float dt)
         Vector3 newPos(ag->npos);
         Vector3 newVel(ag->vel);
 
-        // Notify parent node of the reposition
-        if (newPos != previousPosition_)
+        // Notify parent node of the reposition, the node itself has already been moved by ApplyCrowdPosition()
+        if (positionChanged_)
         {
-            previousPosition_ = newPos;
-
-            if (updateNodePosition_)
-            {
-                ignoreTransformChanges_ = true;
-                node_->SetWorldPosition(newPos);
-                ignoreTransformChanges_ = false;
-            }
+            positionChanged_ = false;
 
             using namespace CrowdAgentReposition;
 
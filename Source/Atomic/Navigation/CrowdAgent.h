@@ -74,7 +74,6 @@ class ATOMIC_API CrowdAgent : public Component
     ATOMIC_OBJECT(CrowdAgent, Component);
 
     friend class CrowdManager;
-    friend void CrowdAgentUpdateCallback(dtCrowdAgent* ag, float dt);
 
 public:
     /// Construct.
@@ -178,8 +177,10 @@ public:
     bool IsInCrowd() const;
 
 protected:
-    /// Handle crowd agent being updated. It is called by CrowdManager::Update() via callback.
+    /// Handle crowd agent being updated. It is called by CrowdManager::Update() after the positions of all agents have been applied, and sends the reposition and state events.
     virtual void OnCrowdUpdate(dtCrowdAgent* ag, float dt);
+    /// Apply the simulated position to the scene node without sending events. It is called by CrowdManager::Update() for all agents before any events are sent.
+    void ApplyCrowdPosition(const dtCrowdAgent* ag);
     /// Handle node being assigned.
     virtual void OnNodeSet(Node* node);
     /// Handle node being assigned.
@@ -228,6 +229,8 @@ private:
     NavigationPushiness navPushiness_;
     /// Agent's previous position used to check for position changes.
     Vector3 previousPosition_;
+    /// Flag indicating the position changed in the last crowd update and a reposition event is pending.
+    bool positionChanged_;
     /// Agent's previous target state used to check for state changes.
     CrowdAgentTargetState previousTargetState_;
     /// Agent's previous agent state used to check for state changes.
@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../IO/Log.h"
 #include "../Navigation/CrowdAgent.h"
@@ -47,6 +48,12 @@ extern const char* NAVIGATION_CATEGORY;
 
 static const unsigned DEFAULT_MAX_AGENTS = 512;
 static const float DEFAULT_MAX_AGENT_RADIUS = 0.f;
+/// Minimum number of agents in one work item of the parallel crowd update.
+static const int MIN_AGENTS_PER_JOB = 64;
+/// Number of work items per thread in the parallel crowd update, to balance uneven agent workloads.
+static const int JOBS_PER_THREAD = 2;
+/// Maximum number of work items in one phase of the parallel crowd update.
+static const int MAX_CROWD_JOBS = 64;
 
 const char* filterTypesStructureElementNames[] =
 {
@@ -73,9 +80,23 @@ const char* obstacleAvoidanceTypesStructureElementNames[] =
     0
 };
 
-void CrowdAgentUpdateCallback(dtCrowdAgent* ag, float dt)
+/// Range of agents updated by one work item in a phase of the parallel crowd update.
+struct CrowdJobRange
+{
+    /// Crowd being updated.
+    dtCrowd* crowd_;
+    /// Phase function.
+    dtCrowdJob job_;
+    /// First agent index.
+    int begin_;
+    /// Agent index past the last.
+    int end_;
+};
+
+static void CrowdJobWork(const WorkItem* item, unsigned threadIndex)
 {
-    static_cast<CrowdAgent*>(ag->params.userData)->OnCrowdUpdate(ag, dt);
+    const CrowdJobRange* range = reinterpret_cast<const CrowdJobRange*>(item->aux_);
+    range->job_(range->crowd_, (int)threadIndex, range->begin_, range->end_);
 }
 
 CrowdManager::CrowdManager(Context* context) :
@@ -592,12 +613,21 @@ bool CrowdManager::CreateCrowd()
     // Initialize the crowd
     if (maxAgentRadius_ == 0.f)
         maxAgentRadius_ = navigationMesh_->GetAgentRadius();
-    if (!crowd_->init(maxAgents_, maxAgentRadius_, navigationMesh_->navMesh_, CrowdAgentUpdateCallback))
+    if (!crowd_->init(maxAgents_, maxAgentRadius_, navigationMesh_->navMesh_, 0))
     {
         ATOMIC_LOGERROR("Could not initialize DetourCrowd");
         return false;
     }
 
+    // Let the crowd spread its per-agent update phases over the worker threads. Each thread needs its own queries,
+    // so the crowd is told the number of threads including the main thread
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    if (queue && queue->GetNumThreads())
+    {
+        if (!crowd_->setParallelFor(ParallelFor, this, (int)queue->GetNumThreads() + 1))
+            ATOMIC_LOGWARNING("Could not allocate per-thread queries for DetourCrowd, updating crowd on the main thread");
+    }
+
     if (recreate)
     {
         // Reconfigure the newly initialized crowd
@@ -688,6 +718,73 @@ void CrowdManager::Update(float delta)
     assert(crowd_ && navigationMesh_);
     ATOMIC_PROFILE(UpdateCrowd);
     crowd_->update(delta, 0);
+
+    // Move all the agent nodes first and only then send the events, so that event handlers see the whole crowd in
+    // its updated state and can not invalidate the agent array while it is being walked
+    {
+        ATOMIC_PROFILE(ApplyCrowdPositions);
+        updatedAgents_.Clear();
+        for (int i = 0; i < crowd_->getAgentCount(); ++i)
+        {
+            dtCrowdAgent* ag = crowd_->getEditableAgent(i);
+            if (!ag->active || !ag->params.userData)
+                continue;
+            CrowdAgent* agent = static_cast<CrowdAgent*>(ag->params.userData);
+            agent->ApplyCrowdPosition(ag);
+            updatedAgents_.Push(WeakPtr<CrowdAgent>(agent));
+        }
+    }
+
+    {
+        ATOMIC_PROFILE(SendCrowdEvents);
+        for (unsigned i = 0; i < updatedAgents_.Size(); ++i)
+        {
+            // The handlers may remove agents or even recreate the crowd
+            CrowdAgent* agent = updatedAgents_[i];
+            if (!agent || !crowd_)
+                continue;
+            dtCrowdAgent* ag = crowd_->getEditableAgent(agent->agentCrowdId_);
+            if (ag && ag->active && ag->params.userData == agent)
+                agent->OnCrowdUpdate(ag, delta);
+        }
+        updatedAgents_.Clear();
+    }
+}
+
+void CrowdManager::ParallelFor(void* userData, dtCrowd* crowd, void (*job)(dtCrowd*, int, int, int), int count)
+{
+    CrowdManager* manager = static_cast<CrowdManager*>(userData);
+    WorkQueue* queue = manager->GetSubsystem<WorkQueue>();
+    int numThreads = queue ? (int)queue->GetNumThreads() + 1 : 1;
+    int numJobs = Min(Min(numThreads * JOBS_PER_THREAD, (count + MIN_AGENTS_PER_JOB - 1) / MIN_AGENTS_PER_JOB), MAX_CROWD_JOBS);
+
+    if (numJobs <= 1)
+    {
+        job(crowd, 0, 0, count);
+        return;
+    }
+
+    // The ranges live on the stack, Complete() returns only after all of them have been processed
+    CrowdJobRange ranges[MAX_CROWD_JOBS];
+    int agentsPerJob = (count + numJobs - 1) / numJobs;
+    for (int i = 0; i < numJobs; ++i)
+    {
+        CrowdJobRange& range = ranges[i];
+        range.crowd_ = crowd;
+        range.job_ = job;
+        range.begin_ = i * agentsPerJob;
+        range.end_ = Min(range.begin_ + agentsPerJob, count);
+        if (range.begin_ >= range.end_)
+            break;
+
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = CrowdJobWork;
+        item->aux_ = &range;
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
 }
 
 const dtCrowdAgent* CrowdManager::GetDetourCrowdAgent(int agent) const
@@ -178,6 +178,8 @@ private:
     void HandleNavMeshChanged(StringHash eventType, VariantMap& eventData);
     /// Handle component added in the scene to check for late addition of the navmesh.
     void HandleComponentAdded(StringHash eventType, VariantMap& eventData);
+    /// Run a phase of the Detour crowd update for a range of agents on the work queue. Called back from dtCrowd::update().
+    static void ParallelFor(void* userData, dtCrowd* crowd, void (*job)(dtCrowd*, int, int, int), int count);
 
     /// Internal Detour crowd object.
     dtCrowd* crowd_;
@@ -195,6 +197,8 @@ private:
     PODVector<unsigned> numAreas_;
     /// Number of obstacle avoidance types configured in the crowd. Limit to DT_CROWD_MAX_OBSTAVOIDANCE_PARAMS.
     unsigned numObstacleAvoidanceTypes_;
+    /// Agents updated in the last crowd update, waiting for their events to be sent.
+    Vector<WeakPtr<CrowdAgent> > updatedAgents_;
 };
 
 }
@@ -25,6 +25,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
@@ -60,6 +61,7 @@ extern const char* NAVIGATION_CATEGORY;
 
 static const int DEFAULT_MAX_OBSTACLES = 1024;
 static const int DEFAULT_MAX_LAYERS = 16;
+static const unsigned TILE_BUILDS_PER_THREAD = 4;
 
 struct DynamicNavigationMesh::TileCacheData
 {
@@ -67,6 +69,53 @@ struct DynamicNavigationMesh::TileCacheData
     int dataSize;
 };
 
+/// Build of the compressed tile cache layers of one tile. Inputs are collected on the main thread, the Recast build may run in a worker thread.
+struct DynamicNavigationTileBuild
+{
+    /// Construct.
+    DynamicNavigationTileBuild(dtTileCacheAlloc* allocator) :
+        build_(allocator),
+        compressor_(0),
+        numLayers_(0),
+        success_(false)
+    {
+    }
+
+    /// Destruct. Free layer data which was not added to the tile cache.
+    ~DynamicNavigationTileBuild()
+    {
+        for (unsigned i = 0; i < numLayers_; ++i)
+        {
+            if (tiles_[i].data)
+                dtFree(tiles_[i].data);
+        }
+    }
+
+    /// Tile index.
+    IntVector2 tile_;
+    /// Tile bounding box.
+    BoundingBox tileBoundingBox_;
+    /// Recast configuration.
+    rcConfig cfg_;
+    /// Input geometry and intermediate results.
+    DynamicNavBuildData build_;
+    /// Partitioning type.
+    NavmeshPartitionType partitionType_;
+    /// Layer compressor. Stateless, so it can be shared between worker threads.
+    dtTileCacheCompressor* compressor_;
+    /// Built compressed layers.
+    DynamicNavigationMesh::TileCacheData tiles_[TILECACHE_MAXLAYERS];
+    /// Number of built layers.
+    unsigned numLayers_;
+    /// Whether the build succeeded.
+    bool success_;
+};
+
+static void BuildDynamicTileWork(const WorkItem* item, unsigned threadIndex)
+{
+    DynamicNavigationMesh::BuildTileData(*reinterpret_cast<DynamicNavigationTileBuild*>(item->aux_));
+}
+
 struct TileCompressor : public dtTileCacheCompressor
 {
     virtual int maxCompressedSize(const int bufferSize)
@@ -432,28 +481,8 @@ bool DynamicNavigationMesh::Build()
         }
 
         // Build each tile
-        unsigned numTiles = 0;
-
-        for (int z = 0; z < numTilesZ_; ++z)
-        {
-            for (int x = 0; x < numTilesX_; ++x)
-            {
-                TileCacheData tiles[TILECACHE_MAXLAYERS];
-                int layerCt = BuildTile(geometryList, x, z, tiles);
-                for (int i = 0; i < layerCt; ++i)
-                {
-                    dtCompressedTileRef tileRef;
-                    int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
-                    if (dtStatusFailed((dtStatus)status))
-                    {
-                        dtFree(tiles[i].data);
-                        tiles[i].data = 0x0;
-                    }
-                }
-                tileCache_->buildNavMeshTilesAt(x, z, navMesh_);
-                ++numTiles;
-            }
-        }
+        BuildTiles(geometryList, IntVector2::ZERO, IntVector2(numTilesX_ - 1, numTilesZ_ - 1));
+        unsigned numTiles = (unsigned)(numTilesX_ * numTilesZ_);
 
         // For a full build it's necessary to update the nav mesh
         // not doing so will cause dependent components to crash, like CrowdManager
@@ -824,17 +853,14 @@ bool DynamicNavigationMesh::ReadTiles(Deserializer& source, bool silent)
     return true;
 }
 
-int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles)
+void DynamicNavigationMesh::PrepareTileBuild(DynamicNavigationTileBuild& tileBuild, Vector<NavigationGeometryInfo>& geometryList, int x, int z)
 {
-    ATOMIC_PROFILE(BuildNavigationMeshTile);
-
-    tileCache_->removeTile(navMesh_->getTileRefAt(x, z, 0), 0, 0);
-
-    const BoundingBox tileBoundingBox = GetTileBoudningBox(IntVector2(x, z));
+    tileBuild.tile_ = IntVector2(x, z);
+    tileBuild.tileBoundingBox_ = GetTileBoudningBox(tileBuild.tile_);
+    tileBuild.partitionType_ = partitionType_;
+    tileBuild.compressor_ = compressor_.Get();
 
-    DynamicNavBuildData build(allocator_.Get());
-
-    rcConfig cfg;
+    rcConfig& cfg = tileBuild.cfg_;
     memset(&cfg, 0, sizeof cfg);
     cfg.cs = cellSize_;
     cfg.ch = cellHeight_;
@@ -854,31 +880,41 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
     cfg.detailSampleDist = detailSampleDistance_ < 0.9f ? 0.0f : cellSize_ * detailSampleDistance_;
     cfg.detailSampleMaxError = cellHeight_ * detailSampleMaxError_;
 
-    rcVcopy(cfg.bmin, &tileBoundingBox.min_.x_);
-    rcVcopy(cfg.bmax, &tileBoundingBox.max_.x_);
+    rcVcopy(cfg.bmin, &tileBuild.tileBoundingBox_.min_.x_);
+    rcVcopy(cfg.bmax, &tileBuild.tileBoundingBox_.max_.x_);
     cfg.bmin[0] -= cfg.borderSize * cfg.cs;
     cfg.bmin[2] -= cfg.borderSize * cfg.cs;
     cfg.bmax[0] += cfg.borderSize * cfg.cs;
     cfg.bmax[2] += cfg.borderSize * cfg.cs;
 
     BoundingBox expandedBox(*reinterpret_cast<Vector3*>(cfg.bmin), *reinterpret_cast<Vector3*>(cfg.bmax));
-    GetTileGeometry(&build, geometryList, expandedBox);
+    GetTileGeometry(&tileBuild.build_, geometryList, expandedBox);
+}
+
+bool DynamicNavigationMesh::BuildTileData(DynamicNavigationTileBuild& tileBuild)
+{
+    ATOMIC_PROFILE(BuildNavigationMeshTile);
+
+    DynamicNavBuildData& build = tileBuild.build_;
+    const rcConfig& cfg = tileBuild.cfg_;
+
+    tileBuild.success_ = false;
 
     if (build.vertices_.Empty() || build.indices_.Empty())
-        return 0; // Nothing to do
+        return false; // Nothing to do
 
     build.heightField_ = rcAllocHeightfield();
     if (!build.heightField_)
     {
         ATOMIC_LOGERROR("Could not allocate heightfield");
-        return 0;
+        return false;
     }
 
     if (!rcCreateHeightfield(build.ctx_, *build.heightField_, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs,
         cfg.ch))
     {
         ATOMIC_LOGERROR("Could not create heightfield");
-        return 0;
+        return false;
     }
 
     unsigned numTriangles = build.indices_.Size() / 3;
@@ -898,18 +934,18 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
     if (!build.compactHeightField_)
     {
         ATOMIC_LOGERROR("Could not allocate create compact heightfield");
-        return 0;
+        return false;
     }
     if (!rcBuildCompactHeightfield(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_,
         *build.compactHeightField_))
     {
         ATOMIC_LOGERROR("Could not build compact heightfield");
-        return 0;
+        return false;
     }
     if (!rcErodeWalkableArea(build.ctx_, cfg.walkableRadius, *build.compactHeightField_))
     {
         ATOMIC_LOGERROR("Could not erode compact heightfield");
-        return 0;
+        return false;
     }
 
     // area volumes
@@ -917,18 +953,18 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
         rcMarkBoxArea(build.ctx_, &build.navAreas_[i].bounds_.min_.x_, &build.navAreas_[i].bounds_.max_.x_,
             build.navAreas_[i].areaID_, *build.compactHeightField_);
 
-    if (this->partitionType_ == NAVMESH_PARTITION_WATERSHED)
+    if (tileBuild.partitionType_ == NAVMESH_PARTITION_WATERSHED)
     {
         if (!rcBuildDistanceField(build.ctx_, *build.compactHeightField_))
         {
             ATOMIC_LOGERROR("Could not build distance field");
-            return 0;
+            return false;
         }
         if (!rcBuildRegions(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea,
             cfg.mergeRegionArea))
         {
             ATOMIC_LOGERROR("Could not build regions");
-            return 0;
+            return false;
         }
     }
     else
@@ -936,7 +972,7 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
         if (!rcBuildRegionsMonotone(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
         {
             ATOMIC_LOGERROR("Could not build monotone regions");
-            return 0;
+            return false;
         }
     }
 
@@ -944,24 +980,23 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
     if (!build.heightFieldLayers_)
     {
         ATOMIC_LOGERROR("Could not allocate height field layer set");
-        return 0;
+        return false;
     }
 
     if (!rcBuildHeightfieldLayers(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.walkableHeight,
         *build.heightFieldLayers_))
     {
         ATOMIC_LOGERROR("Could not build height field layers");
-        return 0;
+        return false;
     }
 
-    int retCt = 0;
     for (int i = 0; i < build.heightFieldLayers_->nlayers; ++i)
     {
         dtTileCacheLayerHeader header;
         header.magic = DT_TILECACHE_MAGIC;
         header.version = DT_TILECACHE_VERSION;
-        header.tx = x;
-        header.ty = z;
+        header.tx = tileBuild.tile_.x_;
+        header.ty = tileBuild.tile_.y_;
         header.tlayer = i;
 
         rcHeightfieldLayer* layer = &build.heightFieldLayers_->layers[i];
@@ -978,71 +1013,164 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
         header.hmin = (unsigned short)layer->hmin;
         header.hmax = (unsigned short)layer->hmax;
 
+        TileCacheData& tile = tileBuild.tiles_[tileBuild.numLayers_];
         if (dtStatusFailed(
-            dtBuildTileCacheLayer(compressor_.Get()/*compressor*/, &header, layer->heights, layer->areas/*areas*/, layer->cons,
-                &(tiles[retCt].data), &tiles[retCt].dataSize)))
+            dtBuildTileCacheLayer(tileBuild.compressor_/*compressor*/, &header, layer->heights, layer->areas/*areas*/, layer->cons,
+                &tile.data, &tile.dataSize)))
         {
             ATOMIC_LOGERROR("Failed to build tile cache layers");
-            return 0;
+            return false;
         }
         else
-            ++retCt;
+            ++tileBuild.numLayers_;
+    }
+
+    tileBuild.success_ = true;
+    return true;
+}
+
+unsigned DynamicNavigationMesh::CommitTileBuild(DynamicNavigationTileBuild& tileBuild)
+{
+    const IntVector2& tile = tileBuild.tile_;
+
+    tileCache_->removeTile(navMesh_->getTileRefAt(tile.x_, tile.y_, 0), 0, 0);
+
+    // Remove the previous compressed layers of this tile (if any)
+    dtCompressedTileRef existing[TILECACHE_MAXLAYERS];
+    const int existingCt = tileCache_->getTilesAt(tile.x_, tile.y_, existing, maxLayers_);
+    for (int i = 0; i < existingCt; ++i)
+    {
+        unsigned char* data = 0x0;
+        if (!dtStatusFailed(tileCache_->removeTile(existing[i], &data, 0)) && data != 0x0)
+            dtFree(data);
     }
 
+    if (!tileBuild.success_)
+        return 0;
+
+    unsigned numLayers = 0;
+    for (unsigned i = 0; i < tileBuild.numLayers_; ++i)
+    {
+        TileCacheData& layer = tileBuild.tiles_[i];
+        dtCompressedTileRef tileRef;
+        int status = tileCache_->addTile(layer.data, layer.dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
+        if (dtStatusFailed((dtStatus)status))
+        {
+            dtFree(layer.data);
+            layer.data = 0x0;
+        }
+        else
+        {
+            // The tile cache owns the data now
+            layer.data = 0x0;
+            tileCache_->buildNavMeshTile(tileRef, navMesh_);
+            ++numLayers;
+        }
+    }
+    tileBuild.numLayers_ = 0;
+
+    // Remove navigation mesh layers which no longer exist in the rebuilt tile
+    for (int i = (int)numLayers; i < existingCt; ++i)
+        navMesh_->removeTile(navMesh_->getTileRefAt(tile.x_, tile.y_, i), 0, 0);
+
     // Send a notification of the rebuild of this tile to anyone interested
     {
         using namespace NavigationAreaRebuilt;
         VariantMap& eventData = GetContext()->GetEventDataMap();
         eventData[P_NODE] = GetNode();
         eventData[P_MESH] = this;
-        eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
-        eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
+        eventData[P_BOUNDSMIN] = Variant(tileBuild.tileBoundingBox_.min_);
+        eventData[P_BOUNDSMAX] = Variant(tileBuild.tileBoundingBox_.max_);
         SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
     }
 
-    return retCt;
+    return numLayers;
 }
 
 unsigned DynamicNavigationMesh::BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
 {
+    ATOMIC_PROFILE(BuildNavigationMeshTiles);
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+
+    // Bound the tiles in flight, each holds a copy of its input geometry
+    unsigned maxBuilds = queue ? (queue->GetNumThreads() + 1) * TILE_BUILDS_PER_THREAD : 1;
+
     unsigned numTiles = 0;
+    PODVector<DynamicNavigationTileBuild*> builds;
+
+    int x = from.x_;
+    int z = from.y_;
 
-    for (int z = from.y_; z <= to.y_; ++z)
+    while (z <= to.y_)
     {
-        for (int x = from.x_; x <= to.x_; ++x)
+        // Collect geometry on the main thread, workers start on each tile as soon as it is queued
+        while (z <= to.y_ && builds.Size() < maxBuilds)
         {
-            dtCompressedTileRef existing[TILECACHE_MAXLAYERS];
-            const int existingCt = tileCache_->getTilesAt(x, z, existing, maxLayers_);
-            for (int i = 0; i < existingCt; ++i)
+            DynamicNavigationTileBuild* tileBuild = new DynamicNavigationTileBuild(allocator_.Get());
+            PrepareTileBuild(*tileBuild, geometryList, x, z);
+            builds.Push(tileBuild);
+
+            if (queue)
             {
-                unsigned char* data = 0x0;
-                if (!dtStatusFailed(tileCache_->removeTile(existing[i], &data, 0)) && data != 0x0)
-                    dtFree(data);
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = BuildDynamicTileWork;
+                item->aux_ = tileBuild;
+                queue->AddWorkItem(item);
             }
+            else
+                BuildTileData(*tileBuild);
 
-            TileCacheData tiles[TILECACHE_MAXLAYERS];
-            int layerCt = BuildTile(geometryList, x, z, tiles);
-            for (int i = 0; i < layerCt; ++i)
+            if (++x > to.x_)
             {
-                dtCompressedTileRef tileRef;
-                int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
-                if (dtStatusFailed((dtStatus)status))
-                {
-                    dtFree(tiles[i].data);
-                    tiles[i].data = 0x0;
-                }
-                else
-                {
-                    tileCache_->buildNavMeshTile(tileRef, navMesh_);
-                    ++numTiles;
-                }
+                x = from.x_;
+                ++z;
             }
         }
+
+        if (queue)
+            queue->Complete(M_MAX_UNSIGNED);
+
+        // Commits to the tile cache and the Detour navigation mesh happen only here, in tile order
+        for (unsigned i = 0; i < builds.Size(); ++i)
+        {
+            numTiles += CommitTileBuild(*builds[i]);
+            delete builds[i];
+        }
+
+        builds.Clear();
     }
 
     return numTiles;
 }
 
+SharedPtr<WorkItem> DynamicNavigationMesh::PrepareAsyncTileBuild(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& tile)
+{
+    DynamicNavigationTileBuild* tileBuild = new DynamicNavigationTileBuild(allocator_.Get());
+    PrepareTileBuild(*tileBuild, geometryList, tile.x_, tile.y_);
+
+    // Not taken from the work queue pool, as the item is polled for completion over several frames
+    SharedPtr<WorkItem> item(new WorkItem());
+    item->priority_ = 0;
+    item->workFunction_ = BuildDynamicTileWork;
+    item->aux_ = tileBuild;
+    return item;
+}
+
+bool DynamicNavigationMesh::FinishAsyncTileBuild(WorkItem* item, bool commit)
+{
+    DynamicNavigationTileBuild* tileBuild = reinterpret_cast<DynamicNavigationTileBuild*>(item->aux_);
+    bool hasData = false;
+
+    if (commit)
+        hasData = CommitTileBuild(*tileBuild) > 0;
+
+    delete tileBuild;
+    item->aux_ = 0;
+    return hasData;
+}
+
 PODVector<OffMeshConnection*> DynamicNavigationMesh::CollectOffMeshConnections(const BoundingBox& bounds)
 {
     PODVector<OffMeshConnection*> connections;
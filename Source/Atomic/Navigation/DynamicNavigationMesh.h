@@ -38,12 +38,15 @@ namespace Atomic
 class OffMeshConnection;
 class Obstacle;
 
+struct DynamicNavigationTileBuild;
+
 class ATOMIC_API DynamicNavigationMesh : public NavigationMesh
 {
     ATOMIC_OBJECT(DynamicNavigationMesh, NavigationMesh)
 
     friend class Obstacle;
     friend struct MeshProcess;
+    friend struct DynamicNavigationTileBuild;
 
 public:
     /// Constructor.
@@ -98,6 +101,9 @@ public:
     /// Return whether to draw Obstacles.
     bool GetDrawObstacles() const { return drawObstacles_; }
 
+    /// Run the Recast build of a prepared tile into compressed layers. Does not touch the tile cache and may be called from a worker thread. Return true if successful.
+    static bool BuildTileData(DynamicNavigationTileBuild& tileBuild);
+
 protected:
     struct TileCacheData;
 
@@ -113,10 +119,16 @@ protected:
     /// Used by Obstacle class to remove itself from the tile cache, if 'silent' an event will not be raised.
     void RemoveObstacle(Obstacle*, bool silent = false);
 
-    /// Build one tile of the navigation mesh. Return true if successful.
-    int BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles);
-    /// Build tiles in the rectangular area. Return number of built tiles.
+    /// Collect the geometry and build configuration of one tile. Called from the main thread.
+    void PrepareTileBuild(DynamicNavigationTileBuild& tileBuild, Vector<NavigationGeometryInfo>& geometryList, int x, int z);
+    /// Replace the layers of a tile in the tile cache and the navigation mesh with the built data. Called from the main thread. Return number of added layers.
+    unsigned CommitTileBuild(DynamicNavigationTileBuild& tileBuild);
+    /// Build tiles in the rectangular area, in parallel if the work queue has threads. Return number of built tiles.
     unsigned BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Prepare a background rebuild of one tile. Return a work item for it, which is not yet queued.
+    virtual SharedPtr<WorkItem> PrepareAsyncTileBuild(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& tile);
+    /// Commit or discard a finished background tile rebuild and free it. Return whether the tile has navigation data after a commit.
+    virtual bool FinishAsyncTileBuild(WorkItem* item, bool commit);
     /// Off-mesh connections to be rebuilt in the mesh processor.
     PODVector<OffMeshConnection*> CollectOffMeshConnections(const BoundingBox& bounds);
     /// Release the navigation mesh, query, and tile cache.
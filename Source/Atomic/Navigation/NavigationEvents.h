@@ -65,6 +65,16 @@ ATOMIC_EVENT(E_NAVIGATION_ALL_TILES_REMOVED, NavigationAllTilesRemoved)
     ATOMIC_PARAM(P_NODE, Node); // Node pointer
     ATOMIC_PARAM(P_MESH, Mesh); // NavigationMesh pointer
 }
+
+/// Queued path request finished. The result is retrieved with NavigationMesh::GetPathResult().
+ATOMIC_EVENT(E_NAVIGATION_PATH_COMPLETED, NavigationPathCompleted)
+{
+    ATOMIC_PARAM(P_NODE, Node); // Node pointer
+    ATOMIC_PARAM(P_MESH, Mesh); // NavigationMesh pointer
+    ATOMIC_PARAM(P_REQUEST, Request); // unsigned
+    ATOMIC_PARAM(P_STATUS, Status); // int (NavigationPathStatus)
+}
+
 /// Crowd agent formation.
 ATOMIC_EVENT(E_CROWD_AGENT_FORMATION, CrowdAgentFormation)
 {
@@ -24,6 +24,8 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Geometry.h"
@@ -46,7 +48,9 @@
 #include "../Physics/CollisionShape.h"
 #endif
 #include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
 
+#include <atomic>
 #include <cfloat>
 
 // ATOMIC BEGIN
@@ -85,6 +89,9 @@ static const float DEFAULT_DETAIL_SAMPLE_DISTANCE = 6.0f;
 static const float DEFAULT_DETAIL_SAMPLE_MAX_ERROR = 1.0f;
 
 static const int MAX_POLYS = 2048;
+static const unsigned TILE_BUILDS_PER_THREAD = 4;
+static const float DEFAULT_ASYNC_BUILD_BUDGET = 2.0f;
+static const unsigned DEFAULT_PATH_ITERATION_BUDGET = 4096;
 
 
 /// Temporary data for finding a path.
@@ -100,12 +107,267 @@ struct FindPathData
     unsigned char pathFlags_[MAX_POLYS];
 };
 
+/// Build of one navigation mesh tile. Inputs are collected on the main thread, the Recast build may run in a worker thread.
+struct NavigationTileBuild
+{
+    /// Construct.
+    NavigationTileBuild() :
+        navData_(0),
+        navDataSize_(0),
+        success_(false)
+    {
+    }
+
+    /// Destruct. Free tile data which was not added to the navigation mesh.
+    ~NavigationTileBuild()
+    {
+        if (navData_)
+            dtFree(navData_);
+    }
+
+    /// Tile index.
+    IntVector2 tile_;
+    /// Tile bounding box.
+    BoundingBox tileBoundingBox_;
+    /// Recast configuration.
+    rcConfig cfg_;
+    /// Input geometry and intermediate results.
+    SimpleNavBuildData build_;
+    /// Partitioning type.
+    NavmeshPartitionType partitionType_;
+    /// Navigation agent height.
+    float agentHeight_;
+    /// Navigation agent radius.
+    float agentRadius_;
+    /// Navigation agent max vertical climb.
+    float agentMaxClimb_;
+    /// Built Detour tile data.
+    unsigned char* navData_;
+    /// Built Detour tile data size.
+    int navDataSize_;
+    /// Whether the build succeeded.
+    bool success_;
+};
+
+static void BuildTileWork(const WorkItem* item, unsigned threadIndex)
+{
+    NavigationMesh::BuildTileData(*reinterpret_cast<NavigationTileBuild*>(item->aux_));
+}
+
+/// Queued path request.
+struct NavigationPathRequest
+{
+    /// Request handle.
+    unsigned id_;
+    /// Start position in local space.
+    Vector3 start_;
+    /// End position in local space.
+    Vector3 end_;
+    /// Search extents for the start and end polygons.
+    Vector3 extents_;
+    /// Query filter.
+    dtQueryFilter filter_;
+    /// End polygon.
+    dtPolyRef endRef_;
+    /// Status.
+    NavigationPathStatus status_;
+    /// Whether the sliced search has been initialized.
+    bool started_;
+    /// Whether the search has been restarted after the navigation mesh changed under it.
+    bool restarted_;
+    /// Whether to send an event when finished.
+    bool sendEvent_;
+    /// Result path. In local space until the request is finished on the main thread.
+    PODVector<NavigationPathPoint> path_;
+};
+
+/// Path search state of one thread. A sliced search lives in its query until finished.
+struct NavigationPathSlot
+{
+    /// Construct.
+    NavigationPathSlot() :
+        query_(0),
+        active_(0)
+    {
+    }
+
+    /// Destruct.
+    ~NavigationPathSlot()
+    {
+        dtFreeNavMeshQuery(query_);
+    }
+
+    /// Detour navigation mesh query.
+    dtNavMeshQuery* query_;
+    /// Temporary data for finding a path.
+    FindPathData pathData_;
+    /// Request being searched.
+    NavigationPathRequest* active_;
+    /// Requests finished during the update.
+    PODVector<NavigationPathRequest*> finished_;
+};
+
+/// Queued path requests and per-thread queries.
+struct NavigationPathQueue
+{
+    /// Construct.
+    NavigationPathQueue() :
+        nextId_(1),
+        numPending_(0),
+        nextPending_(0),
+        iterations_(0)
+    {
+    }
+
+    /// Destruct.
+    ~NavigationPathQueue()
+    {
+        ReleaseSlots();
+        for (HashMap<unsigned, NavigationPathRequest*>::Iterator i = requests_.Begin(); i != requests_.End(); ++i)
+            delete i->second_;
+    }
+
+    /// Free the queries. Searches in progress are queued again to start over.
+    void ReleaseSlots()
+    {
+        for (unsigned i = 0; i < slots_.Size(); ++i)
+        {
+            NavigationPathRequest* request = slots_[i]->active_;
+            if (request)
+            {
+                request->started_ = false;
+                request->restarted_ = false;
+                pending_.Insert(0, request);
+            }
+            delete slots_[i];
+        }
+        slots_.Clear();
+    }
+
+    /// Advance searches of one slot within the iteration budget. May be called from a worker thread.
+    void UpdateSlot(NavigationPathSlot& slot)
+    {
+        dtNavMeshQuery* query = slot.query_;
+        FindPathData& pathData = slot.pathData_;
+        int iterations = iterations_;
+
+        while (iterations > 0)
+        {
+            if (!slot.active_)
+            {
+                unsigned index = nextPending_.fetch_add(1);
+                if (index >= numPending_)
+                    break;
+                slot.active_ = pending_[index];
+            }
+
+            NavigationPathRequest& request = *slot.active_;
+
+            if (!request.started_)
+            {
+                dtPolyRef startRef;
+                query->findNearestPoly(&request.start_.x_, &request.extents_.x_, &request.filter_, &startRef, 0);
+                query->findNearestPoly(&request.end_.x_, &request.extents_.x_, &request.filter_, &request.endRef_, 0);
+
+                if (!startRef || !request.endRef_ || dtStatusFailed(query->initSlicedFindPath(startRef, request.endRef_,
+                    &request.start_.x_, &request.end_.x_, &request.filter_)))
+                {
+                    FinishRequest(slot, NAVPATH_FAILED);
+                    continue;
+                }
+
+                request.started_ = true;
+            }
+
+            int doneIterations = 0;
+            dtStatus status = query->updateSlicedFindPath(iterations, &doneIterations);
+            iterations -= Max(doneIterations, 1);
+
+            if (dtStatusFailed(status))
+            {
+                // Polygons visited by the search may have been removed by a tile rebuild, try once more from scratch
+                if (!request.restarted_)
+                {
+                    request.started_ = false;
+                    request.restarted_ = true;
+                }
+                else
+                    FinishRequest(slot, NAVPATH_FAILED);
+                continue;
+            }
+
+            if (dtStatusInProgress(status))
+                continue;
+
+            int numPolys = 0;
+            query->finalizeSlicedFindPath(pathData.polys_, &numPolys, MAX_POLYS);
+            if (!numPolys)
+            {
+                FinishRequest(slot, NAVPATH_FAILED);
+                continue;
+            }
+
+            Vector3 actualEnd = request.end_;
+            bool partial = pathData.polys_[numPolys - 1] != request.endRef_;
+
+            // If full path was not found, clamp end point to the end polygon
+            if (partial)
+                query->closestPointOnPoly(pathData.polys_[numPolys - 1], &request.end_.x_, &actualEnd.x_, 0);
+
+            int numPathPoints = 0;
+            query->findStraightPath(&request.start_.x_, &actualEnd.x_, pathData.polys_, numPolys,
+                &pathData.pathPoints_[0].x_, pathData.pathFlags_, pathData.pathPolys_, &numPathPoints, MAX_POLYS);
+
+            request.path_.Resize((unsigned)numPathPoints);
+            for (int i = 0; i < numPathPoints; ++i)
+            {
+                NavigationPathPoint& pt = request.path_[i];
+                pt.position_ = pathData.pathPoints_[i];
+                pt.flag_ = (NavigationPathPointFlag)pathData.pathFlags_[i];
+                pt.areaID_ = 0;
+            }
+
+            FinishRequest(slot, partial ? NAVPATH_PARTIAL : NAVPATH_SUCCESS);
+        }
+    }
+
+    /// Finish the active request of a slot.
+    void FinishRequest(NavigationPathSlot& slot, NavigationPathStatus status)
+    {
+        slot.active_->status_ = status;
+        slot.finished_.Push(slot.active_);
+        slot.active_ = 0;
+    }
+
+    /// Requests by handle.
+    HashMap<unsigned, NavigationPathRequest*> requests_;
+    /// Requests waiting for a slot, in request order.
+    PODVector<NavigationPathRequest*> pending_;
+    /// Per-thread search slots.
+    PODVector<NavigationPathSlot*> slots_;
+    /// Next request handle.
+    unsigned nextId_;
+    /// Number of waiting requests visible to the slots during the update.
+    unsigned numPending_;
+    /// Index of the next waiting request to take during the update.
+    std::atomic<unsigned> nextPending_;
+    /// A* iterations per slot during the update.
+    int iterations_;
+};
+
+static void UpdatePathSlotWork(const WorkItem* item, unsigned threadIndex)
+{
+    NavigationPathQueue* paths = reinterpret_cast<NavigationPathQueue*>(item->start_);
+    paths->UpdateSlot(*reinterpret_cast<NavigationPathSlot*>(item->aux_));
+}
+
 NavigationMesh::NavigationMesh(Context* context) :
     Component(context),
     navMesh_(0),
     navMeshQuery_(0),
     queryFilter_(new dtQueryFilter()),
     pathData_(new FindPathData()),
+    pathQueue_(new NavigationPathQueue()),
     tileSize_(DEFAULT_TILE_SIZE),
     cellSize_(DEFAULT_CELL_SIZE),
     cellHeight_(DEFAULT_CELL_HEIGHT),
@@ -125,7 +387,9 @@ NavigationMesh::NavigationMesh(Context* context) :
     partitionType_(NAVMESH_PARTITION_WATERSHED),
     keepInterResults_(false),
     drawOffMeshConnections_(false),
-    drawNavAreas_(false)
+    drawNavAreas_(false),
+    asyncBuildBudget_(DEFAULT_ASYNC_BUILD_BUDGET),
+    pathIterationBudget_(DEFAULT_PATH_ITERATION_BUDGET)
 {
 }
 
@@ -524,6 +788,97 @@ bool NavigationMesh::Build(const IntVector2& from, const IntVector2& to)
     return true;
 }
 
+bool NavigationMesh::BuildAsync(const BoundingBox& boundingBox)
+{
+    if (!node_)
+        return false;
+
+    if (!navMesh_)
+    {
+        ATOMIC_LOGERROR("Navigation mesh must first be built fully before it can be partially rebuilt");
+        return false;
+    }
+
+    BoundingBox localSpaceBox = boundingBox.Transformed(node_->GetWorldTransform().Inverse());
+
+    float tileEdgeLength = (float)tileSize_ * cellSize_;
+
+    int sx = Clamp((int)((localSpaceBox.min_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
+    int sz = Clamp((int)((localSpaceBox.min_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
+    int ex = Clamp((int)((localSpaceBox.max_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
+    int ez = Clamp((int)((localSpaceBox.max_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
+
+    return BuildAsync(IntVector2(sx, sz), IntVector2(ex, ez));
+}
+
+bool NavigationMesh::BuildAsync(const IntVector2& from, const IntVector2& to)
+{
+    Scene* scene = GetScene();
+    if (!node_ || !scene)
+        return false;
+
+    if (!navMesh_)
+    {
+        ATOMIC_LOGERROR("Navigation mesh must first be built fully before it can be partially rebuilt");
+        return false;
+    }
+
+    int sx = Max(from.x_, 0);
+    int sz = Max(from.y_, 0);
+    int ex = Min(to.x_, numTilesX_ - 1);
+    int ez = Min(to.y_, numTilesZ_ - 1);
+
+    for (int z = sz; z <= ez; ++z)
+    {
+        for (int x = sx; x <= ex; ++x)
+        {
+            IntVector2 tile(x, z);
+            if (!asyncQueuedTiles_.Contains(tile))
+            {
+                asyncQueuedTiles_.Insert(tile);
+                asyncTileQueue_.Push(tile);
+            }
+        }
+    }
+
+    if (!asyncTileQueue_.Empty())
+        UpdateEventSubscription();
+
+    return true;
+}
+
+void NavigationMesh::CancelAsyncBuild()
+{
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+
+    for (unsigned i = 0; i < asyncBuilds_.Size(); ++i)
+    {
+        SharedPtr<WorkItem> item = asyncBuilds_[i];
+
+        // A build already taken by a worker thread has to finish before its data can be freed. Yield while waiting, like the
+        // worker threads do when idle
+        if (queue && !queue->RemoveWorkItem(item))
+        {
+            while (!item->completed_)
+                Time::Sleep(0);
+        }
+
+        FinishAsyncTileBuild(item, false);
+    }
+
+    asyncBuilds_.Clear();
+    asyncBuildTiles_.Clear();
+    asyncTileQueue_.Clear();
+    asyncQueuedTiles_.Clear();
+
+    UpdateEventSubscription();
+}
+
+void NavigationMesh::SetAsyncBuildBudget(float ms)
+{
+    asyncBuildBudget_ = Max(ms, 0.0f);
+}
+
 PODVector<unsigned char> NavigationMesh::GetTileData(const IntVector2& tile) const
 {
     VectorBuffer ret;
@@ -712,32 +1067,203 @@ void NavigationMesh::FindPath(PODVector<NavigationPathPoint>& dest, const Vector
         NavigationPathPoint pt;
         pt.position_ = transform * pathData_->pathPoints_[i];
         pt.flag_ = (NavigationPathPointFlag)pathData_->pathFlags_[i];
+        pt.areaID_ = GetNavAreaID(pt.position_);
+
+        dest.Push(pt);
+    }
+}
+
+unsigned NavigationMesh::RequestPath(const Vector3& start, const Vector3& end, const Vector3& extents,
+    const dtQueryFilter* filter, bool sendEvent)
+{
+    if (!node_)
+        return 0;
+
+    // Navigation data is in local space. Transform path points from world to local
+    Matrix3x4 inverse = node_->GetWorldTransform().Inverse();
+
+    NavigationPathRequest* request = new NavigationPathRequest();
+    request->id_ = pathQueue_->nextId_++;
+    if (!pathQueue_->nextId_)
+        pathQueue_->nextId_ = 1;
+    request->start_ = inverse * start;
+    request->end_ = inverse * end;
+    request->extents_ = extents;
+    request->filter_ = filter ? *filter : *queryFilter_;
+    request->endRef_ = 0;
+    request->status_ = NAVPATH_PENDING;
+    request->started_ = false;
+    request->restarted_ = false;
+    request->sendEvent_ = sendEvent;
+
+    pathQueue_->requests_[request->id_] = request;
+    pathQueue_->pending_.Push(request);
+
+    UpdateEventSubscription();
+    return request->id_;
+}
+
+NavigationPathStatus NavigationMesh::GetPathStatus(unsigned request) const
+{
+    HashMap<unsigned, NavigationPathRequest*>::ConstIterator i = pathQueue_->requests_.Find(request);
+    return i != pathQueue_->requests_.End() ? i->second_->status_ : NAVPATH_INVALID;
+}
+
+NavigationPathStatus NavigationMesh::GetPathResult(unsigned request, PODVector<NavigationPathPoint>& dest)
+{
+    dest.Clear();
+
+    HashMap<unsigned, NavigationPathRequest*>::Iterator i = pathQueue_->requests_.Find(request);
+    if (i == pathQueue_->requests_.End())
+        return NAVPATH_INVALID;
+
+    NavigationPathRequest* pathRequest = i->second_;
+    NavigationPathStatus status = pathRequest->status_;
+    if (status == NAVPATH_PENDING)
+        return status;
+
+    dest = pathRequest->path_;
+    pathQueue_->requests_.Erase(i);
+    delete pathRequest;
+    return status;
+}
+
+void NavigationMesh::CancelPathRequest(unsigned request)
+{
+    HashMap<unsigned, NavigationPathRequest*>::Iterator i = pathQueue_->requests_.Find(request);
+    if (i == pathQueue_->requests_.End())
+        return;
+
+    NavigationPathRequest* pathRequest = i->second_;
+    pathQueue_->pending_.Remove(pathRequest);
+    for (unsigned j = 0; j < pathQueue_->slots_.Size(); ++j)
+    {
+        if (pathQueue_->slots_[j]->active_ == pathRequest)
+            pathQueue_->slots_[j]->active_ = 0;
+    }
+
+    pathQueue_->requests_.Erase(i);
+    delete pathRequest;
+}
 
-        // Walk through all NavAreas and find nearest
-        unsigned nearestNavAreaID = 0;       // 0 is the default nav area ID
-        float nearestDistance = M_LARGE_VALUE;
-        for (unsigned j = 0; j < areas_.Size(); j++)
+void NavigationMesh::UpdatePathRequests()
+{
+    NavigationPathQueue& paths = *pathQueue_;
+
+    unsigned numRequests = paths.pending_.Size();
+    for (unsigned i = 0; i < paths.slots_.Size(); ++i)
+    {
+        if (paths.slots_[i]->active_)
+            ++numRequests;
+    }
+
+    if (!navMesh_ || !node_ || !numRequests)
+        return;
+
+    ATOMIC_PROFILE(UpdatePathRequests);
+
+    // One slot per thread, each with its own query. Slots are not freed while a sliced search is in progress
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    unsigned numSlots = Max(Min(queue ? queue->GetNumThreads() + 1 : 1, numRequests), paths.slots_.Size());
+
+    while (paths.slots_.Size() < numSlots)
+    {
+        NavigationPathSlot* slot = new NavigationPathSlot();
+        slot->query_ = dtAllocNavMeshQuery();
+        if (!slot->query_ || dtStatusFailed(slot->query_->init(navMesh_, MAX_POLYS)))
+        {
+            ATOMIC_LOGERROR("Could not init navigation mesh query for path requests");
+            delete slot;
+            break;
+        }
+        paths.slots_.Push(slot);
+    }
+
+    if (paths.slots_.Empty())
+        return;
+
+    paths.numPending_ = paths.pending_.Size();
+    paths.nextPending_ = 0;
+    paths.iterations_ = Max((int)(pathIterationBudget_ / paths.slots_.Size()), 1);
+
+    if (queue && paths.slots_.Size() > 1)
+    {
+        for (unsigned i = 0; i < paths.slots_.Size(); ++i)
         {
-            NavArea* area = areas_[j].Get();
-            if (area && area->IsEnabledEffective())
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = UpdatePathSlotWork;
+            item->start_ = &paths;
+            item->aux_ = paths.slots_[i];
+            queue->AddWorkItem(item);
+        }
+        queue->Complete(M_MAX_UNSIGNED);
+    }
+    else
+        paths.UpdateSlot(*paths.slots_[0]);
+
+    // Remove the requests taken by the slots from the waiting list
+    paths.pending_.Erase(0, Min((unsigned)paths.nextPending_, paths.numPending_));
+
+    // Transform finished paths to world space. NavAreas are scene components, so this is done on the main thread
+    const Matrix3x4& transform = node_->GetWorldTransform();
+    PODVector<unsigned> completed;
+
+    for (unsigned i = 0; i < paths.slots_.Size(); ++i)
+    {
+        PODVector<NavigationPathRequest*>& finished = paths.slots_[i]->finished_;
+        for (unsigned j = 0; j < finished.Size(); ++j)
+        {
+            NavigationPathRequest* request = finished[j];
+            for (unsigned k = 0; k < request->path_.Size(); ++k)
             {
-                BoundingBox bb = area->GetWorldBoundingBox();
-                if (bb.IsInside(pt.position_) == INSIDE)
-                {
-                    Vector3 areaWorldCenter = area->GetNode()->GetWorldPosition();
-                    float distance = (areaWorldCenter - pt.position_).LengthSquared();
-                    if (distance < nearestDistance)
-                    {
-                        nearestDistance = distance;
-                        nearestNavAreaID = area->GetAreaID();
-                    }
-                }
+                NavigationPathPoint& pt = request->path_[k];
+                pt.position_ = transform * pt.position_;
+                pt.areaID_ = GetNavAreaID(pt.position_);
             }
+            if (request->sendEvent_)
+                completed.Push(request->id_);
         }
-        pt.areaID_ = (unsigned char)nearestNavAreaID;
+        finished.Clear();
+    }
 
-        dest.Push(pt);
+    // Event handlers may retrieve or cancel requests, so look each one up again. They may also remove the mesh
+    WeakPtr<NavigationMesh> self(this);
+    for (unsigned i = 0; i < completed.Size(); ++i)
+    {
+        NavigationPathStatus status = GetPathStatus(completed[i]);
+        if (status == NAVPATH_INVALID)
+            continue;
+
+        using namespace NavigationPathCompleted;
+        VariantMap& eventData = GetContext()->GetEventDataMap();
+        eventData[P_NODE] = GetNode();
+        eventData[P_MESH] = this;
+        eventData[P_REQUEST] = completed[i];
+        eventData[P_STATUS] = (int)status;
+        SendEvent(E_NAVIGATION_PATH_COMPLETED, eventData);
+        if (self.Expired())
+            return;
+
+        // The event is the only notification, so release a result that the handlers did not retrieve
+        CancelPathRequest(completed[i]);
+    }
+}
+
+void NavigationMesh::SetPathIterationBudget(unsigned iterations)
+{
+    pathIterationBudget_ = Max(iterations, 1U);
+}
+
+unsigned NavigationMesh::GetNumPendingPathRequests() const
+{
+    unsigned numRequests = pathQueue_->pending_.Size();
+    for (unsigned i = 0; i < pathQueue_->slots_.Size(); ++i)
+    {
+        if (pathQueue_->slots_[i]->active_)
+            ++numRequests;
     }
+    return numRequests;
 }
 
 Vector3 NavigationMesh::GetRandomPoint(const dtQueryFilter* filter, dtPolyRef* randomRef)
@@ -1302,18 +1828,16 @@ bool NavigationMesh::ReadTile(Deserializer& source, bool silent)
     return true;
 }
 
-bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z)
+void NavigationMesh::PrepareTileBuild(NavigationTileBuild& tileBuild, Vector<NavigationGeometryInfo>& geometryList, int x, int z)
 {
-    ATOMIC_PROFILE(BuildNavigationMeshTile);
-
-    // Remove previous tile (if any)
-    navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), 0, 0);
-
-    const BoundingBox tileBoundingBox = GetTileBoudningBox(IntVector2(x, z));
-
-    SimpleNavBuildData build;
-
-    rcConfig cfg;
+    tileBuild.tile_ = IntVector2(x, z);
+    tileBuild.tileBoundingBox_ = GetTileBoudningBox(tileBuild.tile_);
+    tileBuild.partitionType_ = partitionType_;
+    tileBuild.agentHeight_ = agentHeight_;
+    tileBuild.agentRadius_ = agentRadius_;
+    tileBuild.agentMaxClimb_ = agentMaxClimb_;
+
+    rcConfig& cfg = tileBuild.cfg_;
     memset(&cfg, 0, sizeof cfg);
     cfg.cs = cellSize_;
     cfg.ch = cellHeight_;
@@ -1333,18 +1857,32 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
     cfg.detailSampleDist = detailSampleDistance_ < 0.9f ? 0.0f : cellSize_ * detailSampleDistance_;
     cfg.detailSampleMaxError = cellHeight_ * detailSampleMaxError_;
 
-    rcVcopy(cfg.bmin, &tileBoundingBox.min_.x_);
-    rcVcopy(cfg.bmax, &tileBoundingBox.max_.x_);
+    rcVcopy(cfg.bmin, &tileBuild.tileBoundingBox_.min_.x_);
+    rcVcopy(cfg.bmax, &tileBuild.tileBoundingBox_.max_.x_);
     cfg.bmin[0] -= cfg.borderSize * cfg.cs;
     cfg.bmin[2] -= cfg.borderSize * cfg.cs;
     cfg.bmax[0] += cfg.borderSize * cfg.cs;
     cfg.bmax[2] += cfg.borderSize * cfg.cs;
 
+    // Geometry is read from scene components, so it is collected on the main thread
     BoundingBox expandedBox(*reinterpret_cast<Vector3*>(cfg.bmin), *reinterpret_cast<Vector3*>(cfg.bmax));
-    GetTileGeometry(&build, geometryList, expandedBox);
+    GetTileGeometry(&tileBuild.build_, geometryList, expandedBox);
+}
+
+bool NavigationMesh::BuildTileData(NavigationTileBuild& tileBuild)
+{
+    ATOMIC_PROFILE(BuildNavigationMeshTile);
+
+    SimpleNavBuildData& build = tileBuild.build_;
+    const rcConfig& cfg = tileBuild.cfg_;
+
+    tileBuild.success_ = false;
 
     if (build.vertices_.Empty() || build.indices_.Empty())
+    {
+        tileBuild.success_ = true;
         return true; // Nothing to do
+    }
 
     build.heightField_ = rcAllocHeightfield();
     if (!build.heightField_)
@@ -1396,7 +1934,7 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
         rcMarkBoxArea(build.ctx_, &build.navAreas_[i].bounds_.min_.x_, &build.navAreas_[i].bounds_.max_.x_,
             build.navAreas_[i].areaID_, *build.compactHeightField_);
 
-    if (this->partitionType_ == NAVMESH_PARTITION_WATERSHED)
+    if (tileBuild.partitionType_ == NAVMESH_PARTITION_WATERSHED)
     {
         if (!rcBuildDistanceField(build.ctx_, *build.compactHeightField_))
         {
@@ -1465,9 +2003,6 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
             build.polyMesh_->flags[i] = 0x1;
     }
 
-    unsigned char* navData = 0;
-    int navDataSize = 0;
-
     dtNavMeshCreateParams params;
     memset(&params, 0, sizeof params);
     params.verts = build.polyMesh_->verts;
@@ -1482,11 +2017,11 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
     params.detailVertsCount = build.polyMeshDetail_->nverts;
     params.detailTris = build.polyMeshDetail_->tris;
     params.detailTriCount = build.polyMeshDetail_->ntris;
-    params.walkableHeight = agentHeight_;
-    params.walkableRadius = agentRadius_;
-    params.walkableClimb = agentMaxClimb_;
-    params.tileX = x;
-    params.tileY = z;
+    params.walkableHeight = tileBuild.agentHeight_;
+    params.walkableRadius = tileBuild.agentRadius_;
+    params.walkableClimb = tileBuild.agentMaxClimb_;
+    params.tileX = tileBuild.tile_.x_;
+    params.tileY = tileBuild.tile_.y_;
     rcVcopy(params.bmin, build.polyMesh_->bmin);
     rcVcopy(params.bmax, build.polyMesh_->bmax);
     params.cs = cfg.cs;
@@ -1504,44 +2039,285 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
         params.offMeshConDir = &build.offMeshDir_[0];
     }
 
-    if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
+    if (!dtCreateNavMeshData(&params, &tileBuild.navData_, &tileBuild.navDataSize_))
     {
         ATOMIC_LOGERROR("Could not build navigation mesh tile data");
         return false;
     }
 
-    if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, 0)))
+    tileBuild.success_ = true;
+    return true;
+}
+
+bool NavigationMesh::CommitTileBuild(NavigationTileBuild& tileBuild)
+{
+    const IntVector2& tile = tileBuild.tile_;
+
+    // Remove previous tile (if any)
+    navMesh_->removeTile(navMesh_->getTileRefAt(tile.x_, tile.y_, 0), 0, 0);
+
+    if (!tileBuild.success_)
+        return false;
+
+    if (!tileBuild.navData_)
+        return true; // Nothing to do
+
+    if (dtStatusFailed(navMesh_->addTile(tileBuild.navData_, tileBuild.navDataSize_, DT_TILE_FREE_DATA, 0, 0)))
     {
         ATOMIC_LOGERROR("Failed to add navigation mesh tile");
-        dtFree(navData);
         return false;
     }
 
+    // The navigation mesh owns the data now
+    tileBuild.navData_ = 0;
+    tileBuild.navDataSize_ = 0;
+
     // Send a notification of the rebuild of this tile to anyone interested
     {
         using namespace NavigationAreaRebuilt;
         VariantMap& eventData = GetContext()->GetEventDataMap();
         eventData[P_NODE] = GetNode();
         eventData[P_MESH] = this;
-        eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
-        eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
+        eventData[P_BOUNDSMIN] = Variant(tileBuild.tileBoundingBox_.min_);
+        eventData[P_BOUNDSMAX] = Variant(tileBuild.tileBoundingBox_.max_);
         SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
     }
     return true;
 }
 
+bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z)
+{
+    NavigationTileBuild tileBuild;
+    PrepareTileBuild(tileBuild, geometryList, x, z);
+    BuildTileData(tileBuild);
+    return CommitTileBuild(tileBuild);
+}
+
+SharedPtr<WorkItem> NavigationMesh::PrepareAsyncTileBuild(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& tile)
+{
+    NavigationTileBuild* tileBuild = new NavigationTileBuild();
+    PrepareTileBuild(*tileBuild, geometryList, tile.x_, tile.y_);
+
+    // Not taken from the work queue pool, as the item is polled for completion over several frames
+    SharedPtr<WorkItem> item(new WorkItem());
+    item->priority_ = 0;
+    item->workFunction_ = BuildTileWork;
+    item->aux_ = tileBuild;
+    return item;
+}
+
+bool NavigationMesh::FinishAsyncTileBuild(WorkItem* item, bool commit)
+{
+    NavigationTileBuild* tileBuild = reinterpret_cast<NavigationTileBuild*>(item->aux_);
+    bool hasData = false;
+
+    if (commit)
+    {
+        hasData = tileBuild->navData_ != 0;
+        hasData &= CommitTileBuild(*tileBuild);
+    }
+
+    delete tileBuild;
+    item->aux_ = 0;
+    return hasData;
+}
+
+void NavigationMesh::UpdateAsyncBuild()
+{
+    if (asyncBuilds_.Empty() && asyncTileQueue_.Empty())
+        return;
+
+    ATOMIC_PROFILE(UpdateAsyncNavigationBuild);
+
+    HiresTimer timer;
+    long long budget = (long long)(asyncBuildBudget_ * 1000.0f);
+
+    // Swap in finished tiles. At least one per frame so that a small budget still makes progress. Tile event handlers may
+    // remove the mesh
+    WeakPtr<NavigationMesh> self(this);
+    unsigned numCommitted = 0;
+    for (unsigned i = 0; i < asyncBuilds_.Size();)
+    {
+        if (!asyncBuilds_[i]->completed_)
+        {
+            ++i;
+            continue;
+        }
+        if (numCommitted && timer.GetUSec(false) >= budget)
+            break;
+
+        // Remove from the in-progress list first, as event handlers may queue or cancel rebuilds
+        SharedPtr<WorkItem> item = asyncBuilds_[i];
+        IntVector2 tile = asyncBuildTiles_[i];
+        asyncBuilds_.Erase(i);
+        asyncBuildTiles_.Erase(i);
+
+        bool hasData = FinishAsyncTileBuild(item, true);
+        ++numCommitted;
+
+        // NavigationTileRemoved has the same parameters
+        using namespace NavigationTileAdded;
+        VariantMap& tileEventData = GetContext()->GetEventDataMap();
+        tileEventData[P_NODE] = GetNode();
+        tileEventData[P_MESH] = this;
+        tileEventData[P_TILE] = tile;
+        SendEvent(hasData ? E_NAVIGATION_TILE_ADDED : E_NAVIGATION_TILE_REMOVED, tileEventData);
+        if (self.Expired())
+            return;
+    }
+
+    // Start queued tiles. Geometry is collected on the main thread, so this also counts against the budget
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    unsigned maxBuilds = queue ? (queue->GetNumThreads() + 1) * TILE_BUILDS_PER_THREAD : 1;
+
+    Vector<NavigationGeometryInfo> geometryList;
+    bool geometryCollected = false;
+
+    for (unsigned i = 0; i < asyncTileQueue_.Size() && asyncBuilds_.Size() < maxBuilds;)
+    {
+        if (!asyncBuilds_.Empty() && timer.GetUSec(false) >= budget)
+            break;
+
+        // A tile requested again while it is being rebuilt waits until the running build has been swapped in
+        IntVector2 tile = asyncTileQueue_[i];
+        if (asyncBuildTiles_.Contains(tile))
+        {
+            ++i;
+            continue;
+        }
+
+        if (!geometryCollected)
+        {
+            CollectGeometries(geometryList);
+            geometryCollected = true;
+        }
+
+        asyncTileQueue_.Erase(i);
+        asyncQueuedTiles_.Erase(tile);
+
+        SharedPtr<WorkItem> item = PrepareAsyncTileBuild(geometryList, tile);
+        asyncBuilds_.Push(item);
+        asyncBuildTiles_.Push(tile);
+
+        if (queue)
+            queue->AddWorkItem(item);
+        else
+        {
+            item->workFunction_(item, 0);
+            item->completed_ = true;
+        }
+    }
+}
+
+void NavigationMesh::UpdateEventSubscription()
+{
+    Scene* scene = GetScene();
+    bool hasWork = !asyncBuilds_.Empty() || !asyncTileQueue_.Empty() || GetNumPendingPathRequests();
+
+    if (scene && hasWork)
+        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, ATOMIC_HANDLER(NavigationMesh, HandleScenePostUpdate));
+    else
+        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+}
+
+void NavigationMesh::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    // Event handlers called from the updates may remove the mesh, so check before touching it again
+    WeakPtr<NavigationMesh> self(this);
+
+    // Path searches run before tiles are swapped in, so that worker threads never see the navigation mesh change
+    UpdatePathRequests();
+    if (self.Expired())
+        return;
+    UpdateAsyncBuild();
+    if (self.Expired())
+        return;
+
+    UpdateEventSubscription();
+}
+
+unsigned char NavigationMesh::GetNavAreaID(const Vector3& worldPosition) const
+{
+    // Walk through all NavAreas and find nearest
+    unsigned nearestNavAreaID = 0;       // 0 is the default nav area ID
+    float nearestDistance = M_LARGE_VALUE;
+    for (unsigned j = 0; j < areas_.Size(); j++)
+    {
+        NavArea* area = areas_[j].Get();
+        if (area && area->IsEnabledEffective())
+        {
+            BoundingBox bb = area->GetWorldBoundingBox();
+            if (bb.IsInside(worldPosition) == INSIDE)
+            {
+                Vector3 areaWorldCenter = area->GetNode()->GetWorldPosition();
+                float distance = (areaWorldCenter - worldPosition).LengthSquared();
+                if (distance < nearestDistance)
+                {
+                    nearestDistance = distance;
+                    nearestNavAreaID = area->GetAreaID();
+                }
+            }
+        }
+    }
+    return (unsigned char)nearestNavAreaID;
+}
+
 unsigned NavigationMesh::BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
 {
+    ATOMIC_PROFILE(BuildNavigationMeshTiles);
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+
+    // Bound the tiles in flight, each holds a copy of its input geometry
+    unsigned maxBuilds = queue ? (queue->GetNumThreads() + 1) * TILE_BUILDS_PER_THREAD : 1;
+
     unsigned numTiles = 0;
+    PODVector<NavigationTileBuild*> builds;
 
-    for (int z = from.y_; z <= to.y_; ++z)
+    int x = from.x_;
+    int z = from.y_;
+
+    while (z <= to.y_)
     {
-        for (int x = from.x_; x <= to.x_; ++x)
+        // Collect geometry on the main thread, workers start on each tile as soon as it is queued
+        while (z <= to.y_ && builds.Size() < maxBuilds)
         {
-            if (BuildTile(geometryList, x, z))
+            NavigationTileBuild* tileBuild = new NavigationTileBuild();
+            PrepareTileBuild(*tileBuild, geometryList, x, z);
+            builds.Push(tileBuild);
+
+            if (queue)
+            {
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = BuildTileWork;
+                item->aux_ = tileBuild;
+                queue->AddWorkItem(item);
+            }
+            else
+                BuildTileData(*tileBuild);
+
+            if (++x > to.x_)
+            {
+                x = from.x_;
+                ++z;
+            }
+        }
+
+        if (queue)
+            queue->Complete(M_MAX_UNSIGNED);
+
+        // Commits to the Detour navigation mesh happen only here, in tile order
+        for (unsigned i = 0; i < builds.Size(); ++i)
+        {
+            if (CommitTileBuild(*builds[i]))
                 ++numTiles;
+            delete builds[i];
         }
+
+        builds.Clear();
     }
+
     return numTiles;
 }
 
@@ -1571,6 +2347,10 @@ bool NavigationMesh::InitializeQuery()
 
 void NavigationMesh::ReleaseNavigationMesh()
 {
+    CancelAsyncBuild();
+    // Queries refer to the navigation mesh, searches in progress start over on the next one
+    pathQueue_->ReleaseSlots();
+
     dtFreeNavMesh(navMesh_);
     navMesh_ = 0;
 
@@ -51,7 +51,10 @@ class Geometry;
 class NavArea;
 
 struct FindPathData;
+struct NavigationPathQueue;
 struct NavBuildData;
+struct NavigationTileBuild;
+struct WorkItem;
 
 /// Description of a navigation mesh geometry component, with transform and bounds information.
 struct NavigationGeometryInfo
@@ -86,6 +89,16 @@ struct ATOMIC_API NavigationPathPoint
     unsigned char areaID_;
 };
 
+/// Status of a queued path request.
+enum NavigationPathStatus
+{
+    NAVPATH_INVALID = 0,
+    NAVPATH_PENDING,
+    NAVPATH_SUCCESS,
+    NAVPATH_PARTIAL,
+    NAVPATH_FAILED
+};
+
 /// Navigation mesh component. Collects the navigation geometry from child nodes with the Navigable component and responds to path queries.
 class ATOMIC_API NavigationMesh : public Component
 {
@@ -142,6 +155,18 @@ public:
     virtual bool Build(const BoundingBox& boundingBox);
     /// Rebuild part of the navigation mesh in the rectangular area. Return true if successful.
     virtual bool Build(const IntVector2& from, const IntVector2& to);
+    /// Queue a background rebuild of the tiles touching the world-space bounding box. Overlapping requests are coalesced. Return true if successful.
+    bool BuildAsync(const BoundingBox& boundingBox);
+    /// Queue a background rebuild of the tiles in the rectangular area. Overlapping requests are coalesced. Return true if successful.
+    bool BuildAsync(const IntVector2& from, const IntVector2& to);
+    /// Cancel queued and unfinished background tile rebuilds.
+    void CancelAsyncBuild();
+    /// Set the main thread time budget in milliseconds per frame for starting background tile rebuilds and swapping in finished tiles.
+    void SetAsyncBuildBudget(float ms);
+    /// Return the main thread time budget in milliseconds per frame for background tile rebuilds.
+    float GetAsyncBuildBudget() const { return asyncBuildBudget_; }
+    /// Return number of tiles queued or being rebuilt in the background.
+    unsigned GetNumAsyncBuildTiles() const { return asyncTileQueue_.Size() + asyncBuilds_.Size(); }
     /// Return tile data.
     virtual PODVector<unsigned char> GetTileData(const IntVector2& tile) const;
     /// Add tile to navigation mesh.
@@ -169,6 +194,23 @@ public:
     void FindPath
         (PODVector<NavigationPathPoint>& dest, const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE,
             const dtQueryFilter* filter = 0);
+    /// Queue a path request between world space points. The search is advanced in slices over the following frames, in parallel if the work queue has threads. Return a request handle, or 0 if failed. If sendEvent is true, E_NAVIGATION_PATH_COMPLETED is sent when the search finishes and the request is released after the event, so the result must be retrieved with GetPathResult() from the event handler. Otherwise the caller must release the request with GetPathResult() or CancelPathRequest().
+    unsigned RequestPath(const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE,
+        const dtQueryFilter* filter = 0, bool sendEvent = false);
+    /// Return status of a path request.
+    NavigationPathStatus GetPathStatus(unsigned request) const;
+    /// Return the world space path of a finished path request and release the request. Return the request status.
+    NavigationPathStatus GetPathResult(unsigned request, PODVector<NavigationPathPoint>& dest);
+    /// Cancel and release a path request.
+    void CancelPathRequest(unsigned request);
+    /// Advance queued path requests by the iteration budget. Called automatically on scene post-update.
+    void UpdatePathRequests();
+    /// Set the total number of A* iterations per frame for queued path requests.
+    void SetPathIterationBudget(unsigned iterations);
+    /// Return the total number of A* iterations per frame for queued path requests.
+    unsigned GetPathIterationBudget() const { return pathIterationBudget_; }
+    /// Return number of unfinished path requests.
+    unsigned GetNumPendingPathRequests() const;
     /// Return a random point on the navigation mesh.
     Vector3 GetRandomPoint(const dtQueryFilter* filter = 0, dtPolyRef* randomRef = 0);
     /// Return a random point on the navigation mesh within a circle. The circle radius is only a guideline and in practice the returned point may be further away.
@@ -272,6 +314,9 @@ public:
     /// Return whether to draw NavArea components.
     bool GetDrawNavAreas() const { return drawNavAreas_; }
 
+    /// Run the Recast build of a prepared tile. Does not touch the navigation mesh and may be called from a worker thread. Return true if successful.
+    static bool BuildTileData(NavigationTileBuild& tileBuild);
+
 private:
     /// Write tile data.
     void WriteTile(Serializer& dest, int x, int z) const;
@@ -289,8 +334,24 @@ protected:
     void AddTriMeshGeometry(NavBuildData* build, Geometry* geometry, const Matrix3x4& transform);
     /// Build one tile of the navigation mesh. Return true if successful.
     virtual bool BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z);
-    /// Build tiles in the rectangular area. Return number of built tiles.
+    /// Collect the geometry and build configuration of one tile. Called from the main thread.
+    void PrepareTileBuild(NavigationTileBuild& tileBuild, Vector<NavigationGeometryInfo>& geometryList, int x, int z);
+    /// Replace a tile of the navigation mesh with the built data. Called from the main thread. Return true if successful.
+    bool CommitTileBuild(NavigationTileBuild& tileBuild);
+    /// Build tiles in the rectangular area, in parallel if the work queue has threads. Return number of built tiles.
     unsigned BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Prepare a background rebuild of one tile. Return a work item for it, which is not yet queued.
+    virtual SharedPtr<WorkItem> PrepareAsyncTileBuild(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& tile);
+    /// Commit or discard a finished background tile rebuild and free it. Return whether the tile has navigation data after a commit.
+    virtual bool FinishAsyncTileBuild(WorkItem* item, bool commit);
+    /// Start queued background tile rebuilds and swap in finished tiles within the time budget.
+    void UpdateAsyncBuild();
+    /// Subscribe to scene post-update while there are queued path requests or tile rebuilds, unsubscribe otherwise.
+    void UpdateEventSubscription();
+    /// Handle scene post-update to advance path requests and tile rebuilds.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Return the ID of the nearest enabled NavArea containing a world space point, or 0 if none.
+    unsigned char GetNavAreaID(const Vector3& worldPosition) const;
     /// Ensure that the navigation mesh query is initialized. Return true if successful.
     bool InitializeQuery();
     /// Release the navigation mesh and the query.
@@ -306,6 +367,8 @@ protected:
     UniquePtr<dtQueryFilter> queryFilter_;
     /// Temporary data for finding a path.
     UniquePtr<FindPathData> pathData_;
+    /// Queued path requests and per-thread queries.
+    UniquePtr<NavigationPathQueue> pathQueue_;
     /// Tile size.
     int tileSize_;
     /// Cell size.
@@ -350,6 +413,18 @@ protected:
     bool drawNavAreas_;
     /// NavAreas for this NavMesh
     Vector<WeakPtr<NavArea> > areas_;
+    /// Tiles waiting for a background rebuild, in request order.
+    PODVector<IntVector2> asyncTileQueue_;
+    /// Tiles waiting for a background rebuild, for coalescing requests.
+    HashSet<IntVector2> asyncQueuedTiles_;
+    /// Background tile rebuilds in progress, in start order.
+    Vector<SharedPtr<WorkItem> > asyncBuilds_;
+    /// Tiles being rebuilt in the background, matching the work items.
+    PODVector<IntVector2> asyncBuildTiles_;
+    /// Main thread time budget in milliseconds per frame for background tile rebuilds.
+    float asyncBuildBudget_;
+    /// Total number of A* iterations per frame for queued path requests.
+    unsigned pathIterationBudget_;
 };
 
 /// Register Navigation library objects.
@@ -27,11 +27,39 @@
 namespace Atomic
 {
 
+class Node;
+class RigidBody;
+
 /// Physics world is about to be stepped.
 ATOMIC_EVENT(E_PHYSICSPRESTEP, PhysicsPreStep)
 {
     ATOMIC_PARAM(P_WORLD, World);                  // PhysicsWorld pointer
     ATOMIC_PARAM(P_TIMESTEP, TimeStep);            // float
+
+    /// Typed payload. Sent with Object::SendTypedEvent. The world is either a PhysicsWorld or a PhysicsWorld2D.
+    struct Payload
+    {
+        /// Convert to event parameters.
+        void ToVariantMap(VariantMap& dest) const
+        {
+            dest[P_WORLD] = world_;
+            dest[P_TIMESTEP] = timeStep_;
+        }
+
+        /// Fill from event parameters.
+        void FromVariantMap(const VariantMap& source)
+        {
+            const Variant* world = source[P_WORLD];
+            const Variant* timeStep = source[P_TIMESTEP];
+            world_ = world ? static_cast<Object*>(world->GetPtr()) : 0;
+            timeStep_ = timeStep ? timeStep->GetFloat() : 0.0f;
+        }
+
+        /// Physics world.
+        Object* world_;
+        /// Time step.
+        float timeStep_;
+    };
 }
 
 /// Physics world has been stepped.
@@ -94,6 +122,26 @@ ATOMIC_EVENT(E_NODECOLLISION, NodeCollision)
     ATOMIC_PARAM(P_OTHERBODY, OtherBody);          // RigidBody pointer
     ATOMIC_PARAM(P_TRIGGER, Trigger);              // bool
     ATOMIC_PARAM(P_CONTACTS, Contacts);            // Buffer containing position (Vector3), normal (Vector3), distance (float), impulse (float) for each contact
+
+    /// Typed payload. Sent with Object::SendTypedEvent.
+    struct ATOMIC_API Payload
+    {
+        /// Convert to event parameters.
+        void ToVariantMap(VariantMap& dest) const;
+        /// Fill from event parameters.
+        void FromVariantMap(const VariantMap& source);
+
+        /// Rigid body of the node sending the event.
+        RigidBody* body_;
+        /// Other node.
+        Node* otherNode_;
+        /// Other rigid body.
+        RigidBody* otherBody_;
+        /// Contact buffer, valid during the event only.
+        const PODVector<unsigned char>* contacts_;
+        /// Trigger flag.
+        bool trigger_;
+    };
 }
 
 /// Node's physics collision ended. Sent by scene nodes participating in a collision.
@@ -803,10 +803,10 @@ void PhysicsWorld::PreStep(float timeStep)
     // Send pre-step event
     using namespace PhysicsPreStep;
 
-    VariantMap& eventData = GetEventDataMap();
-    eventData[P_WORLD] = this;
-    eventData[P_TIMESTEP] = timeStep;
-    SendEvent(E_PHYSICSPRESTEP, eventData);
+    Payload payload;
+    payload.world_ = this;
+    payload.timeStep_ = timeStep;
+    SendTypedEvent(E_PHYSICSPRESTEP, payload);
 
     // ATOMIC BEGIN
     // Start profiling block for the actual simulation step
@@ -955,20 +955,23 @@ void PhysicsWorld::SendCollisionEvents()
             if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
                 continue;
 
-            nodeCollisionData_[NodeCollision::P_BODY] = bodyA;
-            nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeB;
-            nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyB;
-            nodeCollisionData_[NodeCollision::P_TRIGGER] = trigger;
-            nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
+            // The ongoing node collision event is sent with a typed payload, as it is sent for every contact pair each step
+            NodeCollision::Payload nodeCollision;
+            nodeCollision.body_ = bodyA;
+            nodeCollision.otherNode_ = nodeB;
+            nodeCollision.otherBody_ = bodyB;
+            nodeCollision.contacts_ = &contacts_.GetBuffer();
+            nodeCollision.trigger_ = trigger;
 
             if (newCollision)
             {
+                nodeCollision.ToVariantMap(nodeCollisionData_);
                 nodeA->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
                 if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
                     continue;
             }
 
-            nodeA->SendEvent(E_NODECOLLISION, nodeCollisionData_);
+            nodeA->SendTypedEvent(E_NODECOLLISION, nodeCollision);
             if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
                 continue;
 
@@ -999,19 +1002,20 @@ void PhysicsWorld::SendCollisionEvents()
                 }
             }
 
-            nodeCollisionData_[NodeCollision::P_BODY] = bodyB;
-            nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeA;
-            nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyA;
-            nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
+            nodeCollision.body_ = bodyB;
+            nodeCollision.otherNode_ = nodeA;
+            nodeCollision.otherBody_ = bodyA;
+            nodeCollision.contacts_ = &contacts_.GetBuffer();
 
             if (newCollision)
             {
+                nodeCollision.ToVariantMap(nodeCollisionData_);
                 nodeB->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
                 if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
                     continue;
             }
 
-            nodeB->SendEvent(E_NODECOLLISION, nodeCollisionData_);
+            nodeB->SendTypedEvent(E_NODECOLLISION, nodeCollision);
         }
     }
 
@@ -1077,6 +1081,32 @@ void PhysicsWorld::SendCollisionEvents()
     previousCollisions_ = currentCollisions_;
 }
 
+void NodeCollision::Payload::ToVariantMap(VariantMap& dest) const
+{
+    dest[P_BODY] = body_;
+    dest[P_OTHERNODE] = otherNode_;
+    dest[P_OTHERBODY] = otherBody_;
+    dest[P_TRIGGER] = trigger_;
+    if (contacts_)
+        dest[P_CONTACTS] = *contacts_;
+    else
+        dest[P_CONTACTS] = PODVector<unsigned char>();
+}
+
+void NodeCollision::Payload::FromVariantMap(const VariantMap& source)
+{
+    const Variant* body = source[P_BODY];
+    const Variant* otherNode = source[P_OTHERNODE];
+    const Variant* otherBody = source[P_OTHERBODY];
+    const Variant* trigger = source[P_TRIGGER];
+    const Variant* contacts = source[P_CONTACTS];
+    body_ = body ? static_cast<RigidBody*>(body->GetPtr()) : 0;
+    otherNode_ = otherNode ? static_cast<Node*>(otherNode->GetPtr()) : 0;
+    otherBody_ = otherBody ? static_cast<RigidBody*>(otherBody->GetPtr()) : 0;
+    trigger_ = trigger ? trigger->GetBool() : false;
+    contacts_ = contacts ? &contacts->GetBuffer() : 0;
+}
+
 void RegisterPhysicsLibrary(Context* context)
 {
     CollisionShape::RegisterObject(context);
@@ -26,6 +26,8 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/ProcessUtils.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Resource/BackgroundLoader.h"
 #include "../Resource/ResourceCache.h"
@@ -36,80 +38,170 @@
 namespace Atomic
 {
 
+/// Maximum total size of file contents the I/O stage reads ahead of the decode threads.
+static const unsigned MAX_READ_AHEAD_SIZE = 64 * 1024 * 1024;
+
+/// Background loader thread running either the I/O or the decode stage.
+class BackgroundLoaderThread : public Thread, public RefCounted
+{
+    ATOMIC_REFCOUNTED(BackgroundLoaderThread)
+
+public:
+    /// Construct.
+    BackgroundLoaderThread(BackgroundLoader* owner, bool readFiles) :
+        owner_(owner),
+        readFiles_(readFiles)
+    {
+    }
+
+    /// Run the stage loop.
+    virtual void ThreadFunction()
+    {
+        if (readFiles_)
+            owner_->ReadFiles();
+        else
+            owner_->DecodeResources();
+    }
+
+private:
+    /// Background loader.
+    BackgroundLoader* owner_;
+    /// I/O stage flag.
+    bool readFiles_;
+};
+
+/// Return whether an item should be taken from a priority queue after another.
+static inline bool LoadsAfter(const BackgroundLoadItem* lhs, const BackgroundLoadItem* rhs)
+{
+    if (lhs->priority_ != rhs->priority_)
+        return lhs->priority_ < rhs->priority_;
+    else
+        return lhs->order_ > rhs->order_;
+}
+
 BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
-    owner_(owner)
+    owner_(owner),
+    numDecodeThreads_((unsigned)Clamp((int)GetNumPhysicalCPUs() - 1, 1, 4)),
+    nextOrder_(0),
+    readAheadSize_(0),
+    stopping_(false)
 {
 }
 
 BackgroundLoader::~BackgroundLoader()
 {
+    StopThreads();
+
     MutexLock lock(backgroundLoadMutex_);
 
+    readQueue_.Clear();
+    decodeQueue_.Clear();
     backgroundLoadQueue_.Clear();
 }
 
-void BackgroundLoader::ThreadFunction()
+void BackgroundLoader::ReadFiles()
 {
-    while (shouldRun_)
+    while (!stopping_)
     {
         backgroundLoadMutex_.Acquire();
-
-        // Search for a queued resource that has not been loaded yet
-        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
-        while (i != backgroundLoadQueue_.End())
+        BackgroundLoadItem* item = 0;
+        // Do not read further ahead while the decode threads are behind, to bound the memory held by read files.
+        // A single file larger than the limit is still read once everything before it has been decoded
+        if (!readQueue_.Empty() && readAheadSize_ < MAX_READ_AHEAD_SIZE)
         {
-            if (i->second_.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
-                break;
-            else
-                ++i;
+            item = readQueue_.Back();
+            readQueue_.Pop();
         }
+        backgroundLoadMutex_.Release();
 
-        if (i == backgroundLoadQueue_.End())
+        if (!item)
         {
-            // No resources to load found
-            backgroundLoadMutex_.Release();
-            Time::Sleep(5);
+            readCondition_.Wait();
+            continue;
         }
-        else
+
+        // We can be sure that the item is not removed from the queue as long as it is in the "queued" or "loading" state.
+        // Read the whole file here so that the decode threads never stall on disk
+        Resource* resource = item->resource_;
+        bool success = false;
+        SharedPtr<File> file = owner_->GetFile(resource->GetName(), item->sendEventOnFailure_);
+        if (file)
         {
-            BackgroundLoadItem& item = i->second_;
-            Resource* resource = item.resource_;
-            // We can be sure that the item is not removed from the queue as long as it is in the
-            // "queued" or "loading" state
-            backgroundLoadMutex_.Release();
+            ATOMIC_PROFILE(ReadBackgroundLoadFile);
+
+            item->dataSize_ = file->GetSize();
+            item->data_ = new unsigned char[item->dataSize_];
+            success = file->Read(item->data_.Get(), item->dataSize_) == item->dataSize_;
 
-            bool success = false;
-            SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
-            if (file)
+            // Resources such as shaders check the modification time of their source, which the buffer has to carry
+            if (!file->IsPackaged())
             {
-                resource->SetAsyncLoadState(ASYNC_LOADING);
-                success = resource->BeginLoad(*file);
+                FileSystem* fileSystem = owner_->GetSubsystem<FileSystem>();
+                item->lastModifiedTime_ = fileSystem->GetLastModifiedTime(owner_->GetResourceFileName(file->GetName()));
             }
+        }
 
-            // Process dependencies now
-            // Need to lock the queue again when manipulating other entries
-            Pair<StringHash, StringHash> key = MakePair(resource->GetType(), resource->GetNameHash());
-            backgroundLoadMutex_.Acquire();
-            if (item.dependents_.Size())
-            {
-                for (HashSet<Pair<StringHash, StringHash> >::Iterator i = item.dependents_.Begin();
-                     i != item.dependents_.End(); ++i)
-                {
-                    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
-                    if (j != backgroundLoadQueue_.End())
-                        j->second_.dependencies_.Erase(key);
-                }
+        MutexLock lock(backgroundLoadMutex_);
+        if (success)
+        {
+            readAheadSize_ += item->dataSize_;
+            PushItem(decodeQueue_, item);
+            decodeCondition_.Set();
+        }
+        else
+        {
+            item->data_.Reset();
+            CompleteItem(*item, false);
+        }
+    }
 
-                item.dependents_.Clear();
-            }
+    readCondition_.Set();
+}
 
-            resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
-            backgroundLoadMutex_.Release();
+void BackgroundLoader::DecodeResources()
+{
+    while (!stopping_)
+    {
+        backgroundLoadMutex_.Acquire();
+        BackgroundLoadItem* item = 0;
+        if (!decodeQueue_.Empty())
+        {
+            item = decodeQueue_.Back();
+            decodeQueue_.Pop();
+            item->resource_->SetAsyncLoadState(ASYNC_LOADING);
+
+            // Conditions do not count signals, so pass the wakeup on while there is more work
+            if (!decodeQueue_.Empty())
+                decodeCondition_.Set();
         }
+        backgroundLoadMutex_.Release();
+
+        if (!item)
+        {
+            decodeCondition_.Wait();
+            continue;
+        }
+
+        Resource* resource = item->resource_;
+        BackgroundLoadBuffer buffer(item->data_.Get(), item->dataSize_, resource->GetName(), item->lastModifiedTime_);
+        bool success = resource->BeginLoad(buffer);
+        item->data_.Reset();
+
+        MutexLock lock(backgroundLoadMutex_);
+        // Let the I/O stage continue if it was waiting for the decode threads to catch up
+        bool readAheadFull = readAheadSize_ >= MAX_READ_AHEAD_SIZE;
+        readAheadSize_ -= item->dataSize_;
+        if (readAheadFull && readAheadSize_ < MAX_READ_AHEAD_SIZE)
+            readCondition_.Set();
+
+        CompleteItem(*item, success);
     }
+
+    // Wake up the next decode thread so that it also sees the stop flag
+    decodeCondition_.Set();
 }
 
-bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller)
+bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller, int priority)
 {
     StringHash nameHash(name);
     Pair<StringHash, StringHash> key = MakePair(type, nameHash);
@@ -122,6 +214,10 @@ bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool s
 
     BackgroundLoadItem& item = backgroundLoadQueue_[key];
     item.sendEventOnFailure_ = sendEventOnFailure;
+    item.dataSize_ = 0;
+    item.lastModifiedTime_ = 0;
+    item.priority_ = priority;
+    item.order_ = nextOrder_++;
 
     // Make sure the pointer is non-null and is a Resource subclass
     item.resource_ = DynamicCast<Resource>(owner_->GetContext()->CreateObject(type));
@@ -157,19 +253,55 @@ bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool s
             BackgroundLoadItem& callerItem = j->second_;
             item.dependents_.Insert(callerKey);
             callerItem.dependencies_.Insert(key);
+
+            // The caller can not finish before its dependencies, so they load at least as urgently
+            item.priority_ = Max(item.priority_, callerItem.priority_);
         }
         else
             ATOMIC_LOGWARNING("Resource " + caller->GetName() +
                        " requested for a background loaded resource but was not in the background load queue");
     }
 
-    // Start the background loader thread now
-    if (!IsStarted())
-        Run();
+    PushItem(readQueue_, &item);
+    readCondition_.Set();
+
+    // Start the background loader threads now
+    if (threads_.Empty())
+        StartThreads();
 
     return true;
 }
 
+void BackgroundLoader::SetPriority(StringHash type, StringHash nameHash, int priority)
+{
+    MutexLock lock(backgroundLoadMutex_);
+
+    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(MakePair(type, nameHash));
+    if (i == backgroundLoadQueue_.End())
+        return;
+
+    BackgroundLoadItem& item = i->second_;
+    if (RemoveItem(readQueue_, &item))
+    {
+        item.priority_ = priority;
+        PushItem(readQueue_, &item);
+    }
+    else if (RemoveItem(decodeQueue_, &item))
+    {
+        item.priority_ = priority;
+        PushItem(decodeQueue_, &item);
+    }
+    else
+        item.priority_ = priority;
+
+    for (HashSet<Pair<StringHash, StringHash> >::Iterator j = item.dependencies_.Begin(); j != item.dependencies_.End(); ++j)
+    {
+        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator k = backgroundLoadQueue_.Find(*j);
+        if (k != backgroundLoadQueue_.End())
+            RaisePriority(k->second_, priority);
+    }
+}
+
 void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 {
     backgroundLoadMutex_.Acquire();
@@ -179,6 +311,8 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(key);
     if (i != backgroundLoadQueue_.End())
     {
+        // The resource is needed right now, so move it and its dependencies to the front of the queues
+        RaisePriority(i->second_, M_MAX_INT);
         backgroundLoadMutex_.Release();
 
         {
@@ -188,12 +322,16 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 
             for (;;)
             {
+                backgroundLoadMutex_.Acquire();
                 unsigned numDeps = i->second_.dependencies_.Size();
                 AsyncLoadState state = resource->GetAsyncLoadState();
+                backgroundLoadMutex_.Release();
+
                 if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
                 {
+                    // Woken up whenever any resource completes its decode stage
                     didWait = true;
-                    Time::Sleep(1);
+                    completeCondition_.Wait();
                 }
                 else
                     break;
@@ -217,37 +355,49 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 
 void BackgroundLoader::FinishResources(int maxMs)
 {
-    if (IsStarted())
-    {
-        HiresTimer timer;
+    HiresTimer timer;
 
-        backgroundLoadMutex_.Acquire();
+    backgroundLoadMutex_.Acquire();
 
-        for (HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
-             i != backgroundLoadQueue_.End();)
+    for (HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
+         i != backgroundLoadQueue_.End();)
+    {
+        Resource* resource = i->second_.resource_;
+        unsigned numDeps = i->second_.dependencies_.Size();
+        AsyncLoadState state = resource->GetAsyncLoadState();
+        if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
+            ++i;
+        else
         {
-            Resource* resource = i->second_.resource_;
-            unsigned numDeps = i->second_.dependencies_.Size();
-            AsyncLoadState state = resource->GetAsyncLoadState();
-            if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
-                ++i;
-            else
-            {
-                // Finishing a resource may need it to wait for other resources to load, in which case we can not
-                // hold on to the mutex
-                backgroundLoadMutex_.Release();
-                FinishBackgroundLoading(i->second_);
-                backgroundLoadMutex_.Acquire();
-                i = backgroundLoadQueue_.Erase(i);
-            }
-
-            // Break when the time limit passed so that we keep sufficient FPS
-            if (timer.GetUSec(false) >= maxMs * 1000)
-                break;
+            // Finishing a resource may need it to wait for other resources to load, in which case we can not
+            // hold on to the mutex
+            backgroundLoadMutex_.Release();
+            FinishBackgroundLoading(i->second_);
+            backgroundLoadMutex_.Acquire();
+            i = backgroundLoadQueue_.Erase(i);
         }
 
-        backgroundLoadMutex_.Release();
+        // Break when the time limit passed so that we keep sufficient FPS
+        if (timer.GetUSec(false) >= maxMs * 1000)
+            break;
     }
+
+    backgroundLoadMutex_.Release();
+}
+
+void BackgroundLoader::SetNumDecodeThreads(unsigned num)
+{
+    num = Max(num, 1U);
+    if (num == numDecodeThreads_)
+        return;
+
+    bool wasRunning = !threads_.Empty();
+    StopThreads();
+
+    MutexLock lock(backgroundLoadMutex_);
+    numDecodeThreads_ = num;
+    if (wasRunning)
+        StartThreads();
 }
 
 unsigned BackgroundLoader::GetNumQueuedResources() const
@@ -256,6 +406,112 @@ unsigned BackgroundLoader::GetNumQueuedResources() const
     return backgroundLoadQueue_.Size();
 }
 
+void BackgroundLoader::StartThreads()
+{
+    if (stopping_)
+        return;
+
+    threads_.Push(SharedPtr<BackgroundLoaderThread>(new BackgroundLoaderThread(this, true)));
+    for (unsigned i = 0; i < numDecodeThreads_; ++i)
+        threads_.Push(SharedPtr<BackgroundLoaderThread>(new BackgroundLoaderThread(this, false)));
+
+    for (unsigned i = 0; i < threads_.Size(); ++i)
+        threads_[i]->Run();
+}
+
+void BackgroundLoader::StopThreads()
+{
+    // Do not hold the mutex while joining, as the threads need it to finish their current item
+    Vector<SharedPtr<BackgroundLoaderThread> > threads;
+    {
+        MutexLock lock(backgroundLoadMutex_);
+        threads.Swap(threads_);
+        stopping_ = true;
+    }
+
+    readCondition_.Set();
+    decodeCondition_.Set();
+    for (unsigned i = 0; i < threads.Size(); ++i)
+        threads[i]->Stop();
+
+    stopping_ = false;
+}
+
+void BackgroundLoader::PushItem(PODVector<BackgroundLoadItem*>& queue, BackgroundLoadItem* item)
+{
+    // Binary search for the insertion point, the next item to load is at the back
+    unsigned low = 0;
+    unsigned high = queue.Size();
+    while (low < high)
+    {
+        unsigned mid = (low + high) >> 1;
+        if (LoadsAfter(queue[mid], item))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    queue.Insert(low, item);
+}
+
+bool BackgroundLoader::RemoveItem(PODVector<BackgroundLoadItem*>& queue, BackgroundLoadItem* item)
+{
+    PODVector<BackgroundLoadItem*>::Iterator i = queue.Find(item);
+    if (i == queue.End())
+        return false;
+
+    queue.Erase(i);
+    return true;
+}
+
+void BackgroundLoader::RaisePriority(BackgroundLoadItem& item, int priority)
+{
+    // Stopping at items that are already urgent enough also terminates dependency cycles
+    if (item.priority_ >= priority)
+        return;
+
+    if (RemoveItem(readQueue_, &item))
+    {
+        item.priority_ = priority;
+        PushItem(readQueue_, &item);
+    }
+    else if (RemoveItem(decodeQueue_, &item))
+    {
+        item.priority_ = priority;
+        PushItem(decodeQueue_, &item);
+    }
+    else
+        item.priority_ = priority;
+
+    for (HashSet<Pair<StringHash, StringHash> >::Iterator i = item.dependencies_.Begin(); i != item.dependencies_.End(); ++i)
+    {
+        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
+        if (j != backgroundLoadQueue_.End())
+            RaisePriority(j->second_, priority);
+    }
+}
+
+void BackgroundLoader::CompleteItem(BackgroundLoadItem& item, bool success)
+{
+    // Process dependencies now
+    Resource* resource = item.resource_;
+    Pair<StringHash, StringHash> key = MakePair(resource->GetType(), resource->GetNameHash());
+    if (item.dependents_.Size())
+    {
+        for (HashSet<Pair<StringHash, StringHash> >::Iterator i = item.dependents_.Begin(); i != item.dependents_.End(); ++i)
+        {
+            HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
+            if (j != backgroundLoadQueue_.End())
+                j->second_.dependencies_.Erase(key);
+        }
+
+        item.dependents_.Clear();
+    }
+
+    resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
+    completeCondition_.Set();
+}
+
 void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
 {
     Resource* resource = item.resource_;
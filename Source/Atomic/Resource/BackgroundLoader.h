@@ -22,17 +22,21 @@
 
 #pragma once
 
+#include "../Container/ArrayPtr.h"
 #include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
+#include "../Core/Condition.h"
 #include "../Core/Mutex.h"
 #include "../Container/Ptr.h"
 #include "../Container/RefCounted.h"
 #include "../Core/Thread.h"
+#include "../IO/MemoryBuffer.h"
 #include "../Math/StringHash.h"
 
 namespace Atomic
 {
 
+class BackgroundLoaderThread;
 class Resource;
 class ResourceCache;
 
@@ -45,36 +49,90 @@ struct BackgroundLoadItem
     HashSet<Pair<StringHash, StringHash> > dependencies_;
     /// Resources that depend on this resource's loading.
     HashSet<Pair<StringHash, StringHash> > dependents_;
+    /// File contents read by the I/O stage.
+    SharedArrayPtr<unsigned char> data_;
+    /// Size of the file contents.
+    unsigned dataSize_;
+    /// Last modification time of the file, or zero if it was read from a package.
+    unsigned lastModifiedTime_;
+    /// Load priority, higher loads first.
+    int priority_;
+    /// Queue order for loading items of equal priority first come, first served.
+    unsigned order_;
     /// Whether to send failure event.
     bool sendEventOnFailure_;
 };
 
+/// Memory buffer over the file contents read by the I/O stage, passed to Resource::BeginLoad() instead of the file. Reports the resource name and modification time like the file would.
+class BackgroundLoadBuffer : public MemoryBuffer
+{
+public:
+    /// Construct.
+    BackgroundLoadBuffer(const void* data, unsigned size, const String& name, unsigned lastModifiedTime) :
+        MemoryBuffer(data, size),
+        name_(name),
+        lastModifiedTime_(lastModifiedTime)
+    {
+    }
+
+    /// Return name.
+    virtual const String& GetName() const { return name_; }
+    /// Return last modification time of the file, or zero if it was read from a package.
+    unsigned GetLastModifiedTime() const { return lastModifiedTime_; }
+
+private:
+    /// Resource name.
+    String name_;
+    /// Last modification time of the file.
+    unsigned lastModifiedTime_;
+};
+
 /// Background loader of resources. Owned by the ResourceCache.
-class BackgroundLoader : public RefCounted, public Thread
+class BackgroundLoader : public RefCounted
 {
-    ATOMIC_REFCOUNTED(BackgroundLoader
-                      )
+    ATOMIC_REFCOUNTED(BackgroundLoader)
+
 public:
     /// Construct.
     BackgroundLoader(ResourceCache* owner);
 
-    /// Destruct. Forcibly clear the load queue.
+    /// Destruct. Stop the loader threads and forcibly clear the load queue.
     ~BackgroundLoader();
 
-    /// Resource background loading loop.
-    virtual void ThreadFunction();
+    /// I/O stage loop: read queued resource files into memory. Called by the loader threads.
+    void ReadFiles();
+    /// Decode stage loop: call BeginLoad() on resources whose files have been read. Called by the loader threads.
+    void DecodeResources();
 
     /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type).
-    bool QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller);
+    bool QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller, int priority = 0);
+    /// Change the priority of a resource that is still waiting to be read or decoded.
+    void SetPriority(StringHash type, StringHash nameHash, int priority);
     /// Wait and finish possible loading of a resource when being requested from the cache.
     void WaitForResource(StringHash type, StringHash nameHash);
     /// Process resources that are ready to finish.
     void FinishResources(int maxMs);
+    /// Set number of decode threads. The loader always has one I/O thread in addition.
+    void SetNumDecodeThreads(unsigned num);
 
     /// Return amount of resources in the load queue.
     unsigned GetNumQueuedResources() const;
+    /// Return number of decode threads.
+    unsigned GetNumDecodeThreads() const { return numDecodeThreads_; }
 
 private:
+    /// Start the I/O and decode threads.
+    void StartThreads();
+    /// Stop the I/O and decode threads.
+    void StopThreads();
+    /// Insert an item to a priority queue. Must be called with the mutex held.
+    void PushItem(PODVector<BackgroundLoadItem*>& queue, BackgroundLoadItem* item);
+    /// Remove an item from a priority queue if it is there. Must be called with the mutex held.
+    bool RemoveItem(PODVector<BackgroundLoadItem*>& queue, BackgroundLoadItem* item);
+    /// Raise the priority of a queued item and the resources it depends on. Must be called with the mutex held.
+    void RaisePriority(BackgroundLoadItem& item, int priority);
+    /// Mark an item decoded, release its dependents and wake up a waiting main thread. Must be called with the mutex held.
+    void CompleteItem(BackgroundLoadItem& item, bool success);
     /// Finish one background loaded resource.
     void FinishBackgroundLoading(BackgroundLoadItem& item);
 
@@ -84,6 +142,26 @@ private:
     mutable Mutex backgroundLoadMutex_;
     /// Resources that are queued for background loading.
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem> backgroundLoadQueue_;
+    /// Items waiting for the I/O stage, sorted so that the highest priority is last.
+    PODVector<BackgroundLoadItem*> readQueue_;
+    /// Items waiting for the decode stage, sorted so that the highest priority is last.
+    PODVector<BackgroundLoadItem*> decodeQueue_;
+    /// Loader threads.
+    Vector<SharedPtr<BackgroundLoaderThread> > threads_;
+    /// Wakeup for the I/O thread.
+    Condition readCondition_;
+    /// Wakeup for the decode threads.
+    Condition decodeCondition_;
+    /// Wakeup for the main thread waiting on a resource.
+    Condition completeCondition_;
+    /// Number of decode threads.
+    unsigned numDecodeThreads_;
+    /// Counter for queue order.
+    unsigned nextOrder_;
+    /// Total size of the file contents read but not yet decoded.
+    unsigned readAheadSize_;
+    /// Threads stopping flag.
+    volatile bool stopping_;
 };
 
 }
@@ -36,6 +36,8 @@ Resource::Resource(Context* context) :
     memoryUse_(0),
     asyncLoadState_(ASYNC_DONE)
 {
+    // Resources are handed between the main thread and the background loading threads
+    SetAtomicRefCount();
 }
 
 bool Resource::Load(Deserializer& source)
@@ -72,13 +72,63 @@ static const char* checkDirs[] =
 
 static const SharedPtr<Resource> noResource;
 
+void ResourceGroup::Insert(Resource* resource)
+{
+    StringHash nameHash = resource->GetNameHash();
+    unsigned memoryUse = resource->GetMemoryUse();
+
+    resources_[nameHash] = resource;
+
+    HashMap<StringHash, unsigned>::Iterator i = resourceMemoryUse_.Find(nameHash);
+    if (i != resourceMemoryUse_.End())
+    {
+        memoryUse_ -= i->second_;
+        i->second_ = memoryUse;
+    }
+    else
+        resourceMemoryUse_[nameHash] = memoryUse;
+
+    memoryUse_ += memoryUse;
+}
+
+void ResourceGroup::Erase(StringHash nameHash)
+{
+    HashMap<StringHash, SharedPtr<Resource> >::Iterator i = resources_.Find(nameHash);
+    if (i != resources_.End())
+        Erase(i);
+}
+
+HashMap<StringHash, SharedPtr<Resource> >::Iterator ResourceGroup::Erase(HashMap<StringHash, SharedPtr<Resource> >::Iterator i)
+{
+    HashMap<StringHash, unsigned>::Iterator j = resourceMemoryUse_.Find(i->first_);
+    if (j != resourceMemoryUse_.End())
+    {
+        memoryUse_ -= j->second_;
+        resourceMemoryUse_.Erase(j);
+    }
+
+    return resources_.Erase(i);
+}
+
+void ResourceGroup::UpdateMemoryUse(Resource* resource)
+{
+    HashMap<StringHash, unsigned>::Iterator i = resourceMemoryUse_.Find(resource->GetNameHash());
+    if (i == resourceMemoryUse_.End())
+        return;
+
+    memoryUse_ -= i->second_;
+    i->second_ = resource->GetMemoryUse();
+    memoryUse_ += i->second_;
+}
+
 ResourceCache::ResourceCache(Context* context) :
     Object(context),
     autoReloadResources_(false),
     returnFailedResources_(false),
     searchPackagesFirst_(true),
     isRouting_(false),
-    finishBackgroundResourcesMs_(5)
+    finishBackgroundResourcesMs_(5),
+    reloadResourcesMs_(5)
 {
     // Register Resource library object factories
     RegisterResourceLibrary(context_);
@@ -180,7 +230,7 @@ bool ResourceCache::AddManualResource(Resource* resource)
     }
 
     resource->ResetUseTimer();
-    resourceGroups_[resource->GetType()].resources_[resource->GetNameHash()] = resource;
+    resourceGroups_[resource->GetType()].Insert(resource);
     UpdateResourceGroup(resource->GetType());
     return true;
 }
@@ -258,7 +308,7 @@ void ResourceCache::ReleaseResource(StringHash type, const String& name, bool fo
     // If other references exist, do not release, unless forced
     if ((existingRes.Refs() == 1 && existingRes.WeakRefs() == 0) || force)
     {
-        resourceGroups_[type].resources_.Erase(nameHash);
+        resourceGroups_[type].Erase(nameHash);
         UpdateResourceGroup(type);
     }
 }
@@ -267,7 +317,7 @@ void ResourceCache::ReleaseResources(StringHash type, bool force)
 {
     bool released = false;
 
-    HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
     if (i != resourceGroups_.End())
     {
         for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
@@ -277,7 +327,7 @@ void ResourceCache::ReleaseResources(StringHash type, bool force)
             // If other references exist, do not release, unless forced
             if ((current->second_.Refs() == 1 && current->second_.WeakRefs() == 0) || force)
             {
-                i->second_.resources_.Erase(current);
+                i->second_.Erase(current);
                 released = true;
             }
         }
@@ -291,7 +341,7 @@ void ResourceCache::ReleaseResources(StringHash type, const String& partialName,
 {
     bool released = false;
 
-    HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
     if (i != resourceGroups_.End())
     {
         for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
@@ -303,7 +353,7 @@ void ResourceCache::ReleaseResources(StringHash type, const String& partialName,
                 // If other references exist, do not release, unless forced
                 if ((current->second_.Refs() == 1 && current->second_.WeakRefs() == 0) || force)
                 {
-                    i->second_.resources_.Erase(current);
+                    i->second_.Erase(current);
                     released = true;
                 }
             }
@@ -322,7 +372,7 @@ void ResourceCache::ReleaseResources(const String& partialName, bool force)
 
     while (repeat--)
     {
-        for (HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
+        for (FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
         {
             bool released = false;
 
@@ -335,7 +385,7 @@ void ResourceCache::ReleaseResources(const String& partialName, bool force)
                     // If other references exist, do not release, unless forced
                     if ((current->second_.Refs() == 1 && current->second_.WeakRefs() == 0) || force)
                     {
-                        i->second_.resources_.Erase(current);
+                        i->second_.Erase(current);
                         released = true;
                     }
                 }
@@ -352,7 +402,7 @@ void ResourceCache::ReleaseAllResources(bool force)
 
     while (repeat--)
     {
-        for (HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin();
+        for (FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin();
              i != resourceGroups_.End(); ++i)
         {
             bool released = false;
@@ -364,7 +414,7 @@ void ResourceCache::ReleaseAllResources(bool force)
                 // If other references exist, do not release, unless forced
                 if ((current->second_.Refs() == 1 && current->second_.WeakRefs() == 0) || force)
                 {
-                    i->second_.resources_.Erase(current);
+                    i->second_.Erase(current);
                     released = true;
                 }
             }
@@ -413,6 +463,9 @@ bool ResourceCache::ReloadResource(Resource* resource)
     if (success)
     {
         resource->ResetUseTimer();
+        FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(resource->GetType());
+        if (i != resourceGroups_.End())
+            i->second_.UpdateMemoryUse(resource);
         UpdateResourceGroup(resource->GetType());
         resource->SendEvent(E_RELOADFINISHED);
         return true;
@@ -426,40 +479,8 @@ bool ResourceCache::ReloadResource(Resource* resource)
 
 void ResourceCache::ReloadResourceWithDependencies(const String& fileName)
 {
-    StringHash fileNameHash(fileName);
-    // If the filename is a resource we keep track of, reload it
-    const SharedPtr<Resource>& resource = FindResource(fileNameHash);
-    if (resource)
-    {
-        ATOMIC_LOGDEBUG("Reloading changed resource " + fileName);
-        ReloadResource(resource);
-    }
-    // Always perform dependency resource check for resource loaded from XML file as it could be used in inheritance
-    if (!resource || GetExtension(resource->GetName()) == ".xml")
-    {
-        // Check if this is a dependency resource, reload dependents
-        HashMap<StringHash, HashSet<StringHash> >::ConstIterator j = dependentResources_.Find(fileNameHash);
-        if (j != dependentResources_.End())
-        {
-            // Reloading a resource may modify the dependency tracking structure. Therefore collect the
-            // resources we need to reload first
-            Vector<SharedPtr<Resource> > dependents;
-            dependents.Reserve(j->second_.Size());
-
-            for (HashSet<StringHash>::ConstIterator k = j->second_.Begin(); k != j->second_.End(); ++k)
-            {
-                const SharedPtr<Resource>& dependent = FindResource(*k);
-                if (dependent)
-                    dependents.Push(dependent);
-            }
-
-            for (unsigned k = 0; k < dependents.Size(); ++k)
-            {
-                ATOMIC_LOGDEBUG("Reloading resource " + dependents[k]->GetName() + " depending on " + fileName);
-                ReloadResource(dependents[k]);
-            }
-        }
-    }
+    HashSet<StringHash> reloaded;
+    ReloadChangedFile(fileName, reloaded);
 }
 
 void ResourceCache::SetMemoryBudget(StringHash type, unsigned long long budget)
@@ -481,7 +502,12 @@ void ResourceCache::SetAutoReloadResources(bool enable)
             }
         }
         else
+        {
             fileWatchers_.Clear();
+            pendingFileChanges_.Clear();
+            pendingFileChangeNames_.Clear();
+            reloadedResources_.Clear();
+        }
 
         autoReloadResources_ = enable;
     }
@@ -696,13 +722,14 @@ Resource* ResourceCache::GetResource(StringHash type, const String& nameIn, bool
 
     // Store to cache
     resource->ResetUseTimer();
-    resourceGroups_[type].resources_[nameHash] = resource;
+    resourceGroups_[type].Insert(resource);
     UpdateResourceGroup(type);
 
     return resource;
 }
 
-bool ResourceCache::BackgroundLoadResource(StringHash type, const String& nameIn, bool sendEventOnFailure, Resource* caller)
+bool ResourceCache::BackgroundLoadResource(StringHash type, const String& nameIn, bool sendEventOnFailure, Resource* caller,
+    int priority)
 {
 #ifdef ATOMIC_THREADING
     // If empty name, fail immediately
@@ -715,13 +742,31 @@ bool ResourceCache::BackgroundLoadResource(StringHash type, const String& nameIn
     if (FindResource(type, nameHash) != noResource)
         return false;
 
-    return backgroundLoader_->QueueResource(type, name, sendEventOnFailure, caller);
+    return backgroundLoader_->QueueResource(type, name, sendEventOnFailure, caller, priority);
 #else
     // When threading not supported, fall back to synchronous loading
     return GetResource(type, nameIn, sendEventOnFailure);
 #endif
 }
 
+void ResourceCache::SetBackgroundLoadPriority(StringHash type, const String& nameIn, int priority)
+{
+#ifdef ATOMIC_THREADING
+    String name = SanitateResourceName(nameIn);
+    if (name.Empty())
+        return;
+
+    backgroundLoader_->SetPriority(type, StringHash(name), priority);
+#endif
+}
+
+void ResourceCache::SetNumBackgroundLoadThreads(unsigned num)
+{
+#ifdef ATOMIC_THREADING
+    backgroundLoader_->SetNumDecodeThreads(num);
+#endif
+}
+
 SharedPtr<Resource> ResourceCache::GetTempResource(StringHash type, const String& nameIn, bool sendEventOnFailure)
 {
     String name = SanitateResourceName(nameIn);
@@ -807,10 +852,19 @@ unsigned ResourceCache::GetNumBackgroundLoadResources() const
 #endif
 }
 
+unsigned ResourceCache::GetNumBackgroundLoadThreads() const
+{
+#ifdef ATOMIC_THREADING
+    return backgroundLoader_->GetNumDecodeThreads();
+#else
+    return 0;
+#endif
+}
+
 void ResourceCache::GetResources(PODVector<Resource*>& result, StringHash type) const
 {
     result.Clear();
-    HashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
     if (i != resourceGroups_.End())
     {
         for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator j = i->second_.resources_.Begin();
@@ -856,24 +910,36 @@ bool ResourceCache::Exists(const String& nameIn) const
 
 unsigned long long ResourceCache::GetMemoryBudget(StringHash type) const
 {
-    HashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
     return i != resourceGroups_.End() ? i->second_.memoryBudget_ : 0;
 }
 
 unsigned long long ResourceCache::GetMemoryUse(StringHash type) const
 {
-    HashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
     return i != resourceGroups_.End() ? i->second_.memoryUse_ : 0;
 }
 
 unsigned long long ResourceCache::GetTotalMemoryUse() const
 {
     unsigned long long total = 0;
-    for (HashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
+    for (FlatHashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
         total += i->second_.memoryUse_;
     return total;
 }
 
+unsigned ResourceCache::GetNumEvictions(StringHash type) const
+{
+    FlatHashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
+    return i != resourceGroups_.End() ? i->second_.numEvictions_ : 0;
+}
+
+unsigned long long ResourceCache::GetEvictedMemory(StringHash type) const
+{
+    FlatHashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
+    return i != resourceGroups_.End() ? i->second_.evictedMemory_ : 0;
+}
+
 String ResourceCache::GetResourceFileName(const String& name) const
 {
     MutexLock lock(resourceMutex_);
@@ -1014,7 +1080,7 @@ String ResourceCache::PrintMemoryUsage() const
     unsigned long long totalAverage = 0;
     unsigned long long totalUse = GetTotalMemoryUse();
 
-    for (HashMap<StringHash, ResourceGroup>::ConstIterator cit = resourceGroups_.Begin(); cit != resourceGroups_.End(); ++cit)
+    for (FlatHashMap<StringHash, ResourceGroup>::ConstIterator cit = resourceGroups_.Begin(); cit != resourceGroups_.End(); ++cit)
     {
         const unsigned resourceCt = cit->second_.resources_.Size();
         unsigned long long average = 0;
@@ -1067,7 +1133,7 @@ const SharedPtr<Resource>& ResourceCache::FindResource(StringHash type, StringHa
 {
     MutexLock lock(resourceMutex_);
 
-    HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
     if (i == resourceGroups_.End())
         return noResource;
     HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Find(nameHash);
@@ -1081,7 +1147,7 @@ const SharedPtr<Resource>& ResourceCache::FindResource(StringHash nameHash)
 {
     MutexLock lock(resourceMutex_);
 
-    for (HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
+    for (FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
     {
         HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Find(nameHash);
         if (j != i->second_.resources_.End())
@@ -1101,7 +1167,7 @@ void ResourceCache::ReleasePackageResources(PackageFile* package, bool force)
         StringHash nameHash(i->first_);
 
         // We do not know the actual resource type, so search all type containers
-        for (HashMap<StringHash, ResourceGroup>::Iterator j = resourceGroups_.Begin(); j != resourceGroups_.End(); ++j)
+        for (FlatHashMap<StringHash, ResourceGroup>::Iterator j = resourceGroups_.Begin(); j != resourceGroups_.End(); ++j)
         {
             HashMap<StringHash, SharedPtr<Resource> >::Iterator k = j->second_.resources_.Find(nameHash);
             if (k != j->second_.resources_.End())
@@ -1109,7 +1175,7 @@ void ResourceCache::ReleasePackageResources(PackageFile* package, bool force)
                 // If other references exist, do not release, unless forced
                 if ((k->second_.Refs() == 1 && k->second_.WeakRefs() == 0) || force)
                 {
-                    j->second_.resources_.Erase(k);
+                    j->second_.Erase(k);
                     affectedGroups.Insert(j->first_);
                 }
                 break;
@@ -1121,63 +1187,202 @@ void ResourceCache::ReleasePackageResources(PackageFile* package, bool force)
         UpdateResourceGroup(*i);
 }
 
+/// Resource that may be released for exceeding the memory budget.
+struct EvictionCandidate
+{
+    /// Time since last use in milliseconds.
+    unsigned useTimer_;
+    /// Resource name hash.
+    StringHash nameHash_;
+};
+
+/// Restore the max-heap order on use timer below a candidate.
+static void SiftDownCandidate(PODVector<EvictionCandidate>& heap, unsigned index)
+{
+    unsigned size = heap.Size();
+    for (;;)
+    {
+        unsigned largest = index;
+        unsigned left = index * 2 + 1;
+        unsigned right = left + 1;
+        if (left < size && heap[left].useTimer_ > heap[largest].useTimer_)
+            largest = left;
+        if (right < size && heap[right].useTimer_ > heap[largest].useTimer_)
+            largest = right;
+        if (largest == index)
+            break;
+
+        Swap(heap[index], heap[largest]);
+        index = largest;
+    }
+}
+
 void ResourceCache::UpdateResourceGroup(StringHash type)
 {
-    HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
     if (i == resourceGroups_.End())
         return;
 
-    for (;;)
+    // Memory use is kept up to date as resources are stored and removed, so staying within budget costs nothing
+    ResourceGroup& group = i->second_;
+    if (!group.memoryBudget_ || group.memoryUse_ <= group.memoryBudget_)
+        return;
+
+    // Over budget: resync the total in case resources changed size while stored, and collect the resources that are only
+    // referenced by the cache (resources in use always return a zero timer and can not be removed)
+    PODVector<EvictionCandidate> candidates;
+    unsigned long long totalSize = 0;
+    for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = group.resources_.Begin(); j != group.resources_.End(); ++j)
     {
-        unsigned totalSize = 0;
-        unsigned oldestTimer = 0;
-        HashMap<StringHash, SharedPtr<Resource> >::Iterator oldestResource = i->second_.resources_.End();
+        unsigned memoryUse = j->second_->GetMemoryUse();
+        group.resourceMemoryUse_[j->first_] = memoryUse;
+        totalSize += memoryUse;
+
+        EvictionCandidate candidate;
+        candidate.useTimer_ = j->second_->GetUseTimer();
+        candidate.nameHash_ = j->first_;
+        if (candidate.useTimer_)
+            candidates.Push(candidate);
+    }
 
-        for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
-             j != i->second_.resources_.End(); ++j)
+    group.memoryUse_ = totalSize;
+    if (group.memoryUse_ <= group.memoryBudget_ || candidates.Empty())
+        return;
+
+    // Release the least recently used resources from a heap until within budget
+    for (unsigned j = candidates.Size() / 2; j-- > 0;)
+        SiftDownCandidate(candidates, j);
+
+    while (group.memoryUse_ > group.memoryBudget_ && !candidates.Empty())
+    {
+        HashMap<StringHash, SharedPtr<Resource> >::Iterator oldestResource = group.resources_.Find(candidates[0].nameHash_);
+        unsigned long long oldMemoryUse = group.memoryUse_;
+
+        ATOMIC_LOGDEBUG("Resource group " + oldestResource->second_->GetTypeName() + " over memory budget, releasing resource " +
+                 oldestResource->second_->GetName());
+        group.Erase(oldestResource);
+        ++group.numEvictions_;
+        group.evictedMemory_ += oldMemoryUse - group.memoryUse_;
+
+        candidates[0] = candidates.Back();
+        candidates.Pop();
+        SiftDownCandidate(candidates, 0);
+    }
+}
+
+void ResourceCache::ReloadChangedFile(const String& fileName, HashSet<StringHash>& reloaded)
+{
+    StringHash fileNameHash(fileName);
+    // If the filename is a resource we keep track of, reload it. Hold a reference of our own, as reloading may add resource
+    // groups or release resources, which moves the storage FindResource() returns a reference into
+    SharedPtr<Resource> resource = FindResource(fileNameHash);
+    if (resource && !reloaded.Contains(fileNameHash))
+    {
+        ATOMIC_LOGDEBUG("Reloading changed resource " + fileName);
+        reloaded.Insert(fileNameHash);
+        ReloadResource(resource);
+    }
+    // Always perform dependency resource check for resource loaded from XML file as it could be used in inheritance
+    if (!resource || GetExtension(resource->GetName()) == ".xml")
+    {
+        // Check if this is a dependency resource, reload dependents
+        HashMap<StringHash, HashSet<StringHash> >::ConstIterator j = dependentResources_.Find(fileNameHash);
+        if (j != dependentResources_.End())
         {
-            totalSize += j->second_->GetMemoryUse();
-            unsigned useTimer = j->second_->GetUseTimer();
-            if (useTimer > oldestTimer)
+            // Reloading a resource may modify the dependency tracking structure. Therefore collect the
+            // resources we need to reload first. Resources depending on several changed files are reloaded only once
+            Vector<SharedPtr<Resource> > dependents;
+            dependents.Reserve(j->second_.Size());
+
+            for (HashSet<StringHash>::ConstIterator k = j->second_.Begin(); k != j->second_.End(); ++k)
+            {
+                if (reloaded.Contains(*k))
+                    continue;
+
+                const SharedPtr<Resource>& dependent = FindResource(*k);
+                if (dependent)
+                {
+                    dependents.Push(dependent);
+                    reloaded.Insert(*k);
+                }
+            }
+
+            for (unsigned k = 0; k < dependents.Size(); ++k)
             {
-                oldestTimer = useTimer;
-                oldestResource = j;
+                ATOMIC_LOGDEBUG("Reloading resource " + dependents[k]->GetName() + " depending on " + fileName);
+                ReloadResource(dependents[k]);
             }
         }
+    }
+}
 
-        i->second_.memoryUse_ = totalSize;
+void ResourceCache::QueueFileChange(const String& fileName, const String& resourceName)
+{
+    StringHash nameHash(resourceName);
 
-        // If memory budget defined and is exceeded, remove the oldest resource and loop again
-        // (resources in use always return a zero timer and can not be removed)
-        if (i->second_.memoryBudget_ && i->second_.memoryUse_ > i->second_.memoryBudget_ &&
-            oldestResource != i->second_.resources_.End())
-        {
-            ATOMIC_LOGDEBUG("Resource group " + oldestResource->second_->GetTypeName() + " over memory budget, releasing resource " +
-                     oldestResource->second_->GetName());
-            i->second_.resources_.Erase(oldestResource);
-        }
-        else
-            break;
+    // A file changing again after its resources were reloaded in the current batch must be reloaded again
+    reloadedResources_.Erase(nameHash);
+    HashMap<StringHash, HashSet<StringHash> >::ConstIterator i = dependentResources_.Find(nameHash);
+    if (i != dependentResources_.End())
+    {
+        for (HashSet<StringHash>::ConstIterator j = i->second_.Begin(); j != i->second_.End(); ++j)
+            reloadedResources_.Erase(*j);
     }
+
+    // A change still waiting to be processed will read the latest file contents anyway
+    if (pendingFileChangeNames_.Contains(nameHash))
+        return;
+
+    PendingFileChange change;
+    change.fileName_ = fileName;
+    change.resourceName_ = resourceName;
+    pendingFileChanges_.Push(change);
+    pendingFileChangeNames_.Insert(nameHash);
 }
 
 void ResourceCache::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
+    // Collect the changes of all file watchers once per frame
+    Vector<String> changes;
     for (unsigned i = 0; i < fileWatchers_.Size(); ++i)
     {
-        String fileName;
-        while (fileWatchers_[i]->GetNextChange(fileName))
+        changes.Clear();
+        if (fileWatchers_[i]->GetChanges(changes))
         {
-            ReloadResourceWithDependencies(fileName);
+            const String& path = fileWatchers_[i]->GetPath();
+            for (unsigned j = 0; j < changes.Size(); ++j)
+                QueueFileChange(path + changes[j], changes[j]);
+        }
+    }
+
+    // Reload changed resources within the frame time budget, so that mass changes do not stall a single frame
+    if (!pendingFileChanges_.Empty())
+    {
+        ATOMIC_PROFILE(ReloadChangedResources);
+
+        HiresTimer timer;
+        while (!pendingFileChanges_.Empty())
+        {
+            PendingFileChange change = pendingFileChanges_.Front();
+            pendingFileChanges_.PopFront();
+            pendingFileChangeNames_.Erase(StringHash(change.resourceName_));
+
+            ReloadChangedFile(change.resourceName_, reloadedResources_);
 
             // Finally send a general file changed event even if the file was not a tracked resource
             using namespace FileChanged;
 
             VariantMap& eventData = GetEventDataMap();
-            eventData[P_FILENAME] = fileWatchers_[i]->GetPath() + fileName;
-            eventData[P_RESOURCENAME] = fileName;
+            eventData[P_FILENAME] = change.fileName_;
+            eventData[P_RESOURCENAME] = change.resourceName_;
             SendEvent(E_FILECHANGED, eventData);
+
+            if (timer.GetUSec(false) >= reloadResourcesMs_ * 1000)
+                break;
         }
+
+        if (pendingFileChanges_.Empty())
+            reloadedResources_.Clear();
     }
 
     // Check for background loaded resources that can be finished
@@ -1286,7 +1491,7 @@ String ResourceCache::PrintResources(const String& typeName) const
 
     String output = "Resource Type         Refs   WeakRefs  Name\n\n";
 
-    for (HashMap<StringHash, ResourceGroup>::ConstIterator cit = resourceGroups_.Begin(); cit != resourceGroups_.End(); ++cit)
+    for (FlatHashMap<StringHash, ResourceGroup>::ConstIterator cit = resourceGroups_.Begin(); cit != resourceGroups_.End(); ++cit)
     {
         for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator resIt = cit->second_.resources_.Begin(); resIt != cit->second_.resources_.End(); ++resIt)
         {
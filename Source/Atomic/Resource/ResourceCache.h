@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/FlatHashMap.h"
 #include "../Container/HashSet.h"
 #include "../Container/List.h"
 #include "../Core/Mutex.h"
@@ -40,21 +41,47 @@ class JSONFile;
 static const unsigned PRIORITY_LAST = 0xffffffff;
 
 /// Container of resources with specific type.
-struct ResourceGroup
+struct ATOMIC_API ResourceGroup
 {
     /// Construct with defaults.
     ResourceGroup() :
         memoryBudget_(0),
-        memoryUse_(0)
+        memoryUse_(0),
+        numEvictions_(0),
+        evictedMemory_(0)
     {
     }
 
+    /// Store a resource and add its memory use.
+    void Insert(Resource* resource);
+    /// Remove a resource by name hash and subtract its memory use.
+    void Erase(StringHash nameHash);
+    /// Remove a resource and subtract its memory use. Return iterator to the next resource.
+    HashMap<StringHash, SharedPtr<Resource> >::Iterator Erase(HashMap<StringHash, SharedPtr<Resource> >::Iterator i);
+    /// Account for a change in the memory use of a stored resource, eg. after reloading.
+    void UpdateMemoryUse(Resource* resource);
+
     /// Memory budget.
     unsigned long long memoryBudget_;
     /// Current memory use.
     unsigned long long memoryUse_;
+    /// Number of resources released for exceeding the memory budget.
+    unsigned numEvictions_;
+    /// Total memory released for exceeding the memory budget.
+    unsigned long long evictedMemory_;
     /// Resources.
     HashMap<StringHash, SharedPtr<Resource> > resources_;
+    /// Memory use of each resource as currently included in the memory use total.
+    HashMap<StringHash, unsigned> resourceMemoryUse_;
+};
+
+/// File change waiting to be processed by automatic resource reloading.
+struct PendingFileChange
+{
+    /// Full path of the changed file.
+    String fileName_;
+    /// Resource name of the changed file.
+    String resourceName_;
 };
 
 /// Resource request types.
@@ -150,6 +177,10 @@ public:
 
     /// Set how many milliseconds maximum per frame to spend on finishing background loaded resources.
     void SetFinishBackgroundResourcesMs(int ms) { finishBackgroundResourcesMs_ = Max(ms, 1); }
+    /// Set number of threads decoding background loaded resources. File reading uses one additional thread.
+    void SetNumBackgroundLoadThreads(unsigned num);
+    /// Set how many milliseconds maximum per frame to spend on reloading changed resources when automatic reloading is enabled.
+    void SetReloadResourcesMs(int ms) { reloadResourcesMs_ = Max(ms, 1); }
 
     /// Add a resource router object. By default there is none, so the routing process is skipped.
     void AddResourceRouter(ResourceRouter* router, bool addAsFirst = false);
@@ -164,17 +195,21 @@ public:
     Resource* GetResource(StringHash type, const String& name, bool sendEventOnFailure = true);
     /// Load a resource without storing it in the resource cache. Return null if not found or if fails. Can be called from outside the main thread if the resource itself is safe to load completely (it does not possess for example GPU data.)
     SharedPtr<Resource> GetTempResource(StringHash type, const String& name, bool sendEventOnFailure = true);
-    /// Background load a resource. An event will be sent when complete. Return true if successfully stored to the load queue, false if eg. already exists. Can be called from outside the main thread.
-    bool BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure = true, Resource* caller = 0);
+    /// Background load a resource. An event will be sent when complete. Return true if successfully stored to the load queue, false if eg. already exists. Resources with higher priority are loaded first. Can be called from outside the main thread.
+    bool BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure = true, Resource* caller = 0, int priority = 0);
+    /// Change the priority of a resource waiting in the background load queue, for example by its distance to the camera. Can be called from outside the main thread.
+    void SetBackgroundLoadPriority(StringHash type, const String& name, int priority);
     /// Return number of pending background-loaded resources.
     unsigned GetNumBackgroundLoadResources() const;
+    /// Return number of threads decoding background loaded resources.
+    unsigned GetNumBackgroundLoadThreads() const;
     /// Return all loaded resources of a specific type.
     void GetResources(PODVector<Resource*>& result, StringHash type) const;
     /// Return an already loaded resource of specific type & name, or null if not found. Will not load if does not exist.
     Resource* GetExistingResource(StringHash type, const String& name);
 
     /// Return all loaded resources.
-    const HashMap<StringHash, ResourceGroup>& GetAllResources() const { return resourceGroups_; }
+    const FlatHashMap<StringHash, ResourceGroup>& GetAllResources() const { return resourceGroups_; }
 
     /// Return added resource load directories.
     const Vector<String>& GetResourceDirs() const { return resourceDirs_; }
@@ -191,7 +226,7 @@ public:
     /// Template version of releasing a resource by name.
     template <class T> void ReleaseResource(const String& name, bool force = false);
     /// Template version of queueing a resource background load.
-    template <class T> bool BackgroundLoadResource(const String& name, bool sendEventOnFailure = true, Resource* caller = 0);
+    template <class T> bool BackgroundLoadResource(const String& name, bool sendEventOnFailure = true, Resource* caller = 0, int priority = 0);
     /// Template version of returning loaded resources of a specific type.
     template <class T> void GetResources(PODVector<T*>& result) const;
     /// Return whether a file exists in the resource directories or package files. Does not check manually added in-memory resources.
@@ -202,6 +237,10 @@ public:
     unsigned long long GetMemoryUse(StringHash type) const;
     /// Return total memory use for all resources.
     unsigned long long GetTotalMemoryUse() const;
+    /// Return number of resources of a type released for exceeding the memory budget.
+    unsigned GetNumEvictions(StringHash type) const;
+    /// Return total memory released from a resource type for exceeding the memory budget.
+    unsigned long long GetEvictedMemory(StringHash type) const;
     /// Return full absolute file name of resource if possible, or empty if not found.
     String GetResourceFileName(const String& name) const;
 
@@ -216,6 +255,10 @@ public:
 
     /// Return how many milliseconds maximum to spend on finishing background loaded resources.
     int GetFinishBackgroundResourcesMs() const { return finishBackgroundResourcesMs_; }
+    /// Return how many milliseconds maximum per frame to spend on reloading changed resources.
+    int GetReloadResourcesMs() const { return reloadResourcesMs_; }
+    /// Return number of file changes waiting to be processed by automatic reloading.
+    unsigned GetNumPendingFileChanges() const { return pendingFileChanges_.Size(); }
 
     /// Return a resource router by index.
     ResourceRouter* GetResourceRouter(unsigned index) const;
@@ -252,14 +295,18 @@ public:
     // ATOMIC END
 
 private:
-    /// Find a resource.
+    /// Find a resource. The reference points into the resource group storage, which moves when a group is added or a resource is released, so copy it before loading or releasing resources.
     const SharedPtr<Resource>& FindResource(StringHash type, StringHash nameHash);
-    /// Find a resource by name only. Searches all type groups.
+    /// Find a resource by name only. Searches all type groups. The same reference lifetime applies as above.
     const SharedPtr<Resource>& FindResource(StringHash nameHash);
     /// Release resources loaded from a package file.
     void ReleasePackageResources(PackageFile* package, bool force = false);
-    /// Update a resource group. Recalculate memory use and release resources if over memory budget.
+    /// Update a resource group. Release least recently used resources if over memory budget.
     void UpdateResourceGroup(StringHash type);
+    /// Reload a changed file and its dependent resources, skipping resources already in the reloaded set. Adds the reloaded resources to the set.
+    void ReloadChangedFile(const String& fileName, HashSet<StringHash>& reloaded);
+    /// Queue a file change from a file watcher for reloading.
+    void QueueFileChange(const String& fileName, const String& resourceName);
     /// Handle begin frame event. Automatic resource reloads and the finalization of background loaded resources are processed here.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
     /// Search FileSystem for file.
@@ -272,7 +319,7 @@ private:
     /// Mutex for thread-safe access to the resource directories, resource packages and resource dependencies.
     mutable Mutex resourceMutex_;
     /// Resources by type.
-    HashMap<StringHash, ResourceGroup> resourceGroups_;
+    FlatHashMap<StringHash, ResourceGroup> resourceGroups_;
     /// Resource load directories.
     Vector<String> resourceDirs_;
     /// File watchers for resource directories, if automatic reloading enabled.
@@ -295,6 +342,14 @@ private:
     mutable bool isRouting_;
     /// How many milliseconds maximum per frame to spend on finishing background loaded resources.
     int finishBackgroundResourcesMs_;
+    /// File changes waiting to be processed by automatic reloading.
+    List<PendingFileChange> pendingFileChanges_;
+    /// Resource names of the pending file changes.
+    HashSet<StringHash> pendingFileChangeNames_;
+    /// Resources already reloaded while processing the pending file changes.
+    HashSet<StringHash> reloadedResources_;
+    /// How many milliseconds maximum per frame to spend on reloading changed resources.
+    int reloadResourcesMs_;
 };
 
 template <class T> T* ResourceCache::GetExistingResource(const String& name)
@@ -321,10 +376,10 @@ template <class T> SharedPtr<T> ResourceCache::GetTempResource(const String& nam
     return StaticCast<T>(GetTempResource(type, name, sendEventOnFailure));
 }
 
-template <class T> bool ResourceCache::BackgroundLoadResource(const String& name, bool sendEventOnFailure, Resource* caller)
+template <class T> bool ResourceCache::BackgroundLoadResource(const String& name, bool sendEventOnFailure, Resource* caller, int priority)
 {
     StringHash type = T::GetTypeStatic();
-    return BackgroundLoadResource(type, name, sendEventOnFailure, caller);
+    return BackgroundLoadResource(type, name, sendEventOnFailure, caller, priority);
 }
 
 template <class T> void ResourceCache::GetResources(PODVector<T*>& result) const
@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/FrameAllocator.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/JSONValue.h"
@@ -530,7 +531,17 @@ void Animatable::UpdateAttributeAnimations(float timeStep)
             return;
 
         if (finished)
+        {
+            // Most frames no animation finishes, so only take memory from the frame arena when one does. At most every
+            // animation can finish, so size the temporary list for that
+            if (finishedNames.Empty())
+            {
+                FrameAllocator* frameAllocator = GetSubsystem<FrameAllocator>();
+                if (frameAllocator)
+                    finishedNames.Reserve(attributeAnimationInfos_.Size(), frameAllocator->GetArena());
+            }
             finishedNames.Push(i->second_->GetAttributeInfo().name_);
+        }
     }
 
     for (unsigned i = 0; i < finishedNames.Size(); ++i)
@@ -134,6 +134,8 @@ protected:
     Node* node_;
     /// Unique ID within the scene.
     unsigned id_;
+    /// Index in the scene's per-type component list.
+    unsigned sceneTypeIndex_;
     /// Network update queued flag.
     bool networkUpdate_;
     /// Enabled flag.
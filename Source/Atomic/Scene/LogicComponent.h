@@ -23,6 +23,10 @@
 #pragma once
 
 #include "../Scene/Component.h"
+#include "../Scene/SceneEvents.h"
+#if defined(ATOMIC_PHYSICS) || defined(ATOMIC_ATOMIC2D)
+#include "../Physics/PhysicsEvents.h"
+#endif
 
 namespace Atomic
 {
@@ -86,12 +90,12 @@ private:
     /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
     void UpdateEventSubscription();
     /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleSceneUpdate(StringHash eventType, const SceneUpdate::Payload& eventData);
     /// Handle scene post-update event.
     void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
 #if defined(ATOMIC_PHYSICS) || defined(ATOMIC_ATOMIC2D)
     /// Handle physics pre-step event.
-    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    void HandlePhysicsPreStep(StringHash eventType, const PhysicsPreStep::Payload& eventData);
     /// Handle physics post-step event.
     void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
 #endif
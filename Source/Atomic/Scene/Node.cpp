@@ -58,7 +58,8 @@ Node::Node(Context* context) :
     position_(Vector3::ZERO),
     rotation_(Quaternion::IDENTITY),
     scale_(Vector3::ONE),
-    worldRotation_(Quaternion::IDENTITY)
+    worldRotation_(Quaternion::IDENTITY),
+    lastFoundComponent_(0)
 {
     impl_ = new NodeImpl();
     impl_->owner_ = 0;
@@ -1102,6 +1103,8 @@ void Node::ReorderComponent(Component* component, unsigned index)
             SharedPtr<Component> componentShared(component);
             components_.Erase(i);
             components_.Insert(index, componentShared);
+            // The first component of a type may have changed
+            lastFoundComponent_.store(0, std::memory_order_relaxed);
             return;
         }
     }
@@ -1411,10 +1414,18 @@ const Variant& Node::GetVar(StringHash key) const
 
 Component* Node::GetComponent(StringHash type, bool recursive) const
 {
+    // Components are only appended after a lookup, so the first match stays valid until it is removed or reordered
+    Component* lastFound = lastFoundComponent_.load(std::memory_order_relaxed);
+    if (lastFound && lastFound->GetType() == type)
+        return lastFound;
+
     for (Vector<SharedPtr<Component> >::ConstIterator i = components_.Begin(); i != components_.End(); ++i)
     {
         if ((*i)->GetType() == type)
+        {
+            lastFoundComponent_.store(*i, std::memory_order_relaxed);
             return *i;
+        }
     }
 
     if (recursive)
@@ -2277,6 +2288,8 @@ void Node::RemoveComponent(Vector<SharedPtr<Component> >::Iterator i)
     if (scene_)
         scene_->ComponentRemoved(*i);
     (*i)->SetNode(0);
+    if (lastFoundComponent_.load(std::memory_order_relaxed) == *i)
+        lastFoundComponent_.store(0, std::memory_order_relaxed);
     components_.Erase(i);
 }
 
@@ -736,6 +736,8 @@ private:
     mutable Quaternion worldRotation_;
     /// Components.
     Vector<SharedPtr<Component> > components_;
+    /// Last component found by type, to return repeated lookups without a scan. Atomic because lookups may run in worker threads.
+    mutable std::atomic<Component*> lastFoundComponent_;
     /// Child scene nodes.
     Vector<SharedPtr<Node> > children_;
     /// Node listeners.
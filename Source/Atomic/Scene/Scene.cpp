@@ -79,7 +79,7 @@ Scene::Scene(Context* context) :
     SetID(GetFreeNodeID(REPLICATED));
     NodeAdded(this);
 
-    SubscribeToEvent(E_UPDATE, ATOMIC_HANDLER(Scene, HandleUpdate));
+    SubscribeToEvent(E_UPDATE, ATOMIC_TYPED_HANDLER(Scene, HandleUpdate));
     SubscribeToEvent(E_RESOURCEBACKGROUNDLOADED, ATOMIC_HANDLER(Scene, HandleResourceBackgroundLoaded));
 }
 
@@ -91,9 +91,9 @@ Scene::~Scene()
     RemoveAllChildren();
 
     // Remove scene reference and owner from all nodes that still exist
-    for (HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+    for (FlatHashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
         i->second_->ResetScene();
-    for (HashMap<unsigned, Node*>::Iterator i = localNodes_.Begin(); i != localNodes_.End(); ++i)
+    for (FlatHashMap<unsigned, Node*>::Iterator i = localNodes_.Begin(); i != localNodes_.End(); ++i)
         i->second_->ResetScene();
 }
 
@@ -214,7 +214,7 @@ void Scene::AddReplicationState(NodeReplicationState* state)
     Node::AddReplicationState(state);
 
     // This is the first update for a new connection. Mark all replicated nodes dirty
-    for (HashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+    for (FlatHashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
         state->sceneState_->dirtyNodes_.Insert(i->first_);
 }
 
@@ -711,12 +711,12 @@ Node* Scene::GetNode(unsigned id) const
 {
     if (id < FIRST_LOCAL_ID)
     {
-        HashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Find(id);
+        FlatHashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Find(id);
         return i != replicatedNodes_.End() ? i->second_ : 0;
     }
     else
     {
-        HashMap<unsigned, Node*>::ConstIterator i = localNodes_.Find(id);
+        FlatHashMap<unsigned, Node*>::ConstIterator i = localNodes_.Find(id);
         return i != localNodes_.End() ? i->second_ : 0;
     }
 }
@@ -734,16 +734,24 @@ bool Scene::GetNodesWithTag(PODVector<Node*>& dest, const String& tag) const
         return false;
 }
 
+const PODVector<Component*>& Scene::GetComponentsOfType(StringHash type) const
+{
+    static const PODVector<Component*> noComponents;
+
+    FlatHashMap<StringHash, PODVector<Component*> >::ConstIterator i = componentsByType_.Find(type);
+    return i != componentsByType_.End() ? i->second_ : noComponents;
+}
+
 Component* Scene::GetComponent(unsigned id) const
 {
     if (id < FIRST_LOCAL_ID)
     {
-        HashMap<unsigned, Component*>::ConstIterator i = replicatedComponents_.Find(id);
+        FlatHashMap<unsigned, Component*>::ConstIterator i = replicatedComponents_.Find(id);
         return i != replicatedComponents_.End() ? i->second_ : 0;
     }
     else
     {
-        HashMap<unsigned, Component*>::ConstIterator i = localComponents_.Find(id);
+        FlatHashMap<unsigned, Component*>::ConstIterator i = localComponents_.Find(id);
         return i != localComponents_.End() ? i->second_ : 0;
     }
 }
@@ -777,13 +785,16 @@ void Scene::Update(float timeStep)
 
     using namespace SceneUpdate;
 
+    // Update variable timestep logic. Sent with a typed payload, as every logic component receives it
+    Payload payload;
+    payload.scene_ = this;
+    payload.timeStep_ = timeStep;
+    SendTypedEvent(E_SCENEUPDATE, payload);
+
     VariantMap& eventData = GetEventDataMap();
     eventData[P_SCENE] = this;
     eventData[P_TIMESTEP] = timeStep;
 
-    // Update variable timestep logic
-    SendEvent(E_SCENEUPDATE, eventData);
-
     // Update scene attribute animation.
     SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
 
@@ -930,7 +941,7 @@ void Scene::NodeAdded(Node* node)
     // If node with same ID exists, remove the scene reference from it and overwrite with the new node
     if (id < FIRST_LOCAL_ID)
     {
-        HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Find(id);
+        FlatHashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Find(id);
         if (i != replicatedNodes_.End() && i->second_ != node)
         {
             ATOMIC_LOGWARNING("Overwriting node with ID " + String(id));
@@ -944,7 +955,7 @@ void Scene::NodeAdded(Node* node)
     }
     else
     {
-        HashMap<unsigned, Node*>::Iterator i = localNodes_.Find(id);
+        FlatHashMap<unsigned, Node*>::Iterator i = localNodes_.Find(id);
         if (i != localNodes_.End() && i->second_ != node)
         {
             ATOMIC_LOGWARNING("Overwriting node with ID " + String(id));
@@ -1029,7 +1040,7 @@ void Scene::ComponentAdded(Component* component)
 
     if (id < FIRST_LOCAL_ID)
     {
-        HashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Find(id);
+        FlatHashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Find(id);
         if (i != replicatedComponents_.End() && i->second_ != component)
         {
             ATOMIC_LOGWARNING("Overwriting component with ID " + String(id));
@@ -1040,7 +1051,7 @@ void Scene::ComponentAdded(Component* component)
     }
     else
     {
-        HashMap<unsigned, Component*>::Iterator i = localComponents_.Find(id);
+        FlatHashMap<unsigned, Component*>::Iterator i = localComponents_.Find(id);
         if (i != localComponents_.End() && i->second_ != component)
         {
             ATOMIC_LOGWARNING("Overwriting component with ID " + String(id));
@@ -1050,6 +1061,15 @@ void Scene::ComponentAdded(Component* component)
         localComponents_[id] = component;
     }
 
+    // Add to the per-type list, unless already there. The stored index may be stale if the component was in a destroyed scene
+    PODVector<Component*>& typeComponents = componentsByType_[component->GetType()];
+    unsigned index = component->sceneTypeIndex_;
+    if (index >= typeComponents.Size() || typeComponents[index] != component)
+    {
+        component->sceneTypeIndex_ = typeComponents.Size();
+        typeComponents.Push(component);
+    }
+
     component->OnSceneSet(this);
 }
 
@@ -1064,6 +1084,19 @@ void Scene::ComponentRemoved(Component* component)
     else
         localComponents_.Erase(id);
 
+    // Swap-remove from the per-type list
+    FlatHashMap<StringHash, PODVector<Component*> >::Iterator i = componentsByType_.Find(component->GetType());
+    unsigned index = component->sceneTypeIndex_;
+    if (i != componentsByType_.End() && index < i->second_.Size() && i->second_[index] == component)
+    {
+        PODVector<Component*>& typeComponents = i->second_;
+        Component* last = typeComponents.Back();
+        typeComponents[index] = last;
+        last->sceneTypeIndex_ = index;
+        typeComponents.Pop();
+    }
+    component->sceneTypeIndex_ = M_MAX_UNSIGNED;
+
     component->SetID(0);
     component->OnSceneSet(0);
 }
@@ -1116,10 +1149,10 @@ void Scene::CleanupConnection(Connection* connection)
 {
     Node::CleanupConnection(connection);
 
-    for (HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+    for (FlatHashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
         i->second_->CleanupConnection(connection);
 
-    for (HashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Begin(); i != replicatedComponents_.End(); ++i)
+    for (FlatHashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Begin(); i != replicatedComponents_.End(); ++i)
         i->second_->CleanupConnection(connection);
 }
 
@@ -1166,13 +1199,12 @@ void Scene::MarkReplicationDirty(Node* node)
     }
 }
 
-void Scene::HandleUpdate(StringHash eventType, VariantMap& eventData)
+void Scene::HandleUpdate(StringHash eventType, const Atomic::Update::Payload& eventData)
 {
     if (!updateEnabled_)
         return;
 
-    using namespace Update;
-    Update(eventData[P_TIMESTEP].GetFloat());
+    Update(eventData.timeStep_);
 }
 
 void Scene::HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData)
@@ -1532,6 +1564,20 @@ void Scene::PreloadResourcesJSON(const JSONValue& value)
 #endif
 }
 
+void SceneUpdate::Payload::ToVariantMap(VariantMap& dest) const
+{
+    dest[P_SCENE] = scene_;
+    dest[P_TIMESTEP] = timeStep_;
+}
+
+void SceneUpdate::Payload::FromVariantMap(const VariantMap& source)
+{
+    const Variant* scene = source[P_SCENE];
+    const Variant* timeStep = source[P_TIMESTEP];
+    scene_ = scene ? static_cast<Scene*>(scene->GetPtr()) : 0;
+    timeStep_ = timeStep ? timeStep->GetFloat() : 0.0f;
+}
+
 void RegisterSceneLibrary(Context* context)
 {
     ValueAnimation::RegisterObject(context);
@@ -22,7 +22,9 @@
 
 #pragma once
 
+#include "../Container/FlatHashMap.h"
 #include "../Container/HashSet.h"
+#include "../Core/CoreEvents.h"
 #include "../Core/Mutex.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
@@ -171,6 +173,10 @@ public:
     Component* GetComponent(unsigned id) const;
     /// Get nodes with specific tag from the whole scene, return false if empty.
     bool GetNodesWithTag(PODVector<Node*>& dest, const String& tag)  const;
+    /// Return all components of an exact type in the whole scene, in no particular order. The list is updated as components are added and removed, so copy it before modifying the scene while iterating.
+    const PODVector<Component*>& GetComponentsOfType(StringHash type) const;
+    /// Template version of returning all components of an exact type in the whole scene. The elements are of type T, static_cast them to use them as such.
+    template <class T> const PODVector<Component*>& GetComponentsOfType() const;
 
     /// Return whether updates are enabled.
     bool IsUpdateEnabled() const { return updateEnabled_; }
@@ -258,7 +264,7 @@ public:
 
 private:
     /// Handle the logic update event to update the scene, if active.
-    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleUpdate(StringHash eventType, const Atomic::Update::Payload& eventData);
     /// Handle a background loaded resource completing.
     void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
     /// Update asynchronous loading.
@@ -277,15 +283,17 @@ private:
     void PreloadResourcesJSON(const JSONValue& value);
 
     /// Replicated scene nodes by ID.
-    HashMap<unsigned, Node*> replicatedNodes_;
+    FlatHashMap<unsigned, Node*> replicatedNodes_;
     /// Local scene nodes by ID.
-    HashMap<unsigned, Node*> localNodes_;
+    FlatHashMap<unsigned, Node*> localNodes_;
     /// Replicated components by ID.
-    HashMap<unsigned, Component*> replicatedComponents_;
+    FlatHashMap<unsigned, Component*> replicatedComponents_;
     /// Local components by ID.
-    HashMap<unsigned, Component*> localComponents_;
+    FlatHashMap<unsigned, Component*> localComponents_;
     /// Cached tagged nodes by tag.
     HashMap<StringHash, PODVector<Node*> > taggedNodes_;
+    /// Dense component lists by type. Components are swap-removed using their stored index.
+    FlatHashMap<StringHash, PODVector<Component*> > componentsByType_;
     /// Asynchronous loading progress.
     AsyncProgress asyncProgress_;
     /// Node and component ID resolver for asynchronous loading.
@@ -334,6 +342,11 @@ private:
     bool threadedUpdate_;
 };
 
+template <class T> const PODVector<Component*>& Scene::GetComponentsOfType() const
+{
+    return GetComponentsOfType(T::GetTypeStatic());
+}
+
 /// Register Scene library objects.
 void ATOMIC_API RegisterSceneLibrary(Context* context);
 
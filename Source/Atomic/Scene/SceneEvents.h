@@ -27,11 +27,27 @@
 namespace Atomic
 {
 
+class Scene;
+
 /// Variable timestep scene update.
 ATOMIC_EVENT(E_SCENEUPDATE, SceneUpdate)
 {
     ATOMIC_PARAM(P_SCENE, Scene);                  // Scene pointer
     ATOMIC_PARAM(P_TIMESTEP, TimeStep);            // float
+
+    /// Typed payload. Sent with Object::SendTypedEvent.
+    struct ATOMIC_API Payload
+    {
+        /// Convert to event parameters.
+        void ToVariantMap(VariantMap& dest) const;
+        /// Fill from event parameters.
+        void FromVariantMap(const VariantMap& source);
+
+        /// Scene.
+        Scene* scene_;
+        /// Time step.
+        float timeStep_;
+    };
 }
 
 /// Scene subsystem update.
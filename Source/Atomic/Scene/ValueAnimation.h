@@ -129,6 +129,9 @@ public:
     /// Has event frames.
     bool HasEventFrames() const { return !eventFrames_.Empty(); }
 
+    /// Return number of event frames.
+    unsigned GetNumEventFrames() const { return eventFrames_.Size(); }
+
     /// Return all event frames between time.
     void GetEventFrames(float beginTime, float endTime, PODVector<const VAnimEventFrame*>& eventFrames) const;
 
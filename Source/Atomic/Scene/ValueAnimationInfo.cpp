@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/FrameAllocator.h"
 #include "../IO/Log.h"
 #include "../Scene/ValueAnimation.h"
 #include "../Scene/ValueAnimationInfo.h"
@@ -95,7 +96,11 @@ bool ValueAnimationInfo::SetTime(float time)
     // Send keyframe event if necessary
     if (animation_->HasEventFrames())
     {
+        // The list only lives for this update, so take it from the frame arena when available
         PODVector<const VAnimEventFrame*> eventFrames;
+        FrameAllocator* frameAllocator = target_->GetSubsystem<FrameAllocator>();
+        if (frameAllocator)
+            eventFrames.Reserve(animation_->GetNumEventFrames(), frameAllocator->GetArena());
         GetEventFrames(lastScaledTime_, scaledTime, eventFrames);
 
         if (eventFrames.Size())
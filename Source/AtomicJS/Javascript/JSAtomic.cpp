@@ -399,7 +399,8 @@ void jsapi_init_atomic(JSVM* vm)
     duk_push_global_stash(ctx);
     duk_push_object(ctx);
     duk_put_prop_index(ctx, -2, JS_GLOBALSTASH_VARIANTMAP_CACHE);
-    duk_push_object(ctx);
+    // dense array of stashed objects, indexed by RefCounted stash slot
+    duk_push_array(ctx);
     duk_put_prop_index(ctx, -2, JS_GLOBALSTASH_INDEX_REFCOUNTED_REGISTRY);
     duk_pop(ctx);
 
@@ -27,11 +27,9 @@
 #include <Atomic/Resource/ResourceCache.h>
 
 #ifdef ATOMIC_PHYSICS
-#include <Atomic/Physics/PhysicsEvents.h>
 #include <Atomic/Physics/PhysicsWorld.h>
 #endif
 #include <Atomic/Scene/Scene.h>
-#include <Atomic/Scene/SceneEvents.h>
 
 #include "JSVM.h"
 #include "JSComponentFile.h"
@@ -42,6 +40,16 @@ namespace Atomic
 
 extern const char* LOGIC_CATEGORY;
 
+static const char* scriptMethodNames[] =
+{
+    "start",
+    "delayedStart",
+    "update",
+    "postUpdate",
+    "fixedUpdate",
+    "fixedPostUpdate"
+};
+
 class JSComponentFactory : public ObjectFactory
 {
     ATOMIC_REFCOUNTED(JSComponentFactory)
@@ -125,14 +133,24 @@ JSComponent::JSComponent(Context* context) :
     started_(false),
     destroyed_(false),
     scriptClassInstance_(false),
-    delayedStartCalled_(false)
+    delayedStartCalled_(false),
+    scriptMethodsResolved_(false)
 {
     vm_ = JSVM::GetJSVM(NULL);
+
+    for (unsigned i = 0; i < MAX_SCRIPT_METHODS; i++)
+        scriptMethods_[i] = 0;
+
+    for (unsigned i = 0; i < MAX_JSCOMPONENT_UPDATE_PHASES; i++)
+    {
+        updateGroups_[i] = M_MAX_UNSIGNED;
+        updateSlots_[i] = M_MAX_UNSIGNED;
+    }
 }
 
 JSComponent::~JSComponent()
 {
-
+    RemoveEventSubscription();
 }
 
 void JSComponent::RegisterObject(Context* context)
@@ -269,13 +287,12 @@ void JSComponent::InitInstance(bool hasArgs, int argIdx)
 
     instanceInitialized_ = true;
 
+    ResolveScriptMethods();
+
 }
 
-void JSComponent::CallScriptMethod(const String& name, bool passValue, float value)
+void JSComponent::ResolveScriptMethods()
 {
-    if (destroyed_ || !node_ || !node_->GetScene())
-        return;
-
     void* heapptr = JSGetHeapPtr();
 
     if (!heapptr)
@@ -287,12 +304,66 @@ void JSComponent::CallScriptMethod(const String& name, bool passValue, float val
 
     duk_push_heapptr(ctx, heapptr);
 
-    duk_get_prop_string(ctx, -1, name.CString());
+    // the functions are held by the instance, so the heap pointers stay valid
+    // even if the script later replaces the properties
+    duk_push_array(ctx);
 
-    if (!duk_is_function(ctx, -1))
+    for (unsigned i = 0; i < MAX_SCRIPT_METHODS; i++)
     {
-        duk_set_top(ctx, top);
+        duk_get_prop_string(ctx, -2, scriptMethodNames[i]);
+
+        if (duk_is_function(ctx, -1))
+        {
+            scriptMethods_[i] = duk_get_heapptr(ctx, -1);
+            duk_put_prop_index(ctx, -2, i);
+        }
+        else
+        {
+            scriptMethods_[i] = 0;
+            duk_pop(ctx);
+        }
+    }
+
+    duk_put_prop_string(ctx, -2, "__scriptMethods");
+
+    duk_set_top(ctx, top);
+
+    scriptMethodsResolved_ = true;
+}
+
+void JSComponent::CallScriptMethod(ScriptMethod method, bool passValue, float value)
+{
+    if (destroyed_ || !node_ || !node_->GetScene())
+        return;
+
+    void* heapptr = JSGetHeapPtr();
+
+    if (!heapptr)
         return;
+
+    if (scriptMethodsResolved_ && !scriptMethods_[method])
+        return;
+
+    duk_context* ctx = vm_->GetJSContext();
+
+    duk_idx_t top = duk_get_top(ctx);
+
+    if (scriptMethodsResolved_)
+    {
+        duk_push_heapptr(ctx, scriptMethods_[method]);
+    }
+    else
+    {
+        // not resolved yet, look the method up by name
+        duk_push_heapptr(ctx, heapptr);
+
+        duk_get_prop_string(ctx, -1, scriptMethodNames[method]);
+
+        if (!duk_is_function(ctx, -1))
+        {
+            duk_set_top(ctx, top);
+            return;
+        }
     }
 
     // push this
@@ -316,14 +387,12 @@ void JSComponent::CallScriptMethod(const String& name, bool passValue, float val
 
 void JSComponent::Start()
 {
-    static String name = "start";
-    CallScriptMethod(name);
+    CallScriptMethod(METHOD_START);
 }
 
 void JSComponent::DelayedStart()
 {
-    static String name = "delayedStart";
-    CallScriptMethod(name);
+    CallScriptMethod(METHOD_DELAYEDSTART);
 }
 
 void JSComponent::Update(float timeStep)
@@ -335,28 +404,28 @@ void JSComponent::Update(float timeStep)
     {
         started_ = true;
         Start();
+
+        // start may have assigned methods on the instance
+        if (instanceInitialized_)
+            ResolveScriptMethods();
     }
 
-    static String name = "update";
-    CallScriptMethod(name, true, timeStep);
+    CallScriptMethod(METHOD_UPDATE, true, timeStep);
 }
 
 void JSComponent::PostUpdate(float timeStep)
 {
-    static String name = "postUpdate";
-    CallScriptMethod(name, true, timeStep);
+    CallScriptMethod(METHOD_POSTUPDATE, true, timeStep);
 }
 
 void JSComponent::FixedUpdate(float timeStep)
 {
-    static String name = "fixedUpdate";
-    CallScriptMethod(name, true, timeStep);
+    CallScriptMethod(METHOD_FIXEDUPDATE, true, timeStep);
 }
 
 void JSComponent::FixedPostUpdate(float timeStep)
 {
-    static String name = "fixedPostUpdate";
-    CallScriptMethod(name, true, timeStep);
+    CallScriptMethod(METHOD_FIXEDPOSTUPDATE, true, timeStep);
 }
 
 void JSComponent::OnNodeSet(Node* node)
@@ -375,46 +444,44 @@ void JSComponent::OnSceneSet(Scene* scene)
     if (scene)
         UpdateEventSubscription();
     else
-    {
-        UnsubscribeFromEvent(E_SCENEUPDATE);
-        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
-#ifdef ATOMIC_PHYSICS
-        UnsubscribeFromEvent(E_PHYSICSPRESTEP);
-        UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
-#endif
-        currentEventMask_ = 0;
-    }
+        RemoveEventSubscription();
 }
 
 void JSComponent::UpdateEventSubscription()
 {
     Scene* scene = GetScene();
-    if (!scene)
+    if (!scene || !vm_)
         return;
 
+    if (!updater_ || updater_->GetScene() != scene)
+    {
+        RemoveEventSubscription();
+        updater_ = vm_->GetComponentUpdater(scene);
+    }
+
     bool enabled = IsEnabledEffective();
 
     bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
     if (needUpdate && !(currentEventMask_ & USE_UPDATE))
     {
-        SubscribeToEvent(scene, E_SCENEUPDATE, ATOMIC_HANDLER(JSComponent, HandleSceneUpdate));
+        updater_->AddComponent(this, JSCOMPONENT_UPDATE);
         currentEventMask_ |= USE_UPDATE;
     }
     else if (!needUpdate && (currentEventMask_ & USE_UPDATE))
     {
-        UnsubscribeFromEvent(scene, E_SCENEUPDATE);
+        updater_->RemoveComponent(this, JSCOMPONENT_UPDATE);
         currentEventMask_ &= ~USE_UPDATE;
     }
 
     bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
     if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
     {
-        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, ATOMIC_HANDLER(JSComponent, HandleScenePostUpdate));
+        updater_->AddComponent(this, JSCOMPONENT_POSTUPDATE);
         currentEventMask_ |= USE_POSTUPDATE;
     }
     else if (!needPostUpdate && (currentEventMask_ & USE_POSTUPDATE))
     {
-        UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
+        updater_->RemoveComponent(this, JSCOMPONENT_POSTUPDATE);
         currentEventMask_ &= ~USE_POSTUPDATE;
     }
 
@@ -426,79 +493,93 @@ void JSComponent::UpdateEventSubscription()
     bool needFixedUpdate = enabled && (updateEventMask_ & USE_FIXEDUPDATE);
     if (needFixedUpdate && !(currentEventMask_ & USE_FIXEDUPDATE))
     {
-        SubscribeToEvent(world, E_PHYSICSPRESTEP, ATOMIC_HANDLER(JSComponent, HandlePhysicsPreStep));
+        updater_->AddComponent(this, JSCOMPONENT_FIXEDUPDATE);
         currentEventMask_ |= USE_FIXEDUPDATE;
     }
     else if (!needFixedUpdate && (currentEventMask_ & USE_FIXEDUPDATE))
     {
-        UnsubscribeFromEvent(world, E_PHYSICSPRESTEP);
+        updater_->RemoveComponent(this, JSCOMPONENT_FIXEDUPDATE);
         currentEventMask_ &= ~USE_FIXEDUPDATE;
     }
 
     bool needFixedPostUpdate = enabled && (updateEventMask_ & USE_FIXEDPOSTUPDATE);
     if (needFixedPostUpdate && !(currentEventMask_ & USE_FIXEDPOSTUPDATE))
     {
-        SubscribeToEvent(world, E_PHYSICSPOSTSTEP, ATOMIC_HANDLER(JSComponent, HandlePhysicsPostStep));
+        updater_->AddComponent(this, JSCOMPONENT_FIXEDPOSTUPDATE);
         currentEventMask_ |= USE_FIXEDPOSTUPDATE;
     }
     else if (!needFixedPostUpdate && (currentEventMask_ & USE_FIXEDPOSTUPDATE))
     {
-        UnsubscribeFromEvent(world, E_PHYSICSPOSTSTEP);
+        updater_->RemoveComponent(this, JSCOMPONENT_FIXEDPOSTUPDATE);
         currentEventMask_ &= ~USE_FIXEDPOSTUPDATE;
     }
 #endif
 }
 
-void JSComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+void JSComponent::RemoveEventSubscription()
 {
-    using namespace SceneUpdate;
-
-    assert(!destroyed_);
-
-    // Execute user-defined delayed start function before first update
-    if (!delayedStartCalled_)
+    if (updater_)
     {
-        DelayedStart();
-        delayedStartCalled_ = true;
-
-        // If did not need actual update events, unsubscribe now
-        if (!(updateEventMask_ & USE_UPDATE))
-        {
-            UnsubscribeFromEvent(GetScene(), E_SCENEUPDATE);
-            currentEventMask_ &= ~USE_UPDATE;
-            return;
-        }
+        if (currentEventMask_ & USE_UPDATE)
+            updater_->RemoveComponent(this, JSCOMPONENT_UPDATE);
+        if (currentEventMask_ & USE_POSTUPDATE)
+            updater_->RemoveComponent(this, JSCOMPONENT_POSTUPDATE);
+        if (currentEventMask_ & USE_FIXEDUPDATE)
+            updater_->RemoveComponent(this, JSCOMPONENT_FIXEDUPDATE);
+        if (currentEventMask_ & USE_FIXEDPOSTUPDATE)
+            updater_->RemoveComponent(this, JSCOMPONENT_FIXEDPOSTUPDATE);
     }
 
-    // Then execute user-defined update function
-    Update(eventData[P_TIMESTEP].GetFloat());
+    currentEventMask_ = 0;
 }
 
-void JSComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+void JSComponent::DispatchUpdate(JSComponentUpdatePhase phase, float timeStep)
 {
-    using namespace ScenePostUpdate;
+    switch (phase)
+    {
+    case JSCOMPONENT_UPDATE:
 
-    // Execute user-defined post-update function
-    PostUpdate(eventData[P_TIMESTEP].GetFloat());
-}
+        assert(!destroyed_);
 
-#ifdef ATOMIC_PHYSICS
-void JSComponent::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
-{
-    using namespace PhysicsPreStep;
+        // Execute user-defined delayed start function before first update
+        if (!delayedStartCalled_)
+        {
+            DelayedStart();
+            delayedStartCalled_ = true;
 
-    // Execute user-defined fixed update function
-    FixedUpdate(eventData[P_TIMESTEP].GetFloat());
-}
+            // If did not need actual update events, unregister now
+            if (!(updateEventMask_ & USE_UPDATE))
+            {
+                if (updater_)
+                    updater_->RemoveComponent(this, JSCOMPONENT_UPDATE);
+                currentEventMask_ &= ~USE_UPDATE;
+                return;
+            }
+        }
 
-void JSComponent::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
-{
-    using namespace PhysicsPostStep;
+        // Then execute user-defined update function
+        Update(timeStep);
+        break;
 
-    // Execute user-defined fixed post-update function
-    FixedPostUpdate(eventData[P_TIMESTEP].GetFloat());
+    case JSCOMPONENT_POSTUPDATE:
+        // Execute user-defined post-update function
+        PostUpdate(timeStep);
+        break;
+
+    case JSCOMPONENT_FIXEDUPDATE:
+        // Execute user-defined fixed update function
+        FixedUpdate(timeStep);
+        break;
+
+    case JSCOMPONENT_FIXEDPOSTUPDATE:
+        // Execute user-defined fixed post-update function
+        FixedPostUpdate(timeStep);
+        break;
+
+    default:
+        break;
+    }
 }
-#endif
 
 bool JSComponent::MatchScriptName(const String& path)
 {
@@ -26,6 +26,7 @@
 #include <Atomic/Script/ScriptComponent.h>
 
 #include "JSComponentFile.h"
+#include "JSComponentUpdater.h"
 
 namespace Atomic
 {
@@ -37,6 +38,7 @@ class JSComponent : public ScriptComponent
 {
     friend class JSComponentFactory;
     friend class JSComponentFile;
+    friend class JSComponentUpdater;
 
     ATOMIC_OBJECT(JSComponent, ScriptComponent);
 
@@ -48,6 +50,17 @@ class JSComponent : public ScriptComponent
         USE_FIXEDPOSTUPDATE = 0x8
     };
 
+    enum ScriptMethod
+    {
+        METHOD_START = 0,
+        METHOD_DELAYEDSTART,
+        METHOD_UPDATE,
+        METHOD_POSTUPDATE,
+        METHOD_FIXEDUPDATE,
+        METHOD_FIXEDPOSTUPDATE,
+        MAX_SCRIPT_METHODS
+    };
+
 public:
 
     /// Construct.
@@ -96,20 +109,16 @@ protected:
     virtual void OnSceneSet(Scene* scene);
 
 private:
-    /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
+    /// Register/unregister with the scene's component updater based on current enabled state and update event mask.
     void UpdateEventSubscription();
-    /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
-    /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
-#ifdef ATOMIC_PHYSICS
-    /// Handle physics pre-step event.
-    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
-    /// Handle physics post-step event.
-    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
-#endif
-
-    void CallScriptMethod(const String& name, bool passValue = false, float value = 0.0f);
+    /// Unregister from all update phases.
+    void RemoveEventSubscription();
+    /// Handle an update phase, called by the scene's component updater.
+    void DispatchUpdate(JSComponentUpdatePhase phase, float timeStep);
+
+    /// Resolve the script methods of the instance once, so calling them needs no property lookup.
+    void ResolveScriptMethods();
+    void CallScriptMethod(ScriptMethod method, bool passValue = false, float value = 0.0f);
 
     /// Called when the component is added to a scene node. Other components may not yet exist.
     virtual void Start();
@@ -143,6 +152,16 @@ private:
     WeakPtr<JSVM> vm_;
     SharedPtr<JSComponentFile> componentFile_;
 
+    /// Script method heap pointers, kept alive by the instance, null if not defined.
+    void* scriptMethods_[MAX_SCRIPT_METHODS];
+    bool scriptMethodsResolved_;
+
+    /// Updater of the scene the component is registered with.
+    WeakPtr<JSComponentUpdater> updater_;
+    /// Group and slot in the updater for each phase.
+    unsigned updateGroups_[MAX_JSCOMPONENT_UPDATE_PHASES];
+    unsigned updateSlots_[MAX_JSCOMPONENT_UPDATE_PHASES];
+
 };
 
 }
@@ -0,0 +1,224 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Atomic/Core/Profiler.h>
+#ifdef ATOMIC_PHYSICS
+#include <Atomic/Physics/PhysicsEvents.h>
+#include <Atomic/Physics/PhysicsWorld.h>
+#endif
+#include <Atomic/Scene/Scene.h>
+#include <Atomic/Scene/SceneEvents.h>
+
+#include "JSComponent.h"
+#include "JSComponentUpdater.h"
+
+namespace Atomic
+{
+
+JSComponentUpdater::JSComponentUpdater(Context* context, Scene* scene) :
+    Object(context),
+    scene_(scene)
+{
+    for (unsigned i = 0; i < MAX_JSCOMPONENT_UPDATE_PHASES; i++)
+    {
+        numComponents_[i] = 0;
+        dispatching_[i] = false;
+    }
+
+    SubscribeToEvent(scene, E_SCENEUPDATE, ATOMIC_HANDLER(JSComponentUpdater, HandleSceneUpdate));
+    SubscribeToEvent(scene, E_SCENEPOSTUPDATE, ATOMIC_HANDLER(JSComponentUpdater, HandleScenePostUpdate));
+}
+
+JSComponentUpdater::~JSComponentUpdater()
+{
+
+}
+
+void JSComponentUpdater::AddComponent(JSComponent* component, JSComponentUpdatePhase phase)
+{
+    Vector<ComponentGroup>& groups = groups_[phase];
+    JSComponentFile* componentFile = component->componentFile_;
+
+    unsigned groupIndex = groups.Size();
+    for (unsigned i = 0; i < groups.Size(); i++)
+    {
+        if (groups[i].componentFile_ == componentFile)
+        {
+            groupIndex = i;
+            break;
+        }
+    }
+
+    if (groupIndex == groups.Size())
+    {
+        groups.Resize(groupIndex + 1);
+        groups[groupIndex].componentFile_ = componentFile;
+    }
+
+    ComponentGroup& group = groups[groupIndex];
+
+    // keep churn from growing the group when it is not being dispatched
+    if (!dispatching_[phase] && group.numRemoved_ > group.components_.Size() / 2)
+        Compact(group, phase);
+
+    component->updateGroups_[phase] = groupIndex;
+    component->updateSlots_[phase] = group.components_.Size();
+    group.components_.Push(component);
+
+    numComponents_[phase]++;
+
+    if (phase == JSCOMPONENT_FIXEDUPDATE || phase == JSCOMPONENT_FIXEDPOSTUPDATE)
+        UpdatePhysicsSubscription();
+}
+
+void JSComponentUpdater::RemoveComponent(JSComponent* component, JSComponentUpdatePhase phase)
+{
+    unsigned groupIndex = component->updateGroups_[phase];
+    unsigned slot = component->updateSlots_[phase];
+
+    if (groupIndex >= groups_[phase].Size())
+        return;
+
+    ComponentGroup& group = groups_[phase][groupIndex];
+
+    if (slot >= group.components_.Size() || group.components_[slot] != component)
+        return;
+
+    // leave a hole, the group may be iterated right now, compacted before next dispatch
+    group.components_[slot] = 0;
+    group.numRemoved_++;
+
+    component->updateGroups_[phase] = M_MAX_UNSIGNED;
+    component->updateSlots_[phase] = M_MAX_UNSIGNED;
+
+    numComponents_[phase]--;
+}
+
+unsigned JSComponentUpdater::GetNumComponents() const
+{
+    unsigned count = 0;
+    for (unsigned i = 0; i < MAX_JSCOMPONENT_UPDATE_PHASES; i++)
+        count += numComponents_[i];
+
+    return count;
+}
+
+void JSComponentUpdater::Dispatch(JSComponentUpdatePhase phase, float timeStep)
+{
+    if (!numComponents_[phase] || dispatching_[phase])
+        return;
+
+    dispatching_[phase] = true;
+
+    // groups may be added while dispatching, so always index
+    for (unsigned i = 0; i < groups_[phase].Size(); i++)
+    {
+        if (groups_[phase][i].numRemoved_)
+            Compact(groups_[phase][i], phase);
+
+        // components registered during dispatch are called on the next one
+        unsigned numComponents = groups_[phase][i].components_.Size();
+
+        for (unsigned j = 0; j < numComponents; j++)
+        {
+            JSComponent* component = groups_[phase][i].components_[j];
+
+            if (component)
+                component->DispatchUpdate(phase, timeStep);
+        }
+    }
+
+    dispatching_[phase] = false;
+}
+
+void JSComponentUpdater::Compact(ComponentGroup& group, JSComponentUpdatePhase phase)
+{
+    PODVector<JSComponent*>& components = group.components_;
+
+    unsigned dest = 0;
+    for (unsigned i = 0; i < components.Size(); i++)
+    {
+        JSComponent* component = components[i];
+
+        if (!component)
+            continue;
+
+        components[dest] = component;
+        component->updateSlots_[phase] = dest;
+        dest++;
+    }
+
+    components.Resize(dest);
+    group.numRemoved_ = 0;
+}
+
+void JSComponentUpdater::UpdatePhysicsSubscription()
+{
+#ifdef ATOMIC_PHYSICS
+    if (physicsWorld_ || !scene_)
+        return;
+
+    PhysicsWorld* world = scene_->GetComponent<PhysicsWorld>();
+    if (!world)
+        return;
+
+    physicsWorld_ = world;
+    SubscribeToEvent(world, E_PHYSICSPRESTEP, ATOMIC_HANDLER(JSComponentUpdater, HandlePhysicsPreStep));
+    SubscribeToEvent(world, E_PHYSICSPOSTSTEP, ATOMIC_HANDLER(JSComponentUpdater, HandlePhysicsPostStep));
+#endif
+}
+
+void JSComponentUpdater::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    ATOMIC_PROFILE(JSComponentUpdate);
+
+    using namespace SceneUpdate;
+    Dispatch(JSCOMPONENT_UPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+void JSComponentUpdater::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    ATOMIC_PROFILE(JSComponentPostUpdate);
+
+    using namespace ScenePostUpdate;
+    Dispatch(JSCOMPONENT_POSTUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+#ifdef ATOMIC_PHYSICS
+void JSComponentUpdater::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
+{
+    ATOMIC_PROFILE(JSComponentFixedUpdate);
+
+    using namespace PhysicsPreStep;
+    Dispatch(JSCOMPONENT_FIXEDUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+void JSComponentUpdater::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+{
+    ATOMIC_PROFILE(JSComponentFixedPostUpdate);
+
+    using namespace PhysicsPostStep;
+    Dispatch(JSCOMPONENT_FIXEDPOSTUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+#endif
+
+}
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2017 the Atomic project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Atomic/Core/Object.h>
+
+namespace Atomic
+{
+
+class JSComponent;
+class JSComponentFile;
+class PhysicsWorld;
+class Scene;
+
+/// Update phases dispatched to JSComponents
+enum JSComponentUpdatePhase
+{
+    JSCOMPONENT_UPDATE = 0,
+    JSCOMPONENT_POSTUPDATE,
+    JSCOMPONENT_FIXEDUPDATE,
+    JSCOMPONENT_FIXEDPOSTUPDATE,
+    MAX_JSCOMPONENT_UPDATE_PHASES
+};
+
+/// Per scene dispatcher of JSComponent update phases. Replaces per component event subscriptions,
+/// the scene events are handled once and the components of each script class are walked in one loop
+class JSComponentUpdater : public Object
+{
+    ATOMIC_OBJECT(JSComponentUpdater, Object)
+
+public:
+
+    /// Construct.
+    JSComponentUpdater(Context* context, Scene* scene);
+    /// Destruct.
+    virtual ~JSComponentUpdater();
+
+    /// Register a component for an update phase
+    void AddComponent(JSComponent* component, JSComponentUpdatePhase phase);
+    /// Unregister a component from an update phase, safe to call while the phase is being dispatched
+    void RemoveComponent(JSComponent* component, JSComponentUpdatePhase phase);
+
+    /// Return the scene
+    Scene* GetScene() const { return scene_; }
+    /// Return number of registered components over all phases
+    unsigned GetNumComponents() const;
+
+private:
+
+    /// Components of one script class registered for a phase, in registration order
+    struct ComponentGroup
+    {
+        ComponentGroup() :
+            componentFile_(0),
+            numRemoved_(0)
+        {
+        }
+
+        /// Script class, the component file holds one class
+        JSComponentFile* componentFile_;
+        /// Components, removed components are null until compacted
+        PODVector<JSComponent*> components_;
+        /// Number of removed components
+        unsigned numRemoved_;
+    };
+
+    /// Call the phase on all registered components, class by class
+    void Dispatch(JSComponentUpdatePhase phase, float timeStep);
+    /// Remove null entries from a group and update component slots
+    void Compact(ComponentGroup& group, JSComponentUpdatePhase phase);
+    /// Subscribe to the physics world steps if fixed update phases are in use
+    void UpdatePhysicsSubscription();
+
+    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+#ifdef ATOMIC_PHYSICS
+    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
+#endif
+
+    WeakPtr<Scene> scene_;
+#ifdef ATOMIC_PHYSICS
+    WeakPtr<PhysicsWorld> physicsWorld_;
+#endif
+
+    /// Class groups per phase, in order of first registration
+    Vector<ComponentGroup> groups_[MAX_JSCOMPONENT_UPDATE_PHASES];
+    /// Number of registered components per phase
+    unsigned numComponents_[MAX_JSCOMPONENT_UPDATE_PHASES];
+    /// Whether a phase is being dispatched
+    bool dispatching_[MAX_JSCOMPONENT_UPDATE_PHASES];
+};
+
+}
@@ -39,15 +39,22 @@ JSEventDispatcher::~JSEventDispatcher()
 {
 }
 
-void JSEventDispatcher::BeginSendEvent(Context* context, Object* sender, StringHash eventType, VariantMap& eventData)
+void JSEventDispatcher::BeginSendEvent(Context* context, Object* sender, StringHash eventType, TypedEventData& eventData)
 {
+    // Script handlers receive the event through JSEventHelper subscriptions, nothing to do before delivery
 }
 
-void JSEventDispatcher::EndSendEvent(Context* context, Object* sender, StringHash eventType, VariantMap& eventData)
+void JSEventDispatcher::EndSendEvent(Context* context, Object* sender, StringHash eventType, TypedEventData& typedEventData)
 {
     if (!jsEvents_.Contains(eventType))
         return;
 
+    // A script handler that received the event has converted it to a map, otherwise there is nothing cached to clear
+    if (!typedEventData.IsConverted())
+        return;
+
+    VariantMap& eventData = typedEventData.GetVariantMap();
+
     JSVM* vm = JSVM::GetJSVM(NULL);
 
     if (!vm)
@@ -26,14 +26,19 @@
 
 #include <Atomic/Core/Profiler.h>
 #include <Atomic/Core/CoreEvents.h>
+#include <Atomic/Engine/Engine.h>
+#include <Atomic/Graphics/GraphicsEvents.h>
 
 #include <Atomic/IO/File.h>
 #include <Atomic/IO/Log.h>
 #include <Atomic/IO/FileSystem.h>
 #include <Atomic/IO/PackageFile.h>
 
+#include <Atomic/Metrics/Metrics.h>
 #include <Atomic/Resource/ResourceCache.h>
 
+#include <Atomic/Scene/Scene.h>
+
 #include "JSRequire.h"
 #include "JSPlugin.h"
 #include "JSEvents.h"
@@ -42,6 +47,7 @@
 #include "JSUI.h"
 #include "JSMetrics.h"
 #include "JSEventHelper.h"
+#include "JSComponentUpdater.h"
 
 namespace Atomic
 {
@@ -49,13 +55,36 @@ namespace Atomic
 JSVM* JSVM::instance_ = NULL;
 Vector<JSVM::JSAPIPackageRegistration*> JSVM::packageRegistrations_;
 
+// heap allocations carry their size in front, keeps the block aligned for any type
+static const unsigned JS_HEAP_HEADER_SIZE = 16;
+
+static const float JS_GC_DEFAULT_BUDGET = 2.0f;
+static const float JS_GC_DEFAULT_HITCH_CEILING = 8.0f;
+static const float JS_GC_DEFAULT_MAX_INTERVAL = 5.0f;
+static const unsigned JS_GC_DEFAULT_ALLOCATION_THRESHOLD = 4 * 1024 * 1024;
+
 JSVM::JSVM(Context* context) :
     Object(context),
     ctx_(0),
     gcTime_(0.0f),
+    gcBudget_(JS_GC_DEFAULT_BUDGET),
+    gcHitchCeiling_(JS_GC_DEFAULT_HITCH_CEILING),
+    gcMaxInterval_(JS_GC_DEFAULT_MAX_INTERVAL),
+    gcAllocationThreshold_(JS_GC_DEFAULT_ALLOCATION_THRESHOLD),
+    gcPassesPending_(0),
+    gcPassCost_(0.0f),
+    heapSize_(0),
+    heapSizeAtGC_(0),
+    gcCount_(0),
+    lastGCPause_(0.0f),
+    maxGCPause_(0.0f),
+    frameBusyTime_(0.0f),
+    frameRendered_(false),
     stashCount_(0),
     totalStashCount_(0),
-    totalUnstashCount_(0)
+    totalUnstashCount_(0),
+    stashRegistry_(0),
+    stashSlotCount_(0)
 {
     assert(!instance_);
 
@@ -72,6 +101,8 @@ JSVM::JSVM(Context* context) :
 
 JSVM::~JSVM()
 {
+    componentUpdaters_.Clear();
+
     context_->RemoveGlobalEventListener(context_->GetSubsystem<JSEventDispatcher>());
     context_->RemoveSubsystem(JSEventDispatcher::GetTypeStatic());
 
@@ -86,12 +117,18 @@ JSVM::~JSVM()
 
 void JSVM::InitJSContext()
 {
-    ctx_ = duk_create_heap_default();
+    ctx_ = duk_create_heap(HeapAlloc, HeapRealloc, HeapFree, this, NULL);
     duk_logging_init(ctx_, 0);
     duk_module_duktape_init(ctx_);
 
     jsapi_init_atomic(this);
 
+    // keep the stash registry array as a heap pointer, it is reachable from the global stash
+    duk_push_global_stash(ctx_);
+    duk_get_prop_index(ctx_, -1, JS_GLOBALSTASH_INDEX_REFCOUNTED_REGISTRY);
+    stashRegistry_ = duk_get_heapptr(ctx_, -1);
+    duk_pop_2(ctx_);
+
     // register whether we are in the editor
     duk_get_global_string(ctx_, "Atomic");
     duk_push_boolean(ctx_, context_->GetEditorContext() ? 1 : 0);
@@ -145,6 +182,65 @@ void JSVM::RegisterPackage(JSVMPackageRegistrationSettingsFunction regFunction,
 void JSVM::SubscribeToEvents()
 {
     SubscribeToEvent(E_UPDATE, ATOMIC_HANDLER(JSVM, HandleUpdate));
+    SubscribeToEvent(E_BEGINFRAME, ATOMIC_HANDLER(JSVM, HandleBeginFrame));
+    SubscribeToEvent(E_ENDRENDERING, ATOMIC_HANDLER(JSVM, HandleEndRendering));
+    SubscribeToEvent(E_ENDFRAME, ATOMIC_HANDLER(JSVM, HandleEndFrame));
+}
+
+void* JSVM::HeapAlloc(void* udata, duk_size_t size)
+{
+    if (!size)
+        return 0;
+
+    unsigned char* block = (unsigned char*) malloc(size + JS_HEAP_HEADER_SIZE);
+
+    if (!block)
+        return 0;
+
+    *((duk_size_t*) block) = size;
+    ((JSVM*) udata)->heapSize_ += (unsigned) size;
+
+    return block + JS_HEAP_HEADER_SIZE;
+}
+
+void* JSVM::HeapRealloc(void* udata, void* ptr, duk_size_t size)
+{
+    if (!ptr)
+        return HeapAlloc(udata, size);
+
+    if (!size)
+    {
+        HeapFree(udata, ptr);
+        return 0;
+    }
+
+    unsigned char* block = (unsigned char*) ptr - JS_HEAP_HEADER_SIZE;
+    duk_size_t oldSize = *((duk_size_t*) block);
+
+    // on failure the original block is left intact
+    block = (unsigned char*) realloc(block, size + JS_HEAP_HEADER_SIZE);
+
+    if (!block)
+        return 0;
+
+    *((duk_size_t*) block) = size;
+
+    JSVM* vm = (JSVM*) udata;
+    vm->heapSize_ = vm->heapSize_ - (unsigned) oldSize + (unsigned) size;
+
+    return block + JS_HEAP_HEADER_SIZE;
+}
+
+void JSVM::HeapFree(void* udata, void* ptr)
+{
+    if (!ptr)
+        return;
+
+    unsigned char* block = (unsigned char*) ptr - JS_HEAP_HEADER_SIZE;
+
+    ((JSVM*) udata)->heapSize_ -= (unsigned) *((duk_size_t*) block);
+
+    free(block);
 }
 
 void JSVM::OnRefCountChanged(RefCounted* refCounted, int refCount)
@@ -169,28 +265,34 @@ void JSVM::Stash(RefCounted* refCounted)
 {
     assert(refCounted);
     assert(refCounted->JSGetHeapPtr());
+    assert(stashRegistry_);
+
+    // already holding the script object
+    if (refCounted->JSGetStashIndex())
+        return;
 
     totalStashCount_++;
     stashCount_++;
 
-    duk_push_global_stash(ctx_);
-    duk_get_prop_index(ctx_, -1, JS_GLOBALSTASH_INDEX_REFCOUNTED_REGISTRY);
-    // can't use instance as key, as this coerces to [Object] for
-    // string property, pointer will be string representation of
-    // address, so, unique key
-
-/*
-    duk_push_pointer(ctx_, refCounted);
-    duk_get_prop(ctx_, -2);
-    assert(duk_is_undefined(ctx_, -1));
-    duk_pop(ctx_);
-*/
+    // the registry is a dense array indexed by slot, which avoids
+    // stringifying the pointer as a property key, free slots are reused
+    unsigned slot;
+    if (stashFreeSlots_.Size())
+    {
+        slot = stashFreeSlots_.Back();
+        stashFreeSlots_.Pop();
+    }
+    else
+    {
+        slot = stashSlotCount_++;
+    }
 
-    duk_push_pointer(ctx_, refCounted);
+    duk_push_heapptr(ctx_, stashRegistry_);
     duk_push_heapptr(ctx_, refCounted->JSGetHeapPtr());
-    
-    duk_put_prop(ctx_, -3);
-    duk_pop_2(ctx_);
+    duk_put_prop_index(ctx_, -2, slot);
+    duk_pop(ctx_);
+
+    refCounted->JSSetStashIndex(slot + 1);
 
 }
 void JSVM::Unstash(RefCounted* refCounted)
@@ -198,42 +300,31 @@ void JSVM::Unstash(RefCounted* refCounted)
     assert(refCounted);
     assert(refCounted->JSGetHeapPtr());
 
+    unsigned stashIndex = refCounted->JSGetStashIndex();
+    if (!stashIndex)
+        return;
+
     assert(stashCount_ > 0);
 
     stashCount_--;
     totalUnstashCount_++;
 
-    duk_push_global_stash(ctx_);
-    duk_get_prop_index(ctx_, -1, JS_GLOBALSTASH_INDEX_REFCOUNTED_REGISTRY);
-    // can't use instance as key, as this coerces to [Object] for
-    // string property, pointer will be string representation of
-    // address, so, unique key
-
-/*
-    duk_push_pointer(ctx_, refCounted);
-    duk_get_prop(ctx_, -2);
-    assert(!duk_is_undefined(ctx_, -1));
+    unsigned slot = stashIndex - 1;
+
+    // clear the slot rather than deleting it, so the array part stays dense
+    duk_push_heapptr(ctx_, stashRegistry_);
+    duk_push_undefined(ctx_);
+    duk_put_prop_index(ctx_, -2, slot);
     duk_pop(ctx_);
-*/
 
-    duk_push_pointer(ctx_, refCounted);
-    duk_del_prop(ctx_, -2);   
-    duk_pop_2(ctx_);
+    stashFreeSlots_.Push(slot);
+    refCounted->JSSetStashIndex(0);
 }
 
 // Returns if the given object is stashed
 bool JSVM::GetStashed(RefCounted* refcounted) const
 {
-    duk_push_global_stash(ctx_);
-    duk_get_prop_index(ctx_, -1, JS_GLOBALSTASH_INDEX_REFCOUNTED_REGISTRY);
-
-    duk_push_pointer(ctx_, refcounted);
-    duk_get_prop(ctx_, -2);
-
-    bool result = !duk_is_undefined(ctx_, -1);
-
-    duk_pop_3(ctx_);
-    return result;
+    return refcounted->JSGetStashIndex() != 0;
 }
 
 
@@ -247,22 +338,14 @@ void JSVM::HandleUpdate(StringHash eventType, VariantMap& eventData)
     // Take the frame time step, which is stored as a float
     float timeStep = eventData[P_TIMESTEP].GetFloat();
 
-    gcTime_ += timeStep;
-    if (gcTime_ > 5.0f)
+    // release updaters of destroyed scenes or without components
+    HashMap<Scene*, SharedPtr<JSComponentUpdater> >::Iterator itr = componentUpdaters_.Begin();
+    while (itr != componentUpdaters_.End())
     {
-        ATOMIC_PROFILE(JSVM_GC);
-
-        // run twice to call finalizers
-        // see duktape docs
-        // also ensure #define DUK_OPT_NO_VOLUNTARY_GC
-        // is enabled in duktape.h
-        duk_gc(ctx_, 0);
-        duk_gc(ctx_, 0);
-
-        gcTime_ = 0;
-
-        // DumpJavascriptObjects();
-
+        if (!itr->second_->GetScene() || !itr->second_->GetNumComponents())
+            itr = componentUpdaters_.Erase(itr);
+        else
+            itr++;
     }
 
     duk_get_global_string(ctx_, "__js_atomic_main_update");
@@ -280,6 +363,131 @@ void JSVM::HandleUpdate(StringHash eventType, VariantMap& eventData)
     }
 }
 
+JSComponentUpdater* JSVM::GetComponentUpdater(Scene* scene)
+{
+    if (!scene)
+        return 0;
+
+    HashMap<Scene*, SharedPtr<JSComponentUpdater> >::Iterator itr = componentUpdaters_.Find(scene);
+
+    // an expired updater may be keyed by a new scene at the same address
+    if (itr != componentUpdaters_.End() && itr->second_->GetScene() == scene)
+        return itr->second_;
+
+    SharedPtr<JSComponentUpdater> updater(new JSComponentUpdater(context_, scene));
+    componentUpdaters_[scene] = updater;
+
+    return updater;
+}
+
+void JSVM::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    using namespace BeginFrame;
+
+    gcTime_ += eventData[P_TIMESTEP].GetFloat();
+
+    frameTimer_.Reset();
+    frameRendered_ = false;
+}
+
+void JSVM::HandleEndRendering(StringHash eventType, VariantMap& eventData)
+{
+    // frame limiting happens after rendering, so this is the time the frame was busy
+    frameBusyTime_ = frameTimer_.GetUSec(false) / 1000.0f;
+    frameRendered_ = true;
+}
+
+void JSVM::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    if (!ctx_)
+        return;
+
+    float frameBusyTime = frameRendered_ ? frameBusyTime_ : frameTimer_.GetUSec(false) / 1000.0f;
+
+    if (!gcPassesPending_)
+    {
+        unsigned growth = heapSize_ > heapSizeAtGC_ ? heapSize_ - heapSizeAtGC_ : 0;
+
+        // run twice to call finalizers, see duktape docs
+        if (growth >= gcAllocationThreshold_ || gcTime_ >= gcMaxInterval_)
+            gcPassesPending_ = 2;
+    }
+
+    if (gcPassesPending_)
+        RunScheduledGC(frameBusyTime);
+
+    UpdateStatistics();
+}
+
+void JSVM::RunScheduledGC(float frameBusyTime)
+{
+    float budget = gcBudget_;
+
+    // with a frame limit, only use the idle part of the frame
+    Engine* engine = GetSubsystem<Engine>();
+    int maxFps = engine ? engine->GetMaxFps() : 0;
+    if (maxFps > 0)
+        budget = Min(budget, Max(1000.0f / maxFps - frameBusyTime, 0.0f));
+
+    bool overdue = gcTime_ >= gcMaxInterval_;
+    if (overdue)
+        budget = Max(budget, gcHitchCeiling_);
+
+    float pause = 0.0f;
+
+    while (gcPassesPending_)
+    {
+        float heapMB = Max(heapSize_ / (1024.0f * 1024.0f), 0.001f);
+
+        // a pass can't be split, an overdue collection always runs at least one
+        if (pause + gcPassCost_ * heapMB > budget && !(overdue && pause == 0.0f))
+            break;
+
+        HiresTimer timer;
+
+        {
+            ATOMIC_PROFILE(JSVM_GC);
+            duk_gc(ctx_, 0);
+        }
+
+        float passTime = timer.GetUSec(false) / 1000.0f;
+        float passCost = passTime / heapMB;
+
+        gcPassCost_ = gcPassCost_ > 0.0f ? gcPassCost_ * 0.75f + passCost * 0.25f : passCost;
+        pause += passTime;
+        gcPassesPending_--;
+    }
+
+    if (pause > 0.0f)
+    {
+        lastGCPause_ = pause;
+        maxGCPause_ = Max(maxGCPause_, pause);
+    }
+
+    if (!gcPassesPending_)
+    {
+        gcCount_++;
+        gcTime_ = 0.0f;
+        heapSizeAtGC_ = heapSize_;
+    }
+}
+
+void JSVM::UpdateStatistics()
+{
+    Metrics* metrics = GetSubsystem<Metrics>();
+
+    if (!metrics)
+        return;
+
+    metrics->SetStatistic("JS Heap KB", heapSize_ / 1024.0f);
+    metrics->SetStatistic("JS GC Count", (float) gcCount_);
+    metrics->SetStatistic("JS GC Last Pause ms", lastGCPause_);
+    metrics->SetStatistic("JS GC Max Pause ms", maxGCPause_);
+    metrics->SetStatistic("JS Stash Count", (float) stashCount_);
+    metrics->SetStatistic("JS Total Stash Count", (float) totalStashCount_);
+    metrics->SetStatistic("JS Total Unstash Count", (float) totalUnstashCount_);
+}
+
 bool JSVM::ExecuteFunction(const String& functionName)
 {
     duk_get_global_string(ctx_, functionName.CString());
@@ -538,6 +746,11 @@ void JSVM::GC()
     // run twice to ensure finalizers are run
     duk_gc(ctx_, 0);
     duk_gc(ctx_, 0);
+
+    gcPassesPending_ = 0;
+    gcCount_++;
+    gcTime_ = 0.0f;
+    heapSizeAtGC_ = heapSize_;
 }
 
 bool JSVM::ExecuteMain()
@@ -591,9 +804,6 @@ void JSVM::DumpJavascriptObjects()
     StringHash refCountedTypeHash("RefCounted");
     strLookup[refCountedTypeHash] = "RefCounted";
 
-    duk_push_global_stash(ctx_);
-    duk_get_prop_index(ctx_, -1, JS_GLOBALSTASH_INDEX_REFCOUNTED_REGISTRY);
-
     HashMap<void*, RefCounted*>::ConstIterator itr = heapToObject_.Begin();
     while (itr != heapToObject_.End())
     {
@@ -613,17 +823,12 @@ void JSVM::DumpJavascriptObjects()
         if (refCounted->Refs() > maxRefCount[typeHash])
             maxRefCount[typeHash] = refCounted->Refs();
 
-        duk_push_pointer(ctx_, refCounted);
-        duk_get_prop(ctx_, -2);
-
-        if (!duk_is_undefined(ctx_, -1))
+        if (refCounted->JSGetStashIndex())
         {
             stashedClassCount.InsertNew(typeHash, 0);
             stashedClassCount[typeHash]++;
         }
 
-        duk_pop(ctx_);
-
         itr++;
 
     }
@@ -642,8 +847,6 @@ void JSVM::DumpJavascriptObjects()
         itr2++;
     }
 
-    duk_pop_2(ctx_);
-
 }
 
 }
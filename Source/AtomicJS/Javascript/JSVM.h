@@ -24,6 +24,7 @@
 
 #include <Atomic/Core/Context.h>
 #include <Atomic/Core/Object.h>
+#include <Atomic/Core/Timer.h>
 #include <Atomic/Container/List.h>
 
 #include <Atomic/IO/Log.h>
@@ -41,6 +42,8 @@ class JSFile;
 class JSUI;
 class JSMetrics;
 class JSVM;
+class JSComponentUpdater;
+class Scene;
 
 
 /// Registration signature for JSVM package registration
@@ -88,9 +91,36 @@ public:
 
     inline duk_context* GetJSContext() { return ctx_; }
 
+    /// Run a full garbage collection now
     void GC();
     JSMetrics* GetMetrics() { return metrics_; }
 
+    /// Set idle time in milliseconds garbage collection may use after a frame
+    void SetGCBudget(float ms) { gcBudget_ = ms; }
+    /// Return garbage collection frame budget in milliseconds
+    float GetGCBudget() const { return gcBudget_; }
+    /// Set pause in milliseconds an overdue collection may cause in one frame, further passes move to the next frame
+    void SetGCHitchCeiling(float ms) { gcHitchCeiling_ = ms; }
+    /// Return garbage collection hitch ceiling in milliseconds
+    float GetGCHitchCeiling() const { return gcHitchCeiling_; }
+    /// Set heap growth in bytes since the last collection which schedules a collection
+    void SetGCAllocationThreshold(unsigned bytes) { gcAllocationThreshold_ = bytes; }
+    /// Return heap growth which schedules a collection
+    unsigned GetGCAllocationThreshold() const { return gcAllocationThreshold_; }
+    /// Set time in seconds after which a collection is overdue and runs regardless of frame budget
+    void SetGCMaxInterval(float seconds) { gcMaxInterval_ = seconds; }
+    /// Return time after which a collection is overdue
+    float GetGCMaxInterval() const { return gcMaxInterval_; }
+
+    /// Return bytes allocated by the script heap
+    unsigned GetHeapSize() const { return heapSize_; }
+    /// Return number of completed garbage collections
+    unsigned GetGCCount() const { return gcCount_; }
+    /// Return last garbage collection pause in milliseconds
+    float GetLastGCPause() const { return lastGCPause_; }
+    /// Return longest garbage collection pause in milliseconds
+    float GetMaxGCPause() const { return maxGCPause_; }
+
     void DumpJavascriptObjects();
 
 #ifdef JSVM_DEBUG
@@ -228,6 +258,9 @@ public:
     unsigned GetTotalStashCount() const { return totalStashCount_;  }
     unsigned GetTotalUnstashCount() const { return totalUnstashCount_; }
 
+    /// Return the JSComponent updater of a scene, created on first use
+    JSComponentUpdater* GetComponentUpdater(Scene* scene);
+
 private:
 
     void Unstash(RefCounted* refCounted);
@@ -261,8 +294,21 @@ private:
 
     static void OnRefCountChanged(RefCounted* refCounted, int refCount);
 
+    /// Heap allocation functions, track the heap size for garbage collection scheduling
+    static void* HeapAlloc(void* udata, duk_size_t size);
+    static void* HeapRealloc(void* udata, void* ptr, duk_size_t size);
+    static void HeapFree(void* udata, void* ptr);
+
+    /// Run scheduled garbage collection passes which fit the frame
+    void RunScheduledGC(float frameBusyTime);
+    /// Publish heap and stash statistics to the Metrics subsystem
+    void UpdateStatistics();
+
     void SubscribeToEvents();
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    void HandleEndRendering(StringHash eventType, VariantMap& eventData);
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
 
     duk_context* ctx_;
 
@@ -274,8 +320,30 @@ private:
 
 #endif
 
+    // seconds since last collection
     float gcTime_;
 
+    // garbage collection scheduling, voluntary gc is disabled in duk_config.h
+    float gcBudget_;
+    float gcHitchCeiling_;
+    float gcMaxInterval_;
+    unsigned gcAllocationThreshold_;
+    // passes left in the current collection, the second pass runs finalizers
+    unsigned gcPassesPending_;
+    // smoothed pass time in milliseconds per megabyte of heap
+    float gcPassCost_;
+
+    unsigned heapSize_;
+    unsigned heapSizeAtGC_;
+
+    unsigned gcCount_;
+    float lastGCPause_;
+    float maxGCPause_;
+
+    HiresTimer frameTimer_;
+    float frameBusyTime_;
+    bool frameRendered_;
+
     Vector<String> moduleSearchPath_;
     String lastModuleSearchFilename_;
 
@@ -288,12 +356,19 @@ private:
 
     SharedPtr<JSMetrics> metrics_;
 
+    HashMap<Scene*, SharedPtr<JSComponentUpdater> > componentUpdaters_;
+
     static Vector<JSAPIPackageRegistration*> packageRegistrations_;
 
     unsigned stashCount_;
     unsigned totalStashCount_;
     unsigned totalUnstashCount_;
 
+    // stash registry array, slots are stored on the RefCounted
+    void* stashRegistry_;
+    unsigned stashSlotCount_;
+    PODVector<unsigned> stashFreeSlots_;
+
     static JSVM* instance_;
 
 };
@@ -41,16 +41,22 @@ namespace Atomic
     {
     }
 
-    void NETEventDispatcher::BeginSendEvent(Context* context, Object* sender, StringHash eventType, VariantMap& eventData)
+    void NETEventDispatcher::BeginSendEvent(Context* context, Object* sender, StringHash eventType, TypedEventData& typedEventData)
     {
         if (eventType == E_UPDATE)
         {
-            NETCore::DispatchUpdateEvent(eventData[Update::P_TIMESTEP].GetFloat());
+            // Read the time step from the typed payload when possible, to avoid building the map every frame
+            if (typedEventData.GetToVariantMapFunction() == &TypedEventPayloadToVariantMap<Update::Payload>)
+                NETCore::DispatchUpdateEvent(static_cast<const Update::Payload*>(typedEventData.GetPayload())->timeStep_);
+            else
+                NETCore::DispatchUpdateEvent(typedEventData.GetVariantMap()[Update::P_TIMESTEP].GetFloat());
         }
 
         if (!netEvents_.Contains(eventType))
             return;
 
+        VariantMap& eventData = typedEventData.GetVariantMap();
+
         // Do any conversion that is necessary, will probably want to factor this into something better
 
         if (eventType == E_NODECOLLISION)
@@ -73,7 +79,7 @@ namespace Atomic
 
     }
 
-    void NETEventDispatcher::EndSendEvent(Context* context, Object* sender, StringHash eventType, VariantMap& eventData)
+    void NETEventDispatcher::EndSendEvent(Context* context, Object* sender, StringHash eventType, TypedEventData& eventData)
     {
         if (!netEvents_.Contains(eventType))
             return;
@@ -42,8 +42,8 @@ public:
 
 private:
 
-    void BeginSendEvent(Context* context, Object* sender, StringHash eventType, VariantMap& eventData);
-    void EndSendEvent(Context* context, Object* sender, StringHash eventType, VariantMap& eventData);
+    void BeginSendEvent(Context* context, Object* sender, StringHash eventType, TypedEventData& eventData);
+    void EndSendEvent(Context* context, Object* sender, StringHash eventType, TypedEventData& eventData);
 
     HashMap<StringHash, bool> netEvents_;
 
@@ -204,6 +204,19 @@ struct dtCrowdAgentDebugInfo
 /// Type for the update callback.
 typedef void (*dtUpdateCallback)(dtCrowdAgent* ag, float dt);
 
+// ATOMIC BEGIN
+class dtCrowd;
+
+/// Type for a crowd update phase run over a range of the active agents.
+/// @p threadIndex selects the per-thread queries. [Limits: 0 <= value < thread count given to dtCrowd::setParallelFor()]
+typedef void (*dtCrowdJob)(dtCrowd* crowd, int threadIndex, int begin, int end);
+
+/// Type for the parallel for callback. Must run @p job over [0, @p count), possibly split into ranges
+/// on several threads, and return when all ranges are done. Ranges running at the same time must have
+/// different thread indices.
+typedef void (*dtParallelForCallback)(void* userData, dtCrowd* crowd, dtCrowdJob job, int count);
+// ATOMIC END
+
 /// Provides local steering behaviors for a group of agents. 
 /// @ingroup crowd
 class dtCrowd
@@ -234,6 +247,33 @@ class dtCrowd
 
 	dtNavMeshQuery* m_navquery;
 
+	// ATOMIC BEGIN
+	dtParallelForCallback m_parallelFor;
+	void* m_parallelForUserData;
+	int m_maxThreads;
+	dtNavMeshQuery** m_threadNavqueries;
+	dtObstacleAvoidanceQuery** m_threadObstacleQueries;
+	int* m_threadSampleCounts;
+	struct dtCrowdAgentSortItem* m_sortItems;
+
+	dtCrowdAgent** m_updateAgents;
+	int m_updateAgentCount;
+	float m_updateDt;
+	dtCrowdAgentDebugInfo* m_updateDebug;
+
+	void parallelFor(dtCrowdJob job, const int count);
+	void sortAgentsSpatially(dtCrowdAgent** agents, const int nagents);
+	void freeThreadQueries();
+
+	static void updateNeighbours(dtCrowd* crowd, int threadIndex, int begin, int end);
+	static void updateCorners(dtCrowd* crowd, int threadIndex, int begin, int end);
+	static void updateSteering(dtCrowd* crowd, int threadIndex, int begin, int end);
+	static void updateVelocityPlanning(dtCrowd* crowd, int threadIndex, int begin, int end);
+	static void updateIntegration(dtCrowd* crowd, int threadIndex, int begin, int end);
+	static void updateCollisions(dtCrowd* crowd, int threadIndex, int begin, int end);
+	static void updateNavmeshMovement(dtCrowd* crowd, int threadIndex, int begin, int end);
+	// ATOMIC END
+
 	void updateTopologyOptimization(dtCrowdAgent** agents, const int nagents, const float dt);
 	void updateMoveRequest(const float dt);
 	void checkPathValidity(dtCrowdAgent** agents, const int nagents, const float dt);
@@ -256,6 +296,16 @@ public:
 	///  @param[in]		cb				The update callback.
 	/// @return True if the initialization succeeded.
 	bool init(const int maxAgents, const float maxAgentRadius, dtNavMesh* nav, dtUpdateCallback cb = 0);
+
+	// ATOMIC BEGIN
+	/// Sets the callback used to run the per-agent update phases in parallel. Must be called after init().
+	/// Allocates a navigation mesh query and an obstacle avoidance query for each thread.
+	///  @param[in]		cb				The parallel for callback, or null to update on the calling thread only.
+	///  @param[in]		userData		User data passed to the callback.
+	///  @param[in]		maxThreads		The number of thread indices the callback may use. [Limit: >= 1]
+	/// @return True if the per-thread queries were allocated.
+	bool setParallelFor(dtParallelForCallback cb, void* userData, const int maxThreads);
+	// ATOMIC END
 	
 	/// Sets the shared avoidance configuration for the specified index.
 	///  @param[in]		idx		The index. [Limits: 0 <= value < #DT_CROWD_MAX_OBSTAVOIDANCE_PARAMS]
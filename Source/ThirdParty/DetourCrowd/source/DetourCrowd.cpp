@@ -331,6 +331,14 @@ Notes:
 
 */
 
+// ATOMIC BEGIN
+struct dtCrowdAgentSortItem
+{
+	unsigned int key;
+	dtCrowdAgent* agent;
+};
+// ATOMIC END
+
 dtCrowd::dtCrowd() :
 	// Urho3D: Add update callback support
 	m_updateCallback(0),
@@ -344,7 +352,20 @@ dtCrowd::dtCrowd() :
 	m_maxPathResult(0),
 	m_maxAgentRadius(0),
 	m_velocitySampleCount(0),
-	m_navquery(0)
+	m_navquery(0),
+	// ATOMIC BEGIN
+	m_parallelFor(0),
+	m_parallelForUserData(0),
+	m_maxThreads(0),
+	m_threadNavqueries(0),
+	m_threadObstacleQueries(0),
+	m_threadSampleCounts(0),
+	m_sortItems(0),
+	m_updateAgents(0),
+	m_updateAgentCount(0),
+	m_updateDt(0),
+	m_updateDebug(0)
+	// ATOMIC END
 {
 	// Urho3D: initialize all class members
 	memset(&m_ext, 0, sizeof(m_ext));
@@ -358,6 +379,13 @@ dtCrowd::~dtCrowd()
 
 void dtCrowd::purge()
 {
+	// ATOMIC BEGIN
+	freeThreadQueries();
+
+	dtFree(m_sortItems);
+	m_sortItems = 0;
+	// ATOMIC END
+
 	for (int i = 0; i < m_maxAgents; ++i)
 		m_agents[i].~dtCrowdAgent();
 	dtFree(m_agents);
@@ -466,10 +494,95 @@ bool dtCrowd::init(const int maxAgents, const float maxAgentRadius, dtNavMesh* n
 		return false;
 	if (dtStatusFailed(m_navquery->init(nav, MAX_COMMON_NODES)))
 		return false;
+
+	// ATOMIC BEGIN
+	m_sortItems = (dtCrowdAgentSortItem*)dtAlloc(sizeof(dtCrowdAgentSortItem)*m_maxAgents, DT_ALLOC_PERM);
+	if (!m_sortItems)
+		return false;
+
+	// Single-threaded until setParallelFor() is called
+	if (!setParallelFor(0, 0, 1))
+		return false;
+	// ATOMIC END
 	
 	return true;
 }
 
+// ATOMIC BEGIN
+void dtCrowd::freeThreadQueries()
+{
+	// Index 0 refers to the queries used by the serial parts of the update
+	for (int i = 1; i < m_maxThreads; ++i)
+	{
+		dtFreeNavMeshQuery(m_threadNavqueries[i]);
+		dtFreeObstacleAvoidanceQuery(m_threadObstacleQueries[i]);
+	}
+
+	dtFree(m_threadNavqueries);
+	m_threadNavqueries = 0;
+	dtFree(m_threadObstacleQueries);
+	m_threadObstacleQueries = 0;
+	dtFree(m_threadSampleCounts);
+	m_threadSampleCounts = 0;
+
+	m_maxThreads = 0;
+	m_parallelFor = 0;
+	m_parallelForUserData = 0;
+}
+
+bool dtCrowd::setParallelFor(dtParallelForCallback cb, void* userData, const int maxThreads)
+{
+	if (!m_navquery || maxThreads < 1)
+		return false;
+
+	freeThreadQueries();
+
+	m_threadNavqueries = (dtNavMeshQuery**)dtAlloc(sizeof(dtNavMeshQuery*)*maxThreads, DT_ALLOC_PERM);
+	m_threadObstacleQueries = (dtObstacleAvoidanceQuery**)dtAlloc(sizeof(dtObstacleAvoidanceQuery*)*maxThreads, DT_ALLOC_PERM);
+	m_threadSampleCounts = (int*)dtAlloc(sizeof(int)*maxThreads, DT_ALLOC_PERM);
+	if (!m_threadNavqueries || !m_threadObstacleQueries || !m_threadSampleCounts)
+	{
+		dtFree(m_threadNavqueries);
+		m_threadNavqueries = 0;
+		dtFree(m_threadObstacleQueries);
+		m_threadObstacleQueries = 0;
+		dtFree(m_threadSampleCounts);
+		m_threadSampleCounts = 0;
+		return false;
+	}
+
+	memset(m_threadNavqueries, 0, sizeof(dtNavMeshQuery*)*maxThreads);
+	memset(m_threadObstacleQueries, 0, sizeof(dtObstacleAvoidanceQuery*)*maxThreads);
+	memset(m_threadSampleCounts, 0, sizeof(int)*maxThreads);
+	m_threadNavqueries[0] = m_navquery;
+	m_threadObstacleQueries[0] = m_obstacleQuery;
+	m_maxThreads = maxThreads;
+
+	for (int i = 1; i < maxThreads; ++i)
+	{
+		m_threadNavqueries[i] = dtAllocNavMeshQuery();
+		if (!m_threadNavqueries[i] || dtStatusFailed(m_threadNavqueries[i]->init(m_navquery->getAttachedNavMesh(), MAX_COMMON_NODES)))
+		{
+			freeThreadQueries();
+			setParallelFor(0, 0, 1);
+			return false;
+		}
+
+		m_threadObstacleQueries[i] = dtAllocObstacleAvoidanceQuery();
+		if (!m_threadObstacleQueries[i] || !m_threadObstacleQueries[i]->init(6, 8))
+		{
+			freeThreadQueries();
+			setParallelFor(0, 0, 1);
+			return false;
+		}
+	}
+
+	m_parallelFor = cb;
+	m_parallelForUserData = userData;
+	return true;
+}
+// ATOMIC END
+
 void dtCrowd::setObstacleAvoidanceParams(const int idx, const dtObstacleAvoidanceParams* params)
 {
 	if (idx >= 0 && idx < DT_CROWD_MAX_OBSTAVOIDANCE_PARAMS)
@@ -1058,8 +1171,6 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 {
 	m_velocitySampleCount = 0;
 	
-	const int debugIdx = debug ? debug->idx : -1;
-	
 	dtCrowdAgent** agents = m_activeAgents;
 	int nagents = getActiveAgents(agents, m_maxAgents);
 
@@ -1072,6 +1183,13 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 	// Optimize path topology.
 	updateTopologyOptimization(agents, nagents, dt);
 	
+	// ATOMIC BEGIN
+	// The per-agent phases below only read other agents' state written by an earlier phase,
+	// and each thread uses its own queries, so they run over ranges of agents in parallel.
+	if (m_parallelFor)
+		sortAgentsSpatially(agents, nagents);
+	// ATOMIC END
+
 	// Register agents to proximity grid.
 	m_grid->clear();
 	for (int i = 0; i < nagents; ++i)
@@ -1081,9 +1199,206 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		const float r = ag->params.radius;
 		m_grid->addItem((unsigned short)i, p[0]-r, p[2]-r, p[0]+r, p[2]+r);
 	}
-	
+
+	// ATOMIC BEGIN
+	m_updateAgents = agents;
+	m_updateAgentCount = nagents;
+	m_updateDt = dt;
+	m_updateDebug = debug;
+	for (int i = 0; i < m_maxThreads; ++i)
+		m_threadSampleCounts[i] = 0;
+
 	// Get nearby navmesh segments and agents to collide with.
+	parallelFor(updateNeighbours, nagents);
+
+	// Find next corner to steer to.
+	parallelFor(updateCorners, nagents);
+	// ATOMIC END
+	
+	// Trigger off-mesh connections (depends on corners).
 	for (int i = 0; i < nagents; ++i)
+	{
+		dtCrowdAgent* ag = agents[i];
+		
+		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
+			continue;
+		if (ag->targetState == DT_CROWDAGENT_TARGET_NONE || ag->targetState == DT_CROWDAGENT_TARGET_VELOCITY)
+			continue;
+		
+		// Check 
+		const float triggerRadius = ag->params.radius*2.25f;
+		if (overOffmeshConnection(ag, triggerRadius))
+		{
+			// Prepare to off-mesh connection.
+			const int idx = (int)(ag - m_agents);
+			dtCrowdAgentAnimation* anim = &m_agentAnims[idx];
+			
+			// Adjust the path over the off-mesh connection.
+			dtPolyRef refs[2];
+			if (ag->corridor.moveOverOffmeshConnection(ag->cornerPolys[ag->ncorners-1], refs,
+													   anim->startPos, anim->endPos, m_navquery))
+			{
+				dtVcopy(anim->initPos, ag->npos);
+				anim->polyRef = refs[1];
+				anim->active = true;
+				anim->t = 0.0f;
+				anim->tmax = (dtVdist2D(anim->startPos, anim->endPos) / ag->params.maxSpeed) * 0.5f;
+				
+				ag->state = DT_CROWDAGENT_STATE_OFFMESH;
+				ag->ncorners = 0;
+				ag->nneis = 0;
+				continue;
+			}
+			else
+			{
+				// Path validity check will ensure that bad/blocked connections will be replanned.
+			}
+		}
+	}
+
+	// ATOMIC BEGIN
+	// Calculate steering.
+	parallelFor(updateSteering, nagents);
+
+	// Velocity planning.
+	parallelFor(updateVelocityPlanning, nagents);
+
+	// Integrate.
+	parallelFor(updateIntegration, nagents);
+
+	// Handle collisions.
+	for (int iter = 0; iter < 4; ++iter)
+	{
+		parallelFor(updateCollisions, nagents);
+
+		for (int i = 0; i < nagents; ++i)
+		{
+			dtCrowdAgent* ag = agents[i];
+			if (ag->state != DT_CROWDAGENT_STATE_WALKING)
+				continue;
+			
+			dtVadd(ag->npos, ag->npos, ag->disp);
+		}
+	}
+
+	// Move along navmesh.
+	parallelFor(updateNavmeshMovement, nagents);
+
+	for (int i = 0; i < m_maxThreads; ++i)
+		m_velocitySampleCount += m_threadSampleCounts[i];
+
+	// Urho3D: Add update callback support
+	// The callback may touch application state, so it is always called on the updating thread
+	if (m_updateCallback)
+	{
+		for (int i = 0; i < nagents; ++i)
+		{
+			dtCrowdAgent* ag = agents[i];
+			if (ag->state != DT_CROWDAGENT_STATE_WALKING)
+				continue;
+			(*m_updateCallback)(ag, dt);
+		}
+	}
+	// ATOMIC END
+	
+	// Update agents using off-mesh connection.
+	for (int i = 0; i < m_maxAgents; ++i)
+	{
+		dtCrowdAgentAnimation* anim = &m_agentAnims[i];
+		if (!anim->active)
+			continue;
+		// ATOMIC BEGIN
+		// Animations are indexed by agent, not by active agent
+		dtCrowdAgent* ag = &m_agents[i];
+		// ATOMIC END
+
+		anim->t += dt;
+		if (anim->t > anim->tmax)
+		{
+			// Reset animation
+			anim->active = false;
+			// Prepare agent for walking.
+			ag->state = DT_CROWDAGENT_STATE_WALKING;
+			continue;
+		}
+		
+		// Update position
+		const float ta = anim->tmax*0.15f;
+		const float tb = anim->tmax;
+		if (anim->t < ta)
+		{
+			const float u = tween(anim->t, 0.0, ta);
+			dtVlerp(ag->npos, anim->initPos, anim->startPos, u);
+		}
+		else
+		{
+			const float u = tween(anim->t, ta, tb);
+			dtVlerp(ag->npos, anim->startPos, anim->endPos, u);
+		}
+			
+		// Update velocity.
+		dtVset(ag->vel, 0,0,0);
+		dtVset(ag->dvel, 0,0,0);
+	}
+	
+}
+
+// ATOMIC BEGIN
+static int compareAgentSortItems(const void* va, const void* vb)
+{
+	const dtCrowdAgentSortItem* a = (const dtCrowdAgentSortItem*)va;
+	const dtCrowdAgentSortItem* b = (const dtCrowdAgentSortItem*)vb;
+	if (a->key != b->key)
+		return a->key < b->key ? -1 : 1;
+	// Keep the order stable between frames for agents in the same cell
+	return a->agent < b->agent ? -1 : (a->agent > b->agent ? 1 : 0);
+}
+
+static unsigned int spreadBits(unsigned int v)
+{
+	v &= 0xffff;
+	v = (v | (v << 8)) & 0x00ff00ff;
+	v = (v | (v << 4)) & 0x0f0f0f0f;
+	v = (v | (v << 2)) & 0x33333333;
+	v = (v | (v << 1)) & 0x55555555;
+	return v;
+}
+
+/// Orders the active agents along a Morton curve of proximity grid cells. Each contiguous range handed
+/// to a thread then covers a compact spatial partition, so neighbour queries stay in cache.
+void dtCrowd::sortAgentsSpatially(dtCrowdAgent** agents, const int nagents)
+{
+	const float invCellSize = 1.0f / m_grid->getCellSize();
+
+	for (int i = 0; i < nagents; ++i)
+	{
+		dtCrowdAgent* ag = agents[i];
+		const unsigned int x = (unsigned int)((int)dtMathFloorf(ag->npos[0] * invCellSize) + 0x8000);
+		const unsigned int z = (unsigned int)((int)dtMathFloorf(ag->npos[2] * invCellSize) + 0x8000);
+		m_sortItems[i].key = spreadBits(x) | (spreadBits(z) << 1);
+		m_sortItems[i].agent = ag;
+	}
+
+	qsort(m_sortItems, nagents, sizeof(dtCrowdAgentSortItem), compareAgentSortItems);
+
+	for (int i = 0; i < nagents; ++i)
+		agents[i] = m_sortItems[i].agent;
+}
+
+void dtCrowd::parallelFor(dtCrowdJob job, const int count)
+{
+	if (m_parallelFor && count > 1)
+		(*m_parallelFor)(m_parallelForUserData, this, job, count);
+	else
+		(*job)(this, 0, 0, count);
+}
+
+void dtCrowd::updateNeighbours(dtCrowd* crowd, int threadIndex, int begin, int end)
+{
+	dtCrowdAgent** agents = crowd->m_updateAgents;
+	dtNavMeshQuery* navquery = crowd->m_threadNavqueries[threadIndex];
+
+	for (int i = begin; i < end; ++i)
 	{
 		dtCrowdAgent* ag = agents[i];
 		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
@@ -1093,21 +1408,28 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		// if it has become invalid.
 		const float updateThr = ag->params.collisionQueryRange*0.25f;
 		if (dtVdist2DSqr(ag->npos, ag->boundary.getCenter()) > dtSqr(updateThr) ||
-			!ag->boundary.isValid(m_navquery, &m_filters[ag->params.queryFilterType]))
+			!ag->boundary.isValid(navquery, &crowd->m_filters[ag->params.queryFilterType]))
 		{
 			ag->boundary.update(ag->corridor.getFirstPoly(), ag->npos, ag->params.collisionQueryRange,
-								m_navquery, &m_filters[ag->params.queryFilterType]);
+								navquery, &crowd->m_filters[ag->params.queryFilterType]);
 		}
 		// Query neighbour agents
 		ag->nneis = getNeighbours(ag->npos, ag->params.height, ag->params.collisionQueryRange,
 								  ag, ag->neis, DT_CROWDAGENT_MAX_NEIGHBOURS,
-								  agents, nagents, m_grid);
+								  agents, crowd->m_updateAgentCount, crowd->m_grid);
 		for (int j = 0; j < ag->nneis; j++)
-			ag->neis[j].idx = getAgentIndex(agents[ag->neis[j].idx]);
+			ag->neis[j].idx = crowd->getAgentIndex(agents[ag->neis[j].idx]);
 	}
-	
-	// Find next corner to steer to.
-	for (int i = 0; i < nagents; ++i)
+}
+
+void dtCrowd::updateCorners(dtCrowd* crowd, int threadIndex, int begin, int end)
+{
+	dtCrowdAgent** agents = crowd->m_updateAgents;
+	dtNavMeshQuery* navquery = crowd->m_threadNavqueries[threadIndex];
+	dtCrowdAgentDebugInfo* debug = crowd->m_updateDebug;
+	const int debugIdx = debug ? debug->idx : -1;
+
+	for (int i = begin; i < end; ++i)
 	{
 		dtCrowdAgent* ag = agents[i];
 		
@@ -1118,17 +1440,17 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		
 		// Find corners for steering
 		ag->ncorners = ag->corridor.findCorners(ag->cornerVerts, ag->cornerFlags, ag->cornerPolys,
-												DT_CROWDAGENT_MAX_CORNERS, m_navquery, &m_filters[ag->params.queryFilterType]);
+												DT_CROWDAGENT_MAX_CORNERS, navquery, &crowd->m_filters[ag->params.queryFilterType]);
 		
 		// Check to see if the corner after the next corner is directly visible,
 		// and short cut to there.
 		if ((ag->params.updateFlags & DT_CROWD_OPTIMIZE_VIS) && ag->ncorners > 0)
 		{
 			const float* target = &ag->cornerVerts[dtMin(1,ag->ncorners-1)*3];
-			ag->corridor.optimizePathVisibility(target, ag->params.pathOptimizationRange, m_navquery, &m_filters[ag->params.queryFilterType]);
+			ag->corridor.optimizePathVisibility(target, ag->params.pathOptimizationRange, navquery, &crowd->m_filters[ag->params.queryFilterType]);
 			
 			// Copy data for debug purposes.
-			if (debugIdx == i)
+			if (debugIdx == crowd->getAgentIndex(ag))
 			{
 				dtVcopy(debug->optStart, ag->corridor.getPos());
 				dtVcopy(debug->optEnd, target);
@@ -1137,57 +1459,20 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		else
 		{
 			// Copy data for debug purposes.
-			if (debugIdx == i)
+			if (debugIdx == crowd->getAgentIndex(ag))
 			{
 				dtVset(debug->optStart, 0,0,0);
 				dtVset(debug->optEnd, 0,0,0);
 			}
 		}
 	}
-	
-	// Trigger off-mesh connections (depends on corners).
-	for (int i = 0; i < nagents; ++i)
-	{
-		dtCrowdAgent* ag = agents[i];
-		
-		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-			continue;
-		if (ag->targetState == DT_CROWDAGENT_TARGET_NONE || ag->targetState == DT_CROWDAGENT_TARGET_VELOCITY)
-			continue;
-		
-		// Check 
-		const float triggerRadius = ag->params.radius*2.25f;
-		if (overOffmeshConnection(ag, triggerRadius))
-		{
-			// Prepare to off-mesh connection.
-			const int idx = (int)(ag - m_agents);
-			dtCrowdAgentAnimation* anim = &m_agentAnims[idx];
-			
-			// Adjust the path over the off-mesh connection.
-			dtPolyRef refs[2];
-			if (ag->corridor.moveOverOffmeshConnection(ag->cornerPolys[ag->ncorners-1], refs,
-													   anim->startPos, anim->endPos, m_navquery))
-			{
-				dtVcopy(anim->initPos, ag->npos);
-				anim->polyRef = refs[1];
-				anim->active = true;
-				anim->t = 0.0f;
-				anim->tmax = (dtVdist2D(anim->startPos, anim->endPos) / ag->params.maxSpeed) * 0.5f;
-				
-				ag->state = DT_CROWDAGENT_STATE_OFFMESH;
-				ag->ncorners = 0;
-				ag->nneis = 0;
-				continue;
-			}
-			else
-			{
-				// Path validity check will ensure that bad/blocked connections will be replanned.
-			}
-		}
-	}
-		
-	// Calculate steering.
-	for (int i = 0; i < nagents; ++i)
+}
+
+void dtCrowd::updateSteering(dtCrowd* crowd, int /*threadIndex*/, int begin, int end)
+{
+	dtCrowdAgent** agents = crowd->m_updateAgents;
+
+	for (int i = begin; i < end; ++i)
 	{
 		dtCrowdAgent* ag = agents[i];
 
@@ -1231,7 +1516,7 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 			
 			for (int j = 0; j < ag->nneis; ++j)
 			{
-				const dtCrowdAgent* nei = &m_agents[ag->neis[j].idx];
+				const dtCrowdAgent* nei = &crowd->m_agents[ag->neis[j].idx];
 				
 				float diff[3];
 				dtVsub(diff, ag->npos, nei->npos);
@@ -1264,9 +1549,16 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		// Set the desired velocity.
 		dtVcopy(ag->dvel, dvel);
 	}
-	
-	// Velocity planning.	
-	for (int i = 0; i < nagents; ++i)
+}
+
+void dtCrowd::updateVelocityPlanning(dtCrowd* crowd, int threadIndex, int begin, int end)
+{
+	dtCrowdAgent** agents = crowd->m_updateAgents;
+	dtObstacleAvoidanceQuery* obstacleQuery = crowd->m_threadObstacleQueries[threadIndex];
+	dtCrowdAgentDebugInfo* debug = crowd->m_updateDebug;
+	const int debugIdx = debug ? debug->idx : -1;
+
+	for (int i = begin; i < end; ++i)
 	{
 		dtCrowdAgent* ag = agents[i];
 		
@@ -1275,13 +1567,13 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		
 		if (ag->params.updateFlags & DT_CROWD_OBSTACLE_AVOIDANCE)
 		{
-			m_obstacleQuery->reset();
+			obstacleQuery->reset();
 			
 			// Add neighbours as obstacles.
 			for (int j = 0; j < ag->nneis; ++j)
 			{
-				const dtCrowdAgent* nei = &m_agents[ag->neis[j].idx];
-				m_obstacleQuery->addCircle(nei->npos, nei->params.radius, nei->vel, nei->dvel);
+				const dtCrowdAgent* nei = &crowd->m_agents[ag->neis[j].idx];
+				obstacleQuery->addCircle(nei->npos, nei->params.radius, nei->vel, nei->dvel);
 			}
 
 			// Append neighbour segments as obstacles.
@@ -1290,30 +1582,30 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 				const float* s = ag->boundary.getSegment(j);
 				if (dtTriArea2D(ag->npos, s, s+3) < 0.0f)
 					continue;
-				m_obstacleQuery->addSegment(s, s+3);
+				obstacleQuery->addSegment(s, s+3);
 			}
 
 			dtObstacleAvoidanceDebugData* vod = 0;
-			if (debugIdx == i) 
+			if (debugIdx == crowd->getAgentIndex(ag))
 				vod = debug->vod;
 			
 			// Sample new safe velocity.
 			bool adaptive = true;
 			int ns = 0;
 
-			const dtObstacleAvoidanceParams* params = &m_obstacleQueryParams[ag->params.obstacleAvoidanceType];
+			const dtObstacleAvoidanceParams* params = &crowd->m_obstacleQueryParams[ag->params.obstacleAvoidanceType];
 				
 			if (adaptive)
 			{
-				ns = m_obstacleQuery->sampleVelocityAdaptive(ag->npos, ag->params.radius, ag->desiredSpeed,
-															 ag->vel, ag->dvel, ag->nvel, params, vod);
+				ns = obstacleQuery->sampleVelocityAdaptive(ag->npos, ag->params.radius, ag->desiredSpeed,
+														   ag->vel, ag->dvel, ag->nvel, params, vod);
 			}
 			else
 			{
-				ns = m_obstacleQuery->sampleVelocityGrid(ag->npos, ag->params.radius, ag->desiredSpeed,
-														 ag->vel, ag->dvel, ag->nvel, params, vod);
+				ns = obstacleQuery->sampleVelocityGrid(ag->npos, ag->params.radius, ag->desiredSpeed,
+													   ag->vel, ag->dvel, ag->nvel, params, vod);
 			}
-			m_velocitySampleCount += ns;
+			crowd->m_threadSampleCounts[threadIndex] += ns;
 		}
 		else
 		{
@@ -1321,95 +1613,97 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 			dtVcopy(ag->nvel, ag->dvel);
 		}
 	}
+}
 
-	// Integrate.
-	for (int i = 0; i < nagents; ++i)
+void dtCrowd::updateIntegration(dtCrowd* crowd, int /*threadIndex*/, int begin, int end)
+{
+	dtCrowdAgent** agents = crowd->m_updateAgents;
+
+	for (int i = begin; i < end; ++i)
 	{
 		dtCrowdAgent* ag = agents[i];
 		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
 			continue;
-		integrate(ag, dt);
+		integrate(ag, crowd->m_updateDt);
 	}
-	
-	// Handle collisions.
+}
+
+void dtCrowd::updateCollisions(dtCrowd* crowd, int /*threadIndex*/, int begin, int end)
+{
 	static const float COLLISION_RESOLVE_FACTOR = 0.7f;
-	
-	for (int iter = 0; iter < 4; ++iter)
+
+	dtCrowdAgent** agents = crowd->m_updateAgents;
+
+	for (int i = begin; i < end; ++i)
 	{
-		for (int i = 0; i < nagents; ++i)
+		dtCrowdAgent* ag = agents[i];
+		const int idx0 = crowd->getAgentIndex(ag);
+		
+		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
+			continue;
+
+		dtVset(ag->disp, 0,0,0);
+		
+		float w = 0;
+
+		for (int j = 0; j < ag->nneis; ++j)
 		{
-			dtCrowdAgent* ag = agents[i];
-			const int idx0 = getAgentIndex(ag);
-			
-			if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-				continue;
+			const dtCrowdAgent* nei = &crowd->m_agents[ag->neis[j].idx];
+			const int idx1 = crowd->getAgentIndex(nei);
 
-			dtVset(ag->disp, 0,0,0);
+			float diff[3];
+			dtVsub(diff, ag->npos, nei->npos);
+			diff[1] = 0;
 			
-			float w = 0;
-
-			for (int j = 0; j < ag->nneis; ++j)
+			float dist = dtVlenSqr(diff);
+			if (dist > dtSqr(ag->params.radius + nei->params.radius))
+				continue;
+			dist = dtMathSqrtf(dist);
+			float pen = (ag->params.radius + nei->params.radius) - dist;
+			if (dist < 0.0001f)
 			{
-				const dtCrowdAgent* nei = &m_agents[ag->neis[j].idx];
-				const int idx1 = getAgentIndex(nei);
-
-				float diff[3];
-				dtVsub(diff, ag->npos, nei->npos);
-				diff[1] = 0;
-				
-				float dist = dtVlenSqr(diff);
-				if (dist > dtSqr(ag->params.radius + nei->params.radius))
-					continue;
-				dist = dtMathSqrtf(dist);
-				float pen = (ag->params.radius + nei->params.radius) - dist;
-				if (dist < 0.0001f)
-				{
-					// Agents on top of each other, try to choose diverging separation directions.
-					if (idx0 > idx1)
-						dtVset(diff, -ag->dvel[2],0,ag->dvel[0]);
-					else
-						dtVset(diff, ag->dvel[2],0,-ag->dvel[0]);
-					pen = 0.01f;
-				}
+				// Agents on top of each other, try to choose diverging separation directions.
+				if (idx0 > idx1)
+					dtVset(diff, -ag->dvel[2],0,ag->dvel[0]);
 				else
-				{
-					pen = (1.0f/dist) * (pen*0.5f) * COLLISION_RESOLVE_FACTOR;
-				}
-				
-				// Urho3D: Avoid tremble when another agent can not move away
-				if (ag->params.separationWeight < 0.0001f) 
-					continue;
-				
-				dtVmad(ag->disp, ag->disp, diff, pen);			
-				
-				w += 1.0f;
+					dtVset(diff, ag->dvel[2],0,-ag->dvel[0]);
+				pen = 0.01f;
 			}
-			
-			if (w > 0.0001f)
+			else
 			{
-				const float iw = 1.0f / w;
-				dtVscale(ag->disp, ag->disp, iw);
+				pen = (1.0f/dist) * (pen*0.5f) * COLLISION_RESOLVE_FACTOR;
 			}
+			
+			// Urho3D: Avoid tremble when another agent can not move away
+			if (ag->params.separationWeight < 0.0001f) 
+				continue;
+			
+			dtVmad(ag->disp, ag->disp, diff, pen);			
+			
+			w += 1.0f;
 		}
 		
-		for (int i = 0; i < nagents; ++i)
+		if (w > 0.0001f)
 		{
-			dtCrowdAgent* ag = agents[i];
-			if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-				continue;
-			
-			dtVadd(ag->npos, ag->npos, ag->disp);
+			const float iw = 1.0f / w;
+			dtVscale(ag->disp, ag->disp, iw);
 		}
 	}
-	
-	for (int i = 0; i < nagents; ++i)
+}
+
+void dtCrowd::updateNavmeshMovement(dtCrowd* crowd, int threadIndex, int begin, int end)
+{
+	dtCrowdAgent** agents = crowd->m_updateAgents;
+	dtNavMeshQuery* navquery = crowd->m_threadNavqueries[threadIndex];
+
+	for (int i = begin; i < end; ++i)
 	{
 		dtCrowdAgent* ag = agents[i];
 		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
 			continue;
 		
 		// Move along navmesh.
-		ag->corridor.movePosition(ag->npos, m_navquery, &m_filters[ag->params.queryFilterType]);
+		ag->corridor.movePosition(ag->npos, navquery, &crowd->m_filters[ag->params.queryFilterType]);
 		// Get valid constrained position back.
 		dtVcopy(ag->npos, ag->corridor.getPos());
 
@@ -1419,47 +1713,6 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 			ag->corridor.reset(ag->corridor.getFirstPoly(), ag->npos);
 			ag->partial = false;
 		}
-
-		// Urho3D: Add update callback support
-		if (m_updateCallback)
-			(*m_updateCallback)(ag, dt);
 	}
-	
-	// Update agents using off-mesh connection.
-	for (int i = 0; i < m_maxAgents; ++i)
-	{
-		dtCrowdAgentAnimation* anim = &m_agentAnims[i];
-		if (!anim->active)
-			continue;
-		dtCrowdAgent* ag = agents[i];
-
-		anim->t += dt;
-		if (anim->t > anim->tmax)
-		{
-			// Reset animation
-			anim->active = false;
-			// Prepare agent for walking.
-			ag->state = DT_CROWDAGENT_STATE_WALKING;
-			continue;
-		}
-		
-		// Update position
-		const float ta = anim->tmax*0.15f;
-		const float tb = anim->tmax;
-		if (anim->t < ta)
-		{
-			const float u = tween(anim->t, 0.0, ta);
-			dtVlerp(ag->npos, anim->initPos, anim->startPos, u);
-		}
-		else
-		{
-			const float u = tween(anim->t, ta, tb);
-			dtVlerp(ag->npos, anim->startPos, anim->endPos, u);
-		}
-			
-		// Update velocity.
-		dtVset(ag->vel, 0,0,0);
-		dtVset(ag->dvel, 0,0,0);
-	}
-	
 }
+// ATOMIC END
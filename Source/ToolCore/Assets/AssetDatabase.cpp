@@ -74,6 +74,15 @@ String AssetDatabase::GetCachePath()
 
 }
 
+String AssetDatabase::GetFileIndexPath()
+{
+    if (project_.Null())
+        return String::EMPTY;
+
+    // The __atomic_ prefix keeps ClearDeletedCacheFiles from removing it
+    return GetCachePath() + "__atomic_ResourceFileIndex.bin";
+}
+
 String AssetDatabase::GenerateAssetGUID()
 {
 
@@ -226,7 +235,7 @@ Asset* AssetDatabase::GetAssetByResourcePath(const String& path)
 void AssetDatabase::PruneOrphanedDotAssetFiles()
 {
 
-    if (project_.Null())
+    if (project_.Null() || fileIndex_.Null())
     {
         ATOMIC_LOGDEBUG("AssetDatabase::PruneOrphanedDotAssetFiles - called without project loaded");
         return;
@@ -238,7 +247,7 @@ void AssetDatabase::PruneOrphanedDotAssetFiles()
 
     Vector<String> allResults;
 
-    fs->ScanDir(allResults, resourcePath, "*.asset", SCAN_FILES, true);
+    fileIndex_->ScanDir(allResults, resourcePath, "*.asset", SCAN_FILES, true);
 
     for (unsigned i = 0; i < allResults.Size(); i++)
     {
@@ -246,7 +255,7 @@ void AssetDatabase::PruneOrphanedDotAssetFiles()
         String assetFilename = ReplaceExtension(dotAssetFilename, "");
 
         // remove orphaned asset files
-        if (!fs->FileExists(assetFilename) && !fs->DirExists(assetFilename))
+        if (!fileIndex_->GetEntry(assetFilename))
         {
 
             ATOMIC_LOGINFOF("Removing orphaned asset file: %s", dotAssetFilename.CString());
@@ -344,12 +353,14 @@ void AssetDatabase::PreloadAssets()
 
 void AssetDatabase::GetAllAssetPaths(Vector<String>& assetPaths)
 {
-    FileSystem* fs = GetSubsystem<FileSystem>();
+    if (project_.Null() || fileIndex_.Null())
+        return;
+
     const String& resourcePath = project_->GetResourcePath();
 
     Vector<String> allResults;
 
-    fs->ScanDir(allResults, resourcePath, "", SCAN_FILES | SCAN_DIRS, true);
+    fileIndex_->ScanDir(allResults, resourcePath, "", SCAN_FILES | SCAN_DIRS, true);
 
     assetPaths.Push(RemoveTrailingSlash(resourcePath));
 
@@ -445,6 +456,10 @@ void AssetDatabase::Scan()
 
     assetScanDepth_++;
 
+    // Revalidate the resource file index, so that only changed directories are listed again
+    if (fileIndex_.NotNull())
+        fileIndex_->Update();
+
     PruneOrphanedDotAssetFiles();
 
     Vector<String> assetPaths;
@@ -459,9 +474,14 @@ void AssetDatabase::Scan()
     {
         const String& path = assetPaths[i];
 
-        String dotAssetFilename = GetDotAssetFilename(path);
+        // Scanned paths have no trailing slash, so this matches GetDotAssetFilename without checking for a directory
+        String dotAssetFilename = path + ".asset";
 
-        if (!fs->FileExists(dotAssetFilename))
+        // The resource directory's own .asset file lies outside the file index, so check it on disk
+        bool dotAssetExists = dotAssetFilename.StartsWith(fileIndex_->GetRootPath()) ?
+            fileIndex_->FileExists(dotAssetFilename) : fs->FileExists(dotAssetFilename);
+
+        if (!dotAssetExists)
         {
             // new asset
             SharedPtr<Asset> asset(new Asset(context_));
@@ -508,6 +528,9 @@ void AssetDatabase::Scan()
 
     if (!assetScanDepth_)
     {
+        if (cacheEnabled_ && GetSubsystem<FileSystem>()->DirExists(GetCachePath()))
+            fileIndex_->Save(GetFileIndexPath());
+
         SendEvent(E_ASSETSCANEND);
     }
 }
@@ -590,6 +613,10 @@ void AssetDatabase::HandleProjectBaseLoaded(StringHash eventType, VariantMap& ev
 {
     project_ = GetSubsystem<ToolSystem>()->GetProject();
 
+    fileIndex_ = new FileIndex(context_);
+    fileIndex_->Load(GetFileIndexPath());
+    fileIndex_->SetRootPath(project_->GetResourcePath());
+
     ReadImportConfig();
     ReadAssetCacheConfig();
 
@@ -622,6 +649,7 @@ void AssetDatabase::HandleProjectUnloaded(StringHash eventType, VariantMap& even
     usedGUID_.Clear();
     assetImportErrorTimes_.Clear();
     project_ = 0;
+    fileIndex_ = 0;
 
     UnsubscribeFromEvent(E_FILECHANGED);
 }
@@ -24,6 +24,7 @@
 
 #include <Atomic/Core/Object.h>
 #include <Atomic/Container/List.h>
+#include <Atomic/IO/FileIndex.h>
 #include "AssetCacheManager.h"
 #include "Asset.h"
 
@@ -112,6 +113,9 @@ private:
 
     void GetAllAssetPaths(Vector<String>& assetPaths);
 
+    /// Return the path of the saved resource file index, kept in the asset cache
+    String GetFileIndexPath();
+
     void CompleteProjectAssetsLoad();
 
     bool ImportDirtyAssets();
@@ -144,6 +148,9 @@ private:
     bool cacheEnabled_;
 
     SharedPtr<AssetCacheManager> cacheManager_;
+
+    /// Index of the project resource files, revalidated on each scan
+    SharedPtr<FileIndex> fileIndex_;
 };
 
 }